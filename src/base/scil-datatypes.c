@@ -5,7 +5,6 @@
 static char * dtype_names[] = {
     "unknown",
     "float",
-    "float16",
     "double",
     "int8",
     "int16",
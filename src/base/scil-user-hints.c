@@ -91,6 +91,32 @@ void scil_user_hints_print(const scil_user_hints_t *hints)
 	print_performance_hint("Deco speed", hints->decomp_speed);
 }
 
+void scil_validate_params_print(const scil_validate_params_t *v)
+{
+	printf("validation:\n");
+	printf("\tvalues:\t%zu\n", v->count);
+	printf("\trange:\t%.16g to %.16g\n", v->value_min, v->value_max);
+	printf("\trmse:\t%.16g\n", v->rmse);
+	printf("\tpsnr:\t%f dB\n", v->psnr);
+	printf("\tmean sig bits:\t%f\n", v->mean_significant_bits);
+	printf("\tabs tol idx:\t%zu\n", v->absolute_tolerance_idx);
+	printf("\trel percent idx:\t%zu\n", v->relative_tolerance_percent_idx);
+	printf("\trel abs tol idx:\t%zu\n", v->relative_err_finest_abs_tolerance_idx);
+	printf("\trel error histogram:\n");
+	for(int i = 0; i < SCIL_ERROR_HISTOGRAM_BINS; i++){
+		if (v->error_histogram[i] == 0){
+			continue;
+		}
+		if (i == 0){
+			printf("\t\t>= 1:\t%zu\n", v->error_histogram[i]);
+		}else if (i == SCIL_ERROR_HISTOGRAM_BINS - 1){
+			printf("\t\texact:\t%zu\n", v->error_histogram[i]);
+		}else{
+			printf("\t\t< 2^-%d:\t%zu\n", i - 1, v->error_histogram[i]);
+		}
+	}
+}
+
 static int scil_readline(FILE * fd, int maxlength, char * out){
 	int pos = 0;
 	maxlength = maxlength - 1;
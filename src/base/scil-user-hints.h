@@ -47,11 +47,36 @@ typedef struct
 #define SCIL_ACCURACY_DBL_FINEST 1e-307
 #define SCIL_ACCURACY_INT_FINEST -1
 
+// Number of bins of the error histogram in scil_validate_params_t
+#define SCIL_ERROR_HISTOGRAM_BINS 65
+
+/**
+ * \brief Error metrics of decompressed data compared to the original data.
+ */
 typedef struct
 {
+  /** \brief positions of the values with the largest error */
   size_t absolute_tolerance_idx;
   size_t relative_tolerance_percent_idx;
   size_t relative_err_finest_abs_tolerance_idx;
+
+  /** \brief number of values compared */
+  size_t count;
+  /** \brief range of the original values */
+  double value_min;
+  double value_max;
+  /** \brief root mean square error */
+  double rmse;
+  /** \brief peak signal to noise ratio in dB based on the value range, INFINITY without error */
+  double psnr;
+  /** \brief mean number of agreeing mantissa bits (all bits for integers) */
+  double mean_significant_bits;
+  /**
+   * \brief number of values per binary order of the relative error e.
+   * Bin 0 counts e >= 1 (and errors of zero values), bin k counts 2^-k <= e < 2^(1-k),
+   * bin 63 any smaller error and the last bin the exact values.
+   */
+  size_t error_histogram[SCIL_ERROR_HISTOGRAM_BINS];
 } scil_validate_params_t;
 
 /**
@@ -115,6 +140,8 @@ void scil_user_hints_copy(scil_user_hints_t * out, const scil_user_hints_t* hint
 
 void scil_user_hints_print(const scil_user_hints_t* hints);
 
+void scil_validate_params_print(const scil_validate_params_t* validation);
+
 int scil_user_hints_load(scil_user_hints_t * out_hints, const char * filename, const char * variable);
 
 int scil_set_user_hint_from_string(scil_user_hints_t * out_hints, const char * variable_line);
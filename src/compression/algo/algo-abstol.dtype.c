@@ -18,6 +18,7 @@
 #include <scil-quantizer.h>
 #include <scil-swager.h>
 #include <scil-util.h>
+#include <scil-verify.h>
 
 #include <assert.h>
 #include <math.h>
@@ -85,6 +86,29 @@ static int write_header(byte* dest, double minimum, double absolute_tolerance, u
 //Repeat for each data type
 //Supported datatypes: double float int8_t int16_t int32_t int64_t
 
+static void verify_<DATATYPE>(const scil_context_t* ctx,
+                              const <DATATYPE>* source,
+                              const uint64_t* quantized,
+                              size_t count,
+                              double abs_tol,
+                              <DATATYPE> min,
+                              uint64_t next_free_number){
+    <DATATYPE> reconstructed[SCIL_VERIFY_CHUNK];
+    for(size_t i = 0; i < count; i += SCIL_VERIFY_CHUNK){
+      const size_t n = count - i < SCIL_VERIFY_CHUNK ? count - i : SCIL_VERIFY_CHUNK;
+      if(quantized == NULL){
+        for(size_t j = 0; j < n; ++j){
+          reconstructed[j] = min;
+        }
+      }else if (ctx->hints.fill_value == DBL_MAX){
+        scil_unquantize_buffer_<DATATYPE>(reconstructed, quantized + i, n, abs_tol, min);
+      }else{
+        scil_unquantize_buffer_fill_<DATATYPE>(reconstructed, quantized + i, n, abs_tol, min, ctx->hints.fill_value, next_free_number);
+      }
+      scilC_verify(ctx, source + i, reconstructed, n);
+    }
+}
+
 int scil_abstol_compress_<DATATYPE>(const scil_context_t* ctx,
                                     byte* restrict dest,
                                     size_t* restrict dest_size,
@@ -128,6 +152,9 @@ int scil_abstol_compress_<DATATYPE>(const scil_context_t* ctx,
     if(bits_per_value == 0){
       // constant, stop here
       *dest_size = header_size;
+      if(scilC_verify_enabled(ctx)){
+        verify_<DATATYPE>(ctx, source, NULL, count, abs_tol, min, next_free_number);
+      }
       return SCIL_NO_ERR;
     }
     *dest_size = round_up_byte((uint64_t)bits_per_value * count) + header_size;
@@ -151,6 +178,10 @@ int scil_abstol_compress_<DATATYPE>(const scil_context_t* ctx,
     }
     // ========================================================================
 
+    if(scilC_verify_enabled(ctx)){
+      verify_<DATATYPE>(ctx, source, quantized_buffer, count, abs_tol, min, next_free_number);
+    }
+
     free(quantized_buffer);
 
     return SCIL_NO_ERR;
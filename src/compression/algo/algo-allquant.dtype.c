@@ -21,6 +21,7 @@
 #include <scil-error.h>
 #include <scil-util.h>
 #include <scil-quantizer.h>
+#include <scil-verify.h>
 
 static uint64_t mask[] = {
     0,
@@ -738,7 +739,21 @@ static inline <DATATYPE> unquantize_value_<DATATYPE>(uint64_t value,
     return minimum + (<DATATYPE>)(value * 2 * absolute_tolerance);
 }
 
-static int compress_buffer_<DATATYPE>(byte * restrict dest,
+static inline <DATATYPE> decompress_rel_value_<DATATYPE>(uint64_t value,
+                                                      int sign,
+                                                      allquant_stats_<DATATYPE>* stats){
+    if(sign) {
+        return -decompress_value_<DATATYPE>(value,
+            stats->relneg.exponent_bit_count, stats->relneg.mantissa_bit_count,
+            stats->relneg.max.p.exponent);
+    }
+    return decompress_value_<DATATYPE>(value,
+        stats->relpos.exponent_bit_count, stats->relpos.mantissa_bit_count,
+        stats->relpos.min.p.exponent);
+}
+
+static int compress_buffer_<DATATYPE>(const scil_context_t* ctx,
+                                      byte * restrict dest,
                                       const <DATATYPE>* restrict source,
                                       size_t count,
                                       allquant_stats_<DATATYPE>* stats,
@@ -784,6 +799,11 @@ static int compress_buffer_<DATATYPE>(byte * restrict dest,
     uint64_t fill_prefix_value = stats->fill.prefix_value >> (8 -
         stats->fill.prefix_bit_count);
 
+    // The verification collects the values the decompression yields
+    const int verify = scilC_verify_enabled(ctx);
+    <DATATYPE> reconstructed[SCIL_VERIFY_CHUNK];
+    <DATATYPE> value = 0;
+
     // For each value:
     // - check wich region value belongs to
     // - write regions huffman prefix (variable length)
@@ -798,9 +818,11 @@ static int compress_buffer_<DATATYPE>(byte * restrict dest,
         if((double)cur.f == fill_value && fill_value != DBL_MAX) {
             swage_value(dest, fill_prefix_value,
                 stats->fill.prefix_bit_count, &bit_index);
+            value = (<DATATYPE>)fill_value;
         } else if(cur.p.exponent < finest_exponent - 1) {
             swage_value(dest, zero_prefix_value,
                 stats->zero.prefix_bit_count, &bit_index);
+            value = 0;
         } else if(cur.p.exponent < finest_exponent) {
             if(cur.p.sign) {
                 swage_value(dest, relneg_prefix_value,
@@ -813,6 +835,10 @@ static int compress_buffer_<DATATYPE>(byte * restrict dest,
                 swage_value(dest, finest_pos,
                     relpos_data_bit_count, &bit_index);
             }
+            if(verify) {
+                value = decompress_rel_value_<DATATYPE>(
+                    cur.p.sign ? finest_neg : finest_pos, cur.p.sign, stats);
+            }
         } else if(cur.p.exponent < abstol_min_exponent) {
             if(cur.p.sign) {
                 swage_value(dest, relneg_prefix_value,
@@ -836,6 +862,9 @@ static int compress_buffer_<DATATYPE>(byte * restrict dest,
                 swage_value(dest, unswaged,
                     relpos_data_bit_count, &bit_index);
             }
+            if(verify) {
+                value = decompress_rel_value_<DATATYPE>(unswaged, cur.p.sign, stats);
+            }
         } else {
             if(cur.p.sign) {
                 unswaged = quantize_value_<DATATYPE>(source[i], abstol,
@@ -844,6 +873,8 @@ static int compress_buffer_<DATATYPE>(byte * restrict dest,
                     stats->absneg.prefix_bit_count, &bit_index);
                 swage_value(dest, unswaged,
                     stats->absneg.mantissa_bit_count, &bit_index);
+                value = unquantize_value_<DATATYPE>(unswaged, abstol,
+                    stats->absneg.min.f);
             } else {
                 unswaged = quantize_value_<DATATYPE>(source[i], abstol,
                     stats->abspos.min.f);
@@ -851,6 +882,16 @@ static int compress_buffer_<DATATYPE>(byte * restrict dest,
                     stats->abspos.prefix_bit_count, &bit_index);
                 swage_value(dest, unswaged,
                     stats->abspos.mantissa_bit_count, &bit_index);
+                value = unquantize_value_<DATATYPE>(unswaged, abstol,
+                    stats->abspos.min.f);
+            }
+        }
+
+        if(verify) {
+            const size_t j = i % SCIL_VERIFY_CHUNK;
+            reconstructed[j] = value;
+            if(j == SCIL_VERIFY_CHUNK - 1 || i == count - 1) {
+                scilC_verify(ctx, source + i - j, reconstructed, j + 1);
             }
         }
     }
@@ -1017,7 +1058,7 @@ int scil_allquant_compress_<DATATYPE>(const scil_context_t* ctx,
 
     // Compress and pack / swage per value, as bits_per_value depends on
     // the region the value is in
-    if(compress_buffer_<DATATYPE>(dest + header, source, count, &stats,
+    if(compress_buffer_<DATATYPE>(ctx, dest + header, source, count, &stats,
       ctx->hints.fill_value, finest_exponent, abstol, abstol_min_exponent)) {
         return SCIL_BUFFER_ERR;
     }
@@ -5,6 +5,7 @@
 #include <algo-quantize.h>
 #include <scil-quantizer.h>
 #include <scil-util.h>
+#include <scil-verify.h>
 
 
 //Supported datatypes: float double
@@ -38,7 +39,17 @@ int scil_quantize_compress_<DATATYPE>(const scil_context_t* ctx,
     snprintf(value, 2, "%u", bits_per_value);
     scilU_dict_put(ctx->pipeline_params, "bits_per_value", value);
 
-    return scil_quantize_buffer_minmax_<DATATYPE>((uint64_t*)dest, source, count, ctx->hints.absolute_tolerance, minimum, maximum);
+    int ret = scil_quantize_buffer_minmax_<DATATYPE>((uint64_t*)dest, source, count, ctx->hints.absolute_tolerance, minimum, maximum);
+    if (ret == SCIL_NO_ERR && scilC_verify_enabled(ctx)){
+        <DATATYPE> reconstructed[SCIL_VERIFY_CHUNK];
+        for(size_t i = 0; i < count; i += SCIL_VERIFY_CHUNK){
+            const size_t n = count - i < SCIL_VERIFY_CHUNK ? count - i : SCIL_VERIFY_CHUNK;
+            const uint64_t* quantized = (const uint64_t*)dest + i;
+            scil_unquantize_buffer_<DATATYPE>(reconstructed, quantized, n, ctx->hints.absolute_tolerance, minimum);
+            scilC_verify(ctx, source + i, reconstructed, n);
+        }
+    }
+    return ret;
 }
 
 int scil_quantize_decompress_<DATATYPE>(<DATATYPE>*restrict dest,
@@ -16,11 +16,16 @@
 #include <algo/algo-sigbits.h>
 
 #include <scil-swager.h>
+#include <scil-thread-pool.h>
 #include <scil-util.h>
+#include <scil-verify.h>
 
 #include <math.h>
 #include <string.h>
 
+// Number of values encoded per block by the blocked variant
+#define SIGBITS_BLOCK_SIZE 4096
+
 static uint64_t mask[] = {
     0,
     1,
@@ -226,6 +231,96 @@ static uint64_t get_mantissa_double(uint64_t value, uint8_t mantissa_bit_count){
     return (value & mask[mantissa_bit_count]) << (MANTISSA_LENGTH_DOUBLE - mantissa_bit_count);
 }
 
+static uint8_t get_mantissa_bit_count(const scil_context_t* ctx){
+
+    // If neither hint 'sigbits' nor 'reltol' is given,
+    // this initializes to -1 as unsigned = 255
+    // and will fail the test mantissa_bit_count >= MANTISSA_LENGTH of the datatype
+    uint8_t mantissa_bit_count = ctx->hints.significant_bits - 1;
+
+    // Calculate mantissa bits from hint 'reltol', apply when more strict
+    if (ctx->hints.relative_tolerance_percent > 0.0) {
+        uint8_t mantissa_bits_rel = scilU_relative_tolerance_to_significant_bits(ctx->hints.relative_tolerance_percent) - 1;
+        if (ctx->hints.significant_bits == 0 || mantissa_bits_rel > mantissa_bit_count)
+            mantissa_bit_count = mantissa_bits_rel;
+    }
+    //printf("#mantissa_bit_count = %d\n", mantissa_bit_count);
+    return mantissa_bit_count;
+}
+
+/*
+ * Bookkeeping for the blocked variant.
+ * Each block carries a complete sigbits header, so it can be decoded without
+ * looking at any other block. The block table stores the end offset of every
+ * block relative to the first block.
+ */
+typedef struct{
+    uint8_t signs_id;
+    uint8_t exponent_bit_count;
+    int16_t minimum_exponent;
+    uint64_t fill_value_mask;
+    uint64_t zero_value_mask;
+    size_t size; // encoded size of the block including its header
+    int ret;
+} sigbits_block_t;
+
+typedef struct{
+    const scil_context_t* ctx;
+    void* data;         // uncompressed values
+    byte* blocks_start; // first byte of the first block
+    const uint64_t* block_ends;
+    sigbits_block_t* blocks;
+    size_t count;
+    size_t block_count;
+    size_t block_size;
+    uint8_t mantissa_bit_count;
+    int16_t finest_exponent;
+} sigbits_blocked_job_t;
+
+typedef struct{
+    sigbits_blocked_job_t* job;
+    int thread_id;
+    int thread_count;
+} sigbits_thread_arg_t;
+
+static int get_thread_count(size_t block_count){
+    int threads = scilU_get_thread_count();
+    if ((size_t) threads > block_count) threads = (int) block_count;
+    return threads < 1 ? 1 : threads;
+}
+
+static size_t get_block_value_count(const sigbits_blocked_job_t* job, size_t block){
+    size_t remaining = job->count - block * job->block_size;
+    return remaining < job->block_size ? remaining : job->block_size;
+}
+
+typedef struct{
+    void* (*worker)(void*);
+    sigbits_thread_arg_t* args;
+} sigbits_parallel_t;
+
+static void run_worker(void* arg, int task){
+    sigbits_parallel_t* p = (sigbits_parallel_t*) arg;
+    p->worker(& p->args[task]);
+}
+
+/*
+ * Runs worker as thread_count tasks of the thread pool, the calling thread takes part.
+ */
+static void run_parallel(void* (*worker)(void*), sigbits_blocked_job_t* job, int thread_count){
+    sigbits_thread_arg_t args[SCIL_MAX_THREADS];
+
+    for(int i = 0; i < thread_count; ++i){
+        args[i].job = job;
+        args[i].thread_id = i;
+        args[i].thread_count = thread_count;
+    }
+    sigbits_parallel_t p;
+    p.worker = worker;
+    p.args = args;
+    scilU_parallel_run(thread_count, run_worker, & p);
+}
+
 //Supported datatypes: double float
 // Repeat for each data type
 
@@ -297,6 +392,11 @@ static void find_minimums_and_maximums_fill_<DATATYPE>(const <DATATYPE>* buffer,
             }
         }
     }
+
+    // Only fill values (or values below finest) in the buffer
+    if (*maximum_exponent < *minimum_exponent) {
+      *maximum_exponent = *minimum_exponent = finest_exponent;
+    }
 }
 
 // TODO: Speed up shifts with lookup table.
@@ -480,6 +580,30 @@ static int decompress_buffer_fill_<DATATYPE>(<DATATYPE>* restrict dest,
     return SCIL_NO_ERR;
 }
 
+static void verify_buffer_<DATATYPE>(const scil_context_t* ctx,
+                                     const <DATATYPE>* source,
+                                     const uint64_t* values,
+                                     size_t count,
+                                     uint8_t bit_count_per_value,
+                                     uint8_t signs_id,
+                                     uint8_t exponent_bit_count,
+                                     uint8_t mantissa_bit_count,
+                                     int16_t minimum_exponent,
+                                     uint64_t fill_value_mask,
+                                     uint64_t zero_value_mask){
+    const double fill_value = ctx->hints.fill_value;
+    <DATATYPE> reconstructed[SCIL_VERIFY_CHUNK];
+    for(size_t i = 0; i < count; i += SCIL_VERIFY_CHUNK){
+      const size_t n = count - i < SCIL_VERIFY_CHUNK ? count - i : SCIL_VERIFY_CHUNK;
+      if (fill_value == DBL_MAX){
+        decompress_buffer_<DATATYPE>(reconstructed, values + i, n, bit_count_per_value, signs_id, exponent_bit_count, mantissa_bit_count, minimum_exponent, zero_value_mask);
+      }else{
+        decompress_buffer_fill_<DATATYPE>(reconstructed, values + i, n, bit_count_per_value, signs_id, exponent_bit_count, mantissa_bit_count, minimum_exponent, fill_value, fill_value_mask, zero_value_mask);
+      }
+      scilC_verify(ctx, source + i, reconstructed, n);
+    }
+}
+
 static void get_header_data_<DATATYPE>(const <DATATYPE>* source,
                                        size_t count,
                                        uint8_t* signs_id,
@@ -547,8 +671,10 @@ static void get_header_data_fill_<DATATYPE>(const <DATATYPE>* source,
     int16_t maximum_exponent;
     uint8_t minimum_sign, maximum_sign;
 
-    byte *keys = (byte*)scilU_safe_malloc((EXPONENT_LENGTH_<DATATYPE_UPPER> - 1) << 2);
-    memset(keys, 0, (EXPONENT_LENGTH_<DATATYPE_UPPER> - 1) << 2);
+    // One bit per possible exponent, EXPONENT_LENGTH includes the sign bit
+    const size_t keys_size = (size_t) 1 << (EXPONENT_LENGTH_<DATATYPE_UPPER> - 4);
+    byte *keys = (byte*)scilU_safe_malloc(keys_size);
+    memset(keys, 0, keys_size);
 
     find_minimums_and_maximums_fill_<DATATYPE>(source,
                                           count,
@@ -656,18 +782,7 @@ int scil_sigbits_compress_<DATATYPE>(const scil_context_t* ctx,
 
     // ==================== Initialization =====================================
 
-    // If neither hint 'sigbits' nor 'reltol' is given,
-    // this initializes to -1 as unsigned = 255
-    // and will fail the test mantissa_bit_count >= MANTISSA_LENGTH_<DATATYPE_UPPER>
-    uint8_t mantissa_bit_count = ctx->hints.significant_bits - 1;
-
-    // Calculate mantissa bits from hint 'reltol', apply when more strict
-    if (ctx->hints.relative_tolerance_percent > 0.0) {
-        uint8_t mantissa_bits_rel = scilU_relative_tolerance_to_significant_bits(ctx->hints.relative_tolerance_percent) - 1;
-        if (ctx->hints.significant_bits == 0 || mantissa_bits_rel > mantissa_bit_count)
-            mantissa_bit_count = mantissa_bits_rel;
-    }
-    //printf("#mantissa_bit_count = %d\n", mantissa_bit_count);
+    uint8_t mantissa_bit_count = get_mantissa_bit_count(ctx);
 
     /* Check for finest absolute tolerance.
        Intention is to reduce the amount of used exponents to save bits there.
@@ -689,7 +804,7 @@ int scil_sigbits_compress_<DATATYPE>(const scil_context_t* ctx,
 
     uint8_t signs_id, exponent_bit_count;
     int16_t minimum_exponent;
-    uint64_t fill_value_mask, zero_value_mask;
+    uint64_t fill_value_mask = 0, zero_value_mask;
 
     if (ctx->hints.fill_value == DBL_MAX){
       get_header_data_<DATATYPE>(source, count, &signs_id, &exponent_bit_count, mantissa_bit_count, &minimum_exponent, finest.p.exponent, &zero_value_mask);
@@ -735,6 +850,9 @@ int scil_sigbits_compress_<DATATYPE>(const scil_context_t* ctx,
         ret = SCIL_BUFFER_ERR;
         goto comp_cleanup;
     }
+    if(scilC_verify_enabled(ctx)){
+      verify_buffer_<DATATYPE>(ctx, source, compressed_buffer, count, bit_count_per_value, signs_id, exponent_bit_count, mantissa_bit_count, minimum_exponent, fill_value_mask, zero_value_mask);
+    }
     /*printf("Control dest\n");
     for(size_t i = 0; i < *dest_size; ++i){
       printf("%i ", dest[i]);
@@ -803,6 +921,284 @@ int scil_sigbits_decompress_<DATATYPE>(<DATATYPE>*restrict dest,
     return ret;
 }
 
+static void* blocked_analyze_worker_<DATATYPE>(void* arg){
+    sigbits_thread_arg_t* targ = (sigbits_thread_arg_t*) arg;
+    sigbits_blocked_job_t* job = targ->job;
+    const double fill_value = job->ctx->hints.fill_value;
+    byte header[64];
+
+    for(size_t b = targ->thread_id; b < job->block_count; b += targ->thread_count){
+        sigbits_block_t* blk = & job->blocks[b];
+        const <DATATYPE>* source = ((const <DATATYPE>*) job->data) + b * job->block_size;
+        size_t n = get_block_value_count(job, b);
+
+        blk->ret = SCIL_NO_ERR;
+        blk->fill_value_mask = 0;
+        if (fill_value == DBL_MAX){
+          get_header_data_<DATATYPE>(source, n, &blk->signs_id, &blk->exponent_bit_count, job->mantissa_bit_count, &blk->minimum_exponent, job->finest_exponent, &blk->zero_value_mask);
+        }else{
+          get_header_data_fill_<DATATYPE>(source, n, &blk->signs_id, &blk->exponent_bit_count, job->mantissa_bit_count, &blk->minimum_exponent, fill_value, &blk->fill_value_mask, job->finest_exponent, &blk->zero_value_mask);
+          if(!blk->fill_value_mask){
+            blk->ret = SCIL_FILL_VAL_ERR;
+          }
+        }
+        uint8_t bit_count_per_value = get_bit_count_per_value(blk->signs_id, blk->exponent_bit_count, job->mantissa_bit_count);
+        int header_size = write_header(header, blk->signs_id, blk->exponent_bit_count, job->mantissa_bit_count, blk->minimum_exponent, fill_value, blk->fill_value_mask, blk->zero_value_mask);
+        blk->size = header_size + round_up_byte((uint64_t) bit_count_per_value * n);
+    }
+    return NULL;
+}
+
+static void* blocked_encode_worker_<DATATYPE>(void* arg){
+    sigbits_thread_arg_t* targ = (sigbits_thread_arg_t*) arg;
+    sigbits_blocked_job_t* job = targ->job;
+    const double fill_value = job->ctx->hints.fill_value;
+
+    if ((size_t) targ->thread_id >= job->block_count){
+        return NULL;
+    }
+
+    // scil_swage() may touch the byte after the last value, hence pack into
+    // a private buffer and copy the exact block size afterwards
+    uint64_t* values = (uint64_t*)scilU_thread_scratch(2 * job->block_size * sizeof(uint64_t) + 1);
+    byte* packed = (byte*)(values + job->block_size);
+
+    for(size_t b = targ->thread_id; b < job->block_count; b += targ->thread_count){
+        sigbits_block_t* blk = & job->blocks[b];
+        const <DATATYPE>* source = ((const <DATATYPE>*) job->data) + b * job->block_size;
+        size_t n = get_block_value_count(job, b);
+        byte* dest = job->blocks_start + (b == 0 ? 0 : job->block_ends[b - 1]);
+
+        int header_size = write_header(dest, blk->signs_id, blk->exponent_bit_count, job->mantissa_bit_count, blk->minimum_exponent, fill_value, blk->fill_value_mask, blk->zero_value_mask);
+        uint8_t bit_count_per_value = get_bit_count_per_value(blk->signs_id, blk->exponent_bit_count, job->mantissa_bit_count);
+
+        if (fill_value == DBL_MAX){
+          compress_buffer_<DATATYPE>(values, source, n, blk->signs_id, blk->exponent_bit_count, job->mantissa_bit_count, blk->minimum_exponent, blk->zero_value_mask);
+        }else{
+          compress_buffer_fill_<DATATYPE>(values, source, n, blk->signs_id, blk->exponent_bit_count, job->mantissa_bit_count, blk->minimum_exponent, fill_value, blk->fill_value_mask, blk->zero_value_mask);
+        }
+        if(scil_swage(packed, values, n, bit_count_per_value)){
+          blk->ret = SCIL_BUFFER_ERR;
+          continue;
+        }
+        memcpy(dest + header_size, packed, blk->size - header_size);
+        if(scilC_verify_enabled(job->ctx)){
+          verify_buffer_<DATATYPE>(job->ctx, source, values, n, bit_count_per_value, blk->signs_id, blk->exponent_bit_count, job->mantissa_bit_count, blk->minimum_exponent, blk->fill_value_mask, blk->zero_value_mask);
+        }
+    }
+    return NULL;
+}
+
+static void* blocked_decode_worker_<DATATYPE>(void* arg){
+    sigbits_thread_arg_t* targ = (sigbits_thread_arg_t*) arg;
+    sigbits_blocked_job_t* job = targ->job;
+
+    if ((size_t) targ->thread_id >= job->block_count){
+        return NULL;
+    }
+
+    uint64_t* values = (uint64_t*)scilU_thread_scratch(job->block_size * sizeof(uint64_t));
+
+    for(size_t b = targ->thread_id; b < job->block_count; b += targ->thread_count){
+        sigbits_block_t* blk = & job->blocks[b];
+        <DATATYPE>* dest = ((<DATATYPE>*) job->data) + b * job->block_size;
+        size_t n = get_block_value_count(job, b);
+        size_t start = b == 0 ? 0 : job->block_ends[b - 1];
+        size_t block_size = job->block_ends[b] - start;
+        byte* source = job->blocks_start + start;
+
+        uint8_t mantissa_bit_count;
+        double fill_value = DBL_MAX;
+        blk->fill_value_mask = 0;
+        blk->zero_value_mask = 0;
+        int header_size = read_header(source, &block_size, &blk->signs_id, &blk->exponent_bit_count, &mantissa_bit_count, &blk->minimum_exponent, &fill_value, &blk->fill_value_mask, &blk->zero_value_mask);
+        uint8_t bit_count_per_value = get_bit_count_per_value(blk->signs_id, blk->exponent_bit_count, mantissa_bit_count);
+
+        blk->ret = SCIL_NO_ERR;
+        if(round_up_byte((uint64_t) bit_count_per_value * n) > block_size ||
+           scil_unswage(values, source + header_size, n, bit_count_per_value)){
+          blk->ret = SCIL_BUFFER_ERR;
+          continue;
+        }
+
+        if (fill_value == DBL_MAX){
+          decompress_buffer_<DATATYPE>(dest, values, n, bit_count_per_value, blk->signs_id, blk->exponent_bit_count, mantissa_bit_count, blk->minimum_exponent, blk->zero_value_mask);
+        }else{
+          decompress_buffer_fill_<DATATYPE>(dest, values, n, bit_count_per_value, blk->signs_id, blk->exponent_bit_count, mantissa_bit_count, blk->minimum_exponent, fill_value, blk->fill_value_mask, blk->zero_value_mask);
+        }
+    }
+    return NULL;
+}
+
+int scil_sigbits_blocked_compress_<DATATYPE>(const scil_context_t* ctx,
+                                     byte * restrict dest,
+                                     size_t* dest_size,
+                                     <DATATYPE>*restrict source,
+                                     const scil_dims_t* dims){
+
+    assert(ctx != NULL);
+    assert(dest != NULL);
+    assert(dest_size != NULL);
+    assert(source != NULL);
+    assert(dims != NULL);
+
+    // ==================== Initialization =====================================
+
+    uint8_t mantissa_bit_count = get_mantissa_bit_count(ctx);
+
+    <DATATYPE> finest_value = (<DATATYPE>) ctx->hints.relative_err_finest_abs_tolerance*2.0;
+    datatype_cast_<DATATYPE> finest;
+    finest.f = finest_value;
+
+    if(mantissa_bit_count == SCIL_ACCURACY_INT_FINEST || mantissa_bit_count >= MANTISSA_LENGTH_<DATATYPE_UPPER>){
+        return SCIL_PRECISION_ERR;
+    }
+
+    sigbits_blocked_job_t job;
+    job.ctx = ctx;
+    job.data = source;
+    job.count = scil_dims_get_count(dims);
+    job.block_size = SIGBITS_BLOCK_SIZE;
+    job.block_count = (job.count + job.block_size - 1) / job.block_size;
+    job.mantissa_bit_count = mantissa_bit_count;
+    job.finest_exponent = finest.p.exponent;
+
+    // Header: block size, block count and the end offset of each block
+    const size_t table_size = 8 + job.block_count * sizeof(uint64_t);
+    if(table_size > *dest_size){
+        return SCIL_BUFFER_ERR;
+    }
+    uint32_t block_size = (uint32_t) job.block_size;
+    uint32_t block_count = (uint32_t) job.block_count;
+    byte* block_info = dest;
+    scilU_pack4(block_info, block_size);
+    block_info += 4;
+    scilU_pack4(block_info, block_count);
+    byte* block_table = dest + 8;
+    job.blocks_start = block_table + job.block_count * sizeof(uint64_t);
+
+    job.blocks = (sigbits_block_t*)scilU_safe_malloc(job.block_count * sizeof(sigbits_block_t) + 1);
+    uint64_t* block_ends = (uint64_t*)scilU_safe_malloc(job.block_count * sizeof(uint64_t) + 1);
+    job.block_ends = block_ends;
+
+    int thread_count = get_thread_count(job.block_count);
+    int ret = SCIL_NO_ERR;
+
+    // ==================== Compression ========================================
+
+    // Determine per block exponent range, signs and encoded size
+    run_parallel(blocked_analyze_worker_<DATATYPE>, & job, thread_count);
+
+    uint64_t offset = 0;
+    for(size_t b = 0; b < job.block_count; ++b){
+        if(job.blocks[b].ret != SCIL_NO_ERR){
+            ret = job.blocks[b].ret;
+            goto comp_cleanup;
+        }
+        offset += job.blocks[b].size;
+        if(offset > *dest_size - table_size){
+            ret = SCIL_BUFFER_ERR;
+            goto comp_cleanup;
+        }
+        block_ends[b] = offset;
+        byte* entry = block_table + b * sizeof(uint64_t);
+        scilU_pack8(entry, offset);
+    }
+
+    // Every block knows its final position now, encode them independently
+    run_parallel(blocked_encode_worker_<DATATYPE>, & job, thread_count);
+
+    for(size_t b = 0; b < job.block_count; ++b){
+        if(job.blocks[b].ret != SCIL_NO_ERR){
+            ret = job.blocks[b].ret;
+            goto comp_cleanup;
+        }
+    }
+
+    *dest_size = (job.blocks_start - dest) + offset;
+
+    // ==================== Cleanup ============================================
+
+    comp_cleanup:
+    free(job.blocks);
+    free(block_ends);
+    return ret;
+}
+
+int scil_sigbits_blocked_decompress_<DATATYPE>(<DATATYPE>*restrict dest,
+                                       scil_dims_t* dims,
+                                       byte*restrict source,
+                                       size_t source_size){
+
+    assert(dest != NULL);
+    assert(dims != NULL);
+    assert(source != NULL);
+
+    // ==================== Initialization =====================================
+
+    if(source_size < 8){
+        return SCIL_BUFFER_ERR;
+    }
+
+    uint32_t block_size, block_count;
+    byte* block_info = source;
+    scilU_unpack4(block_info, & block_size);
+    block_info += 4;
+    scilU_unpack4(block_info, & block_count);
+
+    sigbits_blocked_job_t job;
+    job.ctx = NULL;
+    job.data = dest;
+    job.count = scil_dims_get_count(dims);
+    job.block_size = block_size;
+    job.block_count = block_count;
+
+    if(block_size == 0 || job.block_count != (job.count + job.block_size - 1) / job.block_size){
+        return SCIL_BUFFER_ERR;
+    }
+
+    byte* block_table = source + 8;
+    job.blocks_start = block_table + job.block_count * sizeof(uint64_t);
+    if((size_t)(job.blocks_start - source) > source_size){
+        return SCIL_BUFFER_ERR;
+    }
+    const size_t data_size = source_size - (job.blocks_start - source);
+
+    uint64_t* block_ends = (uint64_t*)scilU_safe_malloc(job.block_count * sizeof(uint64_t) + 1);
+    job.block_ends = block_ends;
+    job.blocks = (sigbits_block_t*)scilU_safe_malloc(job.block_count * sizeof(sigbits_block_t) + 1);
+
+    int ret = SCIL_NO_ERR;
+    uint64_t last = 0;
+    for(size_t b = 0; b < job.block_count; ++b){
+        byte* entry = block_table + b * sizeof(uint64_t);
+        scilU_unpack8(entry, & block_ends[b]);
+        if(block_ends[b] < last || block_ends[b] > data_size){
+            ret = SCIL_BUFFER_ERR;
+            goto decomp_cleanup;
+        }
+        last = block_ends[b];
+    }
+
+    // ==================== Decompression ======================================
+
+    run_parallel(blocked_decode_worker_<DATATYPE>, & job, get_thread_count(job.block_count));
+
+    for(size_t b = 0; b < job.block_count; ++b){
+        if(job.blocks[b].ret != SCIL_NO_ERR){
+            ret = job.blocks[b].ret;
+            break;
+        }
+    }
+
+    // ==================== Cleanup ============================================
+
+    decomp_cleanup:
+    free(job.blocks);
+    free(block_ends);
+    return ret;
+}
+
 // End repeat
 
 scilU_algorithm_t algo_sigbits = {
@@ -814,3 +1210,13 @@ scilU_algorithm_t algo_sigbits = {
     SCIL_COMPRESSOR_TYPE_DATATYPES,
     1
 };
+
+scilU_algorithm_t algo_sigbits_blocked = {
+    .c.DNtype = {
+        CREATE_INITIALIZER(scil_sigbits_blocked)
+    },
+    "sigbits-blocked",
+    19,
+    SCIL_COMPRESSOR_TYPE_DATATYPES,
+    1
+};
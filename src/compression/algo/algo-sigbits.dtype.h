@@ -48,9 +48,35 @@ int scil_sigbits_compress_<DATATYPE>(const scil_context_t* ctx, byte* restrict d
  */
 int scil_sigbits_decompress_<DATATYPE>( <DATATYPE>*restrict dest, scil_dims_t* dims, byte*restrict source, const size_t source_size);
 
+
+/**
+ * \brief Compression function of the blocked sigbits variant
+ * \details The data is split into blocks of a fixed number of values, each
+ *   block uses its own exponent range and sign flag. Blocks are encoded in
+ *   parallel and can be decoded independently of each other.
+ * \param ctx Compression context used for this compression
+ * \param dest Preallocated buffer which will hold the compressed data
+ * \param dest_size Byte size the compressed buffer will have
+ * \param source Uncompressed data which should be processed
+ * \param dims Dimensional information of uncompressed buffer
+ * \return Success state of the compression
+ */
+int scil_sigbits_blocked_compress_<DATATYPE>(const scil_context_t* ctx, byte* restrict dest, size_t* restrict dest_size, <DATATYPE>*restrict source, const scil_dims_t* dims);
+
+/**
+ * \brief Deompression function of the blocked sigbits variant
+ * \param dest Pre allocated buffer which will hold the decompressed data
+ * \param dims Dimensional information of decompressed buffer
+ * \param source Compressed data which should be processed
+ * \param source_size Byte size of compressed buffer
+ * \return Success state of the compression
+ */
+int scil_sigbits_blocked_decompress_<DATATYPE>( <DATATYPE>*restrict dest, scil_dims_t* dims, byte*restrict source, const size_t source_size);
+
 // End repeat
 
 
 extern scilU_algorithm_t algo_sigbits;
+extern scilU_algorithm_t algo_sigbits_blocked;
 
 #endif /* SCIL_SIGBITS_H_ */
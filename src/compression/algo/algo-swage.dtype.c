@@ -131,7 +131,8 @@ int scil_swage_compress_<DATATYPE>(const scil_context_t* ctx,
       // we determine the value new based on min / max
       <DATATYPE> minimum, maximum;
       scilU_find_minimum_maximum_<DATATYPE>(source, count, &minimum, &maximum);
-
+      // until the range is used, keep all bits
+      bits_per_value = sizeof(<DATATYPE>) * 8;
     }
 
     if (scil_swage_<DATATYPE>(dest, source, count, bits_per_value))
@@ -18,6 +18,7 @@ the maximum decompression error would be slightly larger than the specified erro
 
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
 #include <string.h>
 
 #include <sz.h>
@@ -26,6 +27,8 @@ the maximum decompression error would be slightly larger than the specified erro
 #include <scil-util.h>
 
 static struct sz_params * params = NULL;
+// SZ keeps its configuration in globals, the calls are serialized
+static pthread_mutex_t sz_lock = PTHREAD_MUTEX_INITIALIZER;
 
 static void init_sz_if_needed(){
   if (params) return;
@@ -58,7 +61,6 @@ int scil_sz_compress_<DATATYPE>(const scil_context_t* ctx,
                                     size_t* restrict dest_size,
                                     <DATATYPE>* restrict source,
                                     const scil_dims_t* dims){
-  init_sz_if_needed();
   size_t size = 0;
   double abstol = ctx->hints.absolute_tolerance;
   double reltol = ctx->hints.relative_tolerance_percent / 100.0;
@@ -76,7 +78,10 @@ int scil_sz_compress_<DATATYPE>(const scil_context_t* ctx,
   //printf("Running SZ: with %d %f %f\n", mode, abstol, reltol);
 
   int ret;
+  pthread_mutex_lock(& sz_lock);
+  init_sz_if_needed();
   ret = SZ_compress_args2(SZ_<DATATYPE_UPPER>, source, dest, & size, mode, abstol, reltol, 0.0, 0, 0, dims->length[3], dims->length[2], dims->length[1], dims->length[0]);
+  pthread_mutex_unlock(& sz_lock);
   //printf("Returns: %d\n", size);
   if (ret == 0){
     *dest_size = size;
@@ -91,10 +96,12 @@ int scil_sz_decompress_<DATATYPE>(<DATATYPE>* restrict dest,
                                       scil_dims_t* dims,
                                       byte* restrict source,
                                       size_t source_size){
-  init_sz_if_needed();
   int size = (int) source_size;
   //printf("Decompress %d %d\n", size, dims->length[0]);
+  pthread_mutex_lock(& sz_lock);
+  init_sz_if_needed();
   int elems = SZ_decompress_args(SZ_<DATATYPE_UPPER>, source, size, (void*) dest, 0, dims->length[3], dims->length[2], dims->length[1], dims->length[0]);
+  pthread_mutex_unlock(& sz_lock);
 
   if (elems < 0){
     printf("SZ DError: %d\n", elems);
@@ -18,6 +18,12 @@
 #define SCIL_PRECOND_DELTA_H_
 #include <scil-algorithm-impl.h>
 
+// Repeat for each data type
+int scil_delta_precond_compress_<DATATYPE>(const scil_context_t* ctx, <DATATYPE>* restrict data_out, byte*restrict header, int * header_size_out, <DATATYPE>*restrict data_in, const scil_dims_t* dims);
+
+int scil_delta_precond_decompress_<DATATYPE>(<DATATYPE>*restrict data_out, scil_dims_t* dims, <DATATYPE>*restrict data_in, byte*restrict header, int * header_parsed_out);
+// End repeat
+
 extern scilU_algorithm_t algo_precond_delta;
 
 #endif
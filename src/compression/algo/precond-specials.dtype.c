@@ -0,0 +1,238 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+//Supported datatypes: float double int8_t int16_t int32_t int64_t
+
+#include <algo/precond-specials.h>
+
+#include <scil-error.h>
+#include <scil-util.h>
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+/*
+ * Header layout (the decompressor parses it from the end):
+ *   runs:   per run of identical special values three fields
+ *           varint number of regular values before the run, varint run length, uint8 class
+ *   values: value_count values of the datatype
+ *   uint32  byte size of the runs
+ *   uint8   value_count
+ * A class below value_count refers to the stored values, the others are defined below.
+ */
+#define SPECIALS_CLASS_NAN 253
+#define SPECIALS_CLASS_PINF 254
+#define SPECIALS_CLASS_NINF 255
+#define SPECIALS_MAX_VALUES 253
+
+// maximum size of one run in the header
+#define SPECIALS_MAX_RUN_BYTES 21
+
+static double special_value_as_double(const scil_value_t* val){
+  switch(val->typ){
+    case(SCIL_TYPE_FLOAT):
+      return val->u.flt32;
+    case(SCIL_TYPE_DOUBLE):
+      return val->u.flt64;
+    case(SCIL_TYPE_INT8):
+      return (int8_t) val->u.uint8;
+    case(SCIL_TYPE_INT16):
+      return (int16_t) val->u.uint16;
+    case(SCIL_TYPE_INT32):
+      return (int32_t) val->u.uint32;
+    case(SCIL_TYPE_INT64):
+      return (double) (int64_t) val->u.uint64;
+    default:
+      return NAN;
+  }
+}
+
+// the fill value hint is unset while it holds DBL_MAX, the bits are compared to avoid a float comparison
+static int fill_value_is_set(double fill_value){
+  const double unset = DBL_MAX;
+  return memcmp(& fill_value, & unset, sizeof(double)) != 0;
+}
+
+static double class_value(int cls){
+  switch(cls){
+    case(SPECIALS_CLASS_NAN):
+      return NAN;
+    case(SPECIALS_CLASS_PINF):
+      return INFINITY;
+    default:
+      return -INFINITY;
+  }
+}
+
+// Repeat for each data type
+
+// the stored values match by bit pattern, so -0.0 differs from 0.0 and a stored NaN keeps its payload
+static inline int classify_<DATATYPE>(<DATATYPE> value, const <DATATYPE>* values, int value_count){
+  for(int i = 0; i < value_count; i++){
+    if(memcmp(& value, & values[i], sizeof(<DATATYPE>)) == 0) return i;
+  }
+  if(! isfinite((double) value)){
+    if(isnan((double) value)) return SPECIALS_CLASS_NAN;
+    return value > 0 ? SPECIALS_CLASS_PINF : SPECIALS_CLASS_NINF;
+  }
+  return -1;
+}
+
+static int collect_values_<DATATYPE>(const scil_context_t* ctx, <DATATYPE>* values){
+  int value_count = 0;
+  for(int i = 0; i <= ctx->special_values_count; i++){
+    double val;
+    if(i < ctx->special_values_count){
+      val = special_value_as_double(& ctx->special_values[i]);
+    }else if(fill_value_is_set(ctx->hints.fill_value)){
+      val = ctx->hints.fill_value;
+    }else{
+      break;
+    }
+    // infinities are covered by the fixed classes, a NaN is stored to keep its payload
+    if(isinf(val)) continue;
+    if(isnan(val) && ctx->datatype != SCIL_TYPE_FLOAT && ctx->datatype != SCIL_TYPE_DOUBLE) continue;
+    <DATATYPE> v = (<DATATYPE>) val;
+    if(classify_<DATATYPE>(v, values, value_count) >= 0) continue;
+    if(value_count == SPECIALS_MAX_VALUES) return -1;
+    values[value_count++] = v;
+  }
+  return value_count;
+}
+
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+static int scil_specials_precond_compress_<DATATYPE>(const scil_context_t* ctx, <DATATYPE>* restrict data_out, byte*restrict header, int * header_size_out, <DATATYPE>*restrict data_in, const scil_dims_t* dims){
+  const size_t count = scil_dims_get_count(dims);
+  const size_t size = scil_dims_get_size(dims, SCIL_TYPE_<DATATYPE_UPPER>);
+  <DATATYPE> values[SPECIALS_MAX_VALUES];
+
+  int value_count = collect_values_<DATATYPE>(ctx, values);
+  if(value_count < 0){
+    return SCIL_EINVAL;
+  }
+  // the header must fit behind the data
+  const size_t header_limit = size > 32 ? size - 16 : 16;
+  const size_t runs_limit = header_limit - value_count * sizeof(<DATATYPE>) - 5;
+  if(header_limit < value_count * sizeof(<DATATYPE>) + 5 + SPECIALS_MAX_RUN_BYTES){
+    return SCIL_BUFFER_ERR;
+  }
+
+  // a special value is replaced with the preceding regular value, leading ones with the first
+  <DATATYPE> neutral = 0;
+  size_t first_regular = count;
+
+  // each value is classified once, a run ends where the class changes
+  byte* pos = header;
+  size_t last_end = 0;
+  size_t start = 0;
+  int run_cls = -1;
+  for(size_t i = 0; i <= count; i++){
+    const int cls = i < count ? classify_<DATATYPE>(data_in[i], values, value_count) : -1;
+    if(cls != run_cls && run_cls >= 0){
+      if((size_t)(pos - header) + SPECIALS_MAX_RUN_BYTES > runs_limit){
+        return SCIL_BUFFER_ERR;
+      }
+      pos = scilU_write_varint(pos, start - last_end);
+      pos = scilU_write_varint(pos, i - start);
+      *pos = (byte) run_cls;
+      pos++;
+      last_end = i;
+    }
+    if(i == count){
+      break;
+    }
+    if(cls < 0){
+      neutral = data_in[i];
+      if(first_regular == count){
+        first_regular = i;
+      }
+    }else if(cls != run_cls){
+      start = i;
+    }
+    data_out[i] = neutral;
+    run_cls = cls;
+  }
+  for(size_t i = 0; i < first_regular && first_regular < count; i++){
+    data_out[i] = data_in[first_regular];
+  }
+
+  uint32_t runs_size = (uint32_t) (pos - header);
+  memcpy(pos, values, value_count * sizeof(<DATATYPE>));
+  pos += value_count * sizeof(<DATATYPE>);
+  scilU_pack4(pos, runs_size);
+  pos += 4;
+  *pos = (byte) value_count;
+  pos++;
+
+  *header_size_out = (int) (pos - header);
+  return SCIL_NO_ERR;
+}
+
+static int scil_specials_precond_decompress_<DATATYPE>(<DATATYPE>*restrict data_out, scil_dims_t* dims, <DATATYPE>*restrict data_in, byte*restrict header, int * header_parsed_out){
+  const size_t count = scil_dims_get_count(dims);
+  <DATATYPE> values[SPECIALS_MAX_VALUES];
+
+  // header points to the last byte of our header
+  const int value_count = *header;
+  if(value_count > SPECIALS_MAX_VALUES){
+    return SCIL_BUFFER_ERR;
+  }
+  byte* pos = header - 4;
+  uint32_t runs_size;
+  scilU_unpack4(pos, & runs_size);
+  pos -= value_count * sizeof(<DATATYPE>);
+  memcpy(values, pos, value_count * sizeof(<DATATYPE>));
+  const byte* runs_end = pos;
+  const byte* runs = pos - runs_size;
+
+  memcpy(data_out, data_in, count * sizeof(<DATATYPE>));
+
+  size_t i = 0;
+  while(runs < runs_end){
+    uint64_t skip, length;
+    runs = scilU_read_varint(runs, runs_end, & skip);
+    if(runs == NULL) return SCIL_BUFFER_ERR;
+    runs = scilU_read_varint(runs, runs_end, & length);
+    if(runs == NULL || runs >= runs_end) return SCIL_BUFFER_ERR;
+    const int cls = *runs;
+    runs++;
+
+    i += skip;
+    if(i + length > count || (cls >= value_count && cls < SPECIALS_CLASS_NAN)){
+      return SCIL_BUFFER_ERR;
+    }
+    const <DATATYPE> val = cls < value_count ? values[cls] : (<DATATYPE>) class_value(cls);
+    for(const size_t end = i + length; i < end; i++){
+      data_out[i] = val;
+    }
+  }
+
+  *header_parsed_out = (int) runs_size + value_count * sizeof(<DATATYPE>) + 5;
+  return SCIL_NO_ERR;
+}
+
+// End repeat
+
+
+scilU_algorithm_t algo_precond_specials = {
+    .c.PFtype = {
+        CREATE_INITIALIZER(scil_specials_precond)
+    },
+    "specials",
+    20,
+    SCIL_COMPRESSOR_TYPE_DATATYPES_PRECONDITIONER_FIRST,
+    0
+};
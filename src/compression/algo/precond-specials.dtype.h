@@ -0,0 +1,30 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SCIL_PRECOND_SPECIALS_H_
+#define SCIL_PRECOND_SPECIALS_H_
+#include <scil-algorithm-impl.h>
+
+/*
+ * This preconditioner extracts special values from the data: the special values
+ * of the context, the fill value hint, NaN and +/-Inf.
+ * Their positions are stored run-length encoded in the header, in the data they
+ * are replaced by the preceding regular value. Thus, the following algorithms
+ * do not need to care about them. Decompression restores the special values.
+ */
+
+extern scilU_algorithm_t algo_precond_specials;
+
+#endif
@@ -21,16 +21,13 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 int scil_zstd22_compress(const scil_context_t* ctx, byte* restrict dest, size_t * restrict out_size, const byte*restrict source, const size_t source_size){
   size_t size;
-  // store the size of the data
-  *((size_t*) dest) = source_size;
-  // normal compression, not fast
-  //size = LZ4_compress_fast((const char *) (source), (char *) dest + 4, source_size, 2*source_size, 4);
   size = ZSTD_compress (dest, 2*source_size, source, source_size, 22);
-  *out_size = size + 4;
-
-  if (size == 0){
+  if (ZSTD_isError(size)){
       return -1;
     }
+  // the frame is followed by 4 padding bytes, they are not part of the frame
+  memset(dest + size, 0, 4);
+  *out_size = size + 4;
 
   return 0;
 }
@@ -38,11 +35,15 @@ int scil_zstd22_compress(const scil_context_t* ctx, byte* restrict dest, size_t
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 int scil_zstd22_decompress(byte*restrict dest, size_t buff_size, const byte*restrict src, const size_t in_size, size_t * uncomp_size_out){
   size_t size;
-  // retrieve the size of the uncompressed data
-  size = *((size_t *) src);
+  if (in_size < 4){
+    return -1;
+  }
+  // the padding would be decoded as another frame
+  size = ZSTD_decompress(dest, buff_size, src, in_size - 4);
+  if (ZSTD_isError(size)){
+    return -1;
+  }
   *uncomp_size_out = size;
-  //size = LZ4_decompress_fast((const char *) src + 4, (char *)  dest, size); // LZ4_decompress_safe (source, dest, source_size, exp_size);
-  size = ZSTD_decompress(dest, buff_size, src, in_size);
   return 0;
 }
 
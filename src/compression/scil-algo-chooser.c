@@ -15,26 +15,96 @@
 
 #include <scil-config.h>
 
+#include <scil.h>
 #include <scil-context-impl.h>
 #include <scil-algo-chooser.h>
+#include <scil-chooser-cache.h>
+#include <scil-chooser-online.h>
 #include <scil-compression-chain.h>
 #include <scil-data-characteristics.h>
 #include <scil-error.h>
 #include <scil-hardware-limits.h>
 #include <scil-debug.h>
 #include <scil-decision-tree.h>
+#include <scil-thread-pool.h>
+#include <scil-util.h>
 
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 
 typedef struct {
   scil_compression_chain_t chain;
+  char *name;
+  SCIL_Datatype_t datatype; // SCIL_TYPE_UNKNOWN if the entry applies to all datatypes
   float randomness;
   float c_speed;
   float d_speed;
   float ratio;
+  int tolerance_kind; // the accuracy the entry was measured with, 0 for lossless or unknown
+  double tolerance;
 } config_file_entry_t;
 
+// Maximum difference in randomness (in percent) to consider a configuration entry
+#define RANDOMNESS_TOLERANCE 25
+
+// Sample size for the trial compression in bytes, a percentage of the data within the limits
+#define TRIAL_SAMPLE_PERCENT 1
+#define TRIAL_SAMPLE_MIN (4 * 1024)
+#define TRIAL_SAMPLE_MAX (64 * 1024)
+// The sample consists of bricks of about this number of values
+#define TRIAL_BRICK_VALUES 1024
+#define TRIAL_DEFAULT_CANDIDATES 4
+#define TRIAL_MAX_CANDIDATES 16
+
+enum chooser_objective_e {
+  OBJECTIVE_RATIO = 0,
+  OBJECTIVE_SPEED,
+  OBJECTIVE_STORAGE
+};
+
+// number of chains tried on a sample, 0 disables the trial compression
+static int trial_candidates = 0;
+// what the trial and the online chooser optimize
+static enum chooser_objective_e chooser_objective = OBJECTIVE_RATIO;
+
+// Default probability of the online chooser to explore another chain
+#define ONLINE_DEFAULT_EXPLORATION 0.1
+// Decompression is measured for the first observations of a chain and while exploring
+#define ONLINE_DECOMPRESSION_SAMPLES 3
+
+// probability to explore another chain, negative values disable the online chooser
+static double online_exploration = -1;
+static char *online_file = NULL;
+static unsigned int online_seed = 1;
+static pthread_mutex_t online_seed_lock = PTHREAD_MUTEX_INITIALIZER;
+static const char *online_default_chains[] = {"memcopy", "lz4", "zstd", NULL};
+
+// The accuracy hints a lossy algorithm can guarantee
+enum accuracy_e {
+  ACCURACY_ABSOLUTE = 1,
+  ACCURACY_RELATIVE = 2,
+  ACCURACY_BITS = 4
+};
+
+static const struct {
+  const char *name;
+  int accuracy;
+} lossy_algorithms[] = {
+    {"abstol", ACCURACY_ABSOLUTE},
+    {"zfp-abstol", ACCURACY_ABSOLUTE},
+    {"quantize", ACCURACY_ABSOLUTE},
+    {"sigbits", ACCURACY_RELATIVE | ACCURACY_BITS},
+    {"sigbits-blocked", ACCURACY_RELATIVE | ACCURACY_BITS},
+    {"zfp-precision", ACCURACY_BITS},
+    {"fpzip", ACCURACY_BITS},
+    {"sz", ACCURACY_ABSOLUTE | ACCURACY_RELATIVE},
+    {"allquant", ACCURACY_ABSOLUTE | ACCURACY_RELATIVE | ACCURACY_BITS},
+    {NULL, 0}
+};
+
 static config_file_entry_t *config_list;
 static int config_list_size = 0;
 
@@ -55,73 +125,62 @@ static void parse_losless_list() {
       (config_file_entry_t **) realloc(config_list_lossless, config_list_lossless_size * sizeof(void *));
 }
 
-static char** parse_array_chars(char* config){
-  int count_elements = 0;
+static int count_array_elements(const char* config){
+  int count_elements = 1;
   for(unsigned int i=0; i<strlen(config); ++i){
     if(config[i] == ';') ++count_elements;
   }
-  count_elements += 1;
-  char** tree_classes = malloc(sizeof(char*)*count_elements);
+  return count_elements;
+}
+
+static char** parse_array_chars(char* config, int* count){
+  char** tree_classes = malloc(sizeof(char*)*count_array_elements(config));
 
-  char* item = strtok(config, ";");
+  char* item = strtok(config, ";\r\n");
   int class_index = 0;
   while(item != NULL){
-    tree_classes[class_index] = malloc(sizeof(char*)*(strlen(item)+1));
-    strcpy(tree_classes[class_index], item);
-    item = strtok(NULL, ";");
-    //warn("Item %s\n", tree_classes[class_index]);
+    tree_classes[class_index] = strdup(item);
+    item = strtok(NULL, ";\r\n");
     ++class_index;
   }
+  *count = class_index;
   return tree_classes;
 }
 
 
-static double* parse_array_double(char* config){
-  int count_elements = 0;
-  for(unsigned int i=0; i<strlen(config); ++i){
-    if(config[i] == ';') ++count_elements;
-  }
-  count_elements += 1;
-  double* tree_classes = malloc(sizeof(double*)*count_elements);
+static double* parse_array_double(char* config, int* count){
+  double* tree_classes = malloc(sizeof(double)*count_array_elements(config));
 
-  char* item = strtok(config, ";");
+  char* item = strtok(config, ";\r\n");
   int class_index = 0;
   while(item != NULL){
     tree_classes[class_index] = atof(item);
-    item = strtok(NULL, ";");
+    item = strtok(NULL, ";\r\n");
     ++class_index;
   }
+  *count = class_index;
   return tree_classes;
 }
 
-static int* parse_array_int(char* config){
-  int count_elements = 0;
-  for(unsigned int i=0; i<strlen(config); ++i){
-    if(config[i] == ';') ++count_elements;
-  }
-  count_elements += 1;
-  int* tree_classes = malloc(sizeof(int*)*count_elements);
+static int* parse_array_int(char* config, int* count){
+  int* tree_classes = malloc(sizeof(int)*count_array_elements(config));
 
-  char* item = strtok(config, ";");
+  char* item = strtok(config, ";\r\n");
   int class_index = 0;
   while(item != NULL){
     tree_classes[class_index] = atoi(item);
-    item = strtok(NULL, ";");
+    item = strtok(NULL, ";\r\n");
     ++class_index;
   }
+  *count = class_index;
   return tree_classes;
 }
 
-static int** parse_array_values(char* config, int *column_size){
-  int count_classes = 0;
-  for(unsigned int i=0; i<strlen(config); ++i){
-    if(config[i] == ';') ++count_classes;
-  }
-  count_classes += 1;
+static int** parse_array_values(char* config, int *column_size, int* count){
   int firstpass = 1;
 
-  int** values = malloc(sizeof(int*)*count_classes);
-  char* item = strtok(config, ";");
+  int** values = malloc(sizeof(int*)*count_array_elements(config));
+  char* item = strtok(config, ";\r\n");
   int index = 0;
   int size_2d = 0;
   while(item != NULL){
@@ -133,20 +192,195 @@ static int** parse_array_values(char* config, int *column_size){
       firstpass = 0;
       *column_size = size_2d;
     }
-    values[index] = malloc(sizeof(int*)*size_2d);
+    values[index] = malloc(sizeof(int)*size_2d);
     char* saveptr;
     char* item_value;
     item_value = strtok_r(item, ".", &saveptr);
     for (int i = 0; i < size_2d; ++i) {
-      values[index][i] = atoi(item_value);
+      values[index][i] = item_value != NULL ? atoi(item_value) : 0;
       item_value = strtok_r(NULL, ".", &saveptr);
     }
-    item = strtok(NULL, ";");
+    item = strtok(NULL, ";\r\n");
     ++index;
   }
+  *count = index;
   return values;
 }
 
+static void load_decision_tree(FILE* decision_tree_data){
+  char* line = NULL;
+  size_t len = 0;
+  char** tree_class_names = NULL;
+  int* tree_left = NULL;
+  int* tree_right = NULL;
+  double* tree_thresholds = NULL;
+  int** tree_classes = NULL;
+  int* tree_indices = NULL;
+  int column_size = 0;
+  int names_count = 0, left_count = 0, right_count = 0, thresholds_count = 0, indices_count = 0, node_count = 0;
+  while (getline(&line, &len, decision_tree_data) != -1) {
+    if (line[0] != '#'){ // Type descriptor
+      continue;
+    }
+    // the data is in the next line
+    if(strstr(line, "classes") != NULL && tree_class_names == NULL){
+      if(getline(&line, &len, decision_tree_data) == -1) break;
+      tree_class_names = parse_array_chars(line, & names_count);
+    }else if(strstr(line, "left") != NULL && tree_left == NULL){
+      if(getline(&line, &len, decision_tree_data) == -1) break;
+      tree_left = parse_array_int(line, & left_count);
+    }else if(strstr(line, "right") != NULL && tree_right == NULL){
+      if(getline(&line, &len, decision_tree_data) == -1) break;
+      tree_right = parse_array_int(line, & right_count);
+    }else if(strstr(line, "thresholds") != NULL && tree_thresholds == NULL){
+      if(getline(&line, &len, decision_tree_data) == -1) break;
+      tree_thresholds = parse_array_double(line, & thresholds_count);
+    }else if(strstr(line, "indices") != NULL && tree_indices == NULL){
+      if(getline(&line, &len, decision_tree_data) == -1) break;
+      tree_indices = parse_array_int(line, & indices_count);
+    }else if(strstr(line, "values") != NULL && tree_classes == NULL){
+      if(getline(&line, &len, decision_tree_data) == -1) break;
+      tree_classes = parse_array_values(line, &column_size, & node_count);
+    }
+  }
+  free(line);
+
+  if(tree_class_names != NULL && tree_left != NULL && tree_right != NULL && tree_thresholds != NULL && tree_indices != NULL && tree_classes != NULL
+      && left_count == node_count && right_count == node_count && thresholds_count == node_count && indices_count == node_count
+      && names_count == column_size){
+    decision_tree = scilU_tree_create(node_count, tree_left, tree_right, tree_thresholds, tree_indices, tree_classes, tree_class_names, column_size, SCIL_FEATURE_LAST);
+  }
+  if(decision_tree == NULL){
+    warn("Invalid decision tree file\n");
+    for(int i = 0; i < names_count; i++){
+      free(tree_class_names[i]);
+    }
+    free(tree_class_names);
+  }else{
+    debug("Decision tree with %d nodes and %d classes\n", node_count, column_size);
+  }
+  for(int i = 0; i < node_count; i++){
+    free(tree_classes[i]);
+  }
+  free(tree_classes);
+  free(tree_left);
+  free(tree_right);
+  free(tree_thresholds);
+  free(tree_indices);
+}
+
+
+static char *trim(char *str) {
+  while (*str == ' ' || *str == '\t') str++;
+  char *end = str + strlen(str);
+  while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+  *end = 0;
+  return str;
+}
+
+// parses a tolerance like "abs=0.01", "rel=1" (percent) or "bits=8"
+static int parse_tolerance(const char *str, config_file_entry_t *e) {
+  const struct {
+    const char *prefix;
+    int kind;
+  } kinds[] = {{"abs=", ACCURACY_ABSOLUTE}, {"rel=", ACCURACY_RELATIVE}, {"bits=", ACCURACY_BITS}, {NULL, 0}};
+  for (int i = 0; kinds[i].prefix != NULL; i++) {
+    const size_t len = strlen(kinds[i].prefix);
+    if (strncmp(str, kinds[i].prefix, len) == 0) {
+      char *end;
+      e->tolerance = strtod(str + len, &end);
+      e->tolerance_kind = kinds[i].kind;
+      return end == str + len || e->tolerance <= 0 ? SCIL_EINVAL : SCIL_NO_ERR;
+    }
+  }
+  return SCIL_EINVAL;
+}
+
+/*
+ * Two line formats are supported, the output of scil-benchmark:
+ *   randomness; data type; pattern name; compressor chain; compr. MiB/s; decompr. MiB/s; inverse compr. ratio
+ * and the short form that applies to all data types:
+ *   randomness; compressor chain; compr. MiB/s; decompr. MiB/s; inverse compr. ratio
+ * Entries of lossy chains may end with the tolerance they were measured with, see
+ * parse_tolerance(), e.g., the Pareto fronts of scil-bench-pareto.
+ */
+static int parse_config_line(char *line, config_file_entry_t *e) {
+  char *fields[8];
+  int count = 0;
+  char *saveptr;
+  for (char *item = strtok_r(line, ";", &saveptr); item != NULL; item = strtok_r(NULL, ";", &saveptr)) {
+    if (count == 8) {
+      return SCIL_EINVAL;
+    }
+    fields[count++] = trim(item);
+  }
+  const int has_tolerance = count == 6 || count == 8;
+  if (has_tolerance) {
+    count--;
+    if (parse_tolerance(fields[count], e) != SCIL_NO_ERR) {
+      return SCIL_EINVAL;
+    }
+  }
+  if (count != 5 && count != 7) {
+    return SCIL_EINVAL;
+  }
+  int pos = 0;
+  e->randomness = (float) atof(fields[pos++]);
+  e->datatype = SCIL_TYPE_UNKNOWN;
+  if (count == 7) {
+    e->datatype = (SCIL_Datatype_t) atoi(fields[pos++]);
+    pos++; // the pattern name is not used
+  }
+  const char *name = fields[pos++];
+  e->c_speed = (float) atof(fields[pos++]);
+  e->d_speed = (float) atof(fields[pos++]);
+  e->ratio = (float) atof(fields[pos++]);
+
+  int ret = scilU_chain_create(&e->chain, name);
+  if (ret != SCIL_NO_ERR) {
+    return ret;
+  }
+  e->name = strdup(name);
+  return SCIL_NO_ERR;
+}
+
+// the statistics of a previous run serve as prior
+static void load_online_file(const char *filename) {
+  FILE *f = fopen(filename, "r");
+  if (f == NULL) {
+    return;
+  }
+  char *line = NULL;
+  size_t len = 0;
+  int count = 0;
+  while (getline(&line, &len, f) != -1) {
+    if (line[0] == '#' || line[0] == '!' || strlen(line) < 5) {
+      continue;
+    }
+    config_file_entry_t e;
+    memset(&e, 0, sizeof(e));
+    if (parse_config_line(line, &e) != SCIL_NO_ERR || !(e.c_speed > 0 && e.d_speed > 0)) {
+      warn("Invalid line in the online chooser file %s\n", filename);
+      continue;
+    }
+    const int bucket = scilC_chooser_online_bucket(e.randomness);
+    scilC_chooser_online_record_compression(e.datatype, bucket, e.name, 1.0, 1.0 / (double) e.c_speed, (double) e.ratio);
+    scilC_chooser_online_record_decompression(e.datatype, bucket, e.name, 1.0, 1.0 / (double) e.d_speed);
+    free(e.name);
+    count++;
+  }
+  free(line);
+  fclose(f);
+  debug("Online chooser loaded %d entries from %s\n", count, filename);
+}
+
+static void save_online_file() {
+  if (scilC_chooser_online_save(online_file) != SCIL_NO_ERR) {
+    warn("Could not write the online chooser file %s\n", online_file);
+  }
+  free(online_file);
+  online_file = NULL;
+}
 
 void scilC_algo_chooser_initialize() {
   int ret;
@@ -168,14 +402,18 @@ void scilC_algo_chooser_initialize() {
     }
     rewind(var_compressor_data);
 
-    variable_dict = scilU_dict_create(lines - 1);
+    variable_dict = scilU_dict_create(lines > 1 ? lines - 1 : 1);
     size_t linenumber = 0;
-    char *delimiter = ",";
     while (getline(&line, &len, var_compressor_data) != -1) {
       if (linenumber > 0) { // Skip header
-        char *variable_name = strtok(line, delimiter);
-        char *compressor_name = strtok(NULL, delimiter);
-        scilU_dict_put(variable_dict, variable_name, compressor_name);
+        // the compressor chain is the remainder of the line
+        char *variable_name = strtok(line, ",");
+        char *compressor_name = strtok(NULL, "\r\n");
+        if (variable_name == NULL || compressor_name == NULL) {
+          warn("Invalid line %zu in the variable mapping file\n", linenumber + 1);
+        } else {
+          scilU_dict_put(variable_dict, variable_name, compressor_name);
+        }
         //printf("Var: %s | Comp: %s", variable_name, scilU_dict_get(variable_dict, variable_name)->value);
       }
       ++linenumber;
@@ -195,51 +433,61 @@ void scilC_algo_chooser_initialize() {
     if (decision_tree_data == NULL) {
       critical("Could not open decision tree file %s\n", decision_tree_file);
     }
-    char* line = NULL;
-    size_t len = 0;
-    char** tree_class_names = NULL;
-    int* tree_left = NULL;
-    int* tree_right = NULL;
-    double* tree_thresholds = NULL;
-    int** tree_classes = NULL;
-    int* tree_indices = NULL;
-    int column_size = 0;
-    while (getline(&line, &len, decision_tree_data) != -1) {
-      if (line[0] == '#'){ // Type descriptor
-        if(strstr(line, "classes") != NULL){
-          getline(&line, &len, decision_tree_data); // Work on next line
-          tree_class_names = parse_array_chars(line);
-        }else if(strstr(line, "left") != NULL){
-          getline(&line, &len, decision_tree_data);
-          tree_left = parse_array_int(line);
-        }else if(strstr(line, "right") != NULL){
-          getline(&line, &len, decision_tree_data);
-          tree_right = parse_array_int(line);
-        }else if(strstr(line, "thresholds") != NULL){
-          getline(&line, &len, decision_tree_data);
-          tree_thresholds = parse_array_double(line);
-        }else if(strstr(line, "indices") != NULL){
-          getline(&line, &len, decision_tree_data);
-          tree_indices = parse_array_int(line);
-        }else if(strstr(line, "values")){
-          getline(&line, &len, decision_tree_data);
-          tree_classes = parse_array_values(line, &column_size);
-        }
-      }
-    }
+    load_decision_tree(decision_tree_data);
     fclose(decision_tree_data);
-    decision_tree = scilU_tree_create(tree_left, tree_right, tree_thresholds, tree_indices, tree_classes, tree_class_names, column_size);
-    //scilU_tree_remove(decision_tree);
+  }
+
+  /*
+   * Trial compression of a sample with the given number of candidate chains
+   */
+  char *trial = getenv("SCIL_CHOOSER_TRIAL");
+  if (trial != NULL) {
+    trial_candidates = atoi(trial);
+    if (trial_candidates <= 0) {
+      trial_candidates = TRIAL_DEFAULT_CANDIDATES;
+    } else if (trial_candidates > TRIAL_MAX_CANDIDATES) {
+      trial_candidates = TRIAL_MAX_CANDIDATES;
+    }
+  }
+  char *objective = getenv("SCIL_CHOOSER_OBJECTIVE");
+  if (objective == NULL || strcmp(objective, "ratio") == 0) {
+    chooser_objective = OBJECTIVE_RATIO;
+  } else if (strcmp(objective, "speed") == 0) {
+    chooser_objective = OBJECTIVE_SPEED;
+  } else if (strcmp(objective, "storage") == 0) {
+    chooser_objective = OBJECTIVE_STORAGE;
+  } else {
+    warn("Unknown chooser objective \"%s\", using the ratio\n", objective);
+  }
+
+  /*
+   * Online learning from the observed compressions with the given exploration rate
+   */
+  char *online = getenv("SCIL_CHOOSER_ONLINE");
+  if (online != NULL) {
+    char *end;
+    online_exploration = strtod(online, &end);
+    if (end == online || online_exploration < 0 || online_exploration > 1) {
+      online_exploration = ONLINE_DEFAULT_EXPLORATION;
+    }
+    char *file = getenv("SCIL_CHOOSER_ONLINE_FILE");
+    if (file != NULL) {
+      online_file = strdup(file);
+      load_online_file(online_file);
+      atexit(save_online_file);
+    }
   }
 
   /*
    * System characteristics
    */
+  // an explicitly given file takes precedence over the one in the working directory
   char *filename = getenv("SCIL_SYSTEM_CHARACTERISTICS_FILE");
+  FILE *data = NULL;
   if (filename == NULL) {
     filename = SYSTEM_CONFIGURATION_FILE;
+    data = fopen("scil.conf", "r");
   }
-  FILE *data = fopen("scil.conf", "r");
   if (data == NULL) {
     data = fopen(filename, "r");
     if (data == NULL) {
@@ -282,23 +530,19 @@ void scilC_algo_chooser_initialize() {
     }
 
     config_file_entry_t *e = &config_list[config_list_size];
-    char name[100];
-    char pattern_name[100];
-    int tokens =
-        sscanf(buff, "%f; %s %s %f; %f; %f", &e->randomness, pattern_name, name, &e->c_speed, &e->d_speed, &e->ratio);
-    if (tokens != 6) {
-      warn("Parsing configuration line \"%s\" returned an error after token %d\n", buff, tokens);
-      continue;
-    }
-    name[strlen(name) - 1] = 0;
-    ret = scilU_chain_create(&e->chain, name);
+    memset(e, 0, sizeof(config_file_entry_t));
+    char line[1024];
+    strncpy(line, buff, sizeof(line) - 1);
+    line[sizeof(line) - 1] = 0;
+    ret = parse_config_line(line, e);
     if (ret != SCIL_NO_ERR) {
-      warn("Parsing configuration line \"%s\"; could not parse compressor chain \"%s\"\n", buff, name);
+      warn("Invalid configuration line \"%s\"\n", buff);
       continue;
     }
-    debug("Configuration line %.3f; %s; %.1f; %.1f; %.3f\n",
+    debug("Configuration line %.3f; %d; %s; %.1f; %.1f; %.3f\n",
           (double) e->randomness,
-          name,
+          e->datatype,
+          e->name,
           (double) e->c_speed,
           (double) e->d_speed,
           (double) e->ratio);
@@ -319,16 +563,658 @@ void scilC_algo_chooser_initialize() {
   parse_losless_list();
 }
 
+static int get_requested_accuracy(const scil_user_hints_t *hints) {
+  int accuracy = 0;
+  if (hints->absolute_tolerance > SCIL_ACCURACY_DBL_IGNORE) {
+    accuracy |= ACCURACY_ABSOLUTE;
+  }
+  if (hints->relative_tolerance_percent > SCIL_ACCURACY_DBL_IGNORE) {
+    accuracy |= ACCURACY_RELATIVE;
+  }
+  if (hints->significant_bits > SCIL_ACCURACY_INT_IGNORE) {
+    accuracy |= ACCURACY_BITS;
+  }
+  return accuracy;
+}
+
+// returns the accuracy guaranteed by all lossy stages of the chain
+static int get_chain_accuracy(const scil_compression_chain_t *chain) {
+  const scilU_algorithm_t *stages[2 * PRECONDITIONER_LIMIT + 3];
+  int count = 0;
+  for (int i = 0; i < chain->precond_first_count; i++) {
+    stages[count++] = chain->pre_cond_first[i];
+  }
+  stages[count++] = chain->converter;
+  for (int i = 0; i < chain->precond_second_count; i++) {
+    stages[count++] = chain->pre_cond_second[i];
+  }
+  stages[count++] = chain->data_compressor;
+  stages[count++] = chain->byte_compressor;
+
+  int accuracy = ACCURACY_ABSOLUTE | ACCURACY_RELATIVE | ACCURACY_BITS;
+  for (int i = 0; i < count; i++) {
+    if (stages[i] == NULL || !stages[i]->is_lossy) {
+      continue;
+    }
+    int supported = 0;
+    for (int a = 0; lossy_algorithms[a].name != NULL; a++) {
+      if (strcmp(lossy_algorithms[a].name, stages[i]->name) == 0) {
+        supported = lossy_algorithms[a].accuracy;
+        break;
+      }
+    }
+    accuracy &= supported;
+  }
+  return accuracy;
+}
+
+// converts a performance hint into MiB/s, 0 if there is no requirement
+static double get_required_speed(const scil_performance_hint_t *hint) {
+  switch (hint->unit) {
+    case (SCIL_PERFORMANCE_MIB):
+      return (double) hint->multiplier;
+    case (SCIL_PERFORMANCE_GIB):
+      return (double) hint->multiplier * 1024.0;
+    case (SCIL_PERFORMANCE_NETWORK):
+      return (double) (hint->multiplier * scilU_get_hardware_limit(NETWORK));
+    case (SCIL_PERFORMANCE_NODELOCAL_STORAGE):
+    case (SCIL_PERFORMANCE_SINGLESTREAM_SHARED_STORAGE):
+      return (double) (hint->multiplier * scilU_get_hardware_limit(STORAGE));
+    default:
+      return 0;
+  }
+}
+
+// the data passes network and storage, the slower one limits the transfer
+static double get_transfer_bandwidth() {
+  double network = scilU_get_hardware_limit(NETWORK);
+  double storage = scilU_get_hardware_limit(STORAGE);
+  if (network <= 0) {
+    return storage;
+  }
+  if (storage <= 0) {
+    return network;
+  }
+  return network < storage ? network : storage;
+}
+
+/*
+ * An entry measured with a tolerance shows what the chain achieves while meeting it,
+ * it only applies if the same or a coarser tolerance of that kind is requested.
+ */
+static int meets_tolerance(const config_file_entry_t *e, const scil_user_hints_t *hints, int accuracy) {
+  if (e->tolerance_kind == 0) {
+    return 1;
+  }
+  if (!(accuracy & e->tolerance_kind)) {
+    return 0;
+  }
+  switch (e->tolerance_kind) {
+    case (ACCURACY_ABSOLUTE):
+      return e->tolerance <= hints->absolute_tolerance;
+    case (ACCURACY_RELATIVE):
+      return e->tolerance <= hints->relative_tolerance_percent;
+    default:
+      return e->tolerance >= hints->significant_bits;
+  }
+}
+
+// how much finer the tolerance of the entry is than the requested one, entries without tolerance come last
+static double get_tolerance_distance(const config_file_entry_t *e, const scil_user_hints_t *hints) {
+  switch (e->tolerance_kind) {
+    case (ACCURACY_ABSOLUTE):
+      return hints->absolute_tolerance / e->tolerance;
+    case (ACCURACY_RELATIVE):
+      return hints->relative_tolerance_percent / e->tolerance;
+    case (ACCURACY_BITS):
+      return 1 + e->tolerance - hints->significant_bits;
+    default:
+      return DBL_MAX;
+  }
+}
+
+static int is_candidate(const config_file_entry_t *e, const scil_context_t *ctx, int accuracy) {
+  if (e->datatype != SCIL_TYPE_UNKNOWN && e->datatype != ctx->datatype) {
+    return 0;
+  }
+  if (scilU_chain_is_applicable(&e->chain, ctx->datatype) != SCIL_NO_ERR) {
+    return 0;
+  }
+  if (e->chain.is_lossy) {
+    // a lossy chain is only allowed if it guarantees all requested tolerances
+    if (ctx->lossless_compression_needed || accuracy == 0) {
+      return 0;
+    }
+    if ((accuracy & get_chain_accuracy(&e->chain)) != accuracy) {
+      return 0;
+    }
+  }
+  return meets_tolerance(e, &ctx->hints, accuracy);
+}
+
+/*
+ * The configuration lists a chain for several levels of randomness.
+ * Only the entry closest to the randomness of the data is used, entries for the
+ * specific datatype take precedence over generic ones.
+ * Among entries of the same randomness, the one measured with the tolerance closest
+ * to the requested one is used.
+ * Entries whose randomness differs by more than the tolerance are not representative.
+ */
+static int is_closest_entry(int pos, const scil_context_t *ctx, int accuracy, float randomness, double tolerance) {
+  const config_file_entry_t *e = &config_list[pos];
+  const double distance = fabs((double) (e->randomness - randomness));
+  if (distance > tolerance) {
+    return 0;
+  }
+  for (int i = 0; i < config_list_size; i++) {
+    const config_file_entry_t *o = &config_list[i];
+    if (i == pos || strcmp(o->name, e->name) != 0 || !is_candidate(o, ctx, accuracy)) {
+      continue;
+    }
+    if (o->datatype != e->datatype) {
+      if (o->datatype == ctx->datatype) {
+        return 0;
+      }
+      continue;
+    }
+    const double o_distance = fabs((double) (o->randomness - randomness));
+    if (o_distance < distance) {
+      return 0;
+    }
+    if (!(o_distance > distance)) {
+      const double e_tolerance = get_tolerance_distance(e, &ctx->hints);
+      const double o_tolerance = get_tolerance_distance(o, &ctx->hints);
+      if (o_tolerance < e_tolerance || (!(o_tolerance > e_tolerance) && i < pos)) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+// expected time in seconds to compress, transfer and decompress one MiB
+static double estimate_time(const config_file_entry_t *e, double bandwidth) {
+  if (e->c_speed <= 0 || e->d_speed <= 0) {
+    return DBL_MAX;
+  }
+  return 1.0 / (double) e->c_speed + (double) e->ratio / bandwidth + 1.0 / (double) e->d_speed;
+}
+
+// returns the fraction of the required speed that is achieved, 1 if all requirements are met
+static double get_speed_fulfillment(const config_file_entry_t *e, double c_required, double d_required) {
+  double fulfillment = 1.0;
+  if (c_required > 0 && (double) e->c_speed / c_required < fulfillment) {
+    fulfillment = (double) e->c_speed / c_required;
+  }
+  if (d_required > 0 && (double) e->d_speed / d_required < fulfillment) {
+    fulfillment = (double) e->d_speed / d_required;
+  }
+  return fulfillment;
+}
+
+typedef struct {
+  const config_file_entry_t *entry;
+  int fulfilled;
+  double cost; // for entries that miss the speed hints the negative fulfillment
+} ranked_entry_t;
+
+static int compare_ranked_entries(const void *a, const void *b) {
+  const ranked_entry_t *x = (const ranked_entry_t *) a;
+  const ranked_entry_t *y = (const ranked_entry_t *) b;
+  if (x->fulfilled != y->fulfilled) {
+    return y->fulfilled - x->fulfilled;
+  }
+  return x->cost < y->cost ? -1 : (x->cost > y->cost ? 1 : 0);
+}
+
+/*
+ * Ranks the chains of the configuration that are applicable to the context and whose
+ * randomness is within the tolerance.
+ * Chains that meet the speed hints come first, ordered by the time to compress,
+ * transfer and decompress the data, or by ratio if the bandwidth is unknown.
+ * They are followed by the chains that come closest to the speed hints.
+ * Returns the number of entries stored in ranked.
+ */
+static int rank_from_config(const scil_context_t *ctx, float randomness, double tolerance, const config_file_entry_t **ranked, int max) {
+  const double bandwidth = get_transfer_bandwidth();
+  const double c_required = get_required_speed(&ctx->hints.comp_speed);
+  const double d_required = get_required_speed(&ctx->hints.decomp_speed);
+  const int accuracy = get_requested_accuracy(&ctx->hints);
+
+  ranked_entry_t *candidates = (ranked_entry_t *) malloc(sizeof(ranked_entry_t) * (config_list_size + 1));
+  int count = 0;
+  for (int i = 0; i < config_list_size; i++) {
+    const config_file_entry_t *e = &config_list[i];
+    if (!is_candidate(e, ctx, accuracy) || !is_closest_entry(i, ctx, accuracy, randomness, tolerance)) {
+      continue;
+    }
+    ranked_entry_t *r = &candidates[count++];
+    const double fulfillment = get_speed_fulfillment(e, c_required, d_required);
+    r->entry = e;
+    r->fulfilled = fulfillment >= 1.0;
+    r->cost = r->fulfilled ? (bandwidth > 0 ? estimate_time(e, bandwidth) : (double) e->ratio) : -fulfillment;
+    debug("Chooser candidate %s: fulfillment %f cost %f\n", e->name, fulfillment, r->cost);
+  }
+  qsort(candidates, count, sizeof(ranked_entry_t), compare_ranked_entries);
+
+  if (count > max) {
+    count = max;
+  }
+  for (int i = 0; i < count; i++) {
+    ranked[i] = candidates[i].entry;
+  }
+  free(candidates);
+  return count;
+}
+
+/*
+ * Picks the best ranked chain from the configuration.
+ * Returns NULL if there is neither a bandwidth nor a speed hint to judge the chains.
+ */
+static const config_file_entry_t *choose_from_config(const scil_context_t *ctx, float randomness) {
+  if (get_transfer_bandwidth() <= 0 && get_required_speed(&ctx->hints.comp_speed) <= 0 &&
+      get_required_speed(&ctx->hints.decomp_speed) <= 0) {
+    return NULL;
+  }
+  const config_file_entry_t *best;
+  if (rank_from_config(ctx, randomness, RANDOMNESS_TOLERANCE, &best, 1) == 0) {
+    return NULL;
+  }
+  return best;
+}
+
+/*
+ * Copies the brick of the field starting at origin into out.
+ */
+static byte *copy_brick(byte *out, const byte *source, size_t value_size, const scil_dims_t *dims,
+                        const size_t *origin, const size_t *edge) {
+  const int nd = dims->dims;
+  const size_t row = edge[0] * value_size;
+  size_t idx[SCIL_DIMS_MAX] = {0};
+  while (1) {
+    size_t pos = 0;
+    for (int d = nd - 1; d >= 0; d--) {
+      pos = pos * dims->length[d] + origin[d] + idx[d];
+    }
+    memcpy(out, source + pos * value_size, row);
+    out += row;
+
+    int d = 1;
+    for (; d < nd; d++) {
+      if (++idx[d] < edge[d]) break;
+      idx[d] = 0;
+    }
+    if (d >= nd) {
+      return out;
+    }
+  }
+}
+
+/*
+ * Draws a stratified sample of bricks that are evenly spread across the N-D domain.
+ * The bricks are concatenated along the last dimension, so the sample is again an N-D field.
+ * Returns the sample or NULL if the data is small enough to be used as is.
+ */
+static byte *gather_sample(const void *source, SCIL_Datatype_t datatype, const scil_dims_t *dims, scil_dims_t *sample_dims) {
+  const size_t value_size = DATATYPE_LENGTH(datatype);
+  const size_t count = scil_dims_get_count(dims);
+  size_t budget = count * value_size / 100 * TRIAL_SAMPLE_PERCENT;
+  budget = budget < TRIAL_SAMPLE_MIN ? TRIAL_SAMPLE_MIN : (budget > TRIAL_SAMPLE_MAX ? TRIAL_SAMPLE_MAX : budget);
+  if (budget / value_size >= count) {
+    return NULL;
+  }
+
+  const int nd = dims->dims;
+  const size_t edge_length = (size_t) pow(TRIAL_BRICK_VALUES, 1.0 / nd);
+  size_t edge[SCIL_DIMS_MAX];
+  size_t grid[SCIL_DIMS_MAX];
+  size_t brick_values = 1;
+  size_t grid_size = 1;
+  for (int d = 0; d < nd; d++) {
+    edge[d] = edge_length < dims->length[d] ? (edge_length > 0 ? edge_length : 1) : dims->length[d];
+    grid[d] = dims->length[d] / edge[d];
+    brick_values *= edge[d];
+    grid_size *= grid[d];
+  }
+  size_t bricks = budget / value_size / brick_values;
+  bricks = bricks == 0 ? 1 : (bricks > grid_size ? grid_size : bricks);
+
+  byte *sample = (byte *) scilU_safe_malloc(bricks * brick_values * value_size);
+  byte *out = sample;
+  for (size_t b = 0; b < bricks; b++) {
+    // systematic sampling of the grid of bricks, the first and last bricks touch the borders
+    size_t cell = (2 * b + 1) * grid_size / (2 * bricks);
+    size_t origin[SCIL_DIMS_MAX];
+    for (int d = 0; d < nd; d++) {
+      const size_t c = cell % grid[d];
+      cell /= grid[d];
+      origin[d] = grid[d] > 1 ? c * (dims->length[d] - edge[d]) / (grid[d] - 1) : 0;
+    }
+    out = copy_brick(out, (const byte *) source, value_size, dims, origin, edge);
+  }
+
+  *sample_dims = *dims;
+  for (int d = 0; d < nd; d++) {
+    sample_dims->length[d] = edge[d];
+  }
+  sample_dims->length[nd - 1] *= bricks;
+  return sample;
+}
+
+typedef struct {
+  const scil_context_t *ctx;
+  const config_file_entry_t *entry;
+  const void *sample;
+  const scil_dims_t *dims;
+  size_t size; // 0 if the chain failed
+  double seconds;
+} trial_t;
+
+static void run_trial(void *arg, int task) {
+  trial_t *t = &((trial_t *) arg)[task];
+  scil_user_hints_t hints = t->ctx->hints;
+  hints.force_compression_methods = t->entry->name;
+  t->size = 0;
+
+  scil_context_t *ctx;
+  int ret = scil_context_create(&ctx, t->ctx->datatype, t->ctx->special_values_count, t->ctx->special_values, &hints);
+  if (ret != SCIL_NO_ERR) {
+    return;
+  }
+  const size_t limit = scil_get_compressed_data_size_limit(t->dims, t->ctx->datatype);
+  byte *buffer = (byte *) scilU_safe_malloc(limit);
+
+  size_t size;
+  scil_timer timer;
+  scilU_start_timer(&timer);
+  ret = scilC_compress_internal(buffer, limit, (void *) t->sample, (scil_dims_t *) t->dims, &size, ctx);
+  t->seconds = scilU_stop_timer(timer);
+  if (ret == SCIL_NO_ERR) {
+    t->size = size;
+  }
+  free(buffer);
+  scil_destroy_context(ctx);
+}
+
+static double get_trial_cost(const trial_t *t, double bandwidth) {
+  if (chooser_objective == OBJECTIVE_SPEED) {
+    return t->seconds;
+  }
+  // without bandwidth the ratio determines the time to storage
+  if (chooser_objective == OBJECTIVE_STORAGE && bandwidth > 0) {
+    return t->seconds + t->size / (bandwidth * 1024 * 1024);
+  }
+  return (double) t->size;
+}
+
+/*
+ * Compresses a sample of the data with the best ranked chains of the configuration
+ * concurrently and picks the one that is best for the objective.
+ */
+static int choose_by_trial(const void *source, const scil_dims_t *dims, scil_context_t *ctx) {
+  scil_dims_t sample_dims;
+  byte *sample = gather_sample(source, ctx->datatype, dims, &sample_dims);
+  const void *data = sample != NULL ? (const void *) sample : source;
+  const scil_dims_t *data_dims = sample != NULL ? &sample_dims : dims;
+  const size_t size = scil_dims_get_size(data_dims, ctx->datatype);
+
+  // the randomness of the sample represents the whole domain
+  size_t buffer_size = size + size / 255 + 64;
+  byte *buffer = (byte *) scilU_safe_malloc(buffer_size);
+  float r = scilU_get_data_randomness(data, size, buffer, buffer_size);
+  free(buffer);
+
+  const config_file_entry_t *ranked[TRIAL_MAX_CANDIDATES];
+  // the trial measures the chains, so any entry may serve to rank them
+  const int count = rank_from_config(ctx, r, DBL_MAX, ranked, trial_candidates);
+  trial_t trials[TRIAL_MAX_CANDIDATES];
+  for (int i = 0; i < count; i++) {
+    trials[i] = (trial_t) {ctx, ranked[i], data, data_dims, 0, 0};
+  }
+  scilU_parallel_run(count, run_trial, trials);
+  const double bandwidth = get_transfer_bandwidth();
+  const trial_t *best = NULL;
+  double best_cost = 0;
+  for (int i = 0; i < count; i++) {
+    const trial_t *t = &trials[i];
+    if (t->size == 0) {
+      continue;
+    }
+    const double cost = get_trial_cost(t, bandwidth);
+    debug("Trial %s: %zu of %zu bytes in %fs\n", t->entry->name, t->size, size, t->seconds);
+    if (best == NULL || cost < best_cost) {
+      best = t;
+      best_cost = cost;
+    }
+  }
+  free(sample);
+
+  if (best == NULL) {
+    return SCIL_EINVAL;
+  }
+  debug("Chooser selected %s by trial compression\n", best->entry->name);
+  ctx->chain = best->entry->chain;
+  return SCIL_NO_ERR;
+}
+
+static double get_online_cost(const scilC_online_stats_t *s, double bandwidth, double c_required, double d_required) {
+  double cost;
+  if (chooser_objective == OBJECTIVE_SPEED) {
+    cost = s->c_seconds + s->d_seconds;
+  } else if (chooser_objective == OBJECTIVE_STORAGE && bandwidth > 0) {
+    cost = s->c_seconds + s->ratio / bandwidth + s->d_seconds;
+  } else {
+    cost = s->ratio;
+  }
+  // chains that miss the speed hints only win if no chain meets them
+  if ((c_required > 0 && s->c_seconds * c_required > 1) || (d_required > 0 && s->d_seconds * d_required > 1)) {
+    cost += 1e6;
+  }
+  return cost;
+}
+
+/*
+ * Multi-armed bandit per randomness bucket: every candidate chain is tried once,
+ * then the chain with the lowest observed cost is used while another candidate
+ * is explored with the configured probability.
+ * The candidates are the best ranked chains of the configuration or, without
+ * configuration, a set of lossless chains.
+ */
+static int choose_online(const void *source, const scil_dims_t *dims, scil_context_t *ctx) {
+  const size_t count = scil_dims_get_count(dims);
+  size_t in_size = count < 10000 ? count : 10000;
+  byte buffer[15000];
+  const float r = scilU_get_data_randomness(source, in_size, buffer, sizeof(buffer));
+  const int bucket = scilC_chooser_online_bucket(r);
+
+  const char *names[TRIAL_MAX_CANDIDATES];
+  const config_file_entry_t *ranked[TRIAL_MAX_CANDIDATES];
+  int candidates = rank_from_config(ctx, r, DBL_MAX, ranked, TRIAL_MAX_CANDIDATES);
+  for (int i = 0; i < candidates; i++) {
+    names[i] = ranked[i]->name;
+  }
+  if (candidates == 0) {
+    for (; online_default_chains[candidates] != NULL; candidates++) {
+      names[candidates] = online_default_chains[candidates];
+    }
+  }
+
+  const double bandwidth = get_transfer_bandwidth();
+  const double c_required = get_required_speed(&ctx->hints.comp_speed);
+  const double d_required = get_required_speed(&ctx->hints.decomp_speed);
+  int choice = -1;
+  int explore = 0;
+  double best_cost = DBL_MAX;
+  scilC_online_stats_t stats;
+  for (int i = 0; i < candidates; i++) {
+    if (!scilC_chooser_online_get(ctx->datatype, bucket, names[i], &stats)) {
+      // not yet observed
+      choice = i;
+      explore = 1;
+      break;
+    }
+    const double cost = get_online_cost(&stats, bandwidth, c_required, d_required);
+    if (choice < 0 || cost < best_cost) {
+      choice = i;
+      best_cost = cost;
+    }
+  }
+  pthread_mutex_lock(&online_seed_lock);
+  if (!explore && candidates > 1 && rand_r(&online_seed) < online_exploration * RAND_MAX) {
+    const int other = rand_r(&online_seed) % (candidates - 1);
+    choice = other < choice ? other : other + 1;
+    explore = 1;
+  }
+  pthread_mutex_unlock(&online_seed_lock);
+
+  int ret = scilU_chain_create(&ctx->chain, names[choice]);
+  if (ret != SCIL_NO_ERR) {
+    return ret;
+  }
+  ctx->chooser_online = 1;
+  ctx->chooser_bucket = bucket;
+  ctx->chooser_measure = explore || !scilC_chooser_online_get(ctx->datatype, bucket, names[choice], &stats) ||
+      stats.d_count < ONLINE_DECOMPRESSION_SAMPLES;
+  debug("Online chooser selected %s for randomness %.1f%s\n", names[choice], (double) r, explore ? " (exploring)" : "");
+  return SCIL_NO_ERR;
+}
+
+/*
+ * Returns the seconds to decompress the compressed data of the chain.
+ * Large data is not decompressed but a sample of it is compressed and decompressed
+ * with the chain, thus the measurement costs a bounded amount of time and memory.
+ */
+static int measure_decompression(const scil_context_t *ctx, const char *name, const void *source, const scil_dims_t *dims,
+                                 byte *compressed, size_t size, double *mib, double *seconds) {
+  scil_dims_t sample_dims;
+  byte *sample = gather_sample(source, ctx->datatype, dims, &sample_dims);
+  const scil_dims_t *data_dims = sample != NULL ? &sample_dims : dims;
+  const size_t data_size = scil_dims_get_size(data_dims, ctx->datatype);
+  const size_t limit = scil_get_compressed_data_size_limit(data_dims, ctx->datatype);
+  byte *tmp = (byte *) scilU_safe_malloc(limit);
+  byte *data = (byte *) scilU_safe_malloc(data_size);
+  byte *buffer = NULL;
+  int ret = SCIL_NO_ERR;
+
+  if (sample != NULL) {
+    scil_user_hints_t hints = ctx->hints;
+    hints.force_compression_methods = (char *) name;
+    scil_context_t *sample_ctx;
+    ret = scil_context_create(&sample_ctx, ctx->datatype, ctx->special_values_count, ctx->special_values, &hints);
+    if (ret == SCIL_NO_ERR) {
+      buffer = (byte *) scilU_safe_malloc(limit);
+      ret = scilC_compress_internal(buffer, limit, sample, &sample_dims, &size, sample_ctx);
+      scil_destroy_context(sample_ctx);
+      compressed = buffer;
+    }
+  }
+  if (ret == SCIL_NO_ERR) {
+    scil_dims_t out_dims = *data_dims;
+    scil_timer timer;
+    scilU_start_timer(&timer);
+    ret = scilC_decompress_internal(ctx->datatype, data, &out_dims, compressed, size, tmp);
+    *seconds = scilU_stop_timer(timer);
+    *mib = (double) data_size / (1024.0 * 1024.0);
+  }
+  free(sample);
+  free(buffer);
+  free(data);
+  free(tmp);
+  return ret;
+}
+
+void scilC_algo_chooser_observe(scil_context_t *ctx, const void *source, byte *compressed, size_t size, scil_dims_t *dims, double seconds) {
+  if (!ctx->chooser_online) {
+    return;
+  }
+  char name[1024];
+  scil_compression_sprint_last_algorithm_chain(ctx, name, sizeof(name));
+  const size_t input_size = scil_dims_get_size(dims, ctx->datatype);
+  const double mib = (double) input_size / (1024.0 * 1024.0);
+  scilC_chooser_online_record_compression(ctx->datatype, ctx->chooser_bucket, name, mib, seconds, (double) size / (double) input_size);
+  if (!ctx->chooser_measure) {
+    return;
+  }
+
+  double d_mib, d_seconds;
+  if (measure_decompression(ctx, name, source, dims, compressed, size, &d_mib, &d_seconds) == SCIL_NO_ERR) {
+    scilC_chooser_online_record_decompression(ctx->datatype, ctx->chooser_bucket, name, d_mib, d_seconds);
+  }
+}
+
+static const char *get_variable_name(const scil_context_t *ctx) {
+  const char *name = ctx->variable_name;
+  if (name == NULL) {
+    name = getenv("H5REPACK_VARIABLE");
+  }
+  if (name == NULL || name[0] == 0) {
+    return NULL;
+  }
+  return name;
+}
+
+static int is_suitable(const scil_compression_chain_t *chain, const scil_context_t *ctx) {
+  return scilU_chain_is_applicable(chain, ctx->datatype) == SCIL_NO_ERR &&
+         !(chain->is_lossy && ctx->lossless_compression_needed);
+}
+
+// features may be NULL if they are not needed
+static void choose_chain(const void *restrict source, const scil_dims_t *dims, scil_context_t *ctx, const double *features) {
+  scil_compression_chain_t *chain = &ctx->chain;
+  int ret;
+
+  if (decision_tree != NULL) {
+    const char *predicted = scilU_tree_predict(decision_tree, features);
+    ret = scilU_chain_create(chain, predicted);
+    if (ret == SCIL_NO_ERR && is_suitable(chain, ctx)) {
+      debug("Decision tree predicted %s\n", predicted);
+      return;
+    }
+    warn("Decision tree predicted the unsuitable chain %s\n", predicted);
+    memset(chain, 0, sizeof(scil_compression_chain_t));
+  }
+
+  if (trial_candidates > 0 && choose_by_trial(source, dims, ctx) == SCIL_NO_ERR) {
+    return;
+  }
+
+  const size_t count = scil_dims_get_count(dims);
+  size_t out_size = 15000;
+  byte buffer[15000];
+  size_t in_size = 10000;
+  if (count < in_size) {
+    in_size = count;
+  }
+
+  float r = scilU_get_data_randomness(source, in_size, buffer, out_size);
+
+  const config_file_entry_t *e = choose_from_config(ctx, r);
+  if (e != NULL) {
+    debug("Chooser selected %s for randomness %.1f\n", e->name, (double) r);
+    *chain = e->chain;
+    return;
+  }
+
+  // without performance data use a fast byte compressor, it is always lossless
+  if (r > 95) {
+    ret = scilU_chain_create(chain, "memcopy");
+  } else {
+    ret = scilU_chain_create(chain, "lz4");
+  }
+  assert(ret == SCIL_NO_ERR);
+}
+
 void scilC_algo_chooser_execute(const void *restrict source,
                                 const scil_dims_t *dims,
                                 scil_context_t *ctx) {
   scil_compression_chain_t *chain = &ctx->chain;
   int ret;
 
-  // at the moment we only set the compression algorith once
-  if (chain->total_size != 0) {
+  // at the moment we only set the compression algorith once, the online chooser learns from each call
+  if (chain->total_size != 0 && !ctx->chooser_online) {
     return;
   }
+  ctx->chooser_online = 0;
   char *chainEnv = getenv("SCIL_FORCE_COMPRESSION_CHAIN");
   if (chainEnv != NULL) {
     if (strcmp(chainEnv, "lossless") == 0) {
@@ -349,25 +1235,38 @@ void scilC_algo_chooser_execute(const void *restrict source,
     return;
   }
 
-  size_t out_size = 15000;
-  byte buffer[15000];
-  size_t in_size = 10000;
-  if (count < in_size) {
-    in_size = count;
+  const char *name = get_variable_name(ctx);
+  if (name != NULL && variable_dict != NULL) {
+    scilU_dict_element_t *element = scilU_dict_get(variable_dict, name);
+    if (element != NULL) {
+      ret = scilU_chain_create(chain, element->value);
+      if (ret == SCIL_NO_ERR && is_suitable(chain, ctx)) {
+        debug("Variable %s is mapped to %s\n", name, element->value);
+        return;
+      }
+      warn("Variable %s is mapped to the unsuitable chain %s\n", name, element->value);
+      memset(chain, 0, sizeof(scil_compression_chain_t));
+    }
   }
 
-  float r = scilU_get_data_randomness(source, in_size, buffer, out_size);
-  if (ctx->lossless_compression_needed) {
-    // we can only select byte compressors compress because data must be accurate!
+  if (online_exploration >= 0 && choose_online(source, dims, ctx) == SCIL_NO_ERR) {
+    return;
   }
-  // TODO: pick the best algorithm for the settings given in ctx...
 
-  if (r > 95) {
-    ret = scilU_chain_create(chain, "memcopy");
-  } else {
-    ret = scilU_chain_create(chain, "lz4");
+  double features[SCIL_FEATURE_LAST];
+  if (name != NULL || decision_tree != NULL) {
+    scilU_get_data_features(source, ctx->datatype, dims, ctx->hints.fill_value, features);
+  }
+  if (name != NULL && scilC_chooser_cache_lookup(name, ctx->datatype, dims, &ctx->hints, features, chain)) {
+    debug("Chooser cache: reusing the chain for %s\n", name);
+    return;
+  }
+
+  choose_chain(source, dims, ctx, features);
+
+  if (name != NULL) {
+    scilC_chooser_cache_store(name, ctx->datatype, dims, &ctx->hints, features, chain);
   }
-  assert(ret == SCIL_NO_ERR);
 }
 
 
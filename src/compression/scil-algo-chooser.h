@@ -30,4 +30,10 @@ void scilC_algo_chooser_execute(const void* restrict source,
                                 const scil_dims_t* dims,
                                 scil_context_t* ctx);
 
+/*
+ * Records the performance of a compression for the online chooser.
+ * The decompression speed may be measured on the compressed data or, for large data, on a sample of the source.
+ */
+void scilC_algo_chooser_observe(scil_context_t* ctx, const void* source, byte* compressed, size_t size, scil_dims_t* dims, double seconds);
+
 #endif // SCIL_ALGO_CHOOSER_H
@@ -0,0 +1,130 @@
+#include <scil-chooser-cache.h>
+
+#include <scil-util.h>
+#include <scil-debug.h>
+
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+// Upper bound for the number of cached decisions, the oldest are dropped
+#define CHOOSER_CACHE_MAX 1024
+
+// A decision is reconsidered if a statistic changes by more than this fraction of the value range
+#define CHOOSER_CACHE_DRIFT 0.1
+
+typedef struct chooser_cache_entry{
+  char * name;
+  SCIL_Datatype_t datatype;
+  int dims;
+  int size_class;
+  scil_user_hints_t hints;
+  double features[SCIL_FEATURE_LAST];
+  scil_compression_chain_t chain;
+  struct chooser_cache_entry * next;
+} chooser_cache_entry_t;
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static chooser_cache_entry_t * cache = NULL;
+static int cache_size = 0;
+
+static int get_size_class(const scil_dims_t* dims){
+  size_t count = scil_dims_get_count(dims);
+  int size_class = 0;
+  while(count > 1){
+    count >>= 1;
+    size_class++;
+  }
+  return size_class;
+}
+
+#define SAME_VALUE(field) (memcmp(& a->field, & b->field, sizeof(a->field)) == 0)
+
+// only the hints that influence the decision are relevant
+static int hints_match(const scil_user_hints_t* a, const scil_user_hints_t* b){
+  return SAME_VALUE(relative_tolerance_percent) && SAME_VALUE(relative_err_finest_abs_tolerance) &&
+      SAME_VALUE(absolute_tolerance) && SAME_VALUE(significant_digits) && SAME_VALUE(significant_bits) &&
+      SAME_VALUE(lossless_data_range_up_to) && SAME_VALUE(lossless_data_range_from) && SAME_VALUE(fill_value) &&
+      SAME_VALUE(comp_speed.unit) && SAME_VALUE(comp_speed.multiplier) &&
+      SAME_VALUE(decomp_speed.unit) && SAME_VALUE(decomp_speed.multiplier);
+}
+
+static chooser_cache_entry_t * find_entry(const char* name, SCIL_Datatype_t datatype, const scil_dims_t* dims, const scil_user_hints_t* hints, chooser_cache_entry_t *** prev_out){
+  const int size_class = get_size_class(dims);
+  chooser_cache_entry_t ** prev = & cache;
+  for(chooser_cache_entry_t * e = cache; e != NULL; e = e->next){
+    if(e->datatype == datatype && e->dims == dims->dims && e->size_class == size_class &&
+        strcmp(e->name, name) == 0 && hints_match(& e->hints, hints)){
+      if(prev_out) *prev_out = prev;
+      return e;
+    }
+    prev = & e->next;
+  }
+  return NULL;
+}
+
+static int has_drifted(const double* old, const double* cur){
+  const double range = old[SCIL_FEATURE_MAX] - old[SCIL_FEATURE_MIN];
+  double scale = range > 0 ? range : fabs(old[SCIL_FEATURE_MEAN]);
+  if(! (scale > 0)){
+    scale = 1;
+  }
+  const int statistics[] = {SCIL_FEATURE_MIN, SCIL_FEATURE_MAX, SCIL_FEATURE_MEAN, SCIL_FEATURE_STDDEV};
+  for(int i = 0; i < 4; i++){
+    if(! (fabs(cur[statistics[i]] - old[statistics[i]]) <= CHOOSER_CACHE_DRIFT * scale)){
+      return 1;
+    }
+  }
+  return fabs(cur[SCIL_FEATURE_FILL_FRACTION] - old[SCIL_FEATURE_FILL_FRACTION]) > CHOOSER_CACHE_DRIFT;
+}
+
+int scilC_chooser_cache_lookup(const char* name, SCIL_Datatype_t datatype, const scil_dims_t* dims, const scil_user_hints_t* hints, const double* features, scil_compression_chain_t* chain){
+  int found = 0;
+  pthread_mutex_lock(& cache_lock);
+  chooser_cache_entry_t * e = find_entry(name, datatype, dims, hints, NULL);
+  if(e != NULL){
+    if(has_drifted(e->features, features)){
+      debug("Chooser cache: the data of %s drifted\n", name);
+    }else{
+      *chain = e->chain;
+      found = 1;
+    }
+  }
+  pthread_mutex_unlock(& cache_lock);
+  return found;
+}
+
+void scilC_chooser_cache_store(const char* name, SCIL_Datatype_t datatype, const scil_dims_t* dims, const scil_user_hints_t* hints, const double* features, const scil_compression_chain_t* chain){
+  pthread_mutex_lock(& cache_lock);
+  chooser_cache_entry_t ** prev;
+  chooser_cache_entry_t * e = find_entry(name, datatype, dims, hints, & prev);
+  if(e != NULL){
+    // move the updated entry to the front
+    *prev = e->next;
+  }else{
+    e = (chooser_cache_entry_t*) scilU_safe_malloc(sizeof(chooser_cache_entry_t));
+    e->name = strdup(name);
+    e->datatype = datatype;
+    e->dims = dims->dims;
+    e->size_class = get_size_class(dims);
+    e->hints = *hints;
+    e->hints.force_compression_methods = NULL;
+    cache_size++;
+  }
+  memcpy(e->features, features, sizeof(e->features));
+  e->chain = *chain;
+  e->next = cache;
+  cache = e;
+
+  if(cache_size > CHOOSER_CACHE_MAX){
+    chooser_cache_entry_t ** last = & cache;
+    while((*last)->next != NULL){
+      last = & (*last)->next;
+    }
+    free((*last)->name);
+    free(*last);
+    *last = NULL;
+    cache_size--;
+  }
+  pthread_mutex_unlock(& cache_lock);
+}
@@ -0,0 +1,23 @@
+#ifndef SCIL_CHOOSER_CACHE_H
+#define SCIL_CHOOSER_CACHE_H
+
+#include <scil-compression-chain.h>
+#include <scil-data-characteristics.h>
+
+/*
+ * Process-wide cache of the decisions of the algorithm chooser per variable.
+ * An entry is keyed by the variable name, datatype, dimensionality, size class
+ * and the accuracy and performance hints. It stores the features of the data
+ * as fingerprint, the decision is reused until the statistics of the data drift.
+ * The functions are thread-safe.
+ */
+
+/*
+ * Returns 1 and copies the cached chain if there is a matching entry, 0 otherwise.
+ * features must contain SCIL_FEATURE_LAST values determined by scilU_get_data_features().
+ */
+int scilC_chooser_cache_lookup(const char* name, SCIL_Datatype_t datatype, const scil_dims_t* dims, const scil_user_hints_t* hints, const double* features, scil_compression_chain_t* chain);
+
+void scilC_chooser_cache_store(const char* name, SCIL_Datatype_t datatype, const scil_dims_t* dims, const scil_user_hints_t* hints, const double* features, const scil_compression_chain_t* chain);
+
+#endif // SCIL_CHOOSER_CACHE_H
@@ -0,0 +1,130 @@
+#include <scil-chooser-online.h>
+
+#include <scil-error.h>
+#include <scil-hardware-limits.h>
+#include <scil-util.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+// Upper bound for the weight of the past, newer observations keep a weight of at least 1/ONLINE_MAX_WEIGHT
+#define ONLINE_MAX_WEIGHT 64
+
+typedef struct online_entry {
+  char *chain;
+  SCIL_Datatype_t datatype;
+  int bucket;
+  scilC_online_stats_t stats;
+  struct online_entry *next;
+} online_entry_t;
+
+static pthread_mutex_t online_lock = PTHREAD_MUTEX_INITIALIZER;
+static online_entry_t *entries = NULL;
+
+int scilC_chooser_online_bucket(float randomness) {
+  int bucket = (int) (randomness / SCIL_ONLINE_BUCKET_WIDTH + 0.5f);
+  if (bucket < 0) {
+    return 0;
+  }
+  if (bucket > 100 / SCIL_ONLINE_BUCKET_WIDTH) {
+    return 100 / SCIL_ONLINE_BUCKET_WIDTH;
+  }
+  return bucket;
+}
+
+static online_entry_t *find_entry(SCIL_Datatype_t datatype, int bucket, const char *chain, int create) {
+  for (online_entry_t *e = entries; e != NULL; e = e->next) {
+    if (e->datatype == datatype && e->bucket == bucket && strcmp(e->chain, chain) == 0) {
+      return e;
+    }
+  }
+  if (!create) {
+    return NULL;
+  }
+  online_entry_t *e = (online_entry_t *) scilU_safe_malloc(sizeof(online_entry_t));
+  memset(e, 0, sizeof(online_entry_t));
+  e->chain = strdup(chain);
+  e->datatype = datatype;
+  e->bucket = bucket;
+  e->next = entries;
+  entries = e;
+  return e;
+}
+
+static void update_mean(double *mean, double *count, double value) {
+  if (*count < ONLINE_MAX_WEIGHT) {
+    *count += 1;
+  }
+  *mean += (value - *mean) / *count;
+}
+
+int scilC_chooser_online_get(SCIL_Datatype_t datatype, int bucket, const char *chain, scilC_online_stats_t *stats) {
+  pthread_mutex_lock(&online_lock);
+  online_entry_t *e = find_entry(datatype, bucket, chain, 0);
+  if (e != NULL) {
+    *stats = e->stats;
+  }
+  pthread_mutex_unlock(&online_lock);
+  return e != NULL;
+}
+
+void scilC_chooser_online_record_compression(SCIL_Datatype_t datatype, int bucket, const char *chain, double mib, double seconds, double ratio) {
+  if (!(mib > 0)) {
+    return;
+  }
+  pthread_mutex_lock(&online_lock);
+  online_entry_t *e = find_entry(datatype, bucket, chain, 1);
+  double count = e->stats.count;
+  update_mean(&e->stats.c_seconds, &count, seconds / mib);
+  update_mean(&e->stats.ratio, &e->stats.count, ratio);
+  pthread_mutex_unlock(&online_lock);
+}
+
+void scilC_chooser_online_record_decompression(SCIL_Datatype_t datatype, int bucket, const char *chain, double mib, double seconds) {
+  if (!(mib > 0)) {
+    return;
+  }
+  pthread_mutex_lock(&online_lock);
+  online_entry_t *e = find_entry(datatype, bucket, chain, 1);
+  update_mean(&e->stats.d_seconds, &e->stats.d_count, seconds / mib);
+  pthread_mutex_unlock(&online_lock);
+}
+
+static double to_speed(double seconds) {
+  // a speed beyond the resolution of the timer
+  return seconds > 1e-9 ? 1.0 / seconds : 1e9;
+}
+
+int scilC_chooser_online_save(const char *filename) {
+  FILE *f = fopen(filename, "w");
+  if (f == NULL) {
+    return SCIL_EINVAL;
+  }
+  fprintf(f, "# Learned by the online chooser\n");
+  fprintf(f, "# randomness; data type; pattern name; compressor chain; compr. MiB/s; decompr. MiB/s; inverse compr. ratio\n");
+  if (scilU_get_hardware_limit(NETWORK) > 0) {
+    fprintf(f, "!network %f\n", (double) scilU_get_hardware_limit(NETWORK));
+  }
+  if (scilU_get_hardware_limit(STORAGE) > 0) {
+    fprintf(f, "!storage %f\n", (double) scilU_get_hardware_limit(STORAGE));
+  }
+  if (scilU_get_hardware_limit(MEMORY) > 0) {
+    fprintf(f, "!memory %f\n", (double) scilU_get_hardware_limit(MEMORY));
+  }
+  pthread_mutex_lock(&online_lock);
+  for (online_entry_t *e = entries; e != NULL; e = e->next) {
+    if (!(e->stats.count > 0 && e->stats.d_count > 0)) {
+      continue;
+    }
+    fprintf(f, "%d; %d; online; %s; %f; %f; %f\n",
+            e->bucket * SCIL_ONLINE_BUCKET_WIDTH,
+            e->datatype,
+            e->chain,
+            to_speed(e->stats.c_seconds),
+            to_speed(e->stats.d_seconds),
+            e->stats.ratio);
+  }
+  pthread_mutex_unlock(&online_lock);
+  return fclose(f) == 0 ? SCIL_NO_ERR : SCIL_EINVAL;
+}
@@ -0,0 +1,41 @@
+#ifndef SCIL_CHOOSER_ONLINE_H
+#define SCIL_CHOOSER_ONLINE_H
+
+#include <scil-datatypes.h>
+
+/*
+ * Statistics of the compression chains observed while the application runs.
+ * The observations are kept per datatype, randomness bucket and chain, the
+ * means are weighted towards the recent observations.
+ * The functions are thread-safe.
+ */
+
+// Width of a randomness bucket in percent
+#define SCIL_ONLINE_BUCKET_WIDTH 10
+
+typedef struct {
+  double count;     // weight of the compressions observed
+  double c_seconds; // mean time to compress one MiB
+  double ratio;     // mean inverse compression ratio
+  double d_count;   // weight of the decompressions observed
+  double d_seconds; // mean time to decompress one MiB
+} scilC_online_stats_t;
+
+int scilC_chooser_online_bucket(float randomness);
+
+/*
+ * Returns 1 and copies the statistics if the chain was observed, 0 otherwise.
+ */
+int scilC_chooser_online_get(SCIL_Datatype_t datatype, int bucket, const char *chain, scilC_online_stats_t *stats);
+
+void scilC_chooser_online_record_compression(SCIL_Datatype_t datatype, int bucket, const char *chain, double mib, double seconds, double ratio);
+
+void scilC_chooser_online_record_decompression(SCIL_Datatype_t datatype, int bucket, const char *chain, double mib, double seconds);
+
+/*
+ * Writes the statistics in the format of scil.conf, chains without observed
+ * decompression are skipped.
+ */
+int scilC_chooser_online_save(const char *filename);
+
+#endif // SCIL_CHOOSER_ONLINE_H
@@ -20,6 +20,7 @@
 #include <algo/algo-sz.h>
 #include <algo/precond-delta.h>
 #include <algo/precond-fp-delta.h>
+#include <algo/precond-specials.h>
 
 #include <scil-debug.h>
 
@@ -55,6 +56,8 @@ static scilU_algorithm_t* algo_array[] = {
   	& algo_zstd,
   	& algo_zstd11,
   	& algo_zstd22,
+	& algo_sigbits_blocked, // 19
+	& algo_precond_specials, // 20
 	NULL
 };
 
@@ -81,20 +84,8 @@ scilU_algorithm_t* scil_get_compressor(int number){
 
 int scilU_get_available_compressor_count()
 {
-	static int count = -1;
-	if (count > 0){
-		return count;
-	}
-
-	scilU_algorithm_t ** cur = algo_array;
-	count = 0;
-	// count
-	while(*cur != NULL){
-		count++;
-		cur++;
-	}
-
-	return count;
+	// without the terminating NULL, a constant as contexts are created concurrently
+	return sizeof(algo_array) / sizeof(algo_array[0]) - 1;
 }
 
 const char* scilU_get_compressor_name(int number)
@@ -3,7 +3,18 @@
 
 #include <scil-context.h>
 #include <scil-compression-chain.h>
+#include <scil-mask-impl.h>
+#include <scil-verify.h>
 
+#include <pthread.h>
+
+struct scil_compress_stats;
+
+/*
+ * The context holds the configuration, it is not changed by scil_compress().
+ * A call of scil_compress() works on a private copy of the context that holds
+ * the state of the call, thus threads may compress with one context concurrently.
+ */
 struct scil_context {
   int lossless_compression_needed;
   enum SCIL_Datatype datatype;
@@ -13,11 +24,60 @@ struct scil_context {
   int  special_values_count;
   scil_value_t *special_values;
 
-  /** \brief The last compressor used, could be used for debugging */
+  /** \brief Guards the chain and the results of the last call, shared with the copies of the calls */
+  pthread_mutex_t *lock;
+
+  /** \brief The chain of the call, the context keeps the last one used; later calls reuse it */
   scil_compression_chain_t chain;
 
-  /** \brief Dictionary for pipeline internal parameters */
+  /** \brief Dictionary for pipeline internal parameters of the call */
   scilU_dict_t *pipeline_params;
+
+  /** \brief Registered mask of valid points, NULL if unused */
+  scilC_mask_t *mask;
+  /** \brief Detect the mask from the fill value for each call */
+  int mask_auto;
+  /** \brief The cached mask detected by the last call, reused while the data matches it */
+  scilC_mask_t *mask_detected;
+
+  /** \brief Name of the variable, used to map and cache the choice of the compression chain */
+  char *variable_name;
+
+  /** \brief The chain is chosen by the online chooser for each call */
+  int chooser_online;
+  /** \brief Randomness bucket of the data for the online chooser */
+  int chooser_bucket;
+  /** \brief Measure the decompression of the next call for the online chooser */
+  int chooser_measure;
+
+  /** \brief Minimum number of values compressed as independent block, 0 to compress all at once */
+  size_t block_size;
+
+  /** \brief Errors reported by the encoders while compressing, NULL if verification is disabled.
+   The context keeps the result of the last call. */
+  scilC_verification_t *verification;
+
+  /** \brief Measurements of the stages, NULL if disabled.
+   The context keeps the measurements of the last call. */
+  struct scil_compress_stats *stats;
 };
 
+/*
+ * scil_compress() and scil_decompress() for calls of the library itself, e.g., the trials of the chooser.
+ * The counters and the trace do not include them.
+ */
+int scilC_compress_internal(byte* restrict dest,
+                            size_t in_dest_size,
+                            void* restrict source,
+                            scil_dims_t* dims,
+                            size_t* restrict out_size_p,
+                            scil_context_t* ctx);
+
+int scilC_decompress_internal(SCIL_Datatype_t datatype,
+                              void* restrict dest,
+                              scil_dims_t* dims,
+                              byte* restrict source,
+                              const size_t source_size,
+                              byte* restrict buff_tmp1);
+
 #endif // SCIL_CONTEXT_H
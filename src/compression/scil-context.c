@@ -1,3 +1,4 @@
+#include <scil.h>
 #include <scil-context-impl.h>
 
 #include <scil-compressor.h>
@@ -12,17 +13,13 @@
 #include <stdio.h>
 #include <string.h>
 
-static int initialized = 0;
+static pthread_once_t initialized = PTHREAD_ONCE_INIT;
 
 static void initialize() {
-  if (initialized) {
-    return;
-  }
   scil_initialize_compressors();
 
   scilU_initialize_hardware_limits();
   scilC_algo_chooser_initialize();
-  initialized = 1;
 }
 
 static int check_compress_lossless_needed(scil_context_t *ctx) {
@@ -56,7 +53,7 @@ int scil_context_create(scil_context_t **out_ctx,
                         int special_values_count,
                         scil_value_t *sv,
                         const scil_user_hints_t *hints) {
-  initialize();
+  pthread_once(&initialized, initialize);
 
   int ret = SCIL_NO_ERR;
   scil_context_t *ctx;
@@ -65,7 +62,8 @@ int scil_context_create(scil_context_t **out_ctx,
   ctx = (scil_context_t *) scilU_safe_malloc(sizeof(scil_context_t));
   memset(ctx, 0, sizeof(scil_context_t));
 
-  ctx->pipeline_params = scilU_dict_create(30);
+  ctx->lock = (pthread_mutex_t *) scilU_safe_malloc(sizeof(pthread_mutex_t));
+  pthread_mutex_init(ctx->lock, NULL);
 
   ctx->datatype = datatype;
   ctx->special_values_count = special_values_count;
@@ -132,16 +130,13 @@ int scil_context_create(scil_context_t **out_ctx,
     ret = scilU_chain_create(&ctx->chain, hints->force_compression_methods);
     if (ret == SCIL_NO_ERR) {
       ret = scilU_chain_is_applicable(&ctx->chain, datatype);
-      if (ret == SCIL_NO_ERR) {
-        oh->force_compression_methods = strdup(oh->force_compression_methods);
-      }
     }
   }
 
   if (ret == SCIL_NO_ERR) {
     *out_ctx = ctx;
   } else {
-    free(ctx);
+    scil_destroy_context(ctx);
   }
 
   return ret;
@@ -149,6 +144,12 @@ int scil_context_create(scil_context_t **out_ctx,
 
 int scil_destroy_context(scil_context_t *out_ctx) {
   free(out_ctx->hints.force_compression_methods);
+  free(out_ctx->variable_name);
+  free(out_ctx->special_values);
+  scilC_verification_destroy(out_ctx->verification);
+  free(out_ctx->stats);
+  pthread_mutex_destroy(out_ctx->lock);
+  free(out_ctx->lock);
   free(out_ctx);
   out_ctx = NULL;
 
@@ -158,3 +159,59 @@ int scil_destroy_context(scil_context_t *out_ctx) {
 scil_user_hints_t scil_get_effective_hints(const scil_context_t *ctx) {
   return ctx->hints;
 }
+
+int scil_context_set_mask(scil_context_t *ctx, const char *name) {
+  ctx->mask = NULL;
+  ctx->mask_auto = 0;
+  ctx->mask_detected = NULL;
+  if (name == NULL) {
+    return SCIL_NO_ERR;
+  }
+  if (strcmp(name, SCIL_MASK_AUTO) == 0) {
+    ctx->mask_auto = 1;
+    return SCIL_NO_ERR;
+  }
+  ctx->mask = scilC_mask_get_by_name(name);
+  return ctx->mask == NULL ? SCIL_EINVAL : SCIL_NO_ERR;
+}
+
+int scil_context_set_variable_name(scil_context_t *ctx, const char *name) {
+  char *copy = name != NULL ? strdup(name) : NULL;
+  // concurrent calls work on their own copy of the name
+  pthread_mutex_lock(ctx->lock);
+  char *old = ctx->variable_name;
+  ctx->variable_name = copy;
+  // the chain must be chosen again for the new variable unless it is forced by the user
+  if (ctx->hints.force_compression_methods == NULL) {
+    memset(&ctx->chain, 0, sizeof(ctx->chain));
+  }
+  pthread_mutex_unlock(ctx->lock);
+  free(old);
+  return SCIL_NO_ERR;
+}
+
+int scil_context_set_block_size(scil_context_t *ctx, size_t count) {
+  ctx->block_size = count;
+  return SCIL_NO_ERR;
+}
+
+int scil_context_set_verification(scil_context_t *ctx, int enabled) {
+  if (enabled && ctx->verification == NULL) {
+    ctx->verification = scilC_verification_create();
+  } else if (!enabled) {
+    scilC_verification_destroy(ctx->verification);
+    ctx->verification = NULL;
+  }
+  return SCIL_NO_ERR;
+}
+
+int scil_context_set_stats(scil_context_t *ctx, int enabled) {
+  if (enabled && ctx->stats == NULL) {
+    ctx->stats = (scil_compress_stats_t *) scilU_safe_malloc(sizeof(scil_compress_stats_t));
+    memset(ctx->stats, 0, sizeof(scil_compress_stats_t));
+  } else if (!enabled) {
+    free(ctx->stats);
+    ctx->stats = NULL;
+  }
+  return SCIL_NO_ERR;
+}
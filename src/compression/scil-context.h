@@ -4,6 +4,7 @@
 #include <scil-datatypes.h>
 #include <scil-user-hints.h>
 #include <scil-dims.h>
+#include <scil-mask.h>
 #include <scil-util.h>
 
 struct scil_context;
@@ -28,4 +29,60 @@ int scil_destroy_context(scil_context_t *out_ctx);
 
 scil_user_hints_t scil_get_effective_hints(const scil_context_t *ctx);
 
+/**
+ * \brief Use a mask of valid points for compression with this context
+ * \details Only the valid points are compressed, the others are restored as
+ *   fill value (or 0 if there is none). The mask must be registered in the
+ *   process decompressing the data, too.
+ * \param name Name of a mask registered with scil_mask_register(),
+ *   SCIL_MASK_AUTO to detect the mask from the fill value hint, NULL to disable
+ * \return SCIL_NO_ERR, or SCIL_EINVAL if no mask with this name exists
+ */
+int scil_context_set_mask(scil_context_t *ctx, const char *name);
+
+/**
+ * \brief Set the name of the variable compressed with this context
+ * \details The automatic choice of the compression chain is cached per variable
+ *   and reused by other contexts for the same variable as long as the
+ *   characteristics of the data are similar. The name is also used to look up
+ *   the chain in the file given by SCIL_VARIABLE_MAPPING_FILE.
+ *   Without a name, the environment variable H5REPACK_VARIABLE is used.
+ * \param name The name of the variable, NULL to unset it
+ * \return SCIL_NO_ERR
+ */
+int scil_context_set_variable_name(scil_context_t *ctx, const char *name);
+
+/**
+ * \brief Compress the data in independent blocks
+ * \details The data is split along the slowest dimension into blocks of at
+ *   least count values. Each block is compressed on its own, thus it can be
+ *   decompressed and validated with memory for one block only.
+ *   With a mask, the valid points are split into blocks of count values.
+ * \param count The minimum number of values per block, 0 to compress the data at once
+ * \return SCIL_NO_ERR
+ */
+int scil_context_set_block_size(scil_context_t *ctx, size_t count);
+
+/**
+ * \brief Verify the accuracy while compressing
+ * \details The quantizing algorithms abstol, sigbits, allquant and quantize
+ *   compare the values a decompression yields with the original values while
+ *   they compress. Chains without lossy algorithm are exact.
+ *   scil_compress() fails with SCIL_PRECISION_ERR if the hints are violated,
+ *   the achieved accuracy is returned by scil_get_verified_accuracy().
+ * \param enabled 1 to enable the verification, 0 to disable it
+ * \return SCIL_NO_ERR
+ */
+int scil_context_set_verification(scil_context_t *ctx, int enabled);
+
+/**
+ * \brief Measure the stages of each compression
+ * \details The time, data sizes and header sizes of each algorithm of the
+ *   chain are recorded, the measurements of the last call are returned by
+ *   scil_get_compress_stats(). The overhead is a few timer reads per stage.
+ * \param enabled 1 to enable the statistics, 0 to disable them
+ * \return SCIL_NO_ERR
+ */
+int scil_context_set_stats(scil_context_t *ctx, int enabled);
+
 #endif // SCIL_CONTEXT_H
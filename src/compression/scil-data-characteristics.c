@@ -3,6 +3,14 @@
 // this is an exception to the rule that there shall not be any dependency
 #include <compression/algo/lz4fast.h>
 
+#include <scil-util.h>
+
+#include <assert.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
 float scilU_get_data_randomness(const void* source, size_t in_size, byte* restrict buffer, size_t buffer_size)
 {
     // We may want to use https://en.wikipedia.org/wiki/Randomness_tests
@@ -14,3 +22,331 @@ float scilU_get_data_randomness(const void* source, size_t in_size, byte* restri
         critical("lz4fast error to determine randomness: %d\n", ret);
     }
 }
+
+// The sample consists of evenly spaced blocks of neighboring values along the fastest dimension
+#define FEATURE_SAMPLE_BLOCKS 64
+#define FEATURE_SAMPLE_BLOCK_SIZE 64
+
+typedef struct {
+  double min;
+  double max;
+  double sum;
+  double sum_sq;
+  double max_step;
+  double diff_sum[4];
+  size_t diff_count[4];
+  size_t sampled;
+  size_t valid;
+  size_t fill;
+  size_t zero;
+  size_t repeats;
+  size_t runs;
+  int exponent_min;
+  int exponent_max;
+  uint64_t histogram[256];
+  size_t bytes;
+} sample_stats_t;
+
+#define GATHER(type) { \
+    const type* d = (const type*) source + start; \
+    for (size_t i = 0; i < n; i++) block[i] = (double) d[i]; \
+  }
+
+static void gather_block(double* block, const void* source, SCIL_Datatype_t datatype, size_t start, size_t n){
+  switch(datatype){
+    case(SCIL_TYPE_FLOAT):
+      GATHER(float)
+      break;
+    case(SCIL_TYPE_DOUBLE):
+      GATHER(double)
+      break;
+    case(SCIL_TYPE_INT8):
+      GATHER(int8_t)
+      break;
+    case(SCIL_TYPE_INT16):
+      GATHER(int16_t)
+      break;
+    case(SCIL_TYPE_INT32):
+      GATHER(int32_t)
+      break;
+    case(SCIL_TYPE_INT64):
+      GATHER(int64_t)
+      break;
+    default:
+      GATHER(uint8_t)
+  }
+}
+
+static int is_fill(double v, double fill_value){
+  return ! (v < fill_value || v > fill_value);
+}
+
+// four partial histograms avoid that consecutive equal bytes stall on the same counter
+static void accumulate_bytes(sample_stats_t* s, const byte* data, size_t size){
+  uint32_t h[4][256];
+  memset(h, 0, sizeof(h));
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    h[0][data[i]]++;
+    h[1][data[i + 1]]++;
+    h[2][data[i + 2]]++;
+    h[3][data[i + 3]]++;
+  }
+  for (; i < size; i++) {
+    h[0][data[i]]++;
+  }
+  for (int b = 0; b < 256; b++) {
+    s->histogram[b] += h[0][b] + h[1][b] + h[2][b] + h[3][b];
+  }
+  s->bytes += size;
+}
+
+// returns v if cond is 1 and other if it is 0, the bit masks keep the loops free of branches
+static inline double mask_value(int64_t cond, double v, double other){
+  uint64_t a, b;
+  memcpy(& a, & v, sizeof(a));
+  memcpy(& b, & other, sizeof(b));
+  const uint64_t m = - (uint64_t) cond;
+  a = (a & m) | (b & ~m);
+  memcpy(& v, & a, sizeof(v));
+  return v;
+}
+
+// all statistics along the fastest dimension are updated in two branch-free passes over the block
+static void accumulate_block(sample_stats_t* s, const double* block, size_t n, double fill_value){
+  assert(n <= FEATURE_SAMPLE_BLOCK_SIZE);
+  // ok[i] is 1 if the value is neither a fill value nor NaN or infinite
+  int64_t ok[FEATURE_SAMPLE_BLOCK_SIZE];
+  double mn = s->min;
+  double mx = s->max;
+  double sum = 0;
+  double sum_sq = 0;
+  int64_t valid = 0;
+  int64_t fill = 0;
+  int64_t zero = 0;
+  int64_t e_min = s->exponent_min;
+  int64_t e_max = s->exponent_max;
+  for (size_t i = 0; i < n; i++) {
+    const double v = block[i];
+    uint64_t bits;
+    memcpy(& bits, & v, sizeof(bits));
+    // the exponent of frexp() is the biased exponent minus 1022,
+    // subnormal values count with the exponent of the smallest normal value
+    const int64_t field = (int64_t) ((bits >> 52) & 0x7ff);
+    const int64_t exponent = (field > 0 ? field : 1) - 1022;
+    const int64_t v_fill = ! (v < fill_value) & ! (v > fill_value);
+    const int64_t v_zero = (bits << 1) == 0;
+    const int64_t v_ok = (field != 0x7ff) & ! v_fill;
+    const int64_t v_exp = v_ok & ! v_zero;
+    ok[i] = v_ok;
+
+    fill += v_fill;
+    zero += v_zero;
+    valid += v_ok;
+    const double x = mask_value(v_ok, v, 0.0);
+    sum += x;
+    sum_sq += x * x;
+    const double x_min = mask_value(v_ok, v, mn);
+    const double x_max = mask_value(v_ok, v, mx);
+    mn = x_min < mn ? x_min : mn;
+    mx = x_max > mx ? x_max : mx;
+    e_min = v_exp & (exponent < e_min) ? exponent : e_min;
+    e_max = v_exp & (exponent > e_max) ? exponent : e_max;
+  }
+
+  // repeated bit patterns and the steps between neighbors that are both valid
+  double max_step = s->max_step;
+  double diff_sum = 0;
+  int64_t diff_count = 0;
+  int64_t repeats = 0;
+  for (size_t i = 1; i < n; i++) {
+    uint64_t a, b;
+    memcpy(& a, & block[i], sizeof(a));
+    memcpy(& b, & block[i - 1], sizeof(b));
+    repeats += a == b;
+    const int64_t pair = ok[i] & ok[i - 1];
+    const double step = mask_value(pair, fabs(block[i] - block[i - 1]), 0.0);
+    max_step = step > max_step ? step : max_step;
+    diff_sum += step;
+    diff_count += pair;
+  }
+
+  s->min = mn;
+  s->max = mx;
+  s->sum += sum;
+  s->sum_sq += sum_sq;
+  s->max_step = max_step;
+  s->diff_sum[0] += diff_sum;
+  s->diff_count[0] += (size_t) diff_count;
+  s->valid += (size_t) valid;
+  s->fill += (size_t) fill;
+  s->zero += (size_t) zero;
+  s->repeats += (size_t) repeats;
+  s->runs += n - (size_t) repeats;
+  s->sampled += n;
+  s->exponent_min = (int) e_min;
+  s->exponent_max = (int) e_max;
+}
+
+// differences to the predecessors along a slower dimension
+static void accumulate_neighbors(sample_stats_t* s, int d, const double* block, const double* neighbor, size_t n, double fill_value){
+  double diff_sum = 0;
+  size_t diff_count = 0;
+  for (size_t i = 0; i < n; i++) {
+    const double v = block[i];
+    const double w = neighbor[i];
+    if (is_fill(v, fill_value) || is_fill(w, fill_value) || ! isfinite(v) || ! isfinite(w)) {
+      continue;
+    }
+    diff_sum += fabs(v - w);
+    diff_count++;
+  }
+  s->diff_sum[d] += diff_sum;
+  s->diff_count[d] += diff_count;
+}
+
+typedef struct {
+  const void* source;
+  SCIL_Datatype_t datatype;
+  double fill_value;
+  int dims;
+  size_t length[4];
+  size_t pitch[4];
+} sample_domain_t;
+
+static void sample_block(sample_stats_t* s, const sample_domain_t* dom, size_t start, size_t n){
+  double block[FEATURE_SAMPLE_BLOCK_SIZE];
+  double neighbor[FEATURE_SAMPLE_BLOCK_SIZE];
+  const size_t value_size = DATATYPE_LENGTH(dom->datatype);
+
+  gather_block(block, dom->source, dom->datatype, start, n);
+  accumulate_block(s, block, n, dom->fill_value);
+  accumulate_bytes(s, (const byte*) dom->source + start * value_size, n * value_size);
+  for (int d = 1; d < dom->dims; d++) {
+    if ((start / dom->pitch[d]) % dom->length[d] == 0) {
+      continue;
+    }
+    gather_block(neighbor, dom->source, dom->datatype, start - dom->pitch[d], n);
+    accumulate_neighbors(s, d, block, neighbor, n, dom->fill_value);
+  }
+}
+
+// blocks are split at the end of a row, thus the neighbors of a block are in the same row
+static void sample_range(sample_stats_t* s, const sample_domain_t* dom, size_t start, size_t count){
+  const size_t row = dom->length[0];
+  const size_t end = start + count;
+  while (start < end) {
+    size_t n = row - start % row;
+    n = n < FEATURE_SAMPLE_BLOCK_SIZE ? n : FEATURE_SAMPLE_BLOCK_SIZE;
+    n = n < end - start ? n : end - start;
+    sample_block(s, dom, start, n);
+    start += n;
+  }
+}
+
+void scilU_get_data_characteristics(const void* source, SCIL_Datatype_t datatype, const scil_dims_t* dims, double fill_value, scilU_data_characteristics_t* out)
+{
+  const size_t count = scil_dims_get_count(dims);
+  sample_domain_t dom = {source, datatype, fill_value, 1, {count, 1, 1, 1}, {1, 1, 1, 1}};
+  if (dims->dims > 0) {
+    dom.dims = dims->dims < 4 ? dims->dims : 4;
+    for (int d = 0; d < dims->dims; d++) {
+      if (d < 4) {
+        dom.length[d] = dims->length[d];
+      } else {
+        dom.length[3] *= dims->length[d];
+      }
+    }
+  }
+  for (int d = 1; d < 4; d++) {
+    dom.pitch[d] = dom.pitch[d - 1] * dom.length[d - 1];
+  }
+
+  sample_stats_t s;
+  memset(& s, 0, sizeof(s));
+  s.min = DBL_MAX;
+  s.max = -DBL_MAX;
+  s.exponent_min = INT_MAX;
+  s.exponent_max = INT_MIN;
+
+  if (count <= FEATURE_SAMPLE_BLOCKS * FEATURE_SAMPLE_BLOCK_SIZE) {
+    sample_range(& s, & dom, 0, count);
+  } else {
+    const size_t stride = (count - FEATURE_SAMPLE_BLOCK_SIZE) / (FEATURE_SAMPLE_BLOCKS - 1);
+    for (size_t b = 0; b < FEATURE_SAMPLE_BLOCKS; b++) {
+      sample_range(& s, & dom, b * stride, FEATURE_SAMPLE_BLOCK_SIZE);
+    }
+  }
+
+  memset(out, 0, sizeof(scilU_data_characteristics_t));
+  out->sampled = s.sampled;
+  out->valid = s.valid;
+  if (s.valid > 0) {
+    const double mean = s.sum / s.valid;
+    const double variance = s.sum_sq / s.valid - mean * mean;
+    out->min = s.min;
+    out->max = s.max;
+    out->mean = mean;
+    out->stddev = variance > 0 ? sqrt(variance) : 0;
+    out->max_step = s.max_step;
+    const double range = s.max - s.min;
+    for (int d = 0; d < 4; d++) {
+      if (s.diff_count[d] > 0 && range > 0) {
+        out->smoothness[d] = s.diff_sum[d] / s.diff_count[d] / range;
+      }
+    }
+  }
+  if (s.exponent_min <= s.exponent_max) {
+    out->exponent_min = s.exponent_min;
+    out->exponent_max = s.exponent_max;
+  }
+  double entropy = 0;
+  for (int b = 0; b < 256; b++) {
+    if (s.histogram[b] > 0) {
+      const double p = (double) s.histogram[b] / s.bytes;
+      entropy -= p * log2(p);
+    }
+  }
+  out->entropy = entropy;
+  if (s.sampled > 0) {
+    out->zero_fraction = (double) s.zero / s.sampled;
+    out->fill_fraction = (double) s.fill / s.sampled;
+    out->repeat_fraction = (double) s.repeats / s.sampled;
+    out->mean_run_length = (double) s.sampled / s.runs;
+  }
+}
+
+void scilU_get_data_features(const void* source, SCIL_Datatype_t datatype, const scil_dims_t* dims, double fill_value, double* features)
+{
+  const size_t count = scil_dims_get_count(dims);
+
+  features[SCIL_FEATURE_DATATYPE_BITS] = DATATYPE_LENGTH(datatype) * 8.0;
+  features[SCIL_FEATURE_SIZE] = (double) scil_dims_get_size(dims, datatype);
+  features[SCIL_FEATURE_COUNT] = (double) count;
+  features[SCIL_FEATURE_DIMS] = dims->dims;
+  for (int d = 0; d < 4; d++) {
+    features[SCIL_FEATURE_DIM_0 + d] = 0;
+  }
+  for (int d = 0; d < dims->dims; d++) {
+    if (d < 4) {
+      features[SCIL_FEATURE_DIM_0 + d] = (double) dims->length[d];
+    } else {
+      features[SCIL_FEATURE_DIM_3] *= (double) dims->length[d];
+    }
+  }
+  features[SCIL_FEATURE_FILL_VALUE] = fill_value;
+
+  scilU_data_characteristics_t c;
+  scilU_get_data_characteristics(source, datatype, dims, fill_value, & c);
+  features[SCIL_FEATURE_MIN] = c.min;
+  features[SCIL_FEATURE_MAX] = c.max;
+  features[SCIL_FEATURE_MEAN] = c.mean;
+  features[SCIL_FEATURE_STDDEV] = c.stddev;
+  features[SCIL_FEATURE_MAX_STEP] = c.max_step;
+  features[SCIL_FEATURE_FILL_FRACTION] = c.fill_fraction;
+  features[SCIL_FEATURE_ENTROPY] = c.entropy;
+  features[SCIL_FEATURE_EXPONENT_SPREAD] = c.exponent_max - c.exponent_min;
+  features[SCIL_FEATURE_SMOOTHNESS] = c.smoothness[0];
+  features[SCIL_FEATURE_ZERO_FRACTION] = c.zero_fraction;
+  features[SCIL_FEATURE_REPEAT_FRACTION] = c.repeat_fraction;
+}
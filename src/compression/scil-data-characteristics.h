@@ -2,9 +2,70 @@
 #define SCIL_DATA_CHARACTERISTICS_H
 
 #include <scil-datatypes.h>
+#include <scil-dims.h>
 
 #include <stdlib.h>
 
 float scilU_get_data_randomness(const void* source, size_t in_size, byte* restrict buffer, size_t buffer_size);
 
+/*
+ * The features describing a variable, e.g., as input for the decision tree.
+ * The statistics are computed on a sample and exclude the fill value and non-finite values.
+ */
+enum scil_feature_e{
+  SCIL_FEATURE_DATATYPE_BITS = 0,
+  SCIL_FEATURE_SIZE,
+  SCIL_FEATURE_COUNT,
+  SCIL_FEATURE_DIMS,
+  SCIL_FEATURE_DIM_0, // additional dimensions are merged into the last one
+  SCIL_FEATURE_DIM_1,
+  SCIL_FEATURE_DIM_2,
+  SCIL_FEATURE_DIM_3,
+  SCIL_FEATURE_FILL_VALUE,
+  SCIL_FEATURE_MIN,
+  SCIL_FEATURE_MAX,
+  SCIL_FEATURE_MEAN,
+  SCIL_FEATURE_STDDEV,
+  SCIL_FEATURE_MAX_STEP, // maximum difference between neighboring values
+  SCIL_FEATURE_FILL_FRACTION,
+  SCIL_FEATURE_ENTROPY,
+  SCIL_FEATURE_EXPONENT_SPREAD,
+  SCIL_FEATURE_SMOOTHNESS, // along the fastest dimension
+  SCIL_FEATURE_ZERO_FRACTION,
+  SCIL_FEATURE_REPEAT_FRACTION,
+  SCIL_FEATURE_LAST
+};
+
+/*
+ * Cheap characteristics of the data determined on a strided sample.
+ * Additional dimensions are merged into the last one.
+ * The statistics exclude the fill value and non-finite values, the byte entropy,
+ * the fractions and the runs consider all values of the sample.
+ */
+typedef struct {
+  size_t sampled; // number of values in the sample
+  size_t valid;   // finite values that are not the fill value
+  double min;
+  double max;
+  double mean;
+  double stddev;
+  double max_step;        // maximum difference between neighboring values along the fastest dimension
+  double smoothness[4];   // mean absolute difference to the predecessor along each dimension, relative to the value range
+  double entropy;         // Shannon entropy of the bytes in bits per byte, between 0 and 8
+  int exponent_min;       // range of the binary exponents of the non-zero values
+  int exponent_max;
+  double zero_fraction;
+  double fill_fraction;
+  double repeat_fraction; // values that equal their predecessor along the fastest dimension
+  double mean_run_length; // mean length of the runs of equal values along the fastest dimension
+} scilU_data_characteristics_t;
+
+void scilU_get_data_characteristics(const void* source, SCIL_Datatype_t datatype, const scil_dims_t* dims, double fill_value, scilU_data_characteristics_t* out);
+
+/*
+ * Determines the features from the characteristics of the data.
+ * features must hold SCIL_FEATURE_LAST values.
+ */
+void scilU_get_data_features(const void* source, SCIL_Datatype_t datatype, const scil_dims_t* dims, double fill_value, double* features);
+
 #endif // SCIL_DATA_CHARACTERISTICS_H
@@ -2,19 +2,40 @@
 
 #include "scil-decision-tree.h"
 
-scilU_decision_tree* scilU_tree_create(int* left, int* right, double* thresholds, int* indices, int** classes, char** class_names, int amount_classes){
+scilU_decision_tree* scilU_tree_create(int node_count, const int* left, const int* right, const double* thresholds, const int* indices, int** classes, char** class_names, int amount_classes, int feature_count){
+  if(node_count <= 0 || amount_classes <= 0){
+    return NULL;
+  }
+  scilU_decision_tree_node* nodes = malloc(sizeof(scilU_decision_tree_node) * node_count);
+  for (int i = 0; i < node_count; i++) {
+    scilU_decision_tree_node* n = & nodes[i];
+    n->threshold = thresholds[i];
+    n->left = left[i];
+    n->right = right[i];
+    if (left[i] < 0 || right[i] < 0) {
+      n->feature = -1;
+      n->class_index = scilU_tree_findMax(classes[i], amount_classes);
+      continue;
+    }
+    // children follow their parent, so the traversal always terminates
+    if (left[i] <= i || right[i] <= i || left[i] >= node_count || right[i] >= node_count ||
+        indices[i] < 0 || indices[i] >= feature_count) {
+      free(nodes);
+      return NULL;
+    }
+    n->feature = indices[i];
+    n->class_index = -1;
+  }
+
   scilU_decision_tree* tree = malloc(sizeof(scilU_decision_tree));
-  tree->left_children = left;
-  tree->right_children = right;
-  tree->thresholds = thresholds;
-  tree->indices = indices;
-  tree->classes = classes;
+  tree->nodes = nodes;
+  tree->node_count = node_count;
   tree->class_names = class_names;
   tree->amount_classes = amount_classes;
   return tree;
 }
 
-int scilU_tree_findMax(int* classes, int amount_classes){
+int scilU_tree_findMax(const int* classes, int amount_classes){
   int index = 0;
   for (int i = 0; i < amount_classes; i++) {
     index = classes[i] > classes[index] ? i : index;
@@ -22,25 +43,20 @@ int scilU_tree_findMax(int* classes, int amount_classes){
   return index;
 }
 
-char* scilU_tree_predict(scilU_decision_tree* tree, int node, double*features){
-  if (tree->thresholds[node] != -2.0) {
-    if (features[tree->indices[node]] <= tree->thresholds[node]) {
-      return scilU_tree_predict(tree, tree->left_children[node], features);
-    } else {
-      return scilU_tree_predict(tree, tree->right_children[node], features);
-    }
+const char* scilU_tree_predict(const scilU_decision_tree* tree, const double* features){
+  const scilU_decision_tree_node* n = tree->nodes;
+  while (n->feature >= 0) {
+    n = & tree->nodes[features[n->feature] <= n->threshold ? n->left : n->right];
   }
-  return tree->class_names[scilU_tree_findMax(tree->classes[node], tree->amount_classes)];
+  return tree->class_names[n->class_index];
 }
 
 void scilU_tree_remove(scilU_decision_tree* tree){
-  free(tree->left_children);
-  free(tree->right_children);
-  free(tree->thresholds);
-  free(tree->classes);
+  for (int i = 0; i < tree->amount_classes; i++) {
+    free(tree->class_names[i]);
+  }
   free(tree->class_names);
+  free(tree->nodes);
 
   free(tree);
 }
-
-
@@ -1,19 +1,33 @@
 #ifndef SCIL_DECISION_TREE_H
 #define SCIL_DECISION_TREE_H
 
+/*
+ * The tree is stored as a flat array of nodes, the root is the first node.
+ * Inner nodes branch to the left if the feature is <= the threshold.
+ */
 typedef struct {
-  int* left_children;
-  int* right_children;
-  double* thresholds;
-  int* indices;
-  int** classes;
-  int amount_classes;
+  double threshold;
+  int feature; // -1 for a leaf
+  int left;
+  int right;
+  int class_index; // the class predicted by a leaf
+} scilU_decision_tree_node;
+
+typedef struct {
+  scilU_decision_tree_node* nodes;
+  int node_count;
   char** class_names;
+  int amount_classes;
 } scilU_decision_tree;
 
-scilU_decision_tree* scilU_tree_create(int* left, int* right, double* thresholds, int* indices, int** classes, char** class_names, int amount_classes);
+/*
+ * Creates the tree from the arrays of a trained tree as exported by scikit-learn.
+ * A leaf has negative children; classes contains the number of training samples per class for each node.
+ * The arrays are copied, only the class names are owned by the tree.
+ * Returns NULL if the tree is inconsistent.
+ */
+scilU_decision_tree* scilU_tree_create(int node_count, const int* left, const int* right, const double* thresholds, const int* indices, int** classes, char** class_names, int amount_classes, int feature_count);
 void scilU_tree_remove(scilU_decision_tree* tree);
-int scilU_tree_findMax(int* classes, int amount_classes);
-char* scilU_tree_predict(scilU_decision_tree* tree, int node, double* features);
+int scilU_tree_findMax(const int* classes, int amount_classes);
+const char* scilU_tree_predict(const scilU_decision_tree* tree, const double* features);
 #endif //SCIL_DECISION_TREE_H
-
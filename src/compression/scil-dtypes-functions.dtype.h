@@ -4,74 +4,139 @@
 #include <float.h>
 #include <string.h>
 
+/*
+ * Error metrics of a range of values.
+ * Ranges are processed independently and merged in the order of their indices.
+ */
+typedef struct{
+	scil_user_hints_t a;        // maximum errors and minimum significant bits
+	scil_validate_params_t v;   // positions of the maximum errors, value range and histogram
+	double sum_squared_error;
+	double sum_significant_bits;
+} scil_error_metrics_t;
+
+static inline int scil_error_histogram_bin(const double err, const double value){
+	if (! (err > 0)){
+		return SCIL_ERROR_HISTOGRAM_BINS - 1;
+	}
+	datatype_cast_double e;
+	e.f = err / fabs(value);
+	if (! (e.f < 1)){
+		return 0;
+	}
+	// the binary exponent of e is -k
+	const int k = 1023 - (int) e.p.exponent;
+	return k < SCIL_ERROR_HISTOGRAM_BINS - 2 ? k : SCIL_ERROR_HISTOGRAM_BINS - 2;
+}
+
+static inline void scil_error_metrics_add(scil_error_metrics_t * m, const size_t i, const double c2, const double err, const double rel, const double rel_finest, const int significant_bits){
+	if(err > m->a.absolute_tolerance){
+		m->a.absolute_tolerance = err;
+		m->v.absolute_tolerance_idx = i;
+	}
+	if(rel_finest > m->a.relative_err_finest_abs_tolerance){
+		m->a.relative_err_finest_abs_tolerance = rel_finest;
+		m->v.relative_err_finest_abs_tolerance_idx = i;
+	}
+	if(rel > m->a.relative_tolerance_percent){
+		m->a.relative_tolerance_percent = rel;
+		m->v.relative_tolerance_percent_idx = i;
+	}
+	m->a.significant_bits = significant_bits < m->a.significant_bits ? significant_bits : m->a.significant_bits;
+	m->v.value_min = c2 < m->v.value_min ? c2 : m->v.value_min;
+	m->v.value_max = c2 > m->v.value_max ? c2 : m->v.value_max;
+	m->sum_squared_error += err * err;
+	m->sum_significant_bits += significant_bits;
+}
+
 //Supported datatypes: float double
 // Repeat for each data type
 
 #pragma GCC diagnostic ignored "-Wfloat-equal"
-static void scil_determine_accuracy_<DATATYPE>(const <DATATYPE> *data_1, const <DATATYPE> *data_2, const size_t length, const double relative_err_finest_abs_tolerance, scil_user_hints_t * a, scil_validate_params_t *out_validation){
-	for(size_t i = 0; i < length; i++ ){
+static void scil_determine_accuracy_<DATATYPE>(const <DATATYPE> *data_1, const <DATATYPE> *data_2, const size_t start, const size_t end, const double relative_err_finest_abs_tolerance, scil_error_metrics_t * m){
+	for(size_t i = start; i < end; i++ ){
 		const <DATATYPE> c1 = data_1[i];
 		const <DATATYPE> c2 = data_2[i];
 		const double err = c2 > c1 ? c2 - c1 : c1 - c2;
-		scil_user_hints_t cur;
-		scil_user_hints_initialize(&cur);
-		cur.absolute_tolerance = err;    
 		// determine significant digits
-		
+		int significant_bits;
+
 		datatype_cast_<DATATYPE> f1, f2;
 		f1.f = c1;
 		f2.f = c2;
-		
+
 		if (f1.p.sign != f2.p.sign ){
-			cur.significant_bits = 0;
+			significant_bits = 0;
 		}else{
 			// check exponent
 			uint64_t diff = (uint64_t) f1.p.exponent - (uint64_t) f2.p.exponent;
 			if(diff > 1){
-				cur.significant_bits = 0;
-			}else{ 
+				significant_bits = 0;
+			}else{
 				if(diff == 1){
 				// wrap around
 				f1.p.mantissa -= 1;
 				}
 				uint64_t res = f1.p.mantissa > f2.p.mantissa ? f1.p.mantissa - f2.p.mantissa : f2.p.mantissa - f1.p.mantissa;
-				// check mantissa, bit by bit
-				cur.significant_bits = MANTISSA_LENGTH_<DATATYPE_UPPER>;
-				for(int m = MANTISSA_LENGTH_<DATATYPE_UPPER> - 1; m >= 0; m--){
-					if( ((res >> m) & 1) != 0){
-						cur.significant_bits = MANTISSA_LENGTH_<DATATYPE_UPPER> - (int) m;
-					}
-				}
+				// the lowest differing bit of the mantissa decides
+				significant_bits = res == 0 ? MANTISSA_LENGTH_<DATATYPE_UPPER> : MANTISSA_LENGTH_<DATATYPE_UPPER> - __builtin_ctzll(res);
 			}
 		}
 		// determine relative tolerance
-		cur.relative_tolerance_percent = 0;
-		cur.relative_err_finest_abs_tolerance = 0;
+		double rel = 0;
+		double rel_finest = 0;
 		if (err >= relative_err_finest_abs_tolerance){
-			if (c1 == 0 && c2 != 0){
-				cur.relative_tolerance_percent = INFINITY;
+			if ((double) c1 == 0.0 && (double) c2 != 0.0){
+				rel = (double) INFINITY;
 			}else{
 				// sign check not needed
-				cur.relative_tolerance_percent = fabs(1 - c2 / c1);
+				rel = fabs(1.0 - (double) c2 / (double) c1);
 			}
 		}else{
-			cur.relative_err_finest_abs_tolerance = err;
-		}
-                
-		if(cur.absolute_tolerance > a->absolute_tolerance){
-			out_validation->absolute_tolerance_idx = i;
+			rel_finest = err;
 		}
-		if(cur.relative_err_finest_abs_tolerance > a->relative_err_finest_abs_tolerance){
-			out_validation->relative_err_finest_abs_tolerance_idx = i;
+		scil_error_metrics_add(m, i, (double) c2, err, rel, rel_finest, significant_bits);
+		m->v.error_histogram[scil_error_histogram_bin(err, (double) c1)]++;
+	}
+}
+
+/*
+ * Determines only the maximum errors and the minimum significant bits, the encoders verify their values with it.
+ */
+static void scil_determine_max_error_<DATATYPE>(const <DATATYPE> *data_1, const <DATATYPE> *data_2, const size_t count, const double relative_err_finest_abs_tolerance, scil_user_hints_t * a){
+	double max_err = a->absolute_tolerance;
+	double max_rel = a->relative_tolerance_percent;
+	double max_rel_finest = a->relative_err_finest_abs_tolerance;
+	int min_bits = a->significant_bits;
+	for(size_t i = 0; i < count; i++ ){
+		const <DATATYPE> c1 = data_1[i];
+		const <DATATYPE> c2 = data_2[i];
+		const double err = c2 > c1 ? c2 - c1 : c1 - c2;
+		max_err = err > max_err ? err : max_err;
+		if (err >= relative_err_finest_abs_tolerance){
+			const double rel = (double) c1 == 0.0 && (double) c2 != 0.0 ? (double) INFINITY : fabs(1.0 - (double) c2 / (double) c1);
+			max_rel = rel > max_rel ? rel : max_rel;
+		}else{
+			max_rel_finest = err > max_rel_finest ? err : max_rel_finest;
 		}
-		if(cur.relative_tolerance_percent > a->relative_tolerance_percent){
-			out_validation->relative_tolerance_percent_idx = i;
+
+		datatype_cast_<DATATYPE> f1, f2;
+		f1.f = c1;
+		f2.f = c2;
+		int significant_bits = 0;
+		uint64_t diff = (uint64_t) f1.p.exponent - (uint64_t) f2.p.exponent;
+		if (f1.p.sign == f2.p.sign && diff <= 1){
+			if(diff == 1){
+				f1.p.mantissa -= 1;
+			}
+			uint64_t res = f1.p.mantissa > f2.p.mantissa ? f1.p.mantissa - f2.p.mantissa : f2.p.mantissa - f1.p.mantissa;
+			significant_bits = res == 0 ? MANTISSA_LENGTH_<DATATYPE_UPPER> : MANTISSA_LENGTH_<DATATYPE_UPPER> - __builtin_ctzll(res);
 		}
-		
-		a->absolute_tolerance = max(cur.absolute_tolerance, a->absolute_tolerance);
-		a->relative_err_finest_abs_tolerance = max(cur.relative_err_finest_abs_tolerance, a->relative_err_finest_abs_tolerance);
-		a->relative_tolerance_percent = max(cur.relative_tolerance_percent, a->relative_tolerance_percent);
-		a->significant_bits = min(cur.significant_bits, a->significant_bits);
+		min_bits = significant_bits < min_bits ? significant_bits : min_bits;
 	}
+	a->absolute_tolerance = max_err;
+	a->relative_tolerance_percent = max_rel;
+	a->relative_err_finest_abs_tolerance = max_rel_finest;
+	a->significant_bits = min_bits;
 }
 // End repeat
@@ -0,0 +1,84 @@
+#ifndef SCIL_MASK_IMPL_H
+#define SCIL_MASK_IMPL_H
+
+#include <scil-mask.h>
+
+#include <stdint.h>
+
+/*
+ * A mask is stored as alternating run lengths of valid and invalid points,
+ * starting with a (potentially empty) run of valid points.
+ */
+typedef struct scilC_mask{
+  char * name; // NULL for automatically detected masks
+  scil_dims_t dims; // as registered, detected masks have one dimension
+  size_t count;
+  size_t valid_count;
+  size_t run_count;
+  size_t * runs;
+  uint64_t fingerprint;
+  int cached; // cached masks are owned by the registry, others by the caller
+  struct scilC_mask * next;
+} scilC_mask_t;
+
+/*
+ * The masked format starts with this marker instead of the chain length.
+ */
+#define SCIL_MASK_MARKER 255
+
+scilC_mask_t * scilC_mask_get_by_name(const char * name);
+
+/*
+ * Find the registered mask with the fingerprint and the dimensions.
+ * Returns NULL if no mask matches both.
+ */
+scilC_mask_t * scilC_mask_get_by_fingerprint(uint64_t fingerprint, const scil_dims_t * dims);
+
+/*
+ * Check that the mask has the given dimensions.
+ */
+int scilC_mask_has_dims(const scilC_mask_t * mask, const scil_dims_t * dims);
+
+/*
+ * Detect the mask of all points with the given value.
+ * NULL is returned if all points are valid.
+ * If the cache is full the returned mask is not cached and must be destroyed.
+ */
+scilC_mask_t * scilC_mask_detect(const void * data, size_t count, SCIL_Datatype_t datatype, double fill_value);
+
+/*
+ * Check that a mask detected before still fits the data: all invalid points
+ * hold the fill value and the valid runs start and end with other values.
+ * Fill values inside valid runs are not searched, they are compressed as data.
+ */
+int scilC_mask_matches(const scilC_mask_t * mask, const void * data, size_t count, SCIL_Datatype_t datatype, double fill_value);
+
+/*
+ * Convert the fill value to the bit pattern of the datatype.
+ */
+int scilC_mask_fill_pattern(SCIL_Datatype_t datatype, double fill_value, byte * out);
+
+/*
+ * Copy the valid points of data to dense, the mask is repeated if the data is larger.
+ */
+void scilC_mask_gather(const scilC_mask_t * mask, byte * dense, const byte * data, size_t count, size_t value_size);
+
+/*
+ * Copy the dense points to the valid points and set the other points to the fill value.
+ */
+void scilC_mask_scatter(const scilC_mask_t * mask, byte * data, const byte * dense, size_t count, size_t value_size, const byte * fill_value);
+
+/*
+ * Serialize the runs into buffer, returns the number of bytes written.
+ */
+size_t scilC_mask_write_runs(const scilC_mask_t * mask, byte * buffer);
+
+/*
+ * Create a mask (which is not cached) from serialized runs.
+ * Returns NULL if the buffer is invalid.
+ */
+scilC_mask_t * scilC_mask_read_runs(const byte * buffer, size_t size, const scil_dims_t * dims);
+
+void scilC_mask_destroy(scilC_mask_t * mask);
+
+#endif // SCIL_MASK_IMPL_H
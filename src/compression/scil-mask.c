@@ -0,0 +1,348 @@
+#include <scil-mask-impl.h>
+
+#include <scil-error.h>
+#include <scil-util.h>
+#include <scil-debug.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <string.h>
+
+// Upper bound for automatically detected masks kept in the cache
+#define MASK_AUTO_CACHE_MAX 64
+
+static pthread_mutex_t masks_lock = PTHREAD_MUTEX_INITIALIZER;
+static scilC_mask_t * masks = NULL;
+static int auto_masks_count = 0;
+
+// Initial capacity of the runs array, it grows geometrically
+#define MASK_RUNS_INITIAL 64
+
+static size_t * push_run(size_t * runs, size_t * run_count, size_t * capacity, size_t length){
+  if(*run_count == *capacity){
+    *capacity *= 2;
+    runs = (size_t*) realloc(runs, *capacity * sizeof(size_t));
+    assert(runs != NULL);
+  }
+  runs[(*run_count)++] = length;
+  return runs;
+}
+
+static uint64_t fingerprint_runs(const size_t * runs, size_t run_count, size_t count){
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  const byte * data = (const byte*) runs;
+  for(size_t i = 0; i < run_count * sizeof(size_t); i++){
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash ^ count;
+}
+
+static int mask_equal(const scilC_mask_t * m, const size_t * runs, size_t run_count, size_t count){
+  return m->count == count && m->run_count == run_count && memcmp(m->runs, runs, run_count * sizeof(size_t)) == 0;
+}
+
+static scilC_mask_t * mask_create(const char * name, size_t * runs, size_t run_count, const scil_dims_t * dims){
+  const size_t count = scil_dims_get_count(dims);
+  scilC_mask_t * m = (scilC_mask_t*) scilU_safe_malloc(sizeof(scilC_mask_t));
+  m->name = name ? strdup(name) : NULL;
+  scil_dims_copy(& m->dims, dims);
+  m->count = count;
+  m->runs = runs;
+  m->run_count = run_count;
+  m->valid_count = 0;
+  for(size_t i = 0; i < run_count; i += 2){
+    m->valid_count += runs[i];
+  }
+  m->fingerprint = fingerprint_runs(runs, run_count, count);
+  m->cached = 0;
+  m->next = NULL;
+  return m;
+}
+
+void scilC_mask_destroy(scilC_mask_t * mask){
+  free(mask->name);
+  free(mask->runs);
+  free(mask);
+}
+
+int scil_mask_register(const char * name, const scil_dims_t * dims, const byte * valid){
+  assert(name != NULL);
+  assert(dims != NULL);
+  assert(valid != NULL);
+
+  const size_t count = scil_dims_get_count(dims);
+  if(count == 0){
+    return SCIL_EINVAL;
+  }
+  size_t capacity = MASK_RUNS_INITIAL;
+  size_t * runs = (size_t*) scilU_safe_malloc(capacity * sizeof(size_t));
+  size_t run_count = 0;
+  size_t i = 0;
+  while(i < count){
+    // alternate between valid (even runs) and invalid points
+    const int want_valid = (run_count % 2) == 0;
+    size_t start = i;
+    while(i < count && (valid[i] != 0) == want_valid) i++;
+    runs = push_run(runs, & run_count, & capacity, i - start);
+  }
+
+  int ret = SCIL_NO_ERR;
+  pthread_mutex_lock(& masks_lock);
+  for(scilC_mask_t * m = masks; m != NULL; m = m->next){
+    if(m->name != NULL && strcmp(m->name, name) == 0){
+      ret = mask_equal(m, runs, run_count, count) ? SCIL_NO_ERR : SCIL_EINVAL;
+      free(runs);
+      pthread_mutex_unlock(& masks_lock);
+      return ret;
+    }
+  }
+  scilC_mask_t * m = mask_create(name, runs, run_count, dims);
+  m->cached = 1;
+  m->next = masks;
+  masks = m;
+  pthread_mutex_unlock(& masks_lock);
+
+  debug("Registered mask %s with %zu of %zu valid points\n", name, m->valid_count, count);
+  return ret;
+}
+
+scilC_mask_t * scilC_mask_get_by_name(const char * name){
+  scilC_mask_t * found = NULL;
+  pthread_mutex_lock(& masks_lock);
+  for(scilC_mask_t * m = masks; m != NULL; m = m->next){
+    if(m->name != NULL && strcmp(m->name, name) == 0){
+      found = m;
+      break;
+    }
+  }
+  pthread_mutex_unlock(& masks_lock);
+  return found;
+}
+
+int scilC_mask_has_dims(const scilC_mask_t * mask, const scil_dims_t * dims){
+  if(mask->dims.dims != dims->dims){
+    return 0;
+  }
+  for(int d = 0; d < dims->dims; d++){
+    if(mask->dims.length[d] != dims->length[d]) return 0;
+  }
+  return 1;
+}
+
+scilC_mask_t * scilC_mask_get_by_fingerprint(uint64_t fingerprint, const scil_dims_t * dims){
+  scilC_mask_t * found = NULL;
+  pthread_mutex_lock(& masks_lock);
+  for(scilC_mask_t * m = masks; m != NULL; m = m->next){
+    // detected masks are stored inline, only registered ones are referenced
+    if(m->name != NULL && m->fingerprint == fingerprint && scilC_mask_has_dims(m, dims)){
+      found = m;
+      break;
+    }
+  }
+  pthread_mutex_unlock(& masks_lock);
+  return found;
+}
+
+#define DETECT_RUNS(type) { \
+    const type * d = (const type *) data; \
+    const type pattern = *(const type *) fill; \
+    while(i < count){ \
+      size_t start = i; \
+      if(run_count % 2 == 0){ \
+        while(i < count && d[i] != pattern) i++; \
+      }else{ \
+        while(i < count && d[i] == pattern) i++; \
+      } \
+      runs = push_run(runs, & run_count, & capacity, i - start); \
+    } \
+  }
+
+int scilC_mask_fill_pattern(SCIL_Datatype_t datatype, double fill_value, byte * out){
+  switch(datatype){
+    case(SCIL_TYPE_FLOAT):{
+      float v = (float) fill_value;
+      memcpy(out, & v, 4);
+      return SCIL_NO_ERR;
+    }case(SCIL_TYPE_DOUBLE):
+      memcpy(out, & fill_value, 8);
+      return SCIL_NO_ERR;
+    case(SCIL_TYPE_INT8):{
+      int8_t v = (int8_t) fill_value;
+      memcpy(out, & v, 1);
+      return SCIL_NO_ERR;
+    }case(SCIL_TYPE_INT16):{
+      int16_t v = (int16_t) fill_value;
+      memcpy(out, & v, 2);
+      return SCIL_NO_ERR;
+    }case(SCIL_TYPE_INT32):{
+      int32_t v = (int32_t) fill_value;
+      memcpy(out, & v, 4);
+      return SCIL_NO_ERR;
+    }case(SCIL_TYPE_INT64):{
+      int64_t v = (int64_t) fill_value;
+      memcpy(out, & v, 8);
+      return SCIL_NO_ERR;
+    }default:
+      return SCIL_EINVAL;
+  }
+}
+
+scilC_mask_t * scilC_mask_detect(const void * data, size_t count, SCIL_Datatype_t datatype, double fill_value){
+  // compare the bit patterns, that also catches NaN as fill value
+  byte fill[8];
+  if(scilC_mask_fill_pattern(datatype, fill_value, fill) != SCIL_NO_ERR){
+    return NULL;
+  }
+
+  size_t capacity = MASK_RUNS_INITIAL;
+  size_t * runs = (size_t*) scilU_safe_malloc(capacity * sizeof(size_t));
+  size_t run_count = 0;
+  size_t i = 0;
+  switch(DATATYPE_LENGTH(datatype)){
+    case 1:
+      DETECT_RUNS(uint8_t)
+      break;
+    case 2:
+      DETECT_RUNS(uint16_t)
+      break;
+    case 4:
+      DETECT_RUNS(uint32_t)
+      break;
+    default:
+      DETECT_RUNS(uint64_t)
+  }
+  if(run_count <= 1){
+    free(runs);
+    return NULL;
+  }
+
+  const uint64_t fingerprint = fingerprint_runs(runs, run_count, count);
+  scilC_mask_t * found = NULL;
+  pthread_mutex_lock(& masks_lock);
+  for(scilC_mask_t * m = masks; m != NULL; m = m->next){
+    if(m->fingerprint == fingerprint && mask_equal(m, runs, run_count, count)){
+      found = m;
+      break;
+    }
+  }
+  if(found != NULL){
+    free(runs);
+  }else{
+    scil_dims_t dims;
+    scil_dims_initialize_1d(& dims, count);
+    found = mask_create(NULL, (size_t*) realloc(runs, run_count * sizeof(size_t)), run_count, & dims);
+    if(auto_masks_count < MASK_AUTO_CACHE_MAX){
+      found->cached = 1;
+      found->next = masks;
+      masks = found;
+      auto_masks_count++;
+    }
+  }
+  pthread_mutex_unlock(& masks_lock);
+  return found;
+}
+
+#define MATCH_RUNS(type) { \
+    const type * d = (const type *) data; \
+    const type pattern = *(const type *) fill; \
+    size_t i = 0; \
+    for(size_t r = 0; r < mask->run_count; r++){ \
+      const size_t end = i + mask->runs[r]; \
+      if(r % 2 == 0){ \
+        if(end > i && (d[i] == pattern || d[end - 1] == pattern)) return 0; \
+      }else{ \
+        type diff = 0; \
+        for( ; i < end; i++) diff |= d[i] ^ pattern; \
+        if(diff) return 0; \
+      } \
+      i = end; \
+    } \
+  }
+
+int scilC_mask_matches(const scilC_mask_t * mask, const void * data, size_t count, SCIL_Datatype_t datatype, double fill_value){
+  byte fill[8];
+  if(mask->count != count || scilC_mask_fill_pattern(datatype, fill_value, fill) != SCIL_NO_ERR){
+    return 0;
+  }
+  switch(DATATYPE_LENGTH(datatype)){
+    case 1:
+      MATCH_RUNS(uint8_t)
+      break;
+    case 2:
+      MATCH_RUNS(uint16_t)
+      break;
+    case 4:
+      MATCH_RUNS(uint32_t)
+      break;
+    default:
+      MATCH_RUNS(uint64_t)
+  }
+  return 1;
+}
+
+void scilC_mask_gather(const scilC_mask_t * mask, byte * dense, const byte * data, size_t count, size_t value_size){
+  for(size_t offset = 0; offset < count; offset += mask->count){
+    const byte * pos = data + offset * value_size;
+    for(size_t r = 0; r < mask->run_count; r++){
+      const size_t bytes = mask->runs[r] * value_size;
+      if(r % 2 == 0){
+        memcpy(dense, pos, bytes);
+        dense += bytes;
+      }
+      pos += bytes;
+    }
+  }
+}
+
+void scilC_mask_scatter(const scilC_mask_t * mask, byte * data, const byte * dense, size_t count, size_t value_size, const byte * fill_value){
+  for(size_t offset = 0; offset < count; offset += mask->count){
+    byte * pos = data + offset * value_size;
+    for(size_t r = 0; r < mask->run_count; r++){
+      const size_t bytes = mask->runs[r] * value_size;
+      if(r % 2 == 0){
+        memcpy(pos, dense, bytes);
+        dense += bytes;
+      }else{
+        for(size_t b = 0; b < bytes; b += value_size){
+          memcpy(pos + b, fill_value, value_size);
+        }
+      }
+      pos += bytes;
+    }
+  }
+}
+
+size_t scilC_mask_write_runs(const scilC_mask_t * mask, byte * buffer){
+  byte * pos = buffer;
+  for(size_t r = 0; r < mask->run_count; r++){
+    pos = scilU_write_varint(pos, mask->runs[r]);
+  }
+  return pos - buffer;
+}
+
+scilC_mask_t * scilC_mask_read_runs(const byte * buffer, size_t size, const scil_dims_t * dims){
+  const size_t count = scil_dims_get_count(dims);
+  if(count == 0){
+    return NULL;
+  }
+  size_t * runs = (size_t*) scilU_safe_malloc((size + 1) * sizeof(size_t));
+  size_t run_count = 0;
+  size_t total = 0;
+  const byte * end = buffer + size;
+  while(buffer < end){
+    uint64_t value;
+    buffer = scilU_read_varint(buffer, end, & value);
+    if(buffer == NULL){
+      free(runs);
+      return NULL;
+    }
+    runs[run_count++] = value;
+    total += value;
+  }
+  if(total != count){
+    free(runs);
+    return NULL;
+  }
+  return mask_create(NULL, runs, run_count, dims);
+}
@@ -0,0 +1,30 @@
+#ifndef SCIL_MASK_H
+#define SCIL_MASK_H
+
+#include <scil-datatypes.h>
+#include <scil-dims.h>
+
+/*
+ * Masks describe points that do not carry data, e.g., the land points of an
+ * ocean variable. If a context uses a mask, only the valid points are
+ * compressed and the compressed data references the mask.
+ */
+
+/**
+ * \brief Name that makes a context detect the mask from the fill value hint
+ * \details The detected mask is fingerprinted and cached, the compressed data
+ *   contains the mask itself.
+ */
+#define SCIL_MASK_AUTO "auto"
+
+/**
+ * \brief Register a named mask for the whole process
+ * \param name Name of the mask, used by scil_context_set_mask()
+ * \param dims Dimensions of the mask, data may contain multiple repetitions
+ *   of the mask, e.g., several time steps
+ * \param valid One byte per point, 0 marks a point which is dropped
+ * \return SCIL_NO_ERR, or SCIL_EINVAL if a different mask with this name exists
+ */
+int scil_mask_register(const char * name, const scil_dims_t * dims, const byte * valid);
+
+#endif // SCIL_MASK_H
@@ -0,0 +1,32 @@
+#ifndef SCIL_VERIFY_H
+#define SCIL_VERIFY_H
+
+#include <scil-context.h>
+
+/*
+ * Verification of the accuracy while compressing.
+ * Encoders that know the values a decompression yields report them together
+ * with the original values, in chunks of at most SCIL_VERIFY_CHUNK values.
+ * The errors are accumulated in the context, the functions are thread-safe.
+ */
+
+// Number of values an encoder reconstructs at once
+#define SCIL_VERIFY_CHUNK 1024
+
+typedef struct scilC_verification scilC_verification_t;
+
+scilC_verification_t *scilC_verification_create();
+
+void scilC_verification_destroy(scilC_verification_t *v);
+
+/*
+ * Returns 1 if the encoder shall report its values to scilC_verify().
+ */
+int scilC_verify_enabled(const scil_context_t *ctx);
+
+/*
+ * Accumulates the errors of count reconstructed values of the datatype of the context.
+ */
+void scilC_verify(const scil_context_t *ctx, const void *original, const void *reconstructed, size_t count);
+
+#endif // SCIL_VERIFY_H
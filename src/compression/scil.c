@@ -12,24 +12,42 @@
 //
 // You should have received a copy of the GNU Lesser General Public License
 // along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+#include <scil.h>
 #include <scil-algo-chooser.h>
 #include <scil-error.h>
 #include <scil-hardware-limits.h>
 #include <scil-debug.h>
+#include <scil-thread-pool.h>
+#include <scil-counters.h>
 #include <scil-context-impl.h>
 
 #include <scil-compressor.h>
 #include <scil-compression-chain.h>
+#include <algo/precond-specials.h>
 
 #include <ctype.h>
 #include <float.h>
 #include <math.h>
+#include <pthread.h>
 #include <string.h>
 
 // this file is automatically created
 #include <scil-dtypes-functions.h>
 #include <scil-dtypes-functions-int.h>
 
+// The block format starts with this marker instead of the chain length
+#define SCIL_BLOCK_MARKER 254
+
+// Part of dest a chain uses for its output if the intermediate results are kept in a separate buffer
+#define CHAIN_BUFFER_OFFSET(size) (2 * (size) + 11)
+
+static void verification_reset(scil_context_t* ctx);
+static size_t verification_begin_chain(scil_context_t* ctx);
+static void verification_end_chain(scil_context_t* ctx, size_t verified_before, size_t count);
+static void verification_merge(scil_context_t* ctx, const scil_context_t* task);
+static int verification_check(scil_context_t* ctx, const void* source, scil_dims_t* dims, byte* compressed, size_t compressed_size);
+static void verification_publish(scil_context_t* ctx, const scil_context_t* call, int ret);
+
 #define CHECK_COMPRESSOR_ID(compressor_id)               \
     if (compressor_id >= scilU_get_available_compressor_count()) { \
         return SCIL_BUFFER_ERR;                          \
@@ -38,7 +56,10 @@
 void scil_compression_sprint_last_algorithm_chain(scil_context_t* ctx, char* out, int buff_length)
 {
     int ret                      = 0;
-    scil_compression_chain_t* lc = &ctx->chain;
+    pthread_mutex_lock(ctx->lock);
+    const scil_compression_chain_t chain = ctx->chain;
+    pthread_mutex_unlock(ctx->lock);
+    const scil_compression_chain_t* lc = &chain;
     for (int i = 0; i < PRECONDITIONER_LIMIT; i++) {
         if (lc->pre_cond_first[i] == NULL) break;
         ret = snprintf(out, buff_length, "%s,", lc->pre_cond_first[i]->name);
@@ -91,6 +112,122 @@ static inline void* pick_buffer(int is_src,
     }
 }
 
+static void stats_reset(scil_compress_stats_t* stats) {
+    memset(stats, 0, sizeof(scil_compress_stats_t));
+}
+
+// set while the library calls itself, e.g., for the trials of the chooser, those calls are not counted
+static __thread int internal_call;
+
+static inline int monitoring_enabled() {
+    return ! internal_call && (scilU_counters_enabled() || scilU_trace_enabled());
+}
+
+/*
+ * Stages are timed for the statistics of the call and the process-wide counters and trace.
+ * An untimed stage has a zero timer.
+ */
+static inline void stats_start(const scil_compress_stats_t* stats, scil_timer* timer) {
+    if (stats != NULL || monitoring_enabled()) {
+        scilU_start_timer(timer);
+    } else {
+        timer->tv_sec = 0;
+        timer->tv_nsec = 0;
+    }
+}
+
+static inline int stats_timed(scil_timer timer) {
+    return timer.tv_sec != 0 || timer.tv_nsec != 0;
+}
+
+// counts the call or stage with the name prefix:name
+static void count_event(const char* prefix, const char* name, scil_timer timer, double seconds, size_t input_bytes, size_t output_bytes, int error) {
+    if (! stats_timed(timer) || ! monitoring_enabled()) {
+        return;
+    }
+    char counter[SCILU_COUNTER_NAME_LENGTH];
+    snprintf(counter, sizeof(counter), "%s:%s", prefix, name);
+    if (scilU_counters_enabled()) {
+        scilU_counter_add(counter, input_bytes, output_bytes, seconds, error);
+    }
+    scilU_trace_event(counter, timer, seconds);
+}
+
+// returns the entry of the algorithm, NULL if there is no space left
+static scil_stage_stats_t* stats_get_stage(scil_compress_stats_t* stats, const char* name, int compressor_id) {
+    for (int i = 0; i < stats->stage_count; i++) {
+        if (stats->stages[i].compressor_id == compressor_id) {
+            return &stats->stages[i];
+        }
+    }
+    if (stats->stage_count == SCIL_STATS_MAX_STAGES) {
+        return NULL;
+    }
+    scil_stage_stats_t* stage = &stats->stages[stats->stage_count];
+    stats->stage_count++;
+    stage->name = name;
+    stage->compressor_id = compressor_id;
+    return stage;
+}
+
+/*
+ * Adds the measurements of a stage to the entry of its algorithm.
+ * The output of all but the last stage is an intermediate result.
+ */
+static void stats_add_stage(scil_compress_stats_t* stats,
+                            const char* direction,
+                            const scilU_algorithm_t* algo,
+                            scil_timer timer,
+                            size_t input_bytes,
+                            size_t output_bytes,
+                            size_t header_bytes,
+                            int last) {
+    if (! stats_timed(timer)) {
+        return;
+    }
+    const double seconds = scilU_stop_timer(timer);
+    count_event(direction, algo->name, timer, seconds, input_bytes, output_bytes, 0);
+    if (stats == NULL) {
+        return;
+    }
+    scil_stage_stats_t* stage = stats_get_stage(stats, algo->name, algo->compressor_id);
+    if (stage == NULL) {
+        return;
+    }
+    stage->runs++;
+    stage->seconds += seconds;
+    stage->input_bytes += input_bytes;
+    stage->output_bytes += output_bytes;
+    stage->header_bytes += header_bytes;
+    if (!last) {
+        stats->scratch_bytes += output_bytes;
+    }
+}
+
+static inline void stats_add_scratch(scil_compress_stats_t* stats, size_t bytes) {
+    if (stats != NULL) {
+        stats->scratch_bytes += bytes;
+    }
+}
+
+// adds the stages of blocks processed by another task
+static void stats_merge(scil_compress_stats_t* stats, const scil_compress_stats_t* o) {
+    for (int i = 0; i < o->stage_count; i++) {
+        const scil_stage_stats_t* s = &o->stages[i];
+        scil_stage_stats_t* stage = stats_get_stage(stats, s->name, s->compressor_id);
+        if (stage == NULL) {
+            continue;
+        }
+        stage->runs += s->runs;
+        stage->seconds += s->seconds;
+        stage->input_bytes += s->input_bytes;
+        stage->output_bytes += s->output_bytes;
+        stage->header_bytes += s->header_bytes;
+    }
+    stats->chooser_seconds += o->chooser_seconds;
+    stats->scratch_bytes += o->scratch_bytes;
+}
+
 /*
 A compression chain compresses data in multiple phases, i.e., applying algo 1,
 then algo 2 ...
@@ -123,9 +260,36 @@ Therefore, the compressor ID and headers of nested datatypes must be split from
 the data.
 
 A datatype compressor terminates the chain of preconditioners.
+
+If the context uses a mask, the buffer starts with SCIL_MASK_MARKER instead:
+
+byte SCIL_MASK_MARKER
+byte MASK_INLINE // 1 if the runs of the mask follow, 0 for a registered mask
+uint64 MASK_FINGERPRINT
+uint64 MASK_COUNT // number of points of the mask, it repeats for larger data
+uint64 MASK_VALID_COUNT // number of valid points of the mask
+byte MASK_DIMS
+uint64 * MASK_DIMS // the dimensions of the mask
+double FILL_VALUE // value for points outside of the mask
+[uint64 RUNS_SIZE, byte * RUNS] // only if MASK_INLINE
+the compressed valid points, formated as above or in blocks as below
+
+If the context uses blocks, the buffer starts with SCIL_BLOCK_MARKER:
+
+byte SCIL_BLOCK_MARKER
+uint64 BLOCK_COUNT
+uint64 SLICES // number of indices of the slowest dimension per block
+uint64 * BLOCK_COUNT // the compressed size of each block
+the blocks, each formated as above
  */
-int scil_compress(byte* restrict dest,
+
+/*
+ * Without a buffer, the intermediate results of the stages are kept in dest behind the first 2 * size bytes.
+ * A buffer must hold 2 * size + SCIL_BLOCK_HEADER_MAX_SIZE bytes, dest then needs only CHAIN_BUFFER_OFFSET(size) bytes.
+ */
+static int compress_chain_buffered(byte* restrict dest,
                   size_t in_dest_size,
+                  byte* restrict buffer,
                   void* restrict source,
                   scil_dims_t* dims,
                   size_t* restrict out_size_p,
@@ -137,7 +301,8 @@ int scil_compress(byte* restrict dest,
 	assert(source != NULL);
 
 	int ret = SCIL_NO_ERR;
-  scil_dims_t* resized_dims = malloc(sizeof(scil_dims_t));
+  scil_dims_t resized;
+  scil_dims_t* resized_dims = &resized;
   memset(resized_dims, 0, sizeof(scil_dims_t));
 
   if(dims->dims > 4){
@@ -169,42 +334,39 @@ int scil_compress(byte* restrict dest,
     }
 
 	// Why? Factor 4 seems arbitrary
-    if (in_dest_size < 4 * datatypes_size) {
+    if (in_dest_size < (buffer != NULL ? CHAIN_BUFFER_OFFSET(datatypes_size) : 4 * datatypes_size)) {
         return SCIL_MEMORY_ERR;
     }
 
-    // Check for variable - compressor mapping
-    if(variable_dict != NULL) {
-        char* h5name = getenv("H5REPACK_VARIABLE");
-        if(strlen(h5name)>0) {
-            scilU_dict_element_t *element = scilU_dict_get(variable_dict, h5name);
-            if (element != NULL) {
-                // TODO: Check existence? scilU_find_compressor_by_name
-                ctx->hints.force_compression_methods = element->value;
-                warn("H5: %s | compressor: %s\n", h5name, element->value);
-            }
-        }
-    }else if(decision_tree != NULL){
-      // TODO: Gather all required infos to apply to tree
-      double features[] = {32.0,9142272.0,2285568.0,4.0,5.0,9.96920996838687e+36,3.0,124.0,96.0,192.0,0.0,0.0,1.0,1.0,0.0,0.0,1.0};
-      char* predicted = scilU_tree_predict(decision_tree, 0, features);
-      warn("Predicted: %s\n", predicted);
-      /*
-      warn("Dim 0: %s\n", getenv("H5REPACK_DIM_0"));
-      warn("Dim 1: %s\n", getenv("H5REPACK_DIM_1"));
-      warn("Dim 2: %s\n", getenv("H5REPACK_DIM_2"));
-      warn("Dim 3: %s\n", getenv("H5REPACK_DIM_3"));
-      */
-    }
-
     // Set local references of hints and compression chain
     const scil_user_hints_t *hints = &ctx->hints;
     scil_compression_chain_t* chain  = &ctx->chain;
 
     // Check whether automatic compressor decision can be skipped because of a user forced chain
     if (hints->force_compression_methods == NULL) {
+        scil_timer chooser_timer;
+        stats_start(ctx->stats, &chooser_timer);
         scilC_algo_chooser_execute(source, resized_dims, ctx);
+        if (stats_timed(chooser_timer)) {
+            const double seconds = scilU_stop_timer(chooser_timer);
+            if (ctx->stats != NULL) {
+                ctx->stats->chooser_seconds += seconds;
+            }
+            if (monitoring_enabled()) {
+                // the decisions are counted per variable
+                char chain_name[1024];
+                scil_compression_sprint_last_algorithm_chain(ctx, chain_name, sizeof(chain_name));
+                char decision[SCILU_COUNTER_NAME_LENGTH];
+                snprintf(decision, sizeof(decision), "%s:%s", ctx->variable_name != NULL ? ctx->variable_name : "-", chain_name);
+                count_event("chooser", decision, chooser_timer, seconds, input_size, 0, 0);
+            }
+        }
     }
+    const size_t verified_before = verification_begin_chain(ctx);
+
+    // the stages behind the specials preconditioner see data without fill values
+    scil_context_t* stage_ctx = ctx;
+    scil_context_t specials_ctx;
 
     size_t out_size = 0;
 
@@ -216,8 +378,7 @@ int scil_compress(byte* restrict dest,
 
     // Process the compression pipeline
     // we use 1.5 the memory buffer as intermediate location // no we don't, do we?
-    const size_t buffer_tmp_offset = 2 * datatypes_size + 10;
-    byte* restrict buff_tmp        = &dest[buffer_tmp_offset];
+    byte* restrict buff_tmp = buffer != NULL ? buffer : &dest[CHAIN_BUFFER_OFFSET(datatypes_size) - 1];
 
     // process the compression chain
     // apply the first pre-conditioners
@@ -231,25 +392,27 @@ int scil_compress(byte* restrict dest,
             scilU_algorithm_t* algo = chain->pre_cond_first[i];
             void* src = pick_buffer(1, total_compressors, remaining_compressors, source, dest, buff_tmp, dest);
             void* dst = pick_buffer(0, total_compressors, remaining_compressors, source, dest, buff_tmp, dest);
+            scil_timer timer;
+            stats_start(ctx->stats, &timer);
 
             switch (ctx->datatype) {
                 case (SCIL_TYPE_FLOAT):
-                    ret = algo->c.PFtype.compress_float(ctx, (float*)dst, header, &header_size_out, src, resized_dims);
+                    ret = algo->c.PFtype.compress_float(stage_ctx, (float*)dst, header, &header_size_out, src, resized_dims);
                     break;
                 case (SCIL_TYPE_DOUBLE):
-                    ret = algo->c.PFtype.compress_double(ctx, (double*)dst, header, &header_size_out, src, resized_dims);
+                    ret = algo->c.PFtype.compress_double(stage_ctx, (double*)dst, header, &header_size_out, src, resized_dims);
                     break;
               	case (SCIL_TYPE_INT8) :
-              		ret = algo->c.PFtype.compress_int8(ctx, (int8_t*)dst, header, &header_size_out, src, resized_dims);
+              		ret = algo->c.PFtype.compress_int8(stage_ctx, (int8_t*)dst, header, &header_size_out, src, resized_dims);
               		break;
               	case(SCIL_TYPE_INT16) :
-              		ret = algo->c.PFtype.compress_int16(ctx, (int16_t*)dst, header, &header_size_out, src, resized_dims);
+              		ret = algo->c.PFtype.compress_int16(stage_ctx, (int16_t*)dst, header, &header_size_out, src, resized_dims);
               		break;
               	case(SCIL_TYPE_INT32) :
-              		ret = algo->c.PFtype.compress_int32(ctx, (int32_t*)dst, header, &header_size_out, src, resized_dims);
+              		ret = algo->c.PFtype.compress_int32(stage_ctx, (int32_t*)dst, header, &header_size_out, src, resized_dims);
               		break;
               	case(SCIL_TYPE_INT64) :
-              		ret = algo->c.PFtype.compress_int64(ctx, (int64_t*)dst, header, &header_size_out, src, resized_dims);
+              		ret = algo->c.PFtype.compress_int64(stage_ctx, (int64_t*)dst, header, &header_size_out, src, resized_dims);
               		break;
                 case(SCIL_TYPE_UNKNOWN) :
               	case(SCIL_TYPE_STRING) :
@@ -259,6 +422,12 @@ int scil_compress(byte* restrict dest,
             }
 
             if (ret != 0) return ret;
+            stats_add_stage(ctx->stats, "compress", algo, timer, datatypes_size, datatypes_size, header_size_out + 1, remaining_compressors == 1);
+            if (algo == &algo_precond_specials && stage_ctx->hints.fill_value != DBL_MAX) {
+                specials_ctx = *ctx;
+                specials_ctx.hints.fill_value = DBL_MAX;
+                stage_ctx = &specials_ctx;
+            }
             remaining_compressors--;
             out_size += header_size_out;
             header   += header_size_out;
@@ -283,24 +452,26 @@ int scil_compress(byte* restrict dest,
         out_size = (size_t)(datatypes_size * 2);
 
         scilU_algorithm_t* algo = chain->converter;
+        scil_timer timer;
+        stats_start(ctx->stats, &timer);
         switch (ctx->datatype) {
             case (SCIL_TYPE_FLOAT):
-                ret = algo->c.Ctype.compress_float(ctx, (int64_t*)dst, &out_size, src, resized_dims);
+                ret = algo->c.Ctype.compress_float(stage_ctx, (int64_t*)dst, &out_size, src, resized_dims);
                 break;
             case (SCIL_TYPE_DOUBLE):
-                ret = algo->c.Ctype.compress_double(ctx, (int64_t*)dst, &out_size, src, resized_dims);
+                ret = algo->c.Ctype.compress_double(stage_ctx, (int64_t*)dst, &out_size, src, resized_dims);
                 break;
           	case (SCIL_TYPE_INT8) :
-          		ret = algo->c.Ctype.compress_int8(ctx, (int64_t*)dst, &out_size, src, resized_dims);
+          		ret = algo->c.Ctype.compress_int8(stage_ctx, (int64_t*)dst, &out_size, src, resized_dims);
           		break;
           	case(SCIL_TYPE_INT16) :
-          		ret = algo->c.Ctype.compress_int16(ctx, (int64_t*)dst, &out_size, src, resized_dims);
+          		ret = algo->c.Ctype.compress_int16(stage_ctx, (int64_t*)dst, &out_size, src, resized_dims);
           		break;
           	case(SCIL_TYPE_INT32) :
-          		ret = algo->c.Ctype.compress_int32(ctx, (int64_t*)dst, &out_size, src, resized_dims);
+          		ret = algo->c.Ctype.compress_int32(stage_ctx, (int64_t*)dst, &out_size, src, resized_dims);
           		break;
           	case(SCIL_TYPE_INT64) :
-          		ret = algo->c.Ctype.compress_int64(ctx, (int64_t*)dst, &out_size, src, resized_dims);
+          		ret = algo->c.Ctype.compress_int64(stage_ctx, (int64_t*)dst, &out_size, src, resized_dims);
           		break;
             case(SCIL_TYPE_UNKNOWN) :
             case(SCIL_TYPE_BINARY) :
@@ -309,6 +480,7 @@ int scil_compress(byte* restrict dest,
           		break;
         }
         if (ret != 0) return ret;
+        stats_add_stage(ctx->stats, "compress", algo, timer, datatypes_size, out_size, 1, remaining_compressors == 1);
         // check if we have to preserve another header from the preconditioners
         if (datatypes_size != input_size) {
             // we have to copy some header.
@@ -338,10 +510,13 @@ int scil_compress(byte* restrict dest,
             scilU_algorithm_t* algo = chain->pre_cond_second[i];
             void* src = pick_buffer(1, total_compressors, remaining_compressors, source, dest, buff_tmp, dest);
             void* dst = pick_buffer(0, total_compressors, remaining_compressors, source, dest, buff_tmp, dest);
+            scil_timer timer;
+            stats_start(ctx->stats, &timer);
 
-			      ret = algo->c.PStype.compress(ctx, (int64_t*)dst, header, &header_size_out, src, resized_dims);
+			      ret = algo->c.PStype.compress(stage_ctx, (int64_t*)dst, header, &header_size_out, src, resized_dims);
 
             if (ret != 0) return ret;
+            stats_add_stage(ctx->stats, "compress", algo, timer, datatypes_size, datatypes_size, header_size_out + 1, remaining_compressors == 1);
             remaining_compressors--;
             out_size += header_size_out;
             header   += header_size_out;
@@ -366,24 +541,26 @@ int scil_compress(byte* restrict dest,
         out_size = (size_t)(datatypes_size * 2);
 
         scilU_algorithm_t* algo = chain->data_compressor;
+        scil_timer timer;
+        stats_start(ctx->stats, &timer);
         switch (ctx->datatype) {
           case (SCIL_TYPE_FLOAT):
-                ret = algo->c.DNtype.compress_float(ctx, dst, &out_size, src, resized_dims);
+                ret = algo->c.DNtype.compress_float(stage_ctx, dst, &out_size, src, resized_dims);
                 break;
           case (SCIL_TYPE_DOUBLE):
-                ret = algo->c.DNtype.compress_double(ctx, dst, &out_size, src, resized_dims);
+                ret = algo->c.DNtype.compress_double(stage_ctx, dst, &out_size, src, resized_dims);
                 break;
     			case (SCIL_TYPE_INT8) :
-    				ret = algo->c.DNtype.compress_int8(ctx, dst, &out_size, src, resized_dims);
+    				ret = algo->c.DNtype.compress_int8(stage_ctx, dst, &out_size, src, resized_dims);
     				break;
     			case(SCIL_TYPE_INT16) :
-    				ret = algo->c.DNtype.compress_int16(ctx, dst, &out_size, src, resized_dims);
+    				ret = algo->c.DNtype.compress_int16(stage_ctx, dst, &out_size, src, resized_dims);
     				break;
     			case(SCIL_TYPE_INT32) :
-    				ret = algo->c.DNtype.compress_int32(ctx, dst, &out_size, src, resized_dims);
+    				ret = algo->c.DNtype.compress_int32(stage_ctx, dst, &out_size, src, resized_dims);
     				break;
     			case(SCIL_TYPE_INT64) :
-    				ret = algo->c.DNtype.compress_int64(ctx, dst, &out_size, src, resized_dims);
+    				ret = algo->c.DNtype.compress_int64(stage_ctx, dst, &out_size, src, resized_dims);
     				break;
           case(SCIL_TYPE_UNKNOWN) :
           case(SCIL_TYPE_BINARY) :
@@ -392,6 +569,7 @@ int scil_compress(byte* restrict dest,
   				break;
         }
         if (ret != 0) return ret;
+        stats_add_stage(ctx->stats, "compress", algo, timer, datatypes_size, out_size, 1, remaining_compressors == 1);
         // check if we have to preserve another header from the preconditioners
         if (datatypes_size != input_size) {
             // we have to copy some header.
@@ -416,8 +594,11 @@ int scil_compress(byte* restrict dest,
 
         // scilU_print_buffer(src, input_size);
 
-        ret = chain->byte_compressor->c.Btype.compress(ctx, dest, &out_size, (byte*)src, input_size);
+        scil_timer timer;
+        stats_start(ctx->stats, &timer);
+        ret = chain->byte_compressor->c.Btype.compress(stage_ctx, dest, &out_size, (byte*)src, input_size);
         if (ret != 0) return ret;
+        stats_add_stage(ctx->stats, "compress", chain->byte_compressor, timer, input_size, out_size, 1, 1);
         dest[out_size] = chain->byte_compressor->compressor_id;
         debugI("C compressor ID %d at pos %llu\n",
                chain->byte_compressor->compressor_id,
@@ -427,16 +608,417 @@ int scil_compress(byte* restrict dest,
         // scilU_print_buffer(dest, out_size);
     }
 
+    verification_end_chain(ctx, verified_before, scil_dims_get_count(resized_dims));
+
     *out_size_p = out_size + 1; // for the length of the processing chain
     return SCIL_NO_ERR;
 }
 
-int scil_decompress(SCIL_Datatype_t datatype,
+static int compress_chain(byte* restrict dest,
+                  size_t in_dest_size,
+                  void* restrict source,
+                  scil_dims_t* dims,
+                  size_t* restrict out_size_p,
+                  scil_context_t* ctx) {
+    return compress_chain_buffered(dest, in_dest_size, NULL, source, dims, out_size_p, ctx);
+}
+
+/*
+ * Determines the dimensions of block b and the position of its first value.
+ */
+static void get_block_dims(const scil_dims_t* dims, size_t slices, size_t b, scil_dims_t* block_dims, size_t* first_value) {
+    const size_t slowest     = dims->length[dims->dims - 1];
+    const size_t slice_count = scil_dims_get_count(dims) / slowest;
+    const size_t start       = b * slices;
+    const size_t end         = start + slices < slowest ? start + slices : slowest;
+    scil_dims_copy(block_dims, dims);
+    block_dims->length[dims->dims - 1] = end - start;
+    *first_value = start * slice_count;
+}
+
+typedef struct {
+    scil_context_t* ctx; // of the call
+    byte* source;
+    scil_dims_t* dims;
+    size_t slices;
+    size_t block_count;
+    size_t buffer_size; // for the intermediate results of a block
+    byte** regions;     // the part of dest for each block, the last one is the end
+    size_t* sizes;      // compressed size of each block
+    int internal;       // the call is not counted
+
+    pthread_mutex_t lock;
+    size_t next_block;
+    int ret;
+} block_compression_t;
+
+/*
+ * Compresses the next unprocessed block into its part of dest.
+ * Each task works on a copy of the context, the chain chosen for the first block is kept.
+ */
+static void compress_blocks_task(void* arg, int task) {
+    block_compression_t* job = (block_compression_t*) arg;
+    const size_t value_size = DATATYPE_LENGTH(job->ctx->datatype);
+    byte* buffer = (byte*)scilU_safe_malloc(job->buffer_size);
+    const int internal = internal_call;
+    internal_call = job->internal;
+
+    scil_context_t ctx = *job->ctx;
+    scil_compress_stats_t stats;
+    ctx.chooser_online = 0;
+    ctx.pipeline_params = scilU_dict_create(30);
+    if (ctx.stats != NULL) {
+        ctx.stats = &stats;
+        stats_reset(&stats);
+    }
+    if (ctx.verification != NULL) {
+        ctx.verification = scilC_verification_create();
+        verification_reset(&ctx);
+    }
+
+    while (1) {
+        pthread_mutex_lock(&job->lock);
+        const size_t b = job->next_block++;
+        const int failed = job->ret != SCIL_NO_ERR;
+        pthread_mutex_unlock(&job->lock);
+        if (b >= job->block_count || failed) {
+            break;
+        }
+        scil_dims_t block_dims;
+        size_t first;
+        get_block_dims(job->dims, job->slices, b, &block_dims, &first);
+        int ret = compress_chain_buffered(job->regions[b], job->regions[b + 1] - job->regions[b], buffer, job->source + first * value_size, &block_dims, &job->sizes[b], &ctx);
+        if (ret != SCIL_NO_ERR) {
+            pthread_mutex_lock(&job->lock);
+            job->ret = ret;
+            pthread_mutex_unlock(&job->lock);
+            break;
+        }
+    }
+    free(buffer);
+
+    pthread_mutex_lock(&job->lock);
+    if (ctx.stats != NULL) {
+        stats_merge(job->ctx->stats, &stats);
+    }
+    if (ctx.verification != NULL) {
+        verification_merge(job->ctx, &ctx);
+    }
+    pthread_mutex_unlock(&job->lock);
+    scilC_verification_destroy(ctx.verification);
+    scilU_dict_destroy(ctx.pipeline_params);
+    internal_call = internal;
+}
+
+/*
+ * The space of dest behind the header is split between the blocks in proportion to their size.
+ * The blocks are compressed concurrently, each straight into its part, and then moved together.
+ */
+static int compress_blocks(byte* restrict dest,
+                           size_t in_dest_size,
+                           void* restrict source,
+                           scil_dims_t* dims,
+                           size_t* restrict out_size_p,
+                           scil_context_t* ctx) {
+    const size_t value_size  = DATATYPE_LENGTH(ctx->datatype);
+    const size_t count       = scil_dims_get_count(dims);
+    const size_t slowest     = dims->length[dims->dims - 1];
+    const size_t slice_count = count / slowest;
+    // tiny blocks would not leave each block the space its chain needs
+    const size_t block_size  = max(ctx->block_size, 64 / value_size);
+    const size_t slices      = (block_size + slice_count - 1) / slice_count;
+    const size_t block_count = (slowest + slices - 1) / slices;
+    const size_t header_size = 1 + 8 * (2 + block_count);
+
+    if (block_count < 2) {
+        return compress_chain(dest, in_dest_size, source, dims, out_size_p, ctx);
+    }
+    if (in_dest_size < header_size) {
+        return SCIL_MEMORY_ERR;
+    }
+
+    byte* pos = dest;
+    *pos = SCIL_BLOCK_MARKER;
+    pos++;
+    uint64_t value = block_count;
+    scilU_pack8(pos, value);
+    pos += 8;
+    value = slices;
+    scilU_pack8(pos, value);
+    pos += 8;
+    byte* sizes = pos;
+
+    block_compression_t job;
+    memset(&job, 0, sizeof(job));
+    job.ctx = ctx;
+    job.source = (byte*)source;
+    job.dims = dims;
+    job.slices = slices;
+    job.block_count = block_count;
+    job.regions = (byte**)scilU_safe_malloc((block_count + 1) * sizeof(byte*));
+    job.sizes = (size_t*)scilU_safe_malloc(block_count * sizeof(size_t));
+    job.internal = internal_call;
+    job.ret = SCIL_NO_ERR;
+
+    const double share = (double)(in_dest_size - header_size) / count;
+    scil_dims_t block_dims;
+    size_t first;
+    for (size_t b = 0; b < block_count; b++) {
+        get_block_dims(dims, slices, b, &block_dims, &first);
+        job.regions[b] = dest + header_size + (size_t)(first * share);
+    }
+    job.regions[block_count] = dest + in_dest_size;
+    for (size_t b = 0; b < block_count; b++) {
+        get_block_dims(dims, slices, b, &block_dims, &first);
+        if ((size_t)(job.regions[b + 1] - job.regions[b]) < CHAIN_BUFFER_OFFSET(scil_dims_get_size(&block_dims, ctx->datatype))) {
+            free(job.regions);
+            free(job.sizes);
+            return SCIL_MEMORY_ERR;
+        }
+    }
+
+    // the first block is the largest, its compression chooses the chain for all blocks
+    get_block_dims(dims, slices, 0, &block_dims, &first);
+    job.buffer_size = 2 * scil_dims_get_size(&block_dims, ctx->datatype) + SCIL_BLOCK_HEADER_MAX_SIZE;
+    byte* buffer = (byte*)scilU_safe_malloc(job.buffer_size);
+    int ret = compress_chain_buffered(job.regions[0], job.regions[1] - job.regions[0], buffer, source, &block_dims, &job.sizes[0], ctx);
+    free(buffer);
+
+    if (ret == SCIL_NO_ERR) {
+        int thread_count = scilU_get_thread_count();
+        if ((size_t) thread_count > block_count - 1) thread_count = (int)(block_count - 1);
+        stats_add_scratch(ctx->stats, job.buffer_size * (thread_count + 1));
+
+        job.next_block = 1;
+        pthread_mutex_init(&job.lock, NULL);
+        scilU_parallel_run(thread_count, compress_blocks_task, &job);
+        pthread_mutex_destroy(&job.lock);
+        ret = job.ret;
+    }
+
+    pos = dest + header_size;
+    for (size_t b = 0; b < block_count && ret == SCIL_NO_ERR; b++) {
+        // the parts are in order of the blocks, thus the data moves only to the front
+        memmove(pos, job.regions[b], job.sizes[b]);
+        pos += job.sizes[b];
+        value = job.sizes[b];
+        byte* size_pos = sizes + 8 * b;
+        scilU_pack8(size_pos, value);
+    }
+    free(job.regions);
+    free(job.sizes);
+
+    *out_size_p = pos - dest;
+    return ret;
+}
+
+static int compress_masked(byte* restrict dest,
+                           size_t in_dest_size,
+                           void* restrict source,
+                           scil_dims_t* dims,
+                           size_t* restrict out_size_p,
+                           scil_context_t* ctx,
+                           const scilC_mask_t* mask,
+                           int mask_inline) {
+    const size_t value_size  = DATATYPE_LENGTH(ctx->datatype);
+    const size_t count       = scil_dims_get_count(dims);
+    const size_t dense_count = mask->valid_count * (count / mask->count);
+    const size_t runs_limit  = mask_inline ? mask->run_count * 10 : 0;
+
+    // fall back to unmasked compression if the mask is too fragmented to pay off
+    if (in_dest_size < 4 * dense_count * value_size + runs_limit + 128 || (mask_inline && runs_limit > count * value_size)) {
+        debug("Mask is too fragmented, compressing all points\n");
+        return compress_chain(dest, in_dest_size, source, dims, out_size_p, ctx);
+    }
+
+    byte* pos = dest;
+    *pos = SCIL_MASK_MARKER;
+    pos++;
+    *pos = (byte) mask_inline;
+    pos++;
+    uint64_t fingerprint = mask->fingerprint;
+    scilU_pack8(pos, fingerprint);
+    pos += 8;
+    uint64_t mask_count = mask->count;
+    scilU_pack8(pos, mask_count);
+    pos += 8;
+    uint64_t valid_count = mask->valid_count;
+    scilU_pack8(pos, valid_count);
+    pos += 8;
+    *pos = mask->dims.dims;
+    pos++;
+    for (int d = 0; d < mask->dims.dims; d++) {
+        uint64_t length = mask->dims.length[d];
+        scilU_pack8(pos, length);
+        pos += 8;
+    }
+    double fill_value = ctx->hints.fill_value != DBL_MAX ? ctx->hints.fill_value : 0.0;
+    scilU_pack8(pos, fill_value);
+    pos += 8;
+    if (mask_inline) {
+        uint64_t runs_size = scilC_mask_write_runs(mask, pos + 8);
+        scilU_pack8(pos, runs_size);
+        pos += 8 + runs_size;
+    }
+    const size_t header_size = pos - dest;
+
+    if (dense_count == 0) {
+        *out_size_p = header_size;
+        return SCIL_NO_ERR;
+    }
+
+    byte* dense = (byte*)scilU_safe_malloc(dense_count * value_size);
+    stats_add_scratch(ctx->stats, dense_count * value_size);
+    scilC_mask_gather(mask, dense, (const byte*)source, count, value_size);
+
+    // the valid points are split into blocks like unmasked data
+    scil_dims_t dense_dims;
+    scil_dims_initialize_1d(&dense_dims, dense_count);
+    size_t dense_size = 0;
+    int ret;
+    if (ctx->block_size > 0) {
+        ret = compress_blocks(pos, in_dest_size - header_size, dense, &dense_dims, &dense_size, ctx);
+    } else {
+        ret = compress_chain(pos, in_dest_size - header_size, dense, &dense_dims, &dense_size, ctx);
+    }
+    free(dense);
+
+    *out_size_p = header_size + dense_size;
+    return ret;
+}
+
+int scil_set_threads(int count) {
+    return scilU_set_thread_count(count);
+}
+
+/*
+ * A call works on a copy of the context with its own state.
+ * The chain chosen by an earlier call is reused.
+ */
+static void begin_call(scil_context_t* ctx, scil_context_t* call, scil_compress_stats_t* stats) {
+    pthread_mutex_lock(ctx->lock);
+    *call = *ctx;
+    call->variable_name = ctx->variable_name != NULL ? strdup(ctx->variable_name) : NULL;
+    pthread_mutex_unlock(ctx->lock);
+    call->pipeline_params = scilU_dict_create(30);
+    if (ctx->verification != NULL) {
+        call->verification = scilC_verification_create();
+        verification_reset(call);
+    }
+    if (ctx->stats != NULL) {
+        call->stats = stats;
+        stats_reset(stats);
+    }
+}
+
+// the chain of a call is kept only if the variable did not change meanwhile
+static int same_variable(const char* a, const char* b) {
+    return a == b || (a != NULL && b != NULL && strcmp(a, b) == 0);
+}
+
+static void end_call(scil_context_t* ctx, scil_context_t* call, int ret) {
+    if (ret == SCIL_NO_ERR || call->stats != NULL) {
+        pthread_mutex_lock(ctx->lock);
+        if (ret == SCIL_NO_ERR && same_variable(ctx->variable_name, call->variable_name)) {
+            ctx->chain = call->chain;
+            ctx->chooser_online = call->chooser_online;
+            if (ctx->mask_auto) {
+                ctx->mask_detected = call->mask_detected;
+            }
+        }
+        if (call->stats != NULL) {
+            *ctx->stats = *call->stats;
+        }
+        pthread_mutex_unlock(ctx->lock);
+    }
+    if (call->verification != NULL) {
+        verification_publish(ctx, call, ret);
+        scilC_verification_destroy(call->verification);
+    }
+    scilU_dict_destroy(call->pipeline_params);
+    free(call->variable_name);
+}
+
+int scil_compress(byte* restrict dest,
+                  size_t in_dest_size,
+                  void* restrict source,
+                  scil_dims_t* dims,
+                  size_t* restrict out_size_p,
+                  scil_context_t* shared_ctx) {
+
+    assert(shared_ctx != NULL);
+    assert(dims != NULL);
+
+    scil_timer timer;
+    scilU_start_timer(&timer);
+
+    scil_context_t call;
+    scil_context_t* ctx = &call;
+    scil_compress_stats_t stats;
+    begin_call(shared_ctx, ctx, &stats);
+
+    const size_t count = scil_dims_get_count(dims);
+    scilC_mask_t* mask = ctx->mask;
+    if (mask == NULL && ctx->mask_auto && ctx->hints.fill_value != DBL_MAX && count > 0) {
+        // checking the mask of the last call is cheaper than detecting it again
+        if (ctx->mask_detected != NULL && scilC_mask_matches(ctx->mask_detected, source, count, ctx->datatype, ctx->hints.fill_value)) {
+            mask = ctx->mask_detected;
+        } else {
+            mask = scilC_mask_detect(source, count, ctx->datatype, ctx->hints.fill_value);
+            if (mask != NULL && mask->cached) {
+                ctx->mask_detected = mask;
+            }
+        }
+    }
+    int ret;
+    if (mask == NULL && ctx->block_size > 0 && count > 0) {
+        ret = compress_blocks(dest, in_dest_size, source, dims, out_size_p, ctx);
+    } else if (mask == NULL) {
+        ret = compress_chain(dest, in_dest_size, source, dims, out_size_p, ctx);
+    } else {
+        if (count == 0 || mask->count == 0 || count % mask->count != 0) {
+            ret = SCIL_EINVAL;
+        } else {
+            ret = compress_masked(dest, in_dest_size, source, dims, out_size_p, ctx, mask, ctx->mask == NULL);
+        }
+        if (! mask->cached) {
+            scilC_mask_destroy(mask);
+        }
+    }
+
+    if (ret == SCIL_NO_ERR && ctx->verification != NULL) {
+        ret = verification_check(ctx, source, dims, dest, *out_size_p);
+    }
+    if (ret == SCIL_NO_ERR && count > 0 && ctx->chooser_online) {
+        scil_timer chooser_timer;
+        stats_start(ctx->stats, &chooser_timer);
+        scilC_algo_chooser_observe(ctx, source, dest, *out_size_p, dims, scilU_stop_timer(timer));
+        if (ctx->stats != NULL) {
+            ctx->stats->chooser_seconds += scilU_stop_timer(chooser_timer);
+        }
+    }
+    if (ctx->stats != NULL || monitoring_enabled()) {
+        const double seconds = scilU_stop_timer(timer);
+        const size_t input_bytes = scil_dims_get_size(dims, ctx->datatype);
+        const size_t output_bytes = ret == SCIL_NO_ERR ? *out_size_p : 0;
+        if (ctx->stats != NULL) {
+            ctx->stats->seconds = seconds;
+            ctx->stats->input_bytes = input_bytes;
+            ctx->stats->output_bytes = output_bytes;
+        }
+        count_event("call", "compress", timer, seconds, input_bytes, output_bytes, ret != SCIL_NO_ERR);
+    }
+    end_call(shared_ctx, ctx, ret);
+    return ret;
+}
+
+static int decompress_chain(SCIL_Datatype_t datatype,
                     void* restrict dest,
                     scil_dims_t* dims,
                     byte* restrict source,
                     const size_t source_size,
-                    byte* restrict buff_tmp1) {
+                    byte* restrict buff_tmp1,
+                    scil_compress_stats_t* stats) {
 
     if (dims->dims == 0) {
         return SCIL_NO_ERR;
@@ -446,7 +1028,8 @@ int scil_decompress(SCIL_Datatype_t datatype,
     assert(source != NULL);
     assert(buff_tmp1 != NULL);
 
-    scil_dims_t* resized_dims = malloc(sizeof(scil_dims_t));
+    scil_dims_t resized;
+    scil_dims_t* resized_dims = &resized;
     memset(resized_dims, 0, sizeof(scil_dims_t));
 
     if(dims->dims > 4){
@@ -491,8 +1074,14 @@ int scil_decompress(SCIL_Datatype_t datatype,
         void* src = pick_buffer(1, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
         void* dst = pick_buffer(0, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
 
-        ret = algo->c.Btype.decompress(dst, output_size * 2 + 10, (byte*)src, src_size, &src_size);
+        // the buffer of the caller has no room beyond the data, zstd uses the room of larger buffers
+        const size_t dst_size = dst == dest ? output_size : output_size * 2 + 10;
+        const size_t input_size = src_size;
+        scil_timer timer;
+        stats_start(stats, &timer);
+        ret = algo->c.Btype.decompress(dst, dst_size, (byte*)src, src_size, &src_size);
         if (ret != 0) return ret;
+        stats_add_stage(stats, "decompress", algo, timer, input_size, src_size, 1, remaining_compressors == 1);
         remaining_compressors--;
 
         // the header is on the right hand side of the buffer
@@ -516,6 +1105,8 @@ int scil_decompress(SCIL_Datatype_t datatype,
     if (algo->type == SCIL_COMPRESSOR_TYPE_DATATYPES) {
         void* src = pick_buffer(1, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
         void* dst = pick_buffer(0, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
+        scil_timer timer;
+        stats_start(stats, &timer);
 
         switch (datatype) {
             case (SCIL_TYPE_FLOAT):
@@ -544,6 +1135,7 @@ int scil_decompress(SCIL_Datatype_t datatype,
         }
 
         if (ret != 0) return ret;
+        stats_add_stage(stats, "decompress", algo, timer, src_size, output_size, 1, remaining_compressors == 1);
         remaining_compressors--;
         if (remaining_compressors > 0) {
             // scilU_print_buffer(dst, src_size);
@@ -559,12 +1151,15 @@ int scil_decompress(SCIL_Datatype_t datatype,
         void* src = pick_buffer(1, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
         void* dst = pick_buffer(0, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
         int header_parsed;
+        scil_timer timer;
+        stats_start(stats, &timer);
 
         ret = algo->c.PStype.decompress(dst, resized_dims, src, header, &header_parsed);
 
         header -= header_parsed;
 
         if (ret != 0) return ret;
+        stats_add_stage(stats, "decompress", algo, timer, output_size, output_size, header_parsed + 1, remaining_compressors == 1);
         remaining_compressors--;
 
         // scilU_print_buffer(dst, src_size);
@@ -578,6 +1173,8 @@ int scil_decompress(SCIL_Datatype_t datatype,
 	if (algo->type == SCIL_COMPRESSOR_TYPE_DATATYPES_CONVERTER) {
         void* src = pick_buffer(1, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
         void* dst = pick_buffer(0, total_compressors, remaining_compressors, src_adj, dest, buff_tmp1, buff_tmp2);
+        scil_timer timer;
+        stats_start(stats, &timer);
 
         switch (datatype) {
           case (SCIL_TYPE_FLOAT):
@@ -606,6 +1203,7 @@ int scil_decompress(SCIL_Datatype_t datatype,
         }
 
         if (ret != 0) return ret;
+        stats_add_stage(stats, "decompress", algo, timer, src_size, output_size, 1, remaining_compressors == 1);
         remaining_compressors--;
         if (remaining_compressors > 0) {
             // scilU_print_buffer(dst, src_size);
@@ -625,6 +1223,8 @@ int scil_decompress(SCIL_Datatype_t datatype,
         if (algo->type != SCIL_COMPRESSOR_TYPE_DATATYPES_PRECONDITIONER_FIRST) {
             return SCIL_BUFFER_ERR;
         }
+        scil_timer timer;
+        stats_start(stats, &timer);
 
         switch (datatype) {
           case (SCIL_TYPE_FLOAT):
@@ -654,6 +1254,7 @@ int scil_decompress(SCIL_Datatype_t datatype,
         header -= header_parsed;
 
         if (ret != 0) return ret;
+        stats_add_stage(stats, "decompress", algo, timer, output_size, output_size, header_parsed + 1, remaining_compressors == 1);
         remaining_compressors--;
 
         if (remaining_compressors > 0) {
@@ -672,6 +1273,426 @@ int scil_decompress(SCIL_Datatype_t datatype,
     return SCIL_NO_ERR;
 }
 
+/*
+ * Reads the header of the block format.
+ * Returns the position of each block relative to source in offsets, the last one is the end.
+ */
+static int read_block_offsets(const byte* source,
+                              const size_t source_size,
+                              const scil_dims_t* dims,
+                              size_t* out_slices,
+                              size_t* out_block_count,
+                              size_t** out_offsets) {
+    if (source_size < 17 || dims->dims == 0) {
+        return SCIL_BUFFER_ERR;
+    }
+    uint64_t block_count, slices;
+    const byte* pos = source + 1;
+    scilU_unpack8(pos, &block_count);
+    pos += 8;
+    scilU_unpack8(pos, &slices);
+    pos += 8;
+    const size_t slowest = dims->length[dims->dims - 1];
+    if (slices == 0 || block_count != (slowest + slices - 1) / slices || block_count > (source_size - 17) / 8) {
+        return SCIL_BUFFER_ERR;
+    }
+
+    size_t* offsets = (size_t*)scilU_safe_malloc((block_count + 1) * sizeof(size_t));
+    offsets[0] = 17 + 8 * block_count;
+    for (size_t b = 0; b < block_count; b++) {
+        uint64_t size;
+        scilU_unpack8(pos, &size);
+        pos += 8;
+        if (size > source_size - offsets[b]) {
+            free(offsets);
+            return SCIL_BUFFER_ERR;
+        }
+        offsets[b + 1] = offsets[b] + size;
+    }
+    *out_slices      = slices;
+    *out_block_count = block_count;
+    *out_offsets     = offsets;
+    return SCIL_NO_ERR;
+}
+
+typedef struct {
+    SCIL_Datatype_t datatype;
+    void* dest;
+    scil_dims_t* dims;
+    byte* source;
+    const size_t* offsets;
+    size_t slices;
+    size_t block_count;
+    byte* buff_tmp; // of the caller, it runs the first task
+    scil_compress_stats_t* stats;
+    int internal;   // the call is not counted
+
+    pthread_mutex_t lock;
+    size_t next_block;
+    int ret;
+} block_decompression_t;
+
+/*
+ * Decompresses the next unprocessed block into its part of dest.
+ */
+static void decompress_blocks_task(void* arg, int task) {
+    block_decompression_t* job = (block_decompression_t*) arg;
+    const size_t value_size = DATATYPE_LENGTH(job->datatype);
+    scil_dims_t block_dims;
+    size_t first;
+    // the first block is the largest
+    get_block_dims(job->dims, job->slices, 0, &block_dims, &first);
+    byte* tmp = task == 0 ? job->buff_tmp : (byte*)scilU_safe_malloc(scil_get_compressed_data_size_limit(&block_dims, job->datatype));
+    scil_compress_stats_t stats;
+    stats_reset(&stats);
+    const int internal = internal_call;
+    internal_call = job->internal;
+
+    while (1) {
+        pthread_mutex_lock(&job->lock);
+        const size_t b = job->next_block++;
+        const int failed = job->ret != SCIL_NO_ERR;
+        pthread_mutex_unlock(&job->lock);
+        if (b >= job->block_count || failed) {
+            break;
+        }
+        get_block_dims(job->dims, job->slices, b, &block_dims, &first);
+        int ret = decompress_chain(job->datatype, (byte*)job->dest + first * value_size, &block_dims, job->source + job->offsets[b], job->offsets[b + 1] - job->offsets[b], tmp, job->stats != NULL ? &stats : NULL);
+        if (ret != SCIL_NO_ERR) {
+            pthread_mutex_lock(&job->lock);
+            job->ret = ret;
+            pthread_mutex_unlock(&job->lock);
+            break;
+        }
+    }
+    if (task != 0) {
+        free(tmp);
+    }
+    if (job->stats != NULL) {
+        pthread_mutex_lock(&job->lock);
+        stats_merge(job->stats, &stats);
+        pthread_mutex_unlock(&job->lock);
+    }
+    internal_call = internal;
+}
+
+static int decompress_blocks(SCIL_Datatype_t datatype,
+                             void* restrict dest,
+                             scil_dims_t* dims,
+                             byte* restrict source,
+                             const size_t source_size,
+                             byte* restrict buff_tmp1,
+                             scil_compress_stats_t* stats) {
+    block_decompression_t job;
+    memset(&job, 0, sizeof(job));
+    size_t* offsets;
+    int ret = read_block_offsets(source, source_size, dims, &job.slices, &job.block_count, &offsets);
+    if (ret != SCIL_NO_ERR) {
+        return ret;
+    }
+    job.datatype = datatype;
+    job.dest = dest;
+    job.dims = dims;
+    job.source = source;
+    job.offsets = offsets;
+    job.buff_tmp = buff_tmp1;
+    job.stats = stats;
+    job.internal = internal_call;
+    job.ret = SCIL_NO_ERR;
+    pthread_mutex_init(&job.lock, NULL);
+
+    int thread_count = scilU_get_thread_count();
+    if ((size_t) thread_count > job.block_count) thread_count = (int) job.block_count;
+
+    // each task takes the next block until all are decompressed
+    scilU_parallel_run(thread_count, decompress_blocks_task, &job);
+    pthread_mutex_destroy(&job.lock);
+
+    free(offsets);
+    return job.ret;
+}
+
+static int decompress_masked(SCIL_Datatype_t datatype,
+                             void* restrict dest,
+                             scil_dims_t* dims,
+                             byte* restrict source,
+                             const size_t source_size,
+                             byte* restrict buff_tmp1,
+                             scil_compress_stats_t* stats) {
+    const size_t value_size = DATATYPE_LENGTH(datatype);
+    const size_t count      = scil_dims_get_count(dims);
+
+    if (source_size < 35) {
+        return SCIL_BUFFER_ERR;
+    }
+    byte* pos = source + 1;
+    const int mask_inline = *pos;
+    pos++;
+    uint64_t fingerprint, mask_count, valid_count;
+    double fill_value;
+    scilU_unpack8(pos, &fingerprint);
+    pos += 8;
+    scilU_unpack8(pos, &mask_count);
+    pos += 8;
+    scilU_unpack8(pos, &valid_count);
+    pos += 8;
+    scil_dims_t mask_dims;
+    mask_dims.dims = *pos;
+    pos++;
+    if (mask_dims.dims == 0 || mask_dims.dims > SCIL_DIMS_MAX || source_size < 35 + 8 * (size_t) mask_dims.dims) {
+        return SCIL_BUFFER_ERR;
+    }
+    for (int d = 0; d < mask_dims.dims; d++) {
+        uint64_t length;
+        scilU_unpack8(pos, &length);
+        pos += 8;
+        mask_dims.length[d] = length;
+    }
+    scilU_unpack8(pos, &fill_value);
+    pos += 8;
+    if (mask_count == 0 || scil_dims_get_count(&mask_dims) != mask_count) {
+        return SCIL_BUFFER_ERR;
+    }
+
+    scilC_mask_t* mask;
+    if (mask_inline) {
+        uint64_t runs_size;
+        if (source_size - (pos - source) < 8) {
+            return SCIL_BUFFER_ERR;
+        }
+        scilU_unpack8(pos, &runs_size);
+        pos += 8;
+        if (runs_size > source_size - (pos - source)) {
+            return SCIL_BUFFER_ERR;
+        }
+        mask = scilC_mask_read_runs(pos, runs_size, &mask_dims);
+        pos += runs_size;
+        if (mask == NULL) {
+            return SCIL_BUFFER_ERR;
+        }
+    } else {
+        mask = scilC_mask_get_by_fingerprint(fingerprint, &mask_dims);
+        if (mask == NULL) {
+            warn("The mask used for compression is not registered\n");
+            return SCIL_EINVAL;
+        }
+    }
+
+    // a fingerprint collision must not scatter the data into the wrong points
+    int ret = SCIL_NO_ERR;
+    byte fill[8];
+    if (mask->count != mask_count || mask->valid_count != valid_count || count % mask->count != 0) {
+        warn("The mask does not match the compressed data\n");
+        ret = SCIL_EINVAL;
+        goto masked_cleanup;
+    }
+    const size_t dense_count = mask->valid_count * (count / mask->count);
+    ret = scilC_mask_fill_pattern(datatype, fill_value, fill);
+    if (ret != SCIL_NO_ERR) {
+        goto masked_cleanup;
+    }
+
+    byte* dense = (byte*)scilU_safe_malloc(dense_count * value_size + 1);
+    stats_add_scratch(stats, dense_count * value_size);
+    if (dense_count > 0) {
+        scil_dims_t dense_dims;
+        scil_dims_initialize_1d(&dense_dims, dense_count);
+        const size_t dense_size = source_size - (pos - source);
+        if (dense_size > 0 && pos[0] == SCIL_BLOCK_MARKER) {
+            ret = decompress_blocks(datatype, dense, &dense_dims, pos, dense_size, buff_tmp1, stats);
+        } else {
+            ret = decompress_chain(datatype, dense, &dense_dims, pos, dense_size, buff_tmp1, stats);
+        }
+    }
+    if (ret == SCIL_NO_ERR) {
+        scilC_mask_scatter(mask, (byte*)dest, dense, count, value_size, fill);
+    }
+    free(dense);
+
+  masked_cleanup:
+    if (! mask->cached) {
+        scilC_mask_destroy(mask);
+    }
+    return ret;
+}
+
+// decompresses each of the formats
+static int decompress_any(SCIL_Datatype_t datatype,
+                          void* restrict dest,
+                          scil_dims_t* dims,
+                          byte* restrict source,
+                          const size_t source_size,
+                          byte* restrict buff_tmp1,
+                          scil_compress_stats_t* stats) {
+    if (source_size > 0 && source[0] == SCIL_MASK_MARKER) {
+        return decompress_masked(datatype, dest, dims, source, source_size, buff_tmp1, stats);
+    } else if (source_size > 0 && source[0] == SCIL_BLOCK_MARKER) {
+        return decompress_blocks(datatype, dest, dims, source, source_size, buff_tmp1, stats);
+    }
+    return decompress_chain(datatype, dest, dims, source, source_size, buff_tmp1, stats);
+}
+
+int scilC_compress_internal(byte* restrict dest,
+                            size_t in_dest_size,
+                            void* restrict source,
+                            scil_dims_t* dims,
+                            size_t* restrict out_size_p,
+                            scil_context_t* ctx) {
+    const int internal = internal_call;
+    internal_call = 1;
+    const int ret = scil_compress(dest, in_dest_size, source, dims, out_size_p, ctx);
+    internal_call = internal;
+    return ret;
+}
+
+int scilC_decompress_internal(SCIL_Datatype_t datatype,
+                              void* restrict dest,
+                              scil_dims_t* dims,
+                              byte* restrict source,
+                              const size_t source_size,
+                              byte* restrict buff_tmp1) {
+    const int internal = internal_call;
+    internal_call = 1;
+    const int ret = scil_decompress(datatype, dest, dims, source, source_size, buff_tmp1);
+    internal_call = internal;
+    return ret;
+}
+
+int scil_decompress(SCIL_Datatype_t datatype,
+                    void* restrict dest,
+                    scil_dims_t* dims,
+                    byte* restrict source,
+                    const size_t source_size,
+                    byte* restrict buff_tmp1) {
+    return scil_decompress_with_stats(datatype, dest, dims, source, source_size, buff_tmp1, NULL);
+}
+
+int scil_decompress_with_stats(SCIL_Datatype_t datatype,
+                               void* restrict dest,
+                               scil_dims_t* dims,
+                               byte* restrict source,
+                               const size_t source_size,
+                               byte* restrict buff_tmp1,
+                               scil_compress_stats_t* stats) {
+    scil_timer timer;
+    stats_start(stats, &timer);
+    if (stats != NULL) {
+        stats_reset(stats);
+    }
+    int ret = decompress_any(datatype, dest, dims, source, source_size, buff_tmp1, stats);
+    if (stats_timed(timer)) {
+        const double seconds = scilU_stop_timer(timer);
+        const size_t output_bytes = ret == SCIL_NO_ERR ? scil_dims_get_size(dims, datatype) : 0;
+        if (stats != NULL) {
+            stats->seconds = seconds;
+            stats->input_bytes = source_size;
+            stats->output_bytes = output_bytes;
+        }
+        count_event("call", "decompress", timer, seconds, source_size, output_bytes, ret != SCIL_NO_ERR);
+    }
+    return ret;
+}
+
+// Number of values an accuracy thread compares at least
+#define ACCURACY_MIN_VALUES_PER_THREAD 262144
+
+typedef struct {
+    SCIL_Datatype_t datatype;
+    const void* data_1;
+    const void* data_2;
+    size_t start;
+    size_t end;
+    double relative_err_finest_abs_tolerance;
+    scil_error_metrics_t metrics;
+} accuracy_range_t;
+
+static int get_max_significant_bits(SCIL_Datatype_t datatype) {
+    switch (datatype) {
+        case (SCIL_TYPE_DOUBLE): return MANTISSA_LENGTH_DOUBLE;
+        case (SCIL_TYPE_FLOAT): return MANTISSA_LENGTH_FLOAT;
+        default: return (int) DATATYPE_LENGTH(datatype) * 8;
+    }
+}
+
+static void initialize_accuracy_metrics(scil_error_metrics_t* m, SCIL_Datatype_t datatype) {
+    memset(m, 0, sizeof(scil_error_metrics_t));
+    scil_user_hints_initialize(&m->a);
+    m->a.significant_bits = get_max_significant_bits(datatype);
+    m->v.value_min = DBL_MAX;
+    m->v.value_max = -DBL_MAX;
+}
+
+static void* determine_accuracy_range(void* arg) {
+    accuracy_range_t* r = (accuracy_range_t*) arg;
+    scil_error_metrics_t* m = &r->metrics;
+    initialize_accuracy_metrics(m, r->datatype);
+
+    switch (r->datatype) {
+        case (SCIL_TYPE_DOUBLE):
+            scil_determine_accuracy_double((double*)r->data_1, (double*)r->data_2, r->start, r->end, r->relative_err_finest_abs_tolerance, m);
+            break;
+        case (SCIL_TYPE_FLOAT):
+            scil_determine_accuracy_float((float*)r->data_1, (float*)r->data_2, r->start, r->end, r->relative_err_finest_abs_tolerance, m);
+            break;
+        case (SCIL_TYPE_INT8):
+            scil_determine_accuracy_int8_t((int8_t*)r->data_1, (int8_t*)r->data_2, r->start, r->end, r->relative_err_finest_abs_tolerance, m);
+            break;
+        case (SCIL_TYPE_INT16):
+            scil_determine_accuracy_int16_t((int16_t*)r->data_1, (int16_t*)r->data_2, r->start, r->end, r->relative_err_finest_abs_tolerance, m);
+            break;
+        case (SCIL_TYPE_INT32):
+            scil_determine_accuracy_int32_t((int32_t*)r->data_1, (int32_t*)r->data_2, r->start, r->end, r->relative_err_finest_abs_tolerance, m);
+            break;
+        case (SCIL_TYPE_INT64):
+            scil_determine_accuracy_int64_t((int64_t*)r->data_1, (int64_t*)r->data_2, r->start, r->end, r->relative_err_finest_abs_tolerance, m);
+            break;
+        default:
+            break;
+    }
+    return NULL;
+}
+
+// merges the metrics of the following range into m, the earlier position wins on ties
+static void merge_accuracy_metrics(scil_error_metrics_t* m, const scil_error_metrics_t* o) {
+    if (o->a.absolute_tolerance > m->a.absolute_tolerance) {
+        m->a.absolute_tolerance = o->a.absolute_tolerance;
+        m->v.absolute_tolerance_idx = o->v.absolute_tolerance_idx;
+    }
+    if (o->a.relative_err_finest_abs_tolerance > m->a.relative_err_finest_abs_tolerance) {
+        m->a.relative_err_finest_abs_tolerance = o->a.relative_err_finest_abs_tolerance;
+        m->v.relative_err_finest_abs_tolerance_idx = o->v.relative_err_finest_abs_tolerance_idx;
+    }
+    if (o->a.relative_tolerance_percent > m->a.relative_tolerance_percent) {
+        m->a.relative_tolerance_percent = o->a.relative_tolerance_percent;
+        m->v.relative_tolerance_percent_idx = o->v.relative_tolerance_percent_idx;
+    }
+    m->a.significant_bits = o->a.significant_bits < m->a.significant_bits ? o->a.significant_bits : m->a.significant_bits;
+    m->v.value_min = o->v.value_min < m->v.value_min ? o->v.value_min : m->v.value_min;
+    m->v.value_max = o->v.value_max > m->v.value_max ? o->v.value_max : m->v.value_max;
+    m->sum_squared_error += o->sum_squared_error;
+    m->sum_significant_bits += o->sum_significant_bits;
+    for (int i = 0; i < SCIL_ERROR_HISTOGRAM_BINS; i++) {
+        m->v.error_histogram[i] += o->v.error_histogram[i];
+    }
+}
+
+static void finish_accuracy(const scil_error_metrics_t* m,
+                            const size_t count,
+                            scil_user_hints_t* out_hints,
+                            scil_validate_params_t* out_validation);
+
+static int get_accuracy_thread_count(size_t count) {
+    int threads = scilU_get_thread_count();
+    const size_t limit = count / ACCURACY_MIN_VALUES_PER_THREAD;
+    if ((size_t) threads > limit) threads = (int) limit;
+    return threads < 1 ? 1 : threads;
+}
+
+static void determine_accuracy_task(void* arg, int task) {
+    accuracy_range_t* ranges = (accuracy_range_t*) arg;
+    determine_accuracy_range(&ranges[task]);
+}
+
 void scil_determine_accuracy(SCIL_Datatype_t datatype,
                              const void* restrict data_1,
                              const void* restrict data_2,
@@ -679,68 +1700,50 @@ void scil_determine_accuracy(SCIL_Datatype_t datatype,
                              const double relative_err_finest_abs_tolerance,
                              scil_user_hints_t* out_hints,
                              scil_validate_params_t *out_validation) {
-    scil_user_hints_t a;
-    scil_user_hints_initialize(&a);
+    const size_t count = scil_dims_get_count(dims);
+    accuracy_range_t ranges[SCIL_MAX_THREADS];
+
+    switch (datatype) {
+        case (SCIL_TYPE_UNKNOWN):
+        case (SCIL_TYPE_BINARY):
+        case (SCIL_TYPE_STRING): {
+            // No relevant comparision
+            scil_user_hints_initialize(out_hints);
+            memset(out_validation, 0, sizeof(scil_validate_params_t));
+            return;
+        }
+        default:
+            break;
+    }
 
-    scil_validate_params_t validation_params;
+    // the ranges are compared concurrently
+    const int thread_count = get_accuracy_thread_count(count);
+    for (int i = 0; i < thread_count; i++) {
+        ranges[i].datatype = datatype;
+        ranges[i].data_1 = data_1;
+        ranges[i].data_2 = data_2;
+        ranges[i].start = count * i / thread_count;
+        ranges[i].end = count * (i + 1) / thread_count;
+        ranges[i].relative_err_finest_abs_tolerance = relative_err_finest_abs_tolerance;
+    }
+    scilU_parallel_run(thread_count, determine_accuracy_task, ranges);
+    scil_error_metrics_t* m = &ranges[0].metrics;
+    for (int i = 1; i < thread_count; i++) {
+        merge_accuracy_metrics(m, &ranges[i].metrics);
+    }
+
+    finish_accuracy(m, count, out_hints, out_validation);
+}
 
-    validation_params.absolute_tolerance_idx = 0;
-    validation_params.relative_tolerance_percent_idx = 0;
-    validation_params.relative_err_finest_abs_tolerance_idx = 0;
-
-    a.absolute_tolerance                = 0;
-    a.relative_err_finest_abs_tolerance = 0;
-    a.relative_tolerance_percent        = 0;
-
-		switch(datatype){
-    		case (SCIL_TYPE_DOUBLE): {
-        		a.significant_bits = MANTISSA_LENGTH_DOUBLE; // in bits
-        		scil_determine_accuracy_double((double*)data_1,
-                                       (double*)data_2,
-                                       scil_dims_get_count(dims),
-                                       relative_err_finest_abs_tolerance,
-                                       &a,
-                                       &validation_params);
-		break;
-    		}
-		case (SCIL_TYPE_FLOAT) : {
-        		a.significant_bits = MANTISSA_LENGTH_FLOAT; // in bits
-        		scil_determine_accuracy_float((float*)data_1,
-                                      (float*)data_2,
-                                      scil_dims_get_count(dims),
-                                      relative_err_finest_abs_tolerance,
-                                      &a,
-                                      &validation_params);
-    		break;
-		}
-		case(SCIL_TYPE_INT8):{
-			a.significant_bits = 8;
-			scil_determine_accuracy_int8_t((int8_t*)data_1, (int8_t*)data_2, scil_dims_get_count(dims), relative_err_finest_abs_tolerance, &a, &validation_params);
-			break;
-		}
-		case(SCIL_TYPE_INT16):{
-			a.significant_bits = 16;
-			scil_determine_accuracy_int16_t((int16_t*)data_1, (int16_t*)data_2, scil_dims_get_count(dims), relative_err_finest_abs_tolerance, &a, &validation_params);
-			break;
-		}
-		case(SCIL_TYPE_INT32):{
-			a.significant_bits = 32;
-			scil_determine_accuracy_int32_t((int32_t*)data_1, (int32_t*)data_2, scil_dims_get_count(dims), relative_err_finest_abs_tolerance, &a, &validation_params);
-			break;
-		}
-		case(SCIL_TYPE_INT64):{
-			a.significant_bits = 64;
-			scil_determine_accuracy_int64_t((int64_t*)data_1, (int64_t*)data_2, scil_dims_get_count(dims), relative_err_finest_abs_tolerance, &a, &validation_params);
-			break;
-		}
-    		case(SCIL_TYPE_UNKNOWN) :
-    		case(SCIL_TYPE_BINARY):
-    		case(SCIL_TYPE_STRING):{
-			// No relevant comparision
-			*out_hints = a;
-			return;
-		}
-		}
+/*
+ * Converts the merged metrics of count values into the accuracy and the error statistics.
+ */
+static void finish_accuracy(const scil_error_metrics_t* m,
+                            const size_t count,
+                            scil_user_hints_t* out_hints,
+                            scil_validate_params_t* out_validation) {
+    scil_user_hints_t a = m->a;
+    scil_validate_params_t v = m->v;
 
     // convert significant_digits in bits to 10 decimals
     a.significant_digits = scilU_convert_significant_bits_to_decimals(a.significant_bits);
@@ -750,16 +1753,39 @@ void scil_determine_accuracy(SCIL_Datatype_t datatype,
         a.relative_err_finest_abs_tolerance = a.absolute_tolerance;
     }
 
-    *out_validation = validation_params;
+    v.count = count;
+    if (count > 0) {
+        v.rmse = sqrt(m->sum_squared_error / count);
+        v.mean_significant_bits = m->sum_significant_bits / count;
+    } else {
+        v.value_min = 0;
+        v.value_max = 0;
+    }
+    if (m->sum_squared_error > 0) {
+        v.psnr = 20 * log10(v.value_max - v.value_min) - 10 * log10(m->sum_squared_error / count);
+    } else {
+        v.psnr = INFINITY;
+    }
+
+    *out_validation = v;
     *out_hints = a;
 }
 
-int scil_validate_compression(SCIL_Datatype_t datatype, const void* restrict data_uncompressed, scil_dims_t* dims, byte* restrict data_compressed, const size_t compressed_size, const scil_context_t* ctx, scil_user_hints_t* out_accuracy, scil_validate_params_t* out_validation) {
+/*
+ * Validates data by decompressing it at once.
+ */
+static int validate_compression_at_once(SCIL_Datatype_t datatype,
+                                        const void* restrict data_uncompressed,
+                                        scil_dims_t* dims,
+                                        byte* restrict data_compressed,
+                                        const size_t compressed_size,
+                                        const scil_context_t* ctx,
+                                        scil_user_hints_t* out_accuracy,
+                                        scil_validate_params_t* out_validation,
+                                        int* out_identical) {
     scil_dims_t* resized_dims = malloc(sizeof(scil_dims_t));
     memset(resized_dims, 0, sizeof(scil_dims_t));
 
-    scil_validate_params_t validation_params;
-
     if(dims->dims > 4){
       resized_dims->dims = 4;
         for(int i=0; i < dims->dims; i++){
@@ -776,79 +1802,384 @@ int scil_validate_compression(SCIL_Datatype_t datatype, const void* restrict dat
           }
         }
     const uint64_t length = scil_get_compressed_data_size_limit(resized_dims, datatype);
+    const size_t size     = scil_dims_get_size(resized_dims, datatype);
     byte* data_out        = (byte*)malloc(length);
     if (data_out == NULL) {
+        free(resized_dims);
         return SCIL_MEMORY_ERR;
     }
+    // values the decompression misses differ from the original
+    memset(data_out, -1, size);
+
+    int ret = scil_decompress(datatype, data_out, resized_dims, data_compressed, compressed_size, &data_out[length / 2]);
+    if (ret == SCIL_NO_ERR) {
+        *out_identical = memcmp(data_out, (byte*)data_uncompressed, size) == 0;
+        // determine achieved accuracy
+        scil_determine_accuracy(datatype, data_out, data_uncompressed, resized_dims, ctx->hints.relative_err_finest_abs_tolerance, out_accuracy, out_validation);
+    }
+    free(data_out);
+    free(resized_dims);
+    return ret;
+}
+
+/*
+ * Checks the accuracy a against the hints h.
+ */
+static int check_accuracy(SCIL_Datatype_t datatype, const scil_user_hints_t* h, const scil_user_hints_t* a) {
+    int ret = SCIL_NO_ERR;
+    if (h->absolute_tolerance > 0.0 && a->absolute_tolerance > h->absolute_tolerance) {
+      if(datatype != SCIL_TYPE_FLOAT || (a->absolute_tolerance - h->absolute_tolerance) > FLT_FINEST_SUB_float){
+        debug("Validation error absolute_tolerance %f > %f\n",
+              a->absolute_tolerance,
+              h->absolute_tolerance);
+        ret = SCIL_PRECISION_ERR;
+      }
+    }
+    if (h->relative_tolerance_percent > 0.0 && a->relative_tolerance_percent > h->relative_tolerance_percent) {
+        debug("Validation error relative_tolerance_percent %f > %f\n",
+              a->relative_tolerance_percent,
+              h->relative_tolerance_percent);
+        ret = SCIL_PRECISION_ERR;
+    }
+    if (h->relative_err_finest_abs_tolerance > 0.0 && a->relative_err_finest_abs_tolerance >
+        h->relative_err_finest_abs_tolerance) {
+        debug(
+            "Validation error relative_err_finest_abs_tolerance %f > %f\n",
+            a->relative_err_finest_abs_tolerance,
+            h->relative_err_finest_abs_tolerance);
+        ret = SCIL_PRECISION_ERR;
+    }
+    if (a->significant_digits < h->significant_digits) {
+        debug("Validation error significant_digits %d < %d\n",
+              a->significant_digits,
+              h->significant_digits);
+        ret = SCIL_PRECISION_ERR;
+    }
+    if (a->significant_bits < h->significant_bits) {
+        debug("Validation error significant_bits %d < %d\n",
+              a->significant_bits,
+              h->significant_bits);
+        ret = SCIL_PRECISION_ERR;
+    }
+    return ret;
+}
+
+typedef struct {
+    SCIL_Datatype_t datatype;
+    const void* original;
+    scil_dims_t* dims;
+    byte* source;
+    const size_t* offsets;
+    size_t slices;
+    size_t block_count;
+    double relative_err_finest_abs_tolerance;
+    scil_error_metrics_t* metrics; // of each block
+
+    pthread_mutex_t lock;
+    size_t next_block;
+    int ret;
+    int identical;
+} block_validation_t;
+
+/*
+ * Decompresses the next unprocessed block into a buffer of the thread and compares it.
+ */
+static void validate_blocks(void* arg, int task) {
+    block_validation_t* job = (block_validation_t*) arg;
+    const size_t value_size = DATATYPE_LENGTH(job->datatype);
+    scil_dims_t block_dims;
+    size_t first;
+    // the first block is the largest
+    get_block_dims(job->dims, job->slices, 0, &block_dims, &first);
+    byte* block = (byte*)scilU_safe_malloc(scil_dims_get_size(&block_dims, job->datatype));
+    byte* tmp = (byte*)scilU_safe_malloc(scil_get_compressed_data_size_limit(&block_dims, job->datatype));
+
+    while (1) {
+        pthread_mutex_lock(&job->lock);
+        const size_t b = job->next_block++;
+        const int failed = job->ret != SCIL_NO_ERR;
+        pthread_mutex_unlock(&job->lock);
+        if (b >= job->block_count || failed) {
+            break;
+        }
+        get_block_dims(job->dims, job->slices, b, &block_dims, &first);
+        const byte* original = (const byte*) job->original + first * value_size;
+        int ret = decompress_chain(job->datatype, block, &block_dims, job->source + job->offsets[b], job->offsets[b + 1] - job->offsets[b], tmp, NULL);
+        if (ret != SCIL_NO_ERR) {
+            pthread_mutex_lock(&job->lock);
+            job->ret = ret;
+            pthread_mutex_unlock(&job->lock);
+            break;
+        }
+
+        accuracy_range_t range;
+        range.datatype = job->datatype;
+        range.data_1 = block;
+        range.data_2 = original;
+        range.start = 0;
+        range.end = scil_dims_get_count(&block_dims);
+        range.relative_err_finest_abs_tolerance = job->relative_err_finest_abs_tolerance;
+        determine_accuracy_range(&range);
+
+        scil_error_metrics_t* m = &job->metrics[b];
+        *m = range.metrics;
+        m->v.absolute_tolerance_idx += first;
+        m->v.relative_tolerance_percent_idx += first;
+        m->v.relative_err_finest_abs_tolerance_idx += first;
+
+        if (memcmp(block, original, scil_dims_get_size(&block_dims, job->datatype)) != 0) {
+            pthread_mutex_lock(&job->lock);
+            job->identical = 0;
+            pthread_mutex_unlock(&job->lock);
+        }
+    }
+    free(block);
+    free(tmp);
+}
+
+/*
+ * Validates data in the block format, the blocks are processed concurrently.
+ * Each thread holds one decompressed block at a time.
+ */
+static int validate_compression_blocks(SCIL_Datatype_t datatype,
+                                       const void* restrict data_uncompressed,
+                                       scil_dims_t* dims,
+                                       byte* restrict data_compressed,
+                                       const size_t compressed_size,
+                                       const scil_context_t* ctx,
+                                       scil_user_hints_t* out_accuracy,
+                                       scil_validate_params_t* out_validation,
+                                       int* out_identical) {
+    block_validation_t job;
+    memset(&job, 0, sizeof(job));
+    size_t* offsets;
+    int ret = read_block_offsets(data_compressed, compressed_size, dims, &job.slices, &job.block_count, &offsets);
+    if (ret != SCIL_NO_ERR) {
+        return ret;
+    }
+    job.datatype = datatype;
+    job.original = data_uncompressed;
+    job.dims = dims;
+    job.source = data_compressed;
+    job.offsets = offsets;
+    job.relative_err_finest_abs_tolerance = ctx->hints.relative_err_finest_abs_tolerance;
+    job.metrics = (scil_error_metrics_t*)scilU_safe_malloc(job.block_count * sizeof(scil_error_metrics_t));
+    job.ret = SCIL_NO_ERR;
+    job.identical = 1;
+    pthread_mutex_init(&job.lock, NULL);
+
+    int thread_count = scilU_get_thread_count();
+    if ((size_t) thread_count > job.block_count) thread_count = (int) job.block_count;
+
+    // each task takes the next block until all are validated
+    scilU_parallel_run(thread_count, validate_blocks, &job);
+    pthread_mutex_destroy(&job.lock);
+
+    ret = job.ret;
+    if (ret == SCIL_NO_ERR) {
+        scil_error_metrics_t* m = &job.metrics[0];
+        for (size_t b = 1; b < job.block_count; b++) {
+            merge_accuracy_metrics(m, &job.metrics[b]);
+        }
+        finish_accuracy(m, scil_dims_get_count(dims), out_accuracy, out_validation);
+        *out_identical = job.identical;
+    }
+    free(job.metrics);
+    free(offsets);
+    return ret;
+}
+
+int scil_validate_compression(SCIL_Datatype_t datatype, const void* restrict data_uncompressed, scil_dims_t* dims, byte* restrict data_compressed, const size_t compressed_size, const scil_context_t* ctx, scil_user_hints_t* out_accuracy, scil_validate_params_t* out_validation) {
+    scil_validate_params_t validation_params;
+    memset(&validation_params, 0, sizeof(scil_validate_params_t));
     scil_user_hints_t a;
     scil_user_hints_initialize(&a);
+    int identical = 0;
+    int ret;
 
-    memset(data_out, -1, length);
-
-    int ret = scil_decompress(datatype, data_out, resized_dims, data_compressed, compressed_size, &data_out[length / 2]);
-    if (ret != 0) {
+    if (compressed_size > 0 && data_compressed[0] == SCIL_BLOCK_MARKER) {
+        ret = validate_compression_blocks(datatype, data_uncompressed, dims, data_compressed, compressed_size, ctx, &a, &validation_params, &identical);
+    } else {
+        ret = validate_compression_at_once(datatype, data_uncompressed, dims, data_compressed, compressed_size, ctx, &a, &validation_params, &identical);
+    }
+    if (ret != SCIL_NO_ERR) {
         goto end;
     }
 
     if (ctx->lossless_compression_needed) {
         // check bytes for identity
-        ret = memcmp(data_out, (byte*)data_uncompressed, length);
-
-        if (!ctx->lossless_compression_needed) {
-            printf(
-                "INFO: can check only for identical data as data is not a "
-                "multiple of DataType\n");
-        } else {
-            scil_determine_accuracy( datatype, data_out, data_uncompressed, resized_dims, ctx->hints.relative_err_finest_abs_tolerance, &a, &validation_params);
-        }
-        goto end;
+        ret = identical ? SCIL_NO_ERR : SCIL_PRECISION_ERR;
     } else {
-        // determine achieved accuracy
-        scil_determine_accuracy(datatype, data_out, data_uncompressed, resized_dims, ctx->hints.relative_err_finest_abs_tolerance, &a, &validation_params);
-
-        const scil_user_hints_t h = ctx->hints;
-
         // check if tolerance level is met:
-        ret = SCIL_NO_ERR;
-        if (h.absolute_tolerance > 0.0 && a.absolute_tolerance > h.absolute_tolerance) {
-          if(datatype != SCIL_TYPE_FLOAT || (a.absolute_tolerance - h.absolute_tolerance) > FLT_FINEST_SUB_float){
-            debug("Validation error absolute_tolerance %f > %f\n",
-                  a.absolute_tolerance,
-                  h.absolute_tolerance);
-            ret = SCIL_PRECISION_ERR;
-          }
-        }
-        if (h.relative_tolerance_percent > 0.0 && a.relative_tolerance_percent > h.relative_tolerance_percent) {
-            debug("Validation error relative_tolerance_percent %f > %f\n",
-                  a.relative_tolerance_percent,
-                  h.relative_tolerance_percent);
-            ret = SCIL_PRECISION_ERR;
-        }
-        if (h.relative_err_finest_abs_tolerance > 0.0 && a.relative_err_finest_abs_tolerance >
-            h.relative_err_finest_abs_tolerance) {
-            debug(
-                "Validation error relative_err_finest_abs_tolerance %f > %f\n",
-                a.relative_err_finest_abs_tolerance,
-                h.relative_err_finest_abs_tolerance);
-            ret = SCIL_PRECISION_ERR;
-        }
-        if (a.significant_digits < h.significant_digits) {
-            debug("Validation error significant_digits %d < %d\n",
-                  a.significant_digits,
-                  h.significant_digits);
-            ret = SCIL_PRECISION_ERR;
-        }
-        if (a.significant_bits < h.significant_bits) {
-            debug("Validation error significant_bits %d < %d\n",
-                  a.significant_bits,
-                  h.significant_bits);
-            ret = SCIL_PRECISION_ERR;
-        }
+        ret = check_accuracy(datatype, &ctx->hints, &a);
     }
 end:
-    free(data_out);
     *out_validation = validation_params;
     *out_accuracy = a;
 
     return ret;
 }
+
+struct scilC_verification {
+    pthread_mutex_t lock;
+    int active;   // the encoders of the current chain report their values
+    int complete; // all values of the last compression were verified
+    size_t count; // number of values verified
+    scil_error_metrics_t metrics;
+    scil_user_hints_t achieved;
+};
+
+scilC_verification_t* scilC_verification_create() {
+    scilC_verification_t* v = (scilC_verification_t*)scilU_safe_malloc(sizeof(scilC_verification_t));
+    memset(v, 0, sizeof(scilC_verification_t));
+    pthread_mutex_init(&v->lock, NULL);
+    return v;
+}
+
+void scilC_verification_destroy(scilC_verification_t* v) {
+    if (v == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&v->lock);
+    free(v);
+}
+
+int scilC_verify_enabled(const scil_context_t* ctx) {
+    return ctx->verification != NULL && ctx->verification->active;
+}
+
+void scilC_verify(const scil_context_t* ctx, const void* original, const void* reconstructed, size_t count) {
+    scilC_verification_t* v = ctx->verification;
+    if (v == NULL || !v->active || count == 0) {
+        return;
+    }
+    // only the errors the hints bound are needed
+    scil_error_metrics_t m;
+    initialize_accuracy_metrics(&m, ctx->datatype);
+    const double finest = ctx->hints.relative_err_finest_abs_tolerance;
+    switch (ctx->datatype) {
+        case (SCIL_TYPE_DOUBLE):
+            scil_determine_max_error_double((const double*)reconstructed, (const double*)original, count, finest, &m.a);
+            break;
+        case (SCIL_TYPE_FLOAT):
+            scil_determine_max_error_float((const float*)reconstructed, (const float*)original, count, finest, &m.a);
+            break;
+        default: {
+            accuracy_range_t range;
+            range.datatype = ctx->datatype;
+            range.data_1 = reconstructed;
+            range.data_2 = original;
+            range.start = 0;
+            range.end = count;
+            range.relative_err_finest_abs_tolerance = finest;
+            determine_accuracy_range(&range);
+            m = range.metrics;
+        }
+    }
+
+    pthread_mutex_lock(&v->lock);
+    merge_accuracy_metrics(&v->metrics, &m);
+    v->count += count;
+    pthread_mutex_unlock(&v->lock);
+}
+
+static void verification_reset(scil_context_t* ctx) {
+    scilC_verification_t* v = ctx->verification;
+    initialize_accuracy_metrics(&v->metrics, ctx->datatype);
+    v->active = 0;
+    v->complete = 1;
+    v->count = 0;
+}
+
+/*
+ * The encoders of a lossy chain verify the values unless a preconditioner changes them before.
+ */
+static size_t verification_begin_chain(scil_context_t* ctx) {
+    scilC_verification_t* v = ctx->verification;
+    if (v == NULL) {
+        return 0;
+    }
+    v->active = ctx->chain.is_lossy && ctx->chain.precond_first_count == 0;
+    return v->count;
+}
+
+static void verification_end_chain(scil_context_t* ctx, size_t verified_before, size_t count) {
+    scilC_verification_t* v = ctx->verification;
+    if (v == NULL) {
+        return;
+    }
+    if (!ctx->chain.is_lossy) {
+        // the values are preserved
+        v->count += count;
+    } else if (v->count - verified_before != count) {
+        debug("The chain did not verify its values\n");
+        v->complete = 0;
+    }
+    v->active = 0;
+}
+
+// adds the values verified by another task
+static void verification_merge(scil_context_t* ctx, const scil_context_t* task) {
+    scilC_verification_t* v = ctx->verification;
+    const scilC_verification_t* t = task->verification;
+    merge_accuracy_metrics(&v->metrics, &t->metrics);
+    v->count += t->count;
+    v->complete = v->complete && t->complete;
+}
+
+/*
+ * If the encoders did not verify all values, e.g., as a preconditioner changed them
+ * or the chain does not report its values, the compressed data is decompressed and compared.
+ */
+static int verification_check(scil_context_t* ctx, const void* source, scil_dims_t* dims, byte* compressed, size_t compressed_size) {
+    scilC_verification_t* v = ctx->verification;
+    if (!v->complete) {
+        debug("Verifying by decompression\n");
+        const size_t size = scil_dims_get_size(dims, ctx->datatype);
+        const size_t tmp_size = scil_get_compressed_data_size_limit(dims, ctx->datatype);
+        byte* reconstructed = (byte*)scilU_safe_malloc(size + tmp_size);
+        stats_add_scratch(ctx->stats, size + tmp_size);
+        int ret = decompress_any(ctx->datatype, reconstructed, dims, compressed, compressed_size, reconstructed + size, NULL);
+        if (ret == SCIL_NO_ERR) {
+            scil_validate_params_t params;
+            scil_determine_accuracy(ctx->datatype, reconstructed, source, dims, ctx->hints.relative_err_finest_abs_tolerance, &v->achieved, &params);
+            v->complete = 1;
+        }
+        free(reconstructed);
+        return ret == SCIL_NO_ERR ? check_accuracy(ctx->datatype, &ctx->hints, &v->achieved) : ret;
+    }
+    scil_validate_params_t params;
+    finish_accuracy(&v->metrics, v->count, &v->achieved, &params);
+    return check_accuracy(ctx->datatype, &ctx->hints, &v->achieved);
+}
+
+// the context keeps the result of the last call
+static void verification_publish(scil_context_t* ctx, const scil_context_t* call, int ret) {
+    scilC_verification_t* v = ctx->verification;
+    pthread_mutex_lock(&v->lock);
+    v->complete = call->verification->complete && (ret == SCIL_NO_ERR || ret == SCIL_PRECISION_ERR);
+    v->achieved = call->verification->achieved;
+    pthread_mutex_unlock(&v->lock);
+}
+
+int scil_get_compress_stats(const scil_context_t* ctx, scil_compress_stats_t* out_stats) {
+    if (ctx->stats == NULL) {
+        return SCIL_EINVAL;
+    }
+    pthread_mutex_lock(ctx->lock);
+    *out_stats = *ctx->stats;
+    pthread_mutex_unlock(ctx->lock);
+    return SCIL_NO_ERR;
+}
+
+int scil_get_verified_accuracy(const scil_context_t* ctx, scil_user_hints_t* out_accuracy) {
+    scilC_verification_t* v = ctx->verification;
+    if (v == NULL) {
+        return SCIL_EINVAL;
+    }
+    pthread_mutex_lock(&v->lock);
+    const int complete = v->complete;
+    *out_accuracy = v->achieved;
+    pthread_mutex_unlock(&v->lock);
+    return complete ? SCIL_NO_ERR : SCIL_EINVAL;
+}
@@ -353,6 +353,49 @@ void scil_compression_sprint_last_algorithm_chain(scil_context_t* ctx,
                                                   char* out,
                                                   int buff_length);
 
+/**
+ * \brief Sets the number of threads the library uses for parallel work,
+ * including the calling thread. All parallel code paths share one thread pool.
+ * \details The default is the environment variable SCIL_THREADS or else the
+ * number of online processors. Applications that run SCIL from several threads
+ * themselves, e.g., in an OpenMP parallel region, should use 1 to avoid
+ * oversubscribing the cores.
+ * \param count number of threads, 1 for serial processing, 0 for the default
+ * \return SCIL_NO_ERR, SCIL_EINVAL if count is negative
+ */
+int scil_set_threads(int count);
+
+// Upper bound for the number of stages scil_compress_stats_t reports
+#define SCIL_STATS_MAX_STAGES 24
+
+/**
+ \brief Measurements of one algorithm of the chain.
+ Data compressed in blocks or with a mask may run an algorithm several times,
+ the values are summed up.
+ */
+typedef struct{
+  const char* name;
+  uint8_t compressor_id;
+  size_t runs;
+  double seconds;
+  size_t input_bytes;
+  size_t output_bytes;
+  size_t header_bytes; // the header and the compressor id the pipeline stores for the algorithm
+} scil_stage_stats_t;
+
+/**
+ \brief Measurements of a call of scil_compress() or scil_decompress_with_stats().
+ */
+typedef struct scil_compress_stats{
+  int stage_count;
+  scil_stage_stats_t stages[SCIL_STATS_MAX_STAGES]; // in the order of processing
+  double seconds;
+  double chooser_seconds; // choice of the chain and measurements of the online chooser
+  size_t input_bytes;
+  size_t output_bytes;
+  size_t scratch_bytes; // intermediate results of the stages and temporary buffers, summed up
+} scil_compress_stats_t;
+
 /**
  * \brief Method to compress a data buffer
  * \param dest Destination of the compressed buffer
@@ -397,6 +440,30 @@ int scil_decompress(SCIL_Datatype_t datatype,
                     const size_t source_size,
                     byte* restrict tmp_buff);
 
+/**
+ * \brief Decompresses like scil_decompress() and measures each stage.
+ * \param stats receives the measurements, NULL to skip them
+ */
+int scil_decompress_with_stats(SCIL_Datatype_t datatype,
+                               void* restrict dest,
+                               scil_dims_t* expected_dims,
+                               byte* restrict source,
+                               const size_t source_size,
+                               byte* restrict tmp_buff,
+                               scil_compress_stats_t* stats);
+
+/**
+ \brief Returns the measurements of the last call of scil_compress() for a
+ context with statistics, see scil_context_set_stats().
+ \return SCIL_NO_ERR, SCIL_EINVAL if the statistics are disabled
+ */
+int scil_get_compress_stats(const scil_context_t* ctx, scil_compress_stats_t* out_stats);
+
+/**
+ \brief Compares data_1 to the reference data_2 in one pass.
+ out_hints contains the largest errors found, out_validation their positions
+ and the error statistics. Large data is compared by multiple threads.
+ */
 void scil_determine_accuracy(SCIL_Datatype_t datatype,
                              const void* restrict data_1,
                              const void* restrict data_2,
@@ -405,11 +472,22 @@ void scil_determine_accuracy(SCIL_Datatype_t datatype,
                              scil_user_hints_t *out_hints,
                              scil_validate_params_t *out_validation);
 
+/**
+ \brief Returns the accuracy achieved by the last call of scil_compress() for a
+ context with verification, see scil_context_set_verification().
+ \return SCIL_NO_ERR, SCIL_EINVAL if the verification is disabled or the chain
+ could not verify its values. scil_validate_compression() determines the
+ accuracy in that case.
+ */
+int scil_get_verified_accuracy(const scil_context_t* ctx, scil_user_hints_t *out_accuracy);
+
 /**
  \brief Test method: check if the conditions as specified by ctx are met by
  comparing compressed and decompressed data.
  out_accuracy contains a set of hints with the observed finest
  resolution/required precision to accept the data.
+ Data compressed in blocks, see scil_context_set_block_size(), is decompressed
+ and compared block by block by multiple threads, each holding a single block.
  */
 int scil_validate_compression(SCIL_Datatype_t datatype,
                               const void* restrict data_uncompressed,
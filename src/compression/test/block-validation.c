@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  Data compressed in blocks is validated block by block.
+    The metrics must match the comparison of the data decompressed at once.
+*/
+
+static int compress(scil_context_t * ctx, float * data, scil_dims_t * dims, byte ** out, size_t * out_size){
+    const size_t size = scil_get_compressed_data_size_limit(dims, SCIL_TYPE_FLOAT);
+    *out = (byte*)malloc(size);
+    int ret = scil_compress(*out, size, data, dims, out_size, ctx);
+    if (ret != SCIL_NO_ERR){
+        printf("Error compressing: %d\n", ret);
+    }
+    return ret != SCIL_NO_ERR;
+}
+
+static int check_lossy(float * data, scil_dims_t * dims){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.001;
+    hints.force_compression_methods = "abstol";
+    scil_context_t* ctx;
+    scil_context_create(&ctx, SCIL_TYPE_FLOAT, 0, NULL, &hints);
+    // two slices of 100x100 per block, the last block holds a single slice
+    scil_context_set_block_size(ctx, 15000);
+
+    byte * compressed;
+    size_t compressed_size;
+    if (compress(ctx, data, dims, &compressed, &compressed_size)){
+        return 1;
+    }
+
+    const size_t count = scil_dims_get_count(dims);
+    float* decompressed = (float*)malloc(count * sizeof(float));
+    byte* tmp = (byte*)malloc(scil_get_compressed_data_size_limit(dims, SCIL_TYPE_FLOAT));
+    int ret = scil_decompress(SCIL_TYPE_FLOAT, decompressed, dims, compressed, compressed_size, tmp);
+
+    scil_user_hints_t expected;
+    scil_validate_params_t expected_v;
+    scil_determine_accuracy(SCIL_TYPE_FLOAT, decompressed, data, dims, hints.relative_err_finest_abs_tolerance, &expected, &expected_v);
+
+    scil_user_hints_t a;
+    scil_validate_params_t v;
+    int ret_v = scil_validate_compression(SCIL_TYPE_FLOAT, data, dims, compressed, compressed_size, ctx, &a, &v);
+
+    printf("lossy,%d,%d,%g,%g,%zu,%zu,%g,%g\n", ret, ret_v, a.absolute_tolerance, expected.absolute_tolerance, v.absolute_tolerance_idx, expected_v.absolute_tolerance_idx, v.rmse, expected_v.rmse);
+    int errors = ret != SCIL_NO_ERR || ret_v != SCIL_NO_ERR;
+    errors += compressed[0] != 254;
+    errors += ! (a.absolute_tolerance <= expected.absolute_tolerance && a.absolute_tolerance >= expected.absolute_tolerance);
+    errors += a.significant_bits != expected.significant_bits;
+    errors += v.absolute_tolerance_idx != expected_v.absolute_tolerance_idx;
+    errors += v.relative_tolerance_percent_idx != expected_v.relative_tolerance_percent_idx;
+    errors += v.count != count;
+    errors += fabs(v.rmse - expected_v.rmse) > 1e-9;
+    errors += memcmp(v.error_histogram, expected_v.error_histogram, sizeof(v.error_histogram)) != 0;
+
+    free(tmp);
+    free(decompressed);
+    free(compressed);
+    scil_destroy_context(ctx);
+    return errors;
+}
+
+static int check_lossless(float * data, scil_dims_t * dims){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = SCIL_ACCURACY_DBL_FINEST;
+    hints.force_compression_methods = "memcopy";
+    scil_context_t* ctx;
+    scil_context_create(&ctx, SCIL_TYPE_FLOAT, 0, NULL, &hints);
+    scil_context_set_block_size(ctx, 100000);
+
+    byte * compressed;
+    size_t compressed_size;
+    if (compress(ctx, data, dims, &compressed, &compressed_size)){
+        return 1;
+    }
+    scil_user_hints_t a;
+    scil_validate_params_t v;
+    int ret = scil_validate_compression(SCIL_TYPE_FLOAT, data, dims, compressed, compressed_size, ctx, &a, &v);
+    // change a value of the last block
+    compressed[compressed_size - 8] ^= 1;
+    int ret_changed = scil_validate_compression(SCIL_TYPE_FLOAT, data, dims, compressed, compressed_size, ctx, &a, &v);
+    printf("lossless,%d,%d\n", ret, ret_changed);
+
+    free(compressed);
+    scil_destroy_context(ctx);
+    return ret != SCIL_NO_ERR || ret_changed != SCIL_PRECISION_ERR;
+}
+
+int main(void){
+    scil_dims_t dims;
+    scil_dims_initialize_3d(&dims, 100, 100, 201);
+    const size_t count = scil_dims_get_count(&dims);
+    float* data = (float*)malloc(count * sizeof(float));
+    for(size_t i = 0; i < count; ++i){
+        data[i] = (float) (sin((double) i * 0.0001) * 10.0);
+    }
+    printf("#Case,Return code,Return code of validation,...\n");
+    int errors = check_lossy(data, &dims);
+    errors += check_lossless(data, &dims);
+    free(data);
+    return errors;
+}
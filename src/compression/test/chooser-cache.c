@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  The chooser caches its decision per variable name.
+    The randomness of the data is only estimated from its beginning, thus noise at the
+    beginning changes the decision unless a cached decision for the variable exists.
+    A decision is reconsidered if the statistics of the data drift.
+*/
+
+static const char * config =
+    "!storage 100\n"
+    "0; memcopy; 10000; 10000; 1\n"
+    "100; memcopy; 10000; 10000; 1\n"
+    "0; lz4; 3000; 6000; 0.3\n"
+    "100; lz4; 3000; 6000; 1\n";
+
+static const char * mapping =
+    "variable,compressor\n"
+    "mapped,zstd\n";
+
+static int check(const char * expected, const char * name, float * data, size_t count){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+
+    scil_context_t* context;
+    int ret = scil_context_create(&context, SCIL_TYPE_FLOAT, 0, NULL, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+    if (name != NULL){
+        scil_context_set_variable_name(context, name);
+    }
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+    size_t compressed_size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_FLOAT);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+
+    size_t out_size;
+    ret = scil_compress(buffer_out, compressed_size, data, &dims, &out_size, context);
+
+    char chain[1024];
+    scil_compression_sprint_last_algorithm_chain(context, chain, 1024);
+    printf("%s,%s,%d,%s\n", expected, name ? name : "", ret, chain);
+
+    free(buffer_out);
+    scil_destroy_context(context);
+    return ret != SCIL_NO_ERR || strcmp(chain, expected) != 0;
+}
+
+static int write_file(char * filename, const char * content){
+    int fd = mkstemp(filename);
+    if (fd < 0 || write(fd, content, strlen(content)) != (ssize_t) strlen(content)){
+        printf("Error writing %s\n", filename);
+        return 1;
+    }
+    close(fd);
+    return 0;
+}
+
+int main(void){
+    char config_file[] = "/tmp/scil-cache-XXXXXX";
+    char mapping_file[] = "/tmp/scil-mapping-XXXXXX";
+    if (write_file(config_file, config) || write_file(mapping_file, mapping)){
+        return 1;
+    }
+    setenv("SCIL_SYSTEM_CHARACTERISTICS_FILE", config_file, 1);
+    setenv("SCIL_VARIABLE_MAPPING_FILE", mapping_file, 1);
+    unsetenv("H5REPACK_VARIABLE");
+
+    const size_t count = 1000000;
+    float* periodic = (float*)malloc(count * sizeof(float));
+    float* noisy = (float*)malloc(count * sizeof(float));
+    float* scaled = (float*)malloc(count * sizeof(float));
+    srand(1);
+    for(size_t i = 0; i < count; ++i){
+        periodic[i] = (float) (i % 1000) * 0.01f;
+        noisy[i] = i < 10000 ? (float) (rand() % 1000) * 0.01f : periodic[i];
+        scaled[i] = noisy[i] * 10.0f;
+    }
+
+    printf("#Expected,Variable,Return code,Chain\n");
+    int errors = 0;
+    // without a name nothing is cached and the noise decides
+    errors += check("lz4", NULL, periodic, count);
+    errors += check("memcopy", NULL, noisy, count);
+
+    errors += check("lz4", "temperature", periodic, count);
+    // the statistics are similar, the cached decision is reused
+    errors += check("lz4", "temperature", noisy, count);
+    // but not for another variable
+    errors += check("memcopy", "pressure", noisy, count);
+    // the value range changed, the chain is chosen again
+    errors += check("memcopy", "temperature", scaled, count);
+
+    // the mapping file takes precedence
+    errors += check("zstd", "mapped", periodic, count);
+
+    unlink(config_file);
+    unlink(mapping_file);
+    free(periodic);
+    free(noisy);
+    free(scaled);
+    return errors;
+}
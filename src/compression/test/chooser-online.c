@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  The online chooser tries every candidate chain once and then converges on the
+    chain with the best observed performance, while it occasionally explores.
+    Without configuration the candidates are memcopy, lz4 and zstd.
+    The learned statistics are written at exit and serve as prior for the next run.
+    Every run is checked in its own process, as the chooser is initialized once.
+*/
+
+#define CALLS 40
+
+static const char * prior =
+    "100; 1; online; memcopy; 5000; 5000; 1\n"
+    "100; 1; online; lz4; 10; 20; 1\n"
+    "100; 1; online; zstd; 1; 10; 1\n";
+
+static int run(const char * exploration, const char * objective, int noise, const char * chain_name, int min_hits, int max_hits, const char * filename){
+    setenv("SCIL_CHOOSER_ONLINE", exploration, 1);
+    setenv("SCIL_CHOOSER_OBJECTIVE", objective, 1);
+    setenv("SCIL_CHOOSER_ONLINE_FILE", filename, 1);
+
+    const size_t count = 100000;
+    float* buffer_in = (float*)malloc(count * sizeof(float));
+    for(size_t i = 0; i < count; ++i){
+        buffer_in[i] = (float) (i % 1000) * 0.5f;
+        if (noise){
+            int r = rand();
+            memcpy(& buffer_in[i], & r, sizeof(float));
+        }
+    }
+
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    scil_context_t* context;
+    int ret = scil_context_create(&context, SCIL_TYPE_FLOAT, 0, NULL, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+    size_t compressed_size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_FLOAT);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+
+    int hits = 0;
+    for(int i = 0; i < CALLS; i++){
+        size_t out_size;
+        ret = scil_compress(buffer_out, compressed_size, buffer_in, &dims, &out_size, context);
+        if (ret != SCIL_NO_ERR){
+            printf("Error compressing: %d\n", ret);
+            return 1;
+        }
+        char chain[1024];
+        scil_compression_sprint_last_algorithm_chain(context, chain, 1024);
+        hits += strcmp(chain, chain_name) == 0;
+    }
+    printf("%s,%s,%d,%s,%d,%d,%d\n", exploration, objective, noise, chain_name, min_hits, max_hits, hits);
+
+    free(buffer_in);
+    free(buffer_out);
+    scil_destroy_context(context);
+    return hits < min_hits || hits > max_hits;
+}
+
+static int run_in_child(const char * exploration, const char * objective, int noise, const char * chain_name, int min_hits, int max_hits, const char * filename){
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0){
+        exit(run(exploration, objective, noise, chain_name, min_hits, max_hits, filename));
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return ! WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
+
+static int file_contains(const char * filename, const char * text){
+    FILE * f = fopen(filename, "r");
+    if (f == NULL){
+        return 0;
+    }
+    char line[1024];
+    int found = 0;
+    while (fgets(line, sizeof(line), f) != NULL){
+        found |= strstr(line, text) != NULL;
+    }
+    fclose(f);
+    return found;
+}
+
+int main(void){
+    char filename[] = "/tmp/scil-online-XXXXXX";
+    int fd = mkstemp(filename);
+    if (fd < 0){
+        printf("Error creating the file\n");
+        return 1;
+    }
+    close(fd);
+    unlink(filename);
+    // no configuration, the default candidates are used
+    setenv("SCIL_SYSTEM_CHARACTERISTICS_FILE", "/nonexistent/scil.conf", 1);
+
+    printf("#Exploration,Objective,Noise,Chain,Minimum,Maximum,Hits\n");
+    int errors = 0;
+    // the warm up tries each of the three chains, then zstd compresses best
+    errors += run_in_child("0.1", "ratio", 0, "zstd", CALLS / 2, CALLS, filename);
+    if (! file_contains(filename, "; zstd;") || ! file_contains(filename, "; memcopy;")){
+        printf("Error: the statistics are not saved\n");
+        errors++;
+    }
+    // without exploration the prior of the file decides from the first call
+    errors += run_in_child("0", "ratio", 0, "zstd", CALLS, CALLS, filename);
+    unlink(filename);
+
+    // a prior in which memcopy is by far the fastest chain for random floats, the
+    // observations of a loaded machine must not change the decision
+    FILE * f = fopen(filename, "w");
+    fprintf(f, "%s", prior);
+    fclose(f);
+    errors += run_in_child("0", "speed", 1, "memcopy", CALLS, CALLS, filename);
+    unlink(filename);
+    return errors;
+}
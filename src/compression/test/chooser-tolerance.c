@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  Entries of lossy chains measured with a tolerance, e.g., the Pareto fronts of
+    scil-bench-pareto, apply if the requested tolerance is the same or coarser.
+    The entry with the closest tolerance describes the chain.
+*/
+
+static const char * config =
+    "!storage 100\n"
+    "0; 0; any; lz4; 3000; 6000; 0.5\n"
+    "0; 2; any; abstol,lz4; 1000; 2000; 0.2; abs=0.001\n"
+    "0; 2; any; abstol,lz4; 1000; 2000; 0.05; abs=0.1\n"
+    "0; 2; any; quantize,lz4; 1000; 2000; 0.1; abs=0.01\n"
+    "0; sigbits,lz4; 1000; 2000; 0.1; bits=10\n";
+
+static int check(const char * expected, scil_user_hints_t * hints, double * data, size_t count){
+    scil_context_t* context;
+    int ret = scil_context_create(&context, SCIL_TYPE_DOUBLE, 0, NULL, hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+    size_t compressed_size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_DOUBLE);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+
+    size_t out_size;
+    ret = scil_compress(buffer_out, compressed_size, data, &dims, &out_size, context);
+
+    char chain[1024];
+    scil_compression_sprint_last_algorithm_chain(context, chain, 1024);
+    printf("%s,%d,%s\n", expected, ret, chain);
+
+    free(buffer_out);
+    scil_destroy_context(context);
+    return ret != SCIL_NO_ERR || strcmp(chain, expected) != 0;
+}
+
+int main(void){
+    char filename[] = "/tmp/scil-chooser-XXXXXX";
+    int fd = mkstemp(filename);
+    if (fd < 0 || write(fd, config, strlen(config)) != (ssize_t) strlen(config)){
+        printf("Error writing the configuration\n");
+        return 1;
+    }
+    close(fd);
+    setenv("SCIL_SYSTEM_CHARACTERISTICS_FILE", filename, 1);
+
+    const size_t count = 10000;
+    double* smooth = (double*)malloc(count * sizeof(double));
+    for(size_t i = 0; i < count; ++i){
+        smooth[i] = (double) (i / 500);
+    }
+
+    printf("#Expected,Return code,Chain\n");
+    int errors = 0;
+    scil_user_hints_t hints;
+
+    // abstol at 0.001 and quantize at 0.01 meet the tolerance, quantize is faster
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.01;
+    errors += check("quantize,lz4", &hints, smooth, count);
+
+    // the entry of abstol at 0.1 is closer and compresses better
+    hints.absolute_tolerance = 0.1;
+    errors += check("abstol,lz4", &hints, smooth, count);
+
+    // no lossy chain was measured with such a fine tolerance
+    hints.absolute_tolerance = 0.0001;
+    errors += check("lz4", &hints, smooth, count);
+
+    // the entry of sigbits keeps more bits than requested
+    scil_user_hints_initialize(&hints);
+    hints.significant_bits = 8;
+    errors += check("sigbits,lz4", &hints, smooth, count);
+
+    hints.significant_bits = 16;
+    errors += check("lz4", &hints, smooth, count);
+
+    unlink(filename);
+    free(smooth);
+    return errors;
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <scil.h>
+#include <scil-util.h>
+#include <scil-counters.h>
+
+/*  The trial chooser compresses a sample of the data with the best ranked chains
+    of the configuration and picks the best one for the objective.
+    Every objective is checked in its own process, as the chooser reads it once.
+    The counters include only the calls of the user, not the trials.
+*/
+
+static const char * config =
+    "0; memcopy; 10000; 10000; 1\n"
+    "100; memcopy; 10000; 10000; 1\n"
+    "0; lz4; 3000; 6000; 0.5\n"
+    "100; lz4; 3000; 6000; 1\n"
+    "0; zstd; 300; 1000; 0.4\n"
+    "100; zstd; 300; 1000; 1\n"
+    "0; zstd-22; 5; 1000; 0.3\n"
+    "100; zstd-22; 5; 1000; 1\n";
+
+static int check(const char * objective, const char * rejected, scil_dims_t * dims){
+    setenv("SCIL_CHOOSER_TRIAL", "4", 1);
+    setenv("SCIL_CHOOSER_OBJECTIVE", objective, 1);
+
+    const size_t count = scil_dims_get_count(dims);
+    float* buffer_in = (float*)malloc(count * sizeof(float));
+    float* buffer_end = (float*)malloc(count * sizeof(float));
+    for(size_t i = 0; i < count; ++i){
+        buffer_in[i] = (float) ((i / 7) % 1000) + (float) (i % 3) * 0.25f;
+    }
+
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    scil_context_t* context;
+    int ret = scil_context_create(&context, SCIL_TYPE_FLOAT, 0, NULL, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+
+    scilU_counters_set_enabled(1);
+    size_t compressed_size = scil_get_compressed_data_size_limit(dims, SCIL_TYPE_FLOAT);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+    byte* buffer_tmp = (byte*)malloc(compressed_size);
+    size_t out_size;
+    ret = scil_compress(buffer_out, compressed_size, buffer_in, dims, &out_size, context);
+    if (ret == SCIL_NO_ERR){
+        ret = scil_decompress(SCIL_TYPE_FLOAT, buffer_end, dims, buffer_out, out_size, buffer_tmp);
+    }
+
+    char chain[1024];
+    scil_compression_sprint_last_algorithm_chain(context, chain, 1024);
+    printf("%s,%d,%zu,%s\n", objective, dims->dims, out_size, chain);
+
+    int errors = ret != SCIL_NO_ERR;
+    if (memcmp(buffer_in, buffer_end, count * sizeof(float)) != 0){
+        printf("Error: data differs\n");
+        errors++;
+    }
+    if (strstr(rejected, chain) != NULL){
+        printf("Error: %s must not be chosen\n", chain);
+        errors++;
+    }
+    scilU_counter_t* counters;
+    const int counter_count = scilU_counters_collect(&counters);
+    for(int i = 0; i < counter_count; i++){
+        if ((strcmp(counters[i].name, "call:compress") == 0 || strcmp(counters[i].name, "call:decompress") == 0) && counters[i].calls != 1){
+            printf("Error: %llu calls counted for %s\n", (unsigned long long) counters[i].calls, counters[i].name);
+            errors++;
+        }
+    }
+    free(counters);
+
+    free(buffer_in);
+    free(buffer_end);
+    free(buffer_out);
+    free(buffer_tmp);
+    scil_destroy_context(context);
+    return errors;
+}
+
+static int run_in_child(const char * objective, const char * rejected, scil_dims_t * dims){
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0){
+        exit(check(objective, rejected, dims));
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return ! WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
+
+int main(void){
+    char filename[] = "/tmp/scil-trial-XXXXXX";
+    int fd = mkstemp(filename);
+    if (fd < 0 || write(fd, config, strlen(config)) != (ssize_t) strlen(config)){
+        printf("Error writing the configuration\n");
+        return 1;
+    }
+    close(fd);
+    setenv("SCIL_SYSTEM_CHARACTERISTICS_FILE", filename, 1);
+
+    scil_dims_t dims_3d;
+    scil_dims_initialize_3d(&dims_3d, 200, 150, 100);
+    scil_dims_t dims_1d;
+    scil_dims_initialize_1d(&dims_1d, 3000017);
+
+    printf("#Objective,Dimensions,Compressed size,Chain\n");
+    int errors = 0;
+    // the byte compressors that do not compress well must lose
+    errors += run_in_child("ratio", "memcopy,lz4", &dims_3d);
+    errors += run_in_child("ratio", "memcopy,lz4", &dims_1d);
+    // zstd-22 is by far the slowest
+    errors += run_in_child("speed", "zstd-22", &dims_3d);
+
+    unlink(filename);
+    return errors;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  The chooser selects the chain from the performance data of the configuration.
+    With a storage bandwidth of 100 MiB/s the time to transfer the data dominates,
+    unless the user hints require a certain speed.
+*/
+
+static const char * config =
+    "!network 1000\n"
+    "!storage 100\n"
+    "100; 0; any; memcopy; 10000; 10000; 1\n"
+    "0; 0; any; memcopy; 10000; 10000; 1\n"
+    "0; 0; any; lz4; 3000; 6000; 0.3\n"
+    "100; 0; any; lz4; 3000; 6000; 1.0\n"
+    "0; 0; any; zstd; 200; 1000; 0.2\n"
+    "0; 1; any; abstol,lz4; 1000; 2000; 0.05\n"
+    "# the short form applies to all datatypes\n"
+    "0; sigbits,lz4; 1000; 2000; 0.05\n";
+
+static int check(const char * expected, SCIL_Datatype_t datatype, scil_user_hints_t * hints, void * data, size_t count){
+    scil_context_t* context;
+    int ret = scil_context_create(&context, datatype, 0, NULL, hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+    size_t compressed_size = scil_get_compressed_data_size_limit(&dims, datatype);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+
+    size_t out_size;
+    ret = scil_compress(buffer_out, compressed_size, data, &dims, &out_size, context);
+
+    char chain[1024];
+    scil_compression_sprint_last_algorithm_chain(context, chain, 1024);
+    printf("%s,%d,%s\n", expected, ret, chain);
+
+    free(buffer_out);
+    scil_destroy_context(context);
+    return ret != SCIL_NO_ERR || strcmp(chain, expected) != 0;
+}
+
+int main(void){
+    char filename[] = "/tmp/scil-chooser-XXXXXX";
+    int fd = mkstemp(filename);
+    if (fd < 0 || write(fd, config, strlen(config)) != (ssize_t) strlen(config)){
+        printf("Error writing the configuration\n");
+        return 1;
+    }
+    close(fd);
+    setenv("SCIL_SYSTEM_CHARACTERISTICS_FILE", filename, 1);
+
+    const size_t count = 10000;
+    float* smooth = (float*)malloc(count * sizeof(float));
+    float* noise = (float*)malloc(count * sizeof(float));
+    double* smooth_dbl = (double*)malloc(count * sizeof(double));
+    int32_t* smooth_int = (int32_t*)malloc(count * sizeof(int32_t));
+    srand(1);
+    for(size_t i = 0; i < count; ++i){
+        smooth[i] = (float) (i / 500);
+        smooth_dbl[i] = (double) (i / 500);
+        smooth_int[i] = (int32_t) (i / 500);
+        int r = rand();
+        memcpy(& noise[i], & r, sizeof(float));
+    }
+
+    printf("#Expected,Return code,Chain\n");
+    int errors = 0;
+    scil_user_hints_t hints;
+
+    // lossless: lz4 needs the least time to compress, transfer and decompress
+    scil_user_hints_initialize(&hints);
+    errors += check("lz4", SCIL_TYPE_FLOAT, &hints, smooth, count);
+
+    // random data does not compress, copying is fastest
+    errors += check("memcopy", SCIL_TYPE_FLOAT, &hints, noise, count);
+
+    // a lossy chain is applicable if it honors the tolerance
+    hints.absolute_tolerance = 0.01;
+    errors += check("abstol,lz4", SCIL_TYPE_FLOAT, &hints, smooth, count);
+
+    // abstol is too slow for the required compression speed
+    hints.comp_speed.unit = SCIL_PERFORMANCE_GIB;
+    hints.comp_speed.multiplier = 2;
+    errors += check("lz4", SCIL_TYPE_FLOAT, &hints, smooth, count);
+
+    // no chain achieves the speed, the fastest one is used
+    hints.comp_speed.multiplier = 100;
+    errors += check("memcopy", SCIL_TYPE_FLOAT, &hints, smooth, count);
+
+    // the abstol entry is limited to float, sigbits does not guarantee absolute tolerances
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.01;
+    errors += check("lz4", SCIL_TYPE_DOUBLE, &hints, smooth_dbl, count);
+
+    // sigbits honors the relative tolerance
+    scil_user_hints_initialize(&hints);
+    hints.relative_tolerance_percent = 1;
+    errors += check("sigbits,lz4", SCIL_TYPE_DOUBLE, &hints, smooth_dbl, count);
+
+    // but it does not support integers
+    errors += check("lz4", SCIL_TYPE_INT32, &hints, smooth_int, count);
+
+    unlink(filename);
+    free(smooth);
+    free(noise);
+    free(smooth_dbl);
+    free(smooth_int);
+    return errors;
+}
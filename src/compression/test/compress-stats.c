@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  The statistics report each stage of the chain with its sizes, for the
+    compression and the decompression.
+*/
+
+#define COUNT 100000
+
+static void print_stats(const char* name, const scil_compress_stats_t* s){
+  for(int i = 0; i < s->stage_count; i++){
+    const scil_stage_stats_t* st = & s->stages[i];
+    printf("%s,%s,%zu,%zu,%zu,%zu,%f\n", name, st->name, st->runs, st->input_bytes, st->output_bytes, st->header_bytes, st->seconds);
+  }
+  printf("%s,total,%zu,%zu,%zu,%f,%f\n", name, s->input_bytes, s->output_bytes, s->scratch_bytes, s->seconds, s->chooser_seconds);
+}
+
+static int check(char* chain, size_t block_size, const char* first, const char* last, size_t runs){
+  scil_user_hints_t hints;
+  scil_user_hints_initialize(&hints);
+  hints.absolute_tolerance = 0.01;
+  hints.force_compression_methods = chain;
+  scil_context_t* ctx;
+  scil_context_create(&ctx, SCIL_TYPE_DOUBLE, 0, NULL, &hints);
+  scil_context_set_block_size(ctx, block_size);
+
+  scil_dims_t dims;
+  scil_dims_initialize_1d(&dims, COUNT);
+  const size_t data_size = COUNT * sizeof(double);
+  const size_t size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_DOUBLE);
+  double* data = (double*)malloc(data_size);
+  double* result = (double*)malloc(data_size);
+  byte* compressed = (byte*)malloc(size);
+  byte* tmp = (byte*)malloc(size);
+  for(size_t i = 0; i < COUNT; i++){
+    data[i] = sin((double) i / 100.0) * 10.0;
+  }
+
+  int errors = 0;
+  scil_compress_stats_t s;
+  size_t compressed_size;
+  // statistics are disabled by default
+  errors += scil_get_compress_stats(ctx, & s) != SCIL_EINVAL;
+  scil_context_set_stats(ctx, 1);
+  int ret = scil_compress(compressed, size, data, &dims, &compressed_size, ctx);
+  errors += ret != SCIL_NO_ERR;
+  errors += scil_get_compress_stats(ctx, & s) != SCIL_NO_ERR;
+  print_stats("compress", & s);
+  errors += s.input_bytes != data_size || s.output_bytes != compressed_size;
+  errors += s.stage_count < 1 || strcmp(s.stages[0].name, first) != 0 || s.stages[0].runs != runs;
+  errors += s.stages[0].input_bytes != data_size;
+  errors += strcmp(s.stages[s.stage_count - 1].name, last) != 0;
+  // the chooser only runs without a forced chain
+  errors += (chain == NULL) != (s.chooser_seconds > 0);
+
+  scil_compress_stats_t d;
+  ret = scil_decompress_with_stats(SCIL_TYPE_DOUBLE, result, &dims, compressed, compressed_size, tmp, & d);
+  errors += ret != SCIL_NO_ERR;
+  print_stats("decompress", & d);
+  errors += d.input_bytes != compressed_size || d.output_bytes != data_size;
+  errors += d.stage_count != s.stage_count;
+  errors += strcmp(d.stages[0].name, last) != 0 || strcmp(d.stages[d.stage_count - 1].name, first) != 0;
+  errors += d.stages[d.stage_count - 1].output_bytes != data_size;
+  for(int i = 0; i < d.stage_count; i++){
+    errors += d.stages[i].runs != runs;
+  }
+
+  free(data);
+  free(result);
+  free(compressed);
+  free(tmp);
+  scil_destroy_context(ctx);
+  return errors;
+}
+
+int main(void){
+  printf("#Call,Stage,Runs,Input,Output,Header,Seconds\n");
+  int errors = 0;
+  errors += check("abstol,lz4", 0, "abstol", "lz4", 1);
+  errors += check("abstol", 0, "abstol", "abstol", 1);
+  // each block runs the chain
+  errors += check("abstol,lz4", 10000, "abstol", "lz4", 10);
+  errors += check(NULL, 0, "memcopy", "memcopy", 1);
+  printf("Errors: %d\n", errors);
+  return errors;
+}
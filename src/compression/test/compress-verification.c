@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  The quantizing algorithms verify the values while they compress.
+    The verified accuracy must match the accuracy scil_validate_compression() determines.
+*/
+
+#define COUNT 100000
+
+static int same(double a, double b){
+    return a <= b && a >= b;
+}
+
+static int check_chain(char * chain, double absolute_tolerance, int significant_bits, double * data, int expect_ret, int expect_verified){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = absolute_tolerance;
+    hints.significant_bits = significant_bits;
+    hints.force_compression_methods = chain;
+    scil_context_t* ctx;
+    int ret = scil_context_create(&ctx, SCIL_TYPE_DOUBLE, 0, NULL, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("%s,Error creating context: %d\n", chain, ret);
+        return 1;
+    }
+    scil_context_set_verification(ctx, 1);
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, COUNT);
+    const size_t size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_DOUBLE);
+    byte* compressed = (byte*)malloc(size);
+    size_t compressed_size;
+    ret = scil_compress(compressed, size, data, &dims, &compressed_size, ctx);
+
+    scil_user_hints_t verified;
+    const int ret_verified = scil_get_verified_accuracy(ctx, &verified);
+
+    scil_user_hints_t a;
+    scil_validate_params_t v;
+    const int ret_v = scil_validate_compression(SCIL_TYPE_DOUBLE, data, &dims, compressed, compressed_size, ctx, &a, &v);
+
+    printf("%s,%d,%d,%d,%g,%g,%g,%g,%d,%d\n", chain, ret, ret_verified, ret_v,
+        verified.absolute_tolerance, a.absolute_tolerance,
+        verified.relative_tolerance_percent, a.relative_tolerance_percent,
+        verified.significant_bits, a.significant_bits);
+
+    int errors = ret != expect_ret || ret_v != expect_ret;
+    if (expect_verified){
+        errors += ret_verified != SCIL_NO_ERR;
+        errors += ! same(verified.absolute_tolerance, a.absolute_tolerance);
+        errors += ! same(verified.relative_tolerance_percent, a.relative_tolerance_percent);
+        errors += ! same(verified.relative_err_finest_abs_tolerance, a.relative_err_finest_abs_tolerance);
+        errors += verified.significant_bits != a.significant_bits;
+    }else{
+        errors += ret_verified != SCIL_EINVAL;
+    }
+
+    free(compressed);
+    scil_destroy_context(ctx);
+    return errors;
+}
+
+int main(void){
+    double* data = (double*)malloc(COUNT * sizeof(double));
+    for(size_t i = 0; i < COUNT; ++i){
+        data[i] = sin((double) i / 1000.0) * 100.0;
+    }
+    // some exact zeros and tiny values
+    for(size_t i = 0; i < COUNT; i += 97){
+        data[i] = (i % 2) ? 0.0 : 1e-20;
+    }
+
+    printf("#Chain,Ret,Verified,Validated,Abstol verified,Abstol,Reltol verified,Reltol,Sigbits verified,Sigbits\n");
+    int errors = 0;
+    errors += check_chain("abstol", 0.01, 0, data, SCIL_NO_ERR, 1);
+    errors += check_chain("abstol,lz4", 0.01, 0, data, SCIL_NO_ERR, 1);
+    errors += check_chain("quantize,lz4", 0.01, 0, data, SCIL_NO_ERR, 1);
+    errors += check_chain("sigbits", 0, 10, data, SCIL_NO_ERR, 1);
+    errors += check_chain("sigbits-blocked", 0, 10, data, SCIL_NO_ERR, 1);
+    // sigbits does not respect the absolute tolerance
+    errors += check_chain("sigbits", 0.01, 10, data, SCIL_PRECISION_ERR, 1);
+    // the values are exact
+    errors += check_chain("memcopy", SCIL_ACCURACY_DBL_FINEST, 0, data, SCIL_NO_ERR, 1);
+    // the preconditioner changes the values before they are quantized, they are verified by decompression
+    errors += check_chain("fpdelta,abstol", 0.01, 0, data, SCIL_NO_ERR, 1);
+
+    free(data);
+    return errors;
+}
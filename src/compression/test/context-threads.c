@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  Threads compress different data with one context concurrently.
+    Every result must decompress to the data of its own thread.
+    The first thread renames the variable meanwhile.
+*/
+
+#define THREADS 8
+#define CALLS 20
+#define COUNT 50000
+
+typedef struct{
+    scil_context_t* ctx;
+    int id;
+    int errors;
+} thread_arg_t;
+
+static void* compress_calls(void* arg){
+    thread_arg_t* t = (thread_arg_t*) arg;
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, COUNT);
+    const size_t size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_DOUBLE);
+    double* data = (double*)malloc(COUNT * sizeof(double));
+    double* result = (double*)malloc(COUNT * sizeof(double));
+    byte* compressed = (byte*)malloc(size);
+    byte* tmp = (byte*)malloc(size);
+
+    for(int c = 0; c < CALLS; c++){
+        // the range of the data differs between the threads
+        for(size_t i = 0; i < COUNT; i++){
+            data[i] = sin((double) i / 100.0 + c) * (double) (t->id + 1) * 10.0;
+        }
+        if (t->id == 0){
+            scil_context_set_variable_name(t->ctx, c % 2 ? "odd" : "even");
+        }
+        size_t compressed_size;
+        int ret = scil_compress(compressed, size, data, &dims, &compressed_size, t->ctx);
+        if (ret == SCIL_NO_ERR){
+            ret = scil_decompress(SCIL_TYPE_DOUBLE, result, &dims, compressed, compressed_size, tmp);
+        }
+        double max_error = 0;
+        for(size_t i = 0; i < COUNT; i++){
+            const double e = fabs(result[i] - data[i]);
+            max_error = e > max_error ? e : max_error;
+        }
+        if (ret != SCIL_NO_ERR || max_error > 0.01){
+            printf("Error in thread %d call %d: %d %g\n", t->id, c, ret, max_error);
+            t->errors++;
+        }
+    }
+    free(data);
+    free(result);
+    free(compressed);
+    free(tmp);
+    return NULL;
+}
+
+static int check(char* chain, size_t block_size){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.01;
+    hints.force_compression_methods = chain;
+    scil_context_t* ctx;
+    int ret = scil_context_create(&ctx, SCIL_TYPE_DOUBLE, 0, NULL, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+    scil_context_set_block_size(ctx, block_size);
+    scil_context_set_verification(ctx, 1);
+
+    pthread_t threads[THREADS];
+    thread_arg_t args[THREADS];
+    for(int i = 0; i < THREADS; i++){
+        args[i].ctx = ctx;
+        args[i].id = i;
+        args[i].errors = 0;
+        pthread_create(&threads[i], NULL, compress_calls, &args[i]);
+    }
+    int errors = 0;
+    for(int i = 0; i < THREADS; i++){
+        pthread_join(threads[i], NULL);
+        errors += args[i].errors;
+    }
+
+    char last[1024];
+    scil_compression_sprint_last_algorithm_chain(ctx, last, sizeof(last));
+    scil_user_hints_t verified;
+    ret = scil_get_verified_accuracy(ctx, &verified);
+    printf("%s,%zu,%s,%d,%g,%d\n", chain != NULL ? chain : "chooser", block_size, last, ret, verified.absolute_tolerance, errors);
+    if (chain != NULL && ret != SCIL_NO_ERR){
+        errors++;
+    }
+    scil_destroy_context(ctx);
+    return errors;
+}
+
+int main(void){
+    printf("#Chain,Block size,Last chain,Verified,Abstol,Errors\n");
+    int errors = 0;
+    // quantize passes parameters through the pipeline of each call
+    errors += check("quantize,lz4", 0);
+    errors += check("abstol", 10000);
+    errors += check(NULL, 0);
+    return errors;
+}
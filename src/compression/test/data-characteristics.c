@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+#include <scil-data-characteristics.h>
+
+/*  The characteristics are determined on a strided sample of the data.
+    Each case checks the characteristics for a field with known properties.
+*/
+
+static int expect(const char * name, double value, double expected, double tolerance){
+    const int error = fabs(value - expected) > tolerance;
+    printf("%s,%g,%g%s\n", name, value, expected, error ? ",Error" : "");
+    return error;
+}
+
+// a field that changes slowly along x and fast along y
+static int check_smoothness(){
+    scil_dims_t dims;
+    scil_dims_initialize_3d(&dims, 200, 100, 50);
+    const size_t count = scil_dims_get_count(&dims);
+    float* data = (float*)malloc(count * sizeof(float));
+    for(size_t i = 0; i < count; ++i){
+        const size_t x = i % 200;
+        const size_t y = (i / 200) % 100;
+        data[i] = (float) x + (float) (y % 2) * 100.0f;
+    }
+    scilU_data_characteristics_t c;
+    scilU_get_data_characteristics(data, SCIL_TYPE_FLOAT, &dims, DBL_MAX, &c);
+    free(data);
+
+    int errors = 0;
+    errors += expect("sampled", (double) c.sampled, 4096, 0.5);
+    errors += expect("min", c.min, 0, 0.001);
+    errors += expect("max", c.max, 299, 0.001);
+    // a step of 1 in a range of 299
+    errors += expect("smoothness x", c.smoothness[0], 1.0 / 299, 1e-6);
+    errors += expect("smoothness y", c.smoothness[1], 100.0 / 299, 1e-6);
+    errors += expect("smoothness z", c.smoothness[2], 0, 1e-6);
+    errors += expect("repeat fraction", c.repeat_fraction, 0, 1e-6);
+    errors += expect("mean run length", c.mean_run_length, 1, 1e-6);
+    return errors;
+}
+
+static int check_runs_and_zeros(){
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, 1000000);
+    const size_t count = scil_dims_get_count(&dims);
+    double* data = (double*)malloc(count * sizeof(double));
+    for(size_t i = 0; i < count; ++i){
+        // runs of 4 values, every fourth run is zero
+        const size_t run = i / 4;
+        data[i] = (run % 4 == 0) ? 0.0 : (double) (run % 4) * 1024.0;
+    }
+    scilU_data_characteristics_t c;
+    scilU_get_data_characteristics(data, SCIL_TYPE_DOUBLE, &dims, DBL_MAX, &c);
+    free(data);
+
+    int errors = 0;
+    errors += expect("zero fraction", c.zero_fraction, 0.25, 0.02);
+    errors += expect("repeat fraction", c.repeat_fraction, 0.75, 0.02);
+    errors += expect("mean run length", c.mean_run_length, 4, 0.1);
+    // 1024 to 3072
+    errors += expect("exponent min", c.exponent_min, 11, 0.5);
+    errors += expect("exponent max", c.exponent_max, 12, 0.5);
+    return errors;
+}
+
+static int check_entropy(){
+    scil_dims_t dims;
+    scil_dims_initialize_2d(&dims, 1000, 1000);
+    const size_t count = scil_dims_get_count(&dims);
+    int32_t* constant = (int32_t*)malloc(count * sizeof(int32_t));
+    int32_t* noise = (int32_t*)malloc(count * sizeof(int32_t));
+    srand(1);
+    for(size_t i = 0; i < count; ++i){
+        constant[i] = 0x01010101;
+        noise[i] = (rand() & 0xFFFF) | (rand() << 16);
+    }
+    scilU_data_characteristics_t c;
+    int errors = 0;
+    scilU_get_data_characteristics(constant, SCIL_TYPE_INT32, &dims, DBL_MAX, &c);
+    errors += expect("entropy constant", c.entropy, 0, 1e-6);
+    // the runs end with the blocks and the rows
+    errors += expect("repeat fraction constant", c.repeat_fraction, 1 - 1.0 / 64, 0.01);
+    scilU_get_data_characteristics(noise, SCIL_TYPE_INT32, &dims, DBL_MAX, &c);
+    errors += expect("entropy noise", c.entropy, 8, 0.1);
+    free(constant);
+    free(noise);
+    return errors;
+}
+
+int main(void){
+    printf("#Characteristic,Value,Expected\n");
+    int errors = check_smoothness();
+    errors += check_runs_and_zeros();
+    errors += check_entropy();
+    return errors;
+}
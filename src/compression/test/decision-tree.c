@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <scil.h>
+#include <scil-util.h>
+#include <scil-data-characteristics.h>
+
+/*  The decision tree predicts the chain from the features of the data.
+    The tree branches on the standard deviation and the fraction of fill values.
+*/
+
+static const char * tree =
+    "#classes\n"
+    "lz4;memcopy;zstd\n"
+    "#left\n"
+    "1;-1;3;-1;-1\n"
+    "#right\n"
+    "2;-1;4;-1;-1\n"
+    "#thresholds\n"
+    "5.0;-2;0.5;-2;-2\n"
+    "#indices\n"
+    "12;-2;14;-2;-2\n"
+    "#values\n"
+    "5.5.5.;10.0.0.;5.5.5.;0.10.0.;0.0.10.\n";
+
+static int check(const char * expected, double fill_value, float * data, size_t count){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.fill_value = fill_value;
+
+    scil_context_t* context;
+    int ret = scil_context_create(&context, SCIL_TYPE_FLOAT, 0, NULL, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+
+    scil_dims_t dims;
+    scil_dims_initialize_2d(&dims, 100, count / 100);
+    size_t compressed_size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_FLOAT);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+
+    size_t out_size;
+    ret = scil_compress(buffer_out, compressed_size, data, &dims, &out_size, context);
+
+    char chain[1024];
+    scil_compression_sprint_last_algorithm_chain(context, chain, 1024);
+    printf("%s,%d,%s\n", expected, ret, chain);
+
+    free(buffer_out);
+    scil_destroy_context(context);
+    return ret != SCIL_NO_ERR || strcmp(chain, expected) != 0;
+}
+
+static int check_features(){
+    int errors = 0;
+    const size_t count = 1000000;
+    double* data = (double*)malloc(count * sizeof(double));
+    for(size_t i = 0; i < count; ++i){
+        data[i] = (i % 4 == 0) ? -999.0 : (double) (i % 100);
+    }
+    data[5] = NAN;
+
+    scil_dims_t dims;
+    scil_dims_initialize_3d(&dims, 100, 100, 100);
+    double features[SCIL_FEATURE_LAST];
+    scilU_get_data_features(data, SCIL_TYPE_DOUBLE, &dims, -999.0, features);
+
+    printf("#Feature,Value\n");
+    for(int f = 0; f < SCIL_FEATURE_LAST; f++){
+        printf("%d,%g\n", f, features[f]);
+    }
+    errors += fabs(features[SCIL_FEATURE_DATATYPE_BITS] - 64.0) > 0.5;
+    errors += fabs(features[SCIL_FEATURE_COUNT] - (double) count) > 0.5;
+    errors += fabs(features[SCIL_FEATURE_DIMS] - 3.0) > 0.5 || fabs(features[SCIL_FEATURE_DIM_2] - 100.0) > 0.5 || fabs(features[SCIL_FEATURE_DIM_3]) > 0.5;
+    errors += fabs(features[SCIL_FEATURE_MIN] - 1.0) > 0.001;
+    errors += fabs(features[SCIL_FEATURE_MAX] - 99.0) > 0.001;
+    errors += fabs(features[SCIL_FEATURE_MEAN] - 50.0) > 1.0;
+    errors += fabs(features[SCIL_FEATURE_STDDEV] - 28.9) > 1.0;
+    // the step from 99 to 1 is interrupted by a fill value
+    errors += fabs(features[SCIL_FEATURE_MAX_STEP] - 1.0) > 0.001;
+    errors += fabs(features[SCIL_FEATURE_FILL_FRACTION] - 0.25) > 0.01;
+    free(data);
+    if (errors){
+        printf("Error: wrong features\n");
+    }
+    return errors;
+}
+
+int main(void){
+    char filename[] = "/tmp/scil-tree-XXXXXX";
+    int fd = mkstemp(filename);
+    if (fd < 0 || write(fd, tree, strlen(tree)) != (ssize_t) strlen(tree)){
+        printf("Error writing the decision tree\n");
+        return 1;
+    }
+    close(fd);
+    setenv("SCIL_DECISION_TREE_FILE", filename, 1);
+
+    const size_t count = 100000;
+    float* smooth = (float*)malloc(count * sizeof(float));
+    float* noise = (float*)malloc(count * sizeof(float));
+    float* masked = (float*)malloc(count * sizeof(float));
+    srand(1);
+    for(size_t i = 0; i < count; ++i){
+        smooth[i] = sinf(i * 0.01f);
+        noise[i] = (float) (rand() % 1000);
+        masked[i] = (i % 10 < 7) ? -999.0f : noise[i];
+    }
+
+    int errors = check_features();
+    printf("#Expected,Return code,Chain\n");
+    errors += check("lz4", DBL_MAX, smooth, count);
+    errors += check("memcopy", DBL_MAX, noise, count);
+    errors += check("zstd", -999.0, masked, count);
+
+    unlink(filename);
+    free(smooth);
+    free(noise);
+    free(masked);
+    return errors;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  The error metrics are determined in one pass, large data is split among threads.
+    The maximum errors and their positions must not depend on the splitting.
+*/
+
+static int expect(const char * name, double value, double expected, double tolerance){
+    const int error = ! (fabs(value - expected) <= tolerance);
+    printf("%s,%g,%g%s\n", name, value, expected, error ? ",Error" : "");
+    return error;
+}
+
+static size_t histogram_sum(const scil_validate_params_t * v){
+    size_t sum = 0;
+    for(int i = 0; i < SCIL_ERROR_HISTOGRAM_BINS; i++){
+        sum += v->error_histogram[i];
+    }
+    return sum;
+}
+
+static int check_double(){
+    const size_t count = 1000000;
+    double* original = (double*)malloc(count * sizeof(double));
+    double* decompressed = (double*)malloc(count * sizeof(double));
+    double sum_squared_error = 0;
+    for(size_t i = 0; i < count; ++i){
+        original[i] = (double) (i + 1);
+        // a large error late in the data
+        const double err = i == 900001 ? 2.0 : (i % 4 == 0 ? 0.5 : 0.0);
+        decompressed[i] = original[i] + err;
+        sum_squared_error += err * err;
+    }
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+    scil_user_hints_t a;
+    scil_validate_params_t v;
+    scil_determine_accuracy(SCIL_TYPE_DOUBLE, decompressed, original, &dims, 0.0, &a, &v);
+
+    const double rmse = sqrt(sum_squared_error / count);
+    int errors = 0;
+    errors += expect("abs tol", a.absolute_tolerance, 2.0, 0);
+    errors += expect("abs tol idx", (double) v.absolute_tolerance_idx, 900001, 0);
+    // 1.5 instead of 1
+    errors += expect("rel percent", a.relative_tolerance_percent, 100.0 / 3, 1e-9);
+    errors += expect("rel percent idx", (double) v.relative_tolerance_percent_idx, 0, 0);
+    errors += expect("count", (double) v.count, count, 0);
+    errors += expect("min", v.value_min, 1, 0);
+    errors += expect("max", v.value_max, count, 0);
+    errors += expect("rmse", v.rmse, rmse, 1e-12);
+    errors += expect("psnr", v.psnr, 20 * log10((count - 1) / rmse), 1e-9);
+    errors += expect("histogram", (double) histogram_sum(&v), count, 0);
+    errors += expect("histogram exact", (double) v.error_histogram[SCIL_ERROR_HISTOGRAM_BINS - 1], count - count / 4 - 1, 0);
+    // the error 0.5 of 1.5 is the only one in [1/4, 1/2)
+    errors += expect("histogram 2^-2", (double) v.error_histogram[2], 1, 0);
+    // three of four values are exact
+    errors += expect("mean sig bits", v.mean_significant_bits, 45.5, 6.5);
+
+    scil_determine_accuracy(SCIL_TYPE_DOUBLE, original, original, &dims, 0.0, &a, &v);
+    errors += expect("identical rmse", v.rmse, 0, 0);
+    errors += expect("identical psnr", isinf(v.psnr) && v.psnr > 0, 1, 0);
+    errors += expect("identical sig bits", v.mean_significant_bits, MANTISSA_LENGTH_DOUBLE, 0);
+    errors += expect("identical histogram exact", (double) v.error_histogram[SCIL_ERROR_HISTOGRAM_BINS - 1], count, 0);
+
+    free(original);
+    free(decompressed);
+    return errors;
+}
+
+static int check_int16(){
+    const size_t count = 100000;
+    int16_t* original = (int16_t*)malloc(count * sizeof(int16_t));
+    int16_t* decompressed = (int16_t*)malloc(count * sizeof(int16_t));
+    for(size_t i = 0; i < count; ++i){
+        original[i] = (int16_t) (i % 1000) - 500;
+        decompressed[i] = original[i] ^ 4;
+    }
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+    scil_user_hints_t a;
+    scil_validate_params_t v;
+    scil_determine_accuracy(SCIL_TYPE_INT16, decompressed, original, &dims, 0.0, &a, &v);
+
+    int errors = 0;
+    errors += expect("int16 abs tol", a.absolute_tolerance, 4, 0);
+    errors += expect("int16 sig bits", a.significant_bits, 14, 0);
+    errors += expect("int16 mean sig bits", v.mean_significant_bits, 14, 0);
+    errors += expect("int16 rmse", v.rmse, 4, 0);
+    errors += expect("int16 min", v.value_min, -500, 0);
+    errors += expect("int16 max", v.value_max, 499, 0);
+    errors += expect("int16 histogram exact", (double) v.error_histogram[SCIL_ERROR_HISTOGRAM_BINS - 1], 0, 0);
+    free(original);
+    free(decompressed);
+    return errors;
+}
+
+static int check_validation(){
+    const size_t count = 1000000;
+    float* data = (float*)malloc(count * sizeof(float));
+    for(size_t i = 0; i < count; ++i){
+        data[i] = (float) sin((double) i * 0.001);
+    }
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.01;
+    hints.force_compression_methods = "abstol";
+    scil_context_t* ctx;
+    int ret = scil_context_create(&ctx, SCIL_TYPE_FLOAT, 0, NULL, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context: %d\n", ret);
+        return 1;
+    }
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+    size_t compressed_size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_FLOAT);
+    byte* compressed = (byte*)malloc(compressed_size);
+    size_t out_size;
+    ret = scil_compress(compressed, compressed_size, data, &dims, &out_size, ctx);
+    scil_user_hints_t a;
+    scil_validate_params_t v;
+    if (ret == SCIL_NO_ERR){
+        ret = scil_validate_compression(SCIL_TYPE_FLOAT, data, &dims, compressed, out_size, ctx, &a, &v);
+    }
+    int errors = ret != SCIL_NO_ERR;
+    errors += expect("validation count", (double) v.count, count, 0);
+    errors += expect("validation rmse", v.rmse, 0.005, 0.005);
+    errors += expect("validation max", v.value_max, 1, 1e-6);
+    errors += expect("validation histogram", (double) histogram_sum(&v), count, 0);
+    free(data);
+    free(compressed);
+    scil_destroy_context(ctx);
+    return errors;
+}
+
+int main(void){
+    printf("#Metric,Value,Expected\n");
+    int errors = check_double();
+    errors += check_int16();
+    errors += check_validation();
+    return errors;
+}
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  Data with fill values on a fixed set of points (a land-sea mask) over several
+    time steps. Using the mask, the fill values must be restored exactly and
+    the compressed data must be smaller than without the mask.
+*/
+
+#define NX 120
+#define NY 80
+#define STEPS 3
+
+static const double fill = -999.0;
+
+static size_t compress(char * mask, size_t block_size, double * buffer_in, byte * buffer_out, size_t compressed_size, scil_dims_t * dims){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.01;
+    hints.fill_value = fill;
+    hints.force_compression_methods = "abstol";
+
+    scil_context_t* context;
+    scil_context_create(&context, SCIL_TYPE_DOUBLE, 0, NULL, &hints);
+    if (scil_context_set_mask(context, mask) != SCIL_NO_ERR){
+        printf("Error: cannot set mask %s\n", mask);
+        exit(1);
+    }
+    scil_context_set_block_size(context, block_size);
+
+    size_t out_size = 0;
+    int ret = scil_compress(buffer_out, compressed_size, buffer_in, dims, &out_size, context);
+    if (ret != SCIL_NO_ERR){
+        printf("Error compressing with mask %s: %d\n", mask, ret);
+        exit(1);
+    }
+    scil_destroy_context(context);
+    return out_size;
+}
+
+static size_t run(char * mask, size_t block_size, double * buffer_in, double * buffer_end, scil_dims_t * dims){
+    size_t compressed_size = scil_get_compressed_data_size_limit(dims, SCIL_TYPE_DOUBLE);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+    byte* buffer_tmp = (byte*)malloc(compressed_size);
+
+    size_t out_size = compress(mask, block_size, buffer_in, buffer_out, compressed_size, dims);
+    int ret = scil_decompress(SCIL_TYPE_DOUBLE, buffer_end, dims, buffer_out, out_size, buffer_tmp);
+    if (ret != SCIL_NO_ERR){
+        printf("Error decompressing with mask %s: %d\n", mask, ret);
+        exit(1);
+    }
+
+    free(buffer_out);
+    free(buffer_tmp);
+    return out_size;
+}
+
+static int is_fill(double value){
+    return memcmp(& value, & fill, sizeof(double)) == 0;
+}
+
+static int check(const char * mask, double * buffer_in, double * buffer_end, size_t count){
+    int errors = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (is_fill(buffer_in[i]) ? ! is_fill(buffer_end[i]) : fabs(buffer_in[i] - buffer_end[i]) > 0.01){
+            printf("Error with mask %s at %zu: %f restored as %f\n", mask, i, buffer_in[i], buffer_end[i]);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+// One context compresses data whose mask changes between the calls
+static int check_auto_changing(double * buffer_in, double * buffer_end, scil_dims_t * dims, size_t count){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.01;
+    hints.fill_value = fill;
+    hints.force_compression_methods = "abstol";
+
+    scil_context_t* context;
+    scil_context_create(&context, SCIL_TYPE_DOUBLE, 0, NULL, &hints);
+    scil_context_set_mask(context, SCIL_MASK_AUTO);
+
+    size_t compressed_size = scil_get_compressed_data_size_limit(dims, SCIL_TYPE_DOUBLE);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+    byte* buffer_tmp = (byte*)malloc(compressed_size);
+
+    int errors = 0;
+    for(int call = 0; call < 4; call++){
+        // the second call sees the same mask, the third one more and the fourth one less fill values
+        if (call == 2){
+            buffer_in[NX * NY / 2] = fill;
+        }else if (call == 3){
+            buffer_in[NX * NY / 2 + NX / 2] = 5.0;
+        }
+        size_t out_size = 0;
+        int ret = scil_compress(buffer_out, compressed_size, buffer_in, dims, &out_size, context);
+        if (ret == SCIL_NO_ERR){
+            ret = scil_decompress(SCIL_TYPE_DOUBLE, buffer_end, dims, buffer_out, out_size, buffer_tmp);
+        }
+        if (ret != SCIL_NO_ERR){
+            printf("Error in call %d with a changing mask: %d\n", call, ret);
+            errors++;
+            continue;
+        }
+        errors += check("changing", buffer_in, buffer_end, count);
+    }
+
+    free(buffer_out);
+    free(buffer_tmp);
+    scil_destroy_context(context);
+    return errors;
+}
+
+// A stream with an empty inline mask must be rejected
+static int check_corrupt(void){
+    byte stream[51];
+    memset(stream, 0, sizeof(stream));
+    stream[0] = 255;
+    stream[1] = 1;
+    stream[26] = 1;
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, 10);
+    double buffer_end[10];
+    byte buffer_tmp[1024];
+    if (scil_decompress(SCIL_TYPE_DOUBLE, buffer_end, &dims, stream, sizeof(stream), buffer_tmp) == SCIL_NO_ERR){
+        printf("Error: a mask without points was accepted\n");
+        return 1;
+    }
+    return 0;
+}
+
+// A stream must not be decompressed with a registered mask of other dimensions or valid points
+static int check_mismatch(double * buffer_in, double * buffer_end, scil_dims_t * dims){
+    size_t compressed_size = scil_get_compressed_data_size_limit(dims, SCIL_TYPE_DOUBLE);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+    byte* buffer_tmp = (byte*)malloc(compressed_size);
+    size_t out_size = compress("continent", 0, buffer_in, buffer_out, compressed_size, dims);
+
+    int errors = 0;
+    // the dimensions of the mask start behind the marker, the fingerprint and the counts
+    uint64_t length = NX * NY;
+    memcpy(buffer_out + 27, & length, 8);
+    length = 1;
+    memcpy(buffer_out + 35, & length, 8);
+    if (scil_decompress(SCIL_TYPE_DOUBLE, buffer_end, dims, buffer_out, out_size, buffer_tmp) != SCIL_EINVAL){
+        printf("Error: a mask of other dimensions was used\n");
+        errors++;
+    }
+
+    out_size = compress("continent", 0, buffer_in, buffer_out, compressed_size, dims);
+    buffer_out[18]++;
+    if (scil_decompress(SCIL_TYPE_DOUBLE, buffer_end, dims, buffer_out, out_size, buffer_tmp) != SCIL_EINVAL){
+        printf("Error: a mask with other valid points was used\n");
+        errors++;
+    }
+
+    free(buffer_out);
+    free(buffer_tmp);
+    return errors;
+}
+
+int main(void){
+    const size_t count = NX * NY * STEPS;
+    byte valid[NX * NY];
+    double* buffer_in  = (double*)malloc(count * sizeof(double));
+    double* buffer_end = (double*)malloc(count * sizeof(double));
+
+    // a round continent in the middle of the ocean
+    for(int y = 0; y < NY; y++){
+        for(int x = 0; x < NX; x++){
+            valid[y * NX + x] = (x - NX / 2) * (x - NX / 2) + (y - NY / 2) * (y - NY / 2) > 900;
+        }
+    }
+    for(size_t i = 0; i < count; i++){
+        buffer_in[i] = valid[i % (NX * NY)] ? 10.0 + sin(i * 0.001) : fill;
+    }
+
+    scil_dims_t mask_dims;
+    scil_dims_initialize_2d(&mask_dims, NX, NY);
+    if (scil_mask_register("continent", &mask_dims, valid) != SCIL_NO_ERR){
+        printf("Error registering mask\n");
+        return 1;
+    }
+    valid[0] = ! valid[0];
+    if (scil_mask_register("continent", &mask_dims, valid) != SCIL_EINVAL){
+        printf("Error: a different mask with the same name was accepted\n");
+        return 1;
+    }
+
+    scil_dims_t empty_dims;
+    scil_dims_initialize_2d(&empty_dims, 0, NY);
+    if (scil_mask_register("empty", &empty_dims, valid) != SCIL_EINVAL){
+        printf("Error: a mask without points was registered\n");
+        return 1;
+    }
+
+    // the same points with other dimensions share the fingerprint
+    valid[0] = ! valid[0];
+    scil_dims_t transposed_dims;
+    scil_dims_initialize_2d(&transposed_dims, NY, NX);
+    if (scil_mask_register("continent-transposed", &transposed_dims, valid) != SCIL_NO_ERR){
+        printf("Error registering the transposed mask\n");
+        return 1;
+    }
+
+    scil_dims_t dims;
+    scil_dims_initialize_3d(&dims, NX, NY, STEPS);
+
+    int errors = 0;
+    size_t size_plain = run(NULL, 0, buffer_in, buffer_end, &dims);
+    errors += check("none", buffer_in, buffer_end, count);
+    size_t size_named = run("continent", 0, buffer_in, buffer_end, &dims);
+    errors += check("continent", buffer_in, buffer_end, count);
+    size_t size_auto = run(SCIL_MASK_AUTO, 0, buffer_in, buffer_end, &dims);
+    errors += check(SCIL_MASK_AUTO, buffer_in, buffer_end, count);
+    // the valid points are compressed in blocks
+    run("continent", 2000, buffer_in, buffer_end, &dims);
+    errors += check("continent in blocks", buffer_in, buffer_end, count);
+
+    printf("#No mask,Named mask,Automatic mask\n");
+    printf("%zu,%zu,%zu\n", size_plain, size_named, size_auto);
+    if (size_named >= size_plain || size_auto >= size_plain){
+        printf("Error: masked data is not smaller\n");
+        errors++;
+    }
+
+    errors += check_auto_changing(buffer_in, buffer_end, &dims, count);
+    errors += check_corrupt();
+    errors += check_mismatch(buffer_in, buffer_end, &dims);
+
+    free(buffer_in);
+    free(buffer_end);
+    return errors;
+}
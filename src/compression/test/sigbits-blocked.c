@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+#include <algo/algo-sigbits.h>
+
+/*  The blocked variant must reconstruct exactly the values of the plain
+    sigbits algorithm, as both round the mantissa in the same way.
+    For data spanning many orders of magnitude it should need less space.
+*/
+
+static size_t run(char * method, double fill_value, double * buffer_in, double * buffer_end, scil_dims_t * dims){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.significant_bits = 9;
+    hints.fill_value = fill_value;
+    hints.force_compression_methods = method;
+
+    scil_context_t* context;
+    scil_context_create(&context, SCIL_TYPE_DOUBLE, 0, NULL, &hints);
+
+    size_t compressed_size = scil_get_compressed_data_size_limit(dims, SCIL_TYPE_DOUBLE);
+    byte* buffer_out = (byte*)malloc(compressed_size);
+    byte* buffer_tmp = (byte*)malloc(compressed_size / 2);
+
+    size_t out_size = 0;
+    int ret = scil_compress(buffer_out, compressed_size, buffer_in, dims, &out_size, context);
+    if (ret != SCIL_NO_ERR){
+        printf("Error compressing with %s: %d\n", method, ret);
+        exit(1);
+    }
+    ret = scil_decompress(SCIL_TYPE_DOUBLE, buffer_end, dims, buffer_out, out_size, buffer_tmp);
+    if (ret != SCIL_NO_ERR){
+        printf("Error decompressing with %s: %d\n", method, ret);
+        exit(1);
+    }
+
+    free(buffer_out);
+    free(buffer_tmp);
+    scil_destroy_context(context);
+    return out_size;
+}
+
+static int check(double fill_value){
+    size_t count = 100003;
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+
+    double* buffer_in    = (double*)malloc(count * sizeof(double));
+    double* buffer_plain = (double*)malloc(count * sizeof(double));
+    double* buffer_block = (double*)malloc(count * sizeof(double));
+
+    for(size_t i = 0; i < count; ++i){
+        // magnitude grows along the array, sign flips in some regions only
+        buffer_in[i] = pow(10.0, -20.0 + 40.0 * i / count) * (1.0 + sin(i * 0.01) * 0.5);
+        if ((i / 30000) % 2 == 1){
+            buffer_in[i] = -buffer_in[i];
+        }
+        if (fill_value < DBL_MAX && i > 50000 && i < 60000){
+            buffer_in[i] = fill_value;
+        }
+    }
+    buffer_in[7] = 0.0;
+
+    size_t plain_size = run("sigbits", fill_value, buffer_in, buffer_plain, &dims);
+    size_t block_size = run("sigbits-blocked", fill_value, buffer_in, buffer_block, &dims);
+
+    printf("#Fill value,Size sigbits,Size sigbits-blocked\n");
+    printf("%g,%zu,%zu\n", fill_value, plain_size, block_size);
+
+    int errors = 0;
+    if (memcmp(buffer_plain, buffer_block, count * sizeof(double)) != 0){
+        printf("Error: reconstructed values differ\n");
+        errors++;
+    }
+    if (block_size >= plain_size){
+        printf("Error: blocked variant is not smaller\n");
+        errors++;
+    }
+
+    free(buffer_in);
+    free(buffer_plain);
+    free(buffer_block);
+    return errors;
+}
+
+// The encoder must not write beyond the capacity it got in dest_size
+static int check_capacity(void){
+    size_t count = 10000;
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+
+    double* buffer_in = (double*)malloc(count * sizeof(double));
+    for(size_t i = 0; i < count; ++i){
+        buffer_in[i] = sin(i * 0.01) * 100.0;
+    }
+
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.significant_bits = 9;
+    scil_context_t* context;
+    scil_context_create(&context, SCIL_TYPE_DOUBLE, 0, NULL, &hints);
+
+    size_t limit = 2 * count * sizeof(double);
+    byte* buffer_out = (byte*)malloc(limit);
+    size_t size = limit;
+    int errors = 0;
+    int ret = scil_sigbits_blocked_compress_double(context, buffer_out, &size, buffer_in, &dims);
+    if (ret != SCIL_NO_ERR){
+        printf("Error compressing with enough space: %d\n", ret);
+        errors++;
+    }
+    size_t sizes[] = {4, 16, size - 1};
+    for(int i = 0; i < 3; ++i){
+        size_t small = sizes[i];
+        ret = scil_sigbits_blocked_compress_double(context, buffer_out, &small, buffer_in, &dims);
+        if (ret != SCIL_BUFFER_ERR){
+            printf("Error: %zu bytes of %zu accepted: %d\n", sizes[i], size, ret);
+            errors++;
+        }
+    }
+
+    free(buffer_in);
+    free(buffer_out);
+    scil_destroy_context(context);
+    return errors;
+}
+
+int main(void){
+    int errors = check(DBL_MAX);
+    errors += check(-999.0);
+    errors += check_capacity();
+    return errors;
+}
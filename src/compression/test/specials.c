@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <scil.h>
+#include <scil-util.h>
+
+/*  The specials preconditioner must restore NaN, +/-Inf and the special values
+    of the context exactly, while the lossy compressor behind it only sees
+    regular values.
+*/
+
+static int same_bits(float a, float b){
+    return memcmp(& a, & b, sizeof(float)) == 0;
+}
+
+static int is_special(float value){
+    return ! isfinite(value) || same_bits(value, -999.0f) || same_bits(value, 1e30f);
+}
+
+static int test_chain(char * chain, double fill_value, float * buffer_in, size_t count, size_t * size){
+    scil_user_hints_t hints;
+    scil_user_hints_initialize(&hints);
+    hints.absolute_tolerance = 0.01;
+    hints.significant_bits = 16;
+    hints.force_compression_methods = chain;
+    hints.fill_value = fill_value;
+
+    scil_value_t special_values[2];
+    special_values[0].typ = SCIL_TYPE_FLOAT;
+    special_values[0].u.flt32 = -999.0f;
+    special_values[1].typ = SCIL_TYPE_DOUBLE;
+    special_values[1].u.flt64 = 1e30;
+
+    scil_context_t* context;
+    int ret = scil_context_create(&context, SCIL_TYPE_FLOAT, 2, special_values, &hints);
+    if (ret != SCIL_NO_ERR){
+        printf("Error creating context for %s: %d\n", chain, ret);
+        return 1;
+    }
+
+    scil_dims_t dims;
+    scil_dims_initialize_1d(&dims, count);
+
+    size_t compressed_size = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_FLOAT);
+    byte* buffer_out  = (byte*)malloc(compressed_size);
+    byte* buffer_tmp  = (byte*)malloc(compressed_size);
+    float* buffer_end = (float*)malloc(count * sizeof(float));
+
+    size_t out_size;
+    ret = scil_compress(buffer_out, compressed_size, buffer_in, &dims, &out_size, context);
+    if (ret != SCIL_NO_ERR){
+        printf("Error compressing with %s: %d\n", chain, ret);
+        return 1;
+    }
+    ret = scil_decompress(SCIL_TYPE_FLOAT, buffer_end, &dims, buffer_out, out_size, buffer_tmp);
+    if (ret != SCIL_NO_ERR){
+        printf("Error decompressing with %s: %d\n", chain, ret);
+        return 1;
+    }
+
+    int errors = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (is_special(buffer_in[i])){
+            if (! same_bits(buffer_in[i], buffer_end[i]) && ! (isnan(buffer_in[i]) && isnan(buffer_end[i]))){
+                printf("Error at %zu: special value %f restored as %f\n", i, (double) buffer_in[i], (double) buffer_end[i]);
+                errors++;
+            }
+        }else if (fabs((double) (buffer_in[i] - buffer_end[i])) > 0.01){
+            printf("Error at %zu: %f restored as %f\n", i, (double) buffer_in[i], (double) buffer_end[i]);
+            errors++;
+        }
+    }
+    printf("%s,%g,%zu,%zu,%d\n", chain, fill_value, count * sizeof(float), out_size, errors);
+
+    *size = out_size;
+    free(buffer_out);
+    free(buffer_tmp);
+    free(buffer_end);
+    scil_destroy_context(context);
+    return errors;
+}
+
+int main(void){
+    size_t count = 10000;
+    float* buffer_in = (float*)malloc(count * sizeof(float));
+
+    for(size_t i = 0; i < count; ++i){
+        buffer_in[i] = sinf(i * 0.01f) * 10.0f;
+    }
+    // leading, trailing and scattered special values
+    buffer_in[0] = -999.0f;
+    buffer_in[1] = -999.0f;
+    for(size_t i = 2000; i < 3000; ++i){
+        buffer_in[i] = -999.0f;
+    }
+    buffer_in[4000] = NAN;
+    buffer_in[4001] = INFINITY;
+    buffer_in[4002] = -INFINITY;
+    buffer_in[4003] = 1e30f;
+    buffer_in[count - 1] = NAN;
+
+    printf("#Chain,Fill value,Uncompressed size,Compressed size,Errors\n");
+    char * chains[] = {"specials,abstol", "specials,sigbits-blocked"};
+    int errors = 0;
+    for(int c = 0; c < 2; ++c){
+        size_t size = 0, size_fill = 1;
+        errors += test_chain(chains[c], DBL_MAX, buffer_in, count, &size);
+        // the fill value is handled by the preconditioner, the stages behind it never see it
+        errors += test_chain(chains[c], -999.0, buffer_in, count, &size_fill);
+        if (size != size_fill){
+            printf("Error: the fill value reached the stages behind %s\n", chains[c]);
+            errors++;
+        }
+    }
+
+    free(buffer_in);
+    return errors;
+}
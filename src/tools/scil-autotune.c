@@ -0,0 +1,762 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tunes the chooser to the variables of a site: a sample of the given files is
+ * read by a file plugin, the features of each variable are determined and the
+ * lossless chains as well as the lossy chains with a sweep of tolerances are
+ * measured on it.
+ * The results of each variable are appended to a state file, a later run with
+ * the same state file skips the variables that are done.
+ * From all results a scil.conf with the measured lossless chains and the
+ * Pareto-optimal lossy chains is created, as well as a decision tree that
+ * predicts the best lossless chain from the features, see SCIL_DECISION_TREE_FILE.
+ * The variables are processed in parallel, the throughput is measured while
+ * the other threads run.
+ */
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <scil.h>
+#include <scil-data-characteristics.h>
+#include <scil-error.h>
+#include <scil-debug.h>
+#include <scil-hardware-limits.h>
+#include <scil-option.h>
+#include <scil-util.h>
+
+#include <scil-sweep.h>
+#include <file-formats/scil-file-format.h>
+
+static char * files = NULL;
+static char * list_file = NULL;
+static char * in_file_format = "csv";
+static int sample = 0;
+static int max_values = 4 * 1024 * 1024;
+static char * lossless_chains = "memcopy;lz4;zstd;gzip;delta,lz4;delta,zstd";
+static char * lossy_chains = "abstol,lz4;quantize,zstd;sigbits,lz4;sigbits-blocked;zfp-abstol;zfp-precision;sz";
+static int threads = 0;
+static int warmup = 1;
+static int repetitions = 3;
+static double fill_value = DBL_MAX;
+static double bandwidth = 0;
+static int tree_depth = 8;
+static int min_leaf = 2;
+static char * state_file = "scil-autotune.state";
+static char * conf_file = "scil.conf";
+static char * tree_file = "scil-decision-tree.txt";
+
+static scil_file_plugin_t * plugin = NULL;
+
+// a variable with the points of the chains measured on it
+typedef struct{
+  char * file;
+  SCIL_Datatype_t datatype;
+  double randomness;
+  double features[SCIL_FEATURE_LAST];
+  sweep_point_t * points;
+  int point_count;
+  int point_capacity;
+  int done;
+} variable_t;
+
+static variable_t * variables = NULL;
+static int variable_count = 0;
+static int variable_capacity = 0;
+
+static char ** todo = NULL;
+static int todo_count = 0;
+static int todo_next = 0;
+
+static FILE * state = NULL;
+static pthread_mutex_t todo_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t state_lock = PTHREAD_MUTEX_INITIALIZER;
+// the file plugins, e.g., NetCDF, are not thread-safe
+static pthread_mutex_t read_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int count_chains(const char * chains){
+  int count = 1;
+  for(const char * c = chains; *c != 0; c++){
+    count += *c == ';';
+  }
+  return count;
+}
+
+static variable_t * find_variable(const char * file){
+  for(int i=0; i < variable_count; i++){
+    if (strcmp(variables[i].file, file) == 0){
+      return & variables[i];
+    }
+  }
+  return NULL;
+}
+
+static variable_t * add_variable(const char * file){
+  variable_t * v = find_variable(file);
+  if (v != NULL){
+    // an interrupted run left the variable incomplete, its points are measured again
+    for(int i=0; i < v->point_count; i++){
+      free((char*) v->points[i].chain);
+    }
+    v->point_count = 0;
+    return v;
+  }
+  if (variable_count == variable_capacity){
+    variable_capacity = variable_capacity == 0 ? 64 : variable_capacity * 2;
+    variables = (variable_t*) realloc(variables, sizeof(variable_t) * variable_capacity);
+  }
+  v = & variables[variable_count++];
+  memset(v, 0, sizeof(variable_t));
+  v->file = strdup(file);
+  return v;
+}
+
+static void free_variables(){
+  for(int i=0; i < variable_count; i++){
+    for(int j=0; j < variables[i].point_count; j++){
+      free((char*) variables[i].points[j].chain);
+    }
+    free(variables[i].points);
+    free(variables[i].file);
+  }
+  variable_count = 0;
+}
+
+static void add_point(variable_t * v, const sweep_point_t * p){
+  if (v->point_count == v->point_capacity){
+    v->point_capacity = v->point_capacity == 0 ? 32 : v->point_capacity * 2;
+    v->points = (sweep_point_t*) realloc(v->points, sizeof(sweep_point_t) * v->point_capacity);
+  }
+  v->points[v->point_count] = *p;
+  v->points[v->point_count].chain = strdup(p->chain);
+  v->point_count++;
+}
+
+/*
+ * The state file contains one tab-separated record per line:
+ *   V file datatype randomness feature,feature,...
+ *   P file chain kind tolerance error ratio c_speed d_speed
+ *   D file
+ * A variable is complete once its D record is written.
+ */
+static void load_state(){
+  FILE * f = fopen(state_file, "r");
+  if (f == NULL){
+    return;
+  }
+  char * line = NULL;
+  size_t len = 0;
+  while (getline(& line, & len, f) != -1){
+    line[strcspn(line, "\r\n")] = 0;
+    char * saveptr;
+    char * type = strtok_r(line, "\t", & saveptr);
+    char * file = strtok_r(NULL, "\t", & saveptr);
+    if (type == NULL || file == NULL){
+      continue;
+    }
+    if (type[0] == 'V'){
+      variable_t * v = add_variable(file);
+      char * datatype = strtok_r(NULL, "\t", & saveptr);
+      char * randomness = strtok_r(NULL, "\t", & saveptr);
+      char * features = strtok_r(NULL, "\t", & saveptr);
+      if (datatype == NULL || randomness == NULL || features == NULL){
+        continue;
+      }
+      v->datatype = (SCIL_Datatype_t) atoi(datatype);
+      v->randomness = atof(randomness);
+      char * fsave;
+      int i = 0;
+      for(char * value = strtok_r(features, ",", & fsave); value != NULL && i < SCIL_FEATURE_LAST; value = strtok_r(NULL, ",", & fsave)){
+        v->features[i++] = atof(value);
+      }
+      continue;
+    }
+    variable_t * v = find_variable(file);
+    if (v == NULL){
+      continue;
+    }
+    if (type[0] == 'D'){
+      v->done = 1;
+    }else if (type[0] == 'P'){
+      char * fields[7];
+      int count = 0;
+      for(char * item = strtok_r(NULL, "\t", & saveptr); item != NULL && count < 7; item = strtok_r(NULL, "\t", & saveptr)){
+        fields[count++] = item;
+      }
+      if (count != 7){
+        continue;
+      }
+      sweep_point_t p = {fields[0], (sweep_kind_t) atoi(fields[1]), atof(fields[2]), atof(fields[3]), atof(fields[4]), atof(fields[5]), atof(fields[6]), 0};
+      add_point(v, & p);
+    }
+  }
+  free(line);
+  fclose(f);
+}
+
+static void write_state(const variable_t * v){
+  pthread_mutex_lock(& state_lock);
+  fprintf(state, "V\t%s\t%d\t%g\t", v->file, v->datatype, v->randomness);
+  for(int i=0; i < SCIL_FEATURE_LAST; i++){
+    fprintf(state, "%s%.17g", i == 0 ? "" : ",", v->features[i]);
+  }
+  fprintf(state, "\n");
+  for(int i=0; i < v->point_count; i++){
+    const sweep_point_t * p = & v->points[i];
+    fprintf(state, "P\t%s\t%s\t%d\t%.17g\t%.17g\t%.17g\t%.17g\t%.17g\n", v->file, p->chain, p->kind, p->tolerance, p->error, p->ratio, p->c_speed, p->d_speed);
+  }
+  fprintf(state, "D\t%s\n", v->file);
+  fflush(state);
+  pthread_mutex_unlock(& state_lock);
+}
+
+// keeps the leading values along the slowest dimension
+static void limit_dims(scil_dims_t * dims){
+  const size_t count = scil_dims_get_count(dims);
+  if (max_values <= 0 || count <= (size_t) max_values){
+    return;
+  }
+  const size_t slab = count / dims->length[dims->dims - 1];
+  const size_t keep = (size_t) max_values / slab;
+  dims->length[dims->dims - 1] = keep > 0 ? keep : 1;
+}
+
+static void measure_chains(variable_t * v, sweep_data_t * s, const char * chains, int lossy){
+  char * chain_list = strdup(chains);
+  char * saveptr;
+  for(char * chain = strtok_r(chain_list, ";", & saveptr); chain != NULL; chain = strtok_r(NULL, ";", & saveptr)){
+    sweep_point_t points[SWEEP_LEVELS];
+    int count = 1;
+    if (lossy){
+      scilO_sweep_lossy_points(s, chain, points);
+      count = SWEEP_LEVELS;
+    }else{
+      memset(points, 0, sizeof(sweep_point_t));
+      points[0].chain = chain;
+      points[0].kind = SWEEP_LOSSLESS;
+    }
+    for(int i=0; i < count; i++){
+      int ret = scilO_sweep_measure(s, & points[i], warmup, repetitions);
+      if (ret == SCIL_NO_ERR){
+        add_point(v, & points[i]);
+      }else{
+        debug("Skipping %s with %s on %s: %d\n", chain, scilO_sweep_kind_name(points[i].kind), v->file, ret);
+      }
+    }
+  }
+  free(chain_list);
+}
+
+static void process(const char * file){
+  byte * read_data = NULL;
+  SCIL_Datatype_t datatype;
+  scil_dims_t dims;
+  size_t read_size;
+  pthread_mutex_lock(& read_lock);
+  int ret = plugin->readData(file, & read_data, & datatype, & dims, & read_size);
+  pthread_mutex_unlock(& read_lock);
+  if (ret != 0){
+    printf("Warning: the file %s could not be read\n", file);
+    return;
+  }
+  if (datatype < SCIL_DATATYPE_NUMERIC_MIN || datatype > SCIL_DATATYPE_NUMERIC_MAX){
+    printf("Skipping %s, the data type %s is not numeric\n", file, scil_datatype_to_str(datatype));
+    scil_free_plugin_data(read_data);
+    return;
+  }
+  limit_dims(& dims);
+  // the chains may use the data buffer up to the size limit
+  byte * data = (byte*) scilU_safe_malloc(scil_get_compressed_data_size_limit(& dims, datatype));
+  memcpy(data, read_data, scil_dims_get_size(& dims, datatype));
+  scil_free_plugin_data(read_data);
+
+  variable_t v;
+  memset(& v, 0, sizeof(v));
+  v.file = (char*) file;
+  v.datatype = datatype;
+  scilU_get_data_features(data, datatype, & dims, fill_value, v.features);
+
+  sweep_data_t s;
+  scilO_sweep_init(& s, datatype, data, & dims);
+  v.randomness = (double) scilU_get_data_randomness(data, scil_dims_get_size(& dims, datatype), s.tmp_buff, s.buff_size);
+  measure_chains(& v, & s, lossless_chains, 0);
+  if (datatype == SCIL_TYPE_FLOAT || datatype == SCIL_TYPE_DOUBLE){
+    measure_chains(& v, & s, lossy_chains, 1);
+  }
+  scilO_sweep_destroy(& s);
+  free(data);
+
+  write_state(& v);
+  printf("%s: %d points\n", file, v.point_count);
+  for(int i=0; i < v.point_count; i++){
+    free((char*) v.points[i].chain);
+  }
+  free(v.points);
+}
+
+static void * worker(void * arg){
+  (void) arg;
+  while(1){
+    pthread_mutex_lock(& todo_lock);
+    const int pos = todo_next++;
+    pthread_mutex_unlock(& todo_lock);
+    if (pos >= todo_count){
+      return NULL;
+    }
+    process(todo[pos]);
+  }
+}
+
+static void read_file_list(char *** out, int * out_count){
+  int capacity = 64;
+  char ** list = (char**) malloc(sizeof(char*) * capacity);
+  int count = 0;
+  if (files != NULL){
+    char * file_list = strdup(files);
+    char * saveptr;
+    for(char * file = strtok_r(file_list, ",", & saveptr); file != NULL; file = strtok_r(NULL, ",", & saveptr)){
+      if (count == capacity){
+        capacity *= 2;
+        list = (char**) realloc(list, sizeof(char*) * capacity);
+      }
+      list[count++] = strdup(file);
+    }
+    free(file_list);
+  }
+  if (list_file != NULL){
+    FILE * f = fopen(list_file, "r");
+    if (f == NULL){
+      critical("Could not open %s: %s\n", list_file, strerror(errno));
+    }
+    char * line = NULL;
+    size_t len = 0;
+    while (getline(& line, & len, f) != -1){
+      line[strcspn(line, "\r\n")] = 0;
+      if (line[0] == 0 || line[0] == '#'){
+        continue;
+      }
+      if (count == capacity){
+        capacity *= 2;
+        list = (char**) realloc(list, sizeof(char*) * capacity);
+      }
+      list[count++] = strdup(line);
+    }
+    free(line);
+    fclose(f);
+  }
+  *out = list;
+  *out_count = count;
+}
+
+// the variables are sampled evenly from the list
+static void select_sample(char ** list, int * count){
+  if (sample <= 0 || sample >= *count){
+    return;
+  }
+  char * selected[sample];
+  for(int i=0; i < sample; i++){
+    const size_t pos = (size_t) i * *count / sample;
+    selected[i] = list[pos];
+    list[pos] = NULL;
+  }
+  for(int i=0; i < *count; i++){
+    free(list[i]);
+  }
+  memcpy(list, selected, sizeof(selected));
+  *count = sample;
+}
+
+// the name of a variable in the configuration
+static void print_name(FILE * f, const char * file){
+  const char * name = strrchr(file, '/') != NULL ? strrchr(file, '/') + 1 : file;
+  for(const char * c = name; *c != 0; c++){
+    fputc(*c == ';' || *c == ' ' ? '_' : *c, f);
+  }
+}
+
+// the time to compress, transfer and decompress one MiB as used by the chooser, or the ratio
+static double get_cost(const sweep_point_t * p){
+  if (bandwidth > 0){
+    return 1.0 / p->c_speed + p->ratio / bandwidth + 1.0 / p->d_speed;
+  }
+  return p->ratio;
+}
+
+// the index of the best lossless chain of the variable in classes, -1 if none was measured
+static int get_label(const variable_t * v, char ** classes, int class_count){
+  const sweep_point_t * best = NULL;
+  for(int i=0; i < v->point_count; i++){
+    const sweep_point_t * p = & v->points[i];
+    if (p->kind == SWEEP_LOSSLESS && (best == NULL || get_cost(p) < get_cost(best))){
+      best = p;
+    }
+  }
+  if (best == NULL){
+    return -1;
+  }
+  for(int i=0; i < class_count; i++){
+    if (strcmp(classes[i], best->chain) == 0){
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void write_conf(){
+  char conf_tmp[1024];
+  snprintf(conf_tmp, sizeof(conf_tmp), "%s.bak", conf_file);
+  FILE * f = fopen(conf_tmp, "w");
+  if (f == NULL){
+    critical("Could not create %s: %s\n", conf_tmp, strerror(errno));
+  }
+  fprintf(f, "#randomness; data type; variable; compressor name; compr. performance MiB; decompr. performance MiB; inverse compr. ratio; tolerance\n");
+  fprintf(f, "# created by scil-autotune from %d variables, median of %d runs\n", variable_count, repetitions);
+  // must match the order of hardware_limit_e
+  const char * names[] = {"network", "storage", "memory"};
+  for(int i=0; i < HARDWARE_MAX; i++){
+    const float limit = scilU_get_hardware_limit((enum hardware_limit_e) i);
+    if (limit > 0){
+      fprintf(f, "!%s %.1f\n", names[i], (double) limit);
+    }
+  }
+  for(int i=0; i < variable_count; i++){
+    variable_t * v = & variables[i];
+    if (! v->done){
+      continue;
+    }
+    scilO_sweep_mark_pareto(v->points, v->point_count);
+    for(int j=0; j < v->point_count; j++){
+      const sweep_point_t * p = & v->points[j];
+      if (p->kind != SWEEP_LOSSLESS && ! p->pareto){
+        continue;
+      }
+      fprintf(f, "%.1f; %d; ", v->randomness, v->datatype);
+      print_name(f, v->file);
+      fprintf(f, "; %s; %.1f; %.1f; %.4f", p->chain, p->c_speed, p->d_speed, p->ratio);
+      if (p->kind != SWEEP_LOSSLESS){
+        fprintf(f, "; ");
+        scilO_sweep_print_tolerance(f, p);
+      }
+      fprintf(f, "\n");
+    }
+  }
+  fclose(f);
+  int ret = rename(conf_tmp, conf_file);
+  if (ret != 0){
+    critical("Could not create %s: %s\n", conf_file, strerror(errno));
+  }
+}
+
+/*
+ * The decision tree is trained as a CART classifier: each node splits the
+ * samples on the feature and threshold with the lowest weighted Gini impurity.
+ */
+typedef struct{
+  int feature; // -2 for a leaf
+  double threshold;
+  int left;
+  int right;
+  int * counts;
+} tree_node_t;
+
+typedef struct{
+  const double * features; // of the sample
+  int label;
+} tree_sample_t;
+
+static tree_node_t * nodes = NULL;
+static int node_count = 0;
+static int node_capacity = 0;
+static int class_count = 0;
+
+static int sort_feature;
+
+static int compare_samples(const void * a, const void * b){
+  const double x = (*(const tree_sample_t**) a)->features[sort_feature];
+  const double y = (*(const tree_sample_t**) b)->features[sort_feature];
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double gini(const int * counts, int total){
+  if (total == 0){
+    return 0;
+  }
+  double sum = 0;
+  for(int c=0; c < class_count; c++){
+    const double p = (double) counts[c] / total;
+    sum += p * p;
+  }
+  return 1.0 - sum;
+}
+
+// the feature as seen by the prediction, NaN compares false and branches to the right
+static double feature_value(const tree_sample_t * s, int feature){
+  const double v = s->features[feature];
+  return isnan(v) ? (double) INFINITY : v;
+}
+
+static int build_tree(tree_sample_t ** samples, int count, int depth){
+  if (node_count == node_capacity){
+    node_capacity = node_capacity == 0 ? 64 : node_capacity * 2;
+    nodes = (tree_node_t*) realloc(nodes, sizeof(tree_node_t) * node_capacity);
+  }
+  const int pos = node_count++;
+  tree_node_t * node = & nodes[pos];
+  node->feature = -2;
+  node->threshold = -2;
+  node->left = -1;
+  node->right = -1;
+  node->counts = (int*) calloc(class_count, sizeof(int));
+  for(int i=0; i < count; i++){
+    node->counts[samples[i]->label]++;
+  }
+  const double impurity = gini(node->counts, count);
+  if (depth >= tree_depth || count < 2 * min_leaf || ! (impurity > 0)){
+    return pos;
+  }
+
+  double best_impurity = impurity;
+  int best_feature = -1;
+  double best_threshold = 0;
+  int left_counts[class_count];
+  int right_counts[class_count];
+  for(int f=0; f < SCIL_FEATURE_LAST; f++){
+    sort_feature = f;
+    qsort(samples, count, sizeof(tree_sample_t*), compare_samples);
+    memset(left_counts, 0, sizeof(left_counts));
+    memcpy(right_counts, node->counts, sizeof(right_counts));
+    for(int i=0; i < count - 1; i++){
+      left_counts[samples[i]->label]++;
+      right_counts[samples[i]->label]--;
+      const double value = feature_value(samples[i], f);
+      const double next = feature_value(samples[i + 1], f);
+      if (i + 1 < min_leaf || count - i - 1 < min_leaf || ! (next > value)){
+        continue;
+      }
+      const double split = ((i + 1) * gini(left_counts, i + 1) + (count - i - 1) * gini(right_counts, count - i - 1)) / count;
+      if (split < best_impurity){
+        best_impurity = split;
+        best_feature = f;
+        best_threshold = isinf(next) ? value : value + (next - value) / 2;
+      }
+    }
+  }
+  if (best_feature < 0){
+    return pos;
+  }
+
+  // partition the samples, the nodes may move while the children are built
+  int left = 0;
+  for(int i=0; i < count; i++){
+    if (feature_value(samples[i], best_feature) <= best_threshold){
+      tree_sample_t * tmp = samples[left];
+      samples[left++] = samples[i];
+      samples[i] = tmp;
+    }
+  }
+  const int left_child = build_tree(samples, left, depth + 1);
+  const int right_child = build_tree(samples + left, count - left, depth + 1);
+  nodes[pos].feature = best_feature;
+  nodes[pos].threshold = best_threshold;
+  nodes[pos].left = left_child;
+  nodes[pos].right = right_child;
+  return pos;
+}
+
+// the format read by the chooser, as exported from a scikit-learn tree
+static void write_tree(){
+  int capacity = count_chains(lossless_chains);
+  char ** classes = (char**) malloc(sizeof(char*) * capacity);
+  char * chain_list = strdup(lossless_chains);
+  char * saveptr;
+  for(char * chain = strtok_r(chain_list, ";", & saveptr); chain != NULL; chain = strtok_r(NULL, ";", & saveptr)){
+    classes[class_count++] = chain;
+  }
+
+  tree_sample_t * samples = (tree_sample_t*) malloc(sizeof(tree_sample_t) * (variable_count + 1));
+  tree_sample_t ** sample_ptrs = (tree_sample_t**) malloc(sizeof(tree_sample_t*) * (variable_count + 1));
+  int count = 0;
+  for(int i=0; i < variable_count; i++){
+    const int label = variables[i].done ? get_label(& variables[i], classes, class_count) : -1;
+    if (label >= 0){
+      samples[count].features = variables[i].features;
+      samples[count].label = label;
+      sample_ptrs[count] = & samples[count];
+      count++;
+    }
+  }
+  if (count == 0){
+    printf("Warning: no lossless chain was measured, the decision tree is not created\n");
+  }else{
+    build_tree(sample_ptrs, count, 0);
+
+    FILE * f = fopen(tree_file, "w");
+    if (f == NULL){
+      critical("Could not create %s: %s\n", tree_file, strerror(errno));
+    }
+    fprintf(f, "#classes\n");
+    for(int c=0; c < class_count; c++){
+      fprintf(f, "%s%s", c == 0 ? "" : ";", classes[c]);
+    }
+    fprintf(f, "\n#left\n");
+    for(int i=0; i < node_count; i++){
+      fprintf(f, "%s%d", i == 0 ? "" : ";", nodes[i].left);
+    }
+    fprintf(f, "\n#right\n");
+    for(int i=0; i < node_count; i++){
+      fprintf(f, "%s%d", i == 0 ? "" : ";", nodes[i].right);
+    }
+    fprintf(f, "\n#thresholds\n");
+    for(int i=0; i < node_count; i++){
+      fprintf(f, "%s%.17g", i == 0 ? "" : ";", nodes[i].threshold);
+    }
+    fprintf(f, "\n#indices\n");
+    for(int i=0; i < node_count; i++){
+      fprintf(f, "%s%d", i == 0 ? "" : ";", nodes[i].feature);
+    }
+    fprintf(f, "\n#values\n");
+    for(int i=0; i < node_count; i++){
+      fprintf(f, "%s", i == 0 ? "" : ";");
+      for(int c=0; c < class_count; c++){
+        fprintf(f, "%d.", nodes[i].counts[c]);
+      }
+    }
+    fprintf(f, "\n");
+    fclose(f);
+    printf("Decision tree with %d nodes trained on %d variables\n", node_count, count);
+  }
+
+  for(int i=0; i < node_count; i++){
+    free(nodes[i].counts);
+  }
+  free(nodes);
+  free(samples);
+  free(sample_ptrs);
+  free(classes);
+  free(chain_list);
+}
+
+// the chooser reads the hardware limits when the first context is created
+static void initialize_library(){
+  scil_context_t * ctx;
+  scil_user_hints_t hints;
+  scil_user_hints_initialize(& hints);
+  hints.force_compression_methods = "memcopy";
+  int ret = scil_context_create(& ctx, SCIL_TYPE_DOUBLE, 0, NULL, & hints);
+  assert(ret == SCIL_NO_ERR);
+  scil_destroy_context(ctx);
+}
+
+int main(int argc, char** argv){
+  option_help known_args[] = {
+    {'f', "files", "The files to tune with, separated by ,", OPTION_OPTIONAL_ARGUMENT, 's', & files},
+    {'l', "list", "A file with the files to tune with, one per line", OPTION_OPTIONAL_ARGUMENT, 's', & list_file},
+    {'I', "in_file_format", "Format of the files", OPTION_OPTIONAL_ARGUMENT, 's', & in_file_format},
+    {'s', "sample", "Tune with this many files evenly taken from the list, 0 for all", OPTION_OPTIONAL_ARGUMENT, 'd', & sample},
+    {0, "max-values", "Only measure the leading values of larger variables", OPTION_OPTIONAL_ARGUMENT, 'd', & max_values},
+    {0, "lossless", "The lossless chains, separated by ;", OPTION_OPTIONAL_ARGUMENT, 's', & lossless_chains},
+    {0, "lossy", "The lossy chains to sweep, separated by ;", OPTION_OPTIONAL_ARGUMENT, 's', & lossy_chains},
+    {'t', "threads", "Number of variables processed in parallel, 0 for the number of CPUs", OPTION_OPTIONAL_ARGUMENT, 'd', & threads},
+    {'w', "warmup", "Number of runs before the measurement", OPTION_OPTIONAL_ARGUMENT, 'd', & warmup},
+    {'r', "repetitions", "Number of measured runs, the median throughput is used", OPTION_OPTIONAL_ARGUMENT, 'd', & repetitions},
+    {0, "fill-value", "The fill value of the variables", OPTION_OPTIONAL_ARGUMENT, 'F', & fill_value},
+    {0, "bandwidth", "MiB/s to transfer the data, the best chain minimizes the time instead of the ratio; by default the !network and !storage limits", OPTION_OPTIONAL_ARGUMENT, 'F', & bandwidth},
+    {0, "tree-depth", "Maximum depth of the decision tree", OPTION_OPTIONAL_ARGUMENT, 'd', & tree_depth},
+    {0, "min-leaf", "Minimum number of variables in a leaf of the decision tree", OPTION_OPTIONAL_ARGUMENT, 'd', & min_leaf},
+    {0, "state", "The results of the variables, an existing file is resumed", OPTION_OPTIONAL_ARGUMENT, 's', & state_file},
+    {0, "conf", "The configuration file to create", OPTION_OPTIONAL_ARGUMENT, 's', & conf_file},
+    {0, "tree", "The decision tree file to create", OPTION_OPTIONAL_ARGUMENT, 's', & tree_file},
+    LAST_OPTION
+  };
+
+  int printhelp = 0;
+  int parsed = scilO_parseOptions(argc, argv, known_args, & printhelp);
+  plugin = scil_find_plugin(in_file_format);
+  if (plugin == NULL){
+    critical("Unknown format for input: %s\n", in_file_format);
+  }
+  scilO_parseOptions(argc - parsed, argv + parsed, plugin->get_options(), & printhelp);
+  if (printhelp != 0 || (files == NULL && list_file == NULL) || repetitions < 1 || warmup < 0 || tree_depth < 0 || min_leaf < 1){
+    printf("\nSynopsis: %s ", argv[0]);
+    scilO_print_help(known_args, "-- <Input plugin options, see below>\n");
+    printf("\nPlugin options for input plugin %s\n", in_file_format);
+    scilO_print_help(plugin->get_options(), "");
+    exit(printhelp == 1 ? 0 : 1);
+  }
+  if (threads <= 0){
+    threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  initialize_library();
+  if (bandwidth <= 0){
+    const double network = scilU_get_hardware_limit(NETWORK);
+    const double storage = scilU_get_hardware_limit(STORAGE);
+    bandwidth = network > 0 && (storage <= 0 || network < storage) ? network : storage;
+  }
+
+  char ** list;
+  int list_count;
+  read_file_list(& list, & list_count);
+  select_sample(list, & list_count);
+
+  load_state();
+  todo = (char**) malloc(sizeof(char*) * (list_count + 1));
+  for(int i=0; i < list_count; i++){
+    const variable_t * v = find_variable(list[i]);
+    if (v == NULL || ! v->done){
+      todo[todo_count++] = list[i];
+    }
+  }
+  printf("Tuning with %d variables, %d are done already, %d threads\n", list_count, list_count - todo_count, threads);
+
+  state = fopen(state_file, "a");
+  if (state == NULL){
+    critical("Could not open %s: %s\n", state_file, strerror(errno));
+  }
+  pthread_t workers[threads];
+  for(int t=0; t < threads; t++){
+    int ret = pthread_create(& workers[t], NULL, worker, NULL);
+    if (ret != 0){
+      critical("pthread_create returned the error %s\n", strerror(ret));
+    }
+  }
+  for(int t=0; t < threads; t++){
+    pthread_join(workers[t], NULL);
+  }
+  fclose(state);
+
+  // the state contains the variables of all runs
+  free_variables();
+  load_state();
+  write_conf();
+  write_tree();
+  printf("Created %s and %s\n", conf_file, tree_file);
+
+  free_variables();
+  free(variables);
+  for(int i=0; i < list_count; i++){
+    free(list[i]);
+  }
+  free(list);
+  free(todo);
+  return 0;
+}
@@ -0,0 +1,325 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Measures the effective I/O bandwidth of each chain on local storage: the
+ * data is compressed and written to a file, then read and decompressed.
+ * The effective bandwidth relates the size of the uncompressed data to the
+ * time of both steps and is compared to writing and reading the raw data.
+ * The raw bandwidth is stored as the hardware limit "!storage" in scil.conf.
+ * With --direct the file is accessed with O_DIRECT, otherwise the data is
+ * synced and dropped from the page cache before it is read unless --no-fsync
+ * is given, in which case the page cache is measured.
+ */
+
+// for O_DIRECT
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <scil.h>
+#include <scil-error.h>
+#include <scil-debug.h>
+#include <scil-option.h>
+#include <scil-patterns.h>
+#include <scil-util.h>
+
+#include <scil-conf-update.h>
+
+// O_DIRECT requires buffers, sizes and offsets aligned to the logical block size
+#define ALIGNMENT 4096
+
+static int warmup = 1;
+static int repetitions = 3;
+static int count = 16 * 1024 * 1024;
+static int direct = 0;
+static int no_fsync = 0;
+static double abstol = 0.01;
+static char * dir = ".";
+static char * chains_str = "memcopy;lz4;zstd;abstol,lz4;quantize,zstd";
+static char * pattern = "simplex206";
+static char * csv_file = "scil-bench-io.csv";
+static char * conf_file = "scil.conf";
+
+static char file[1024];
+
+typedef struct{
+	double compress;
+	double write;
+	double read;
+	double decompress;
+	size_t size; // of the file
+} io_times_t;
+
+static int compare_double(const void * a, const void * b){
+	const double x = *(const double*) a;
+	const double y = *(const double*) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double median(double * values, int n){
+	qsort(values, n, sizeof(double), compare_double);
+	return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+static size_t aligned(size_t size){
+	return direct ? (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT : size;
+}
+
+static byte * allocate_aligned(size_t size){
+	void * buffer = NULL;
+	int ret = posix_memalign(& buffer, ALIGNMENT, aligned(size));
+	if (ret != 0){
+		critical("posix_memalign returned the error %s\n", strerror(ret));
+	}
+	return (byte*) buffer;
+}
+
+static int open_file(int flags){
+	int fd = open(file, flags | (direct ? O_DIRECT : 0), S_IRUSR | S_IWUSR);
+	if (fd < 0){
+		critical("Could not open %s: %s%s\n", file, strerror(errno), direct && errno == EINVAL ? ", the file system does not support O_DIRECT" : "");
+	}
+	return fd;
+}
+
+// writes the buffer, the time includes the fsync
+static double write_file(const byte * buffer, size_t size){
+	scil_timer timer;
+	scilU_start_timer(& timer);
+	int fd = open_file(O_WRONLY | O_CREAT | O_TRUNC);
+	const size_t total = aligned(size);
+	for(size_t pos = 0; pos < total; ){
+		const ssize_t ret = write(fd, buffer + pos, total - pos);
+		if (ret < 0){
+			critical("Could not write %s: %s\n", file, strerror(errno));
+		}
+		pos += (size_t) ret;
+	}
+	if (! no_fsync && fsync(fd) != 0){
+		critical("Could not sync %s: %s\n", file, strerror(errno));
+	}
+	close(fd);
+	const double seconds = scilU_stop_timer(timer);
+
+	// synced pages are clean and can be dropped, the next read comes from the device
+	if (! direct && ! no_fsync){
+		fd = open(file, O_RDONLY);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+	return seconds;
+}
+
+static double read_file(byte * buffer, size_t size){
+	scil_timer timer;
+	scilU_start_timer(& timer);
+	int fd = open_file(O_RDONLY);
+	const size_t total = aligned(size);
+	for(size_t pos = 0; pos < total; ){
+		const ssize_t ret = read(fd, buffer + pos, total - pos);
+		if (ret < 0){
+			critical("Could not read %s: %s\n", file, strerror(errno));
+		}
+		if (ret == 0){
+			critical("%s is shorter than expected\n", file);
+		}
+		pos += (size_t) ret;
+	}
+	close(fd);
+	return scilU_stop_timer(timer);
+}
+
+// writes and reads the uncompressed data
+static void measure_raw(double * data, size_t size, io_times_t * out){
+	double seconds_write[repetitions];
+	double seconds_read[repetitions];
+	byte * buffer = allocate_aligned(size);
+	for(int run = -warmup; run < repetitions; run++){
+		const double w = write_file((byte*) data, size);
+		const double r = read_file(buffer, size);
+		if (run >= 0){
+			seconds_write[run] = w;
+			seconds_read[run] = r;
+		}
+	}
+	free(buffer);
+	memset(out, 0, sizeof(io_times_t));
+	out->write = median(seconds_write, repetitions);
+	out->read = median(seconds_read, repetitions);
+	out->size = size;
+}
+
+static int measure_chain(const char * chain, double * data, scil_dims_t * dims, io_times_t * out){
+	const size_t limit = scil_get_compressed_data_size_limit(dims, SCIL_TYPE_DOUBLE);
+	byte * compressed = allocate_aligned(limit);
+	byte * read_buffer = allocate_aligned(limit);
+	byte * output = (byte*) malloc(limit);
+	byte * tmp = (byte*) malloc(limit);
+	double seconds[4][repetitions];
+
+	scil_user_hints_t hints;
+	scil_user_hints_initialize(& hints);
+	hints.absolute_tolerance = abstol;
+	hints.force_compression_methods = (char*) chain;
+	scil_context_t * ctx;
+	int ret = scil_context_create(& ctx, SCIL_TYPE_DOUBLE, 0, NULL, & hints);
+
+	size_t size = 0;
+	for(int run = -warmup; run < repetitions && ret == SCIL_NO_ERR; run++){
+		scil_timer timer;
+		scilU_start_timer(& timer);
+		ret = scil_compress(compressed, limit, data, dims, & size, ctx);
+		const double c = scilU_stop_timer(timer);
+		if (ret != SCIL_NO_ERR){
+			break;
+		}
+		const double w = write_file(compressed, size);
+		const double r = read_file(read_buffer, size);
+		scilU_start_timer(& timer);
+		ret = scil_decompress(SCIL_TYPE_DOUBLE, (double*) output, dims, read_buffer, size, tmp);
+		const double d = scilU_stop_timer(timer);
+		if (run >= 0){
+			seconds[0][run] = c;
+			seconds[1][run] = w;
+			seconds[2][run] = r;
+			seconds[3][run] = d;
+		}
+	}
+	if (ctx != NULL){
+		scil_destroy_context(ctx);
+	}
+	free(compressed);
+	free(read_buffer);
+	free(output);
+	free(tmp);
+	if (ret != SCIL_NO_ERR){
+		return ret;
+	}
+	out->compress = median(seconds[0], repetitions);
+	out->write = median(seconds[1], repetitions);
+	out->read = median(seconds[2], repetitions);
+	out->decompress = median(seconds[3], repetitions);
+	out->size = size;
+	return SCIL_NO_ERR;
+}
+
+static double mib_per_s(size_t size, double seconds){
+	return size / seconds / 1024 / 1024;
+}
+
+static void report(FILE * csv, const char * chain, size_t data_size, const io_times_t * t, const io_times_t * raw){
+	const double eff_write = mib_per_s(data_size, t->compress + t->write);
+	const double eff_read = mib_per_s(data_size, t->read + t->decompress);
+	const double raw_write = mib_per_s(data_size, raw->write);
+	const double raw_read = mib_per_s(data_size, raw->read);
+	const double ratio = (double) t->size / data_size;
+	printf("%-20s %8.4f %12.1f %12.1f %8.2f %8.2f\n", chain, ratio, eff_write, eff_read, eff_write / raw_write, eff_read / raw_read);
+	fprintf(csv, "\"%s\",ok,%zu,%.4f,%.6f,%.6f,%.6f,%.6f,%.1f,%.1f,%.3f,%.3f\n", chain, t->size, ratio,
+		t->compress, t->write, t->read, t->decompress, eff_write, eff_read, eff_write / raw_write, eff_read / raw_read);
+	fflush(csv);
+}
+
+int main(int argc, char ** argv){
+	option_help known_args[] = {
+		{'d', "dir", "Directory of the file, it should reside on the storage to measure", OPTION_OPTIONAL_ARGUMENT, 's', & dir},
+		{'n', "count", "Number of doubles", OPTION_OPTIONAL_ARGUMENT, 'd', & count},
+		{'c', "chains", "Chains to measure, separated by ;", OPTION_OPTIONAL_ARGUMENT, 's', & chains_str},
+		{0, "abstol", "Absolute tolerance of lossy chains", OPTION_OPTIONAL_ARGUMENT, 'F', & abstol},
+		{'w', "warmup", "Number of runs before the measurement", OPTION_OPTIONAL_ARGUMENT, 'd', & warmup},
+		{'r', "repetitions", "Number of measured runs, the median is reported", OPTION_OPTIONAL_ARGUMENT, 'd', & repetitions},
+		{0, "direct", "Bypass the page cache with O_DIRECT", OPTION_FLAG, 'd', & direct},
+		{0, "no-fsync", "Do not sync the file after writing, the page cache is measured", OPTION_FLAG, 'd', & no_fsync},
+		{0, "pattern", "The pattern of the library to compress", OPTION_OPTIONAL_ARGUMENT, 's', & pattern},
+		{0, "csv", "CSV file with all results", OPTION_OPTIONAL_ARGUMENT, 's', & csv_file},
+		{0, "conf", "The configuration file to update with the storage bandwidth", OPTION_OPTIONAL_ARGUMENT, 's', & conf_file},
+		LAST_OPTION
+	};
+	int printhelp = 0;
+	scilO_parseOptions(argc, argv, known_args, & printhelp);
+	if (printhelp != 0 || repetitions < 1 || warmup < 0 || count < 1){
+		printf("\nSynopsis: %s ", argv[0]);
+		scilO_print_help(known_args, "\n");
+		exit(printhelp == 1 ? 0 : 1);
+	}
+
+	int pattern_index = -1;
+	for(int i = 0; i < scilP_get_pattern_library_size(); i++){
+		if (strcmp(scilP_get_library_pattern_name(i), pattern) == 0){
+			pattern_index = i;
+		}
+	}
+	if (pattern_index == -1){
+		printf("Unknown pattern %s\n", pattern);
+		exit(1);
+	}
+	scil_dims_t dims;
+	scil_dims_initialize_1d(& dims, count);
+	const size_t data_size = scil_dims_get_size(& dims, SCIL_TYPE_DOUBLE);
+	double * data = (double*) allocate_aligned(scil_get_compressed_data_size_limit(& dims, SCIL_TYPE_DOUBLE));
+	int ret = scilP_create_library_pattern(data, SCIL_TYPE_DOUBLE, & dims, pattern_index);
+	assert(ret == SCIL_NO_ERR);
+	snprintf(file, sizeof(file), "%s/scil-bench-io.%d.tmp", dir, (int) getpid());
+
+	FILE * csv = fopen(csv_file, "w");
+	if (csv == NULL){
+		critical("fopen returned the error %s\n", strerror(errno));
+	}
+	fprintf(csv, "chain,status,size,ratio,compress_s,write_s,read_s,decompress_s,write_eff,read_eff,write_speedup,read_speedup\n");
+
+	io_times_t raw;
+	measure_raw(data, data_size, & raw);
+	const double raw_write = mib_per_s(data_size, raw.write);
+	const double raw_read = mib_per_s(data_size, raw.read);
+	printf("%-20s %8s %12s %12s %8s %8s\n", "chain", "ratio", "write MiB/s", "read MiB/s", "write x", "read x");
+	report(csv, "raw", data_size, & raw, & raw);
+
+	int error_occured = 0;
+	char * chains = strdup(chains_str);
+	char * saveptr = NULL;
+	for(char * chain = strtok_r(chains, ";", & saveptr); chain != NULL; chain = strtok_r(NULL, ";", & saveptr)){
+		io_times_t t;
+		if (measure_chain(chain, data, & dims, & t) != SCIL_NO_ERR){
+			printf("Warning: compression %s returned an error!\n", chain);
+			fprintf(csv, "\"%s\",error,0,0,0,0,0,0,0,0,0,0\n", chain);
+			error_occured = 1;
+			continue;
+		}
+		report(csv, chain, data_size, & t, & raw);
+	}
+	fclose(csv);
+	unlink(file);
+
+	// the slower direction limits the transfer
+	const double storage = raw_write < raw_read ? raw_write : raw_read;
+	char comment[128];
+	snprintf(comment, sizeof(comment), "storage writes %.1f MiB/s and reads %.1f MiB/s%s", raw_write, raw_read,
+		direct ? " with O_DIRECT" : (no_fsync ? " without fsync" : ""));
+	if (scilO_conf_set_hardware_limit(conf_file, "storage", storage, comment) != 0){
+		critical("Could not update %s: %s\n", conf_file, strerror(errno));
+	}
+	printf("Set !storage %.1f in %s\n", storage, conf_file);
+
+	free(chains);
+	free(data);
+	return error_occured;
+}
@@ -0,0 +1,227 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Measures the rate-distortion of the lossy chains: each chain compresses the
+ * patterns of the library and the given files with a sweep of absolute,
+ * relative and significant bits tolerances.
+ * For each data class and kind of tolerance the Pareto-optimal points regarding
+ * achieved error, ratio and throughput are written as configuration entries
+ * tagged with their tolerance, all points are written as CSV.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <scil.h>
+#include <scil-data-characteristics.h>
+#include <scil-error.h>
+#include <scil-debug.h>
+#include <scil-option.h>
+#include <scil-patterns.h>
+#include <scil-util.h>
+
+#include <scil-sweep.h>
+#include <file-formats/scil-file-format.h>
+
+static int warmup = 1;
+static int repetitions = 3;
+static int count = 256 * 1024;
+static char * chains = "abstol;abstol,lz4;quantize;quantize,zstd;sigbits;sigbits,lz4;sigbits-blocked;zfp-abstol;zfp-precision;sz;allquant";
+static char * check_pattern = NULL;
+static char * files = NULL;
+static char * in_file_format = "csv";
+static char * conf_file = "scil-pareto.conf";
+static char * csv_file = "scil-pareto.csv";
+
+static FILE * conf = NULL;
+static FILE * csv = NULL;
+
+static void write_csv(const char * name, SCIL_Datatype_t datatype, double r, const sweep_point_t * p, const char * status){
+  fprintf(csv, "%s,%d,%.1f,\"%s\",%s,%g,%g,%.4f,%.1f,%.1f,%s,%d\n",
+    name, datatype, r, p->chain, scilO_sweep_kind_name(p->kind), p->tolerance,
+    p->kind == SWEEP_BITS ? 0.0 - p->error : p->error,
+    p->ratio, p->c_speed, p->d_speed, status, p->pareto);
+  fflush(csv);
+}
+
+static void sweep(const char * name, SCIL_Datatype_t datatype, byte * data, scil_dims_t * dims){
+  sweep_data_t s;
+  scilO_sweep_init(& s, datatype, data, dims);
+  const double r = (double) scilU_get_data_randomness(data, scil_dims_get_size(dims, datatype), s.tmp_buff, s.buff_size);
+
+  char * chain_list = strdup(chains);
+  int chain_count = 1;
+  for(char * c = chain_list; *c != 0; c++){
+    chain_count += *c == ';';
+  }
+  sweep_point_t * points = (sweep_point_t*) scilU_safe_malloc(sizeof(sweep_point_t) * chain_count * SWEEP_LEVELS);
+  int point_count = 0;
+  int violations = 0;
+
+  char * saveptr;
+  for(char * chain = strtok_r(chain_list, ";", & saveptr); chain != NULL; chain = strtok_r(NULL, ";", & saveptr)){
+    sweep_point_t sweep_points[SWEEP_LEVELS];
+    scilO_sweep_lossy_points(& s, chain, sweep_points);
+    for(int i=0; i < SWEEP_LEVELS; i++){
+      sweep_point_t * p = & sweep_points[i];
+      int ret = scilO_sweep_measure(& s, p, warmup, repetitions);
+      if (ret == SCIL_NO_ERR){
+        points[point_count++] = *p;
+      }else if (ret == SCIL_PRECISION_ERR){
+        // also chains that do not support the kind of tolerance
+        debug("%s violates %s %g on %s\n", chain, scilO_sweep_kind_name(p->kind), p->tolerance, name);
+        violations++;
+        write_csv(name, datatype, r, p, "violation");
+      }else{
+        // the chain does not support the data type
+        debug("Skipping %s with %s on %s: %d\n", chain, scilO_sweep_kind_name(p->kind), name, ret);
+      }
+    }
+  }
+
+  const int pareto = scilO_sweep_mark_pareto(points, point_count);
+  for(int i=0; i < point_count; i++){
+    const sweep_point_t * p = & points[i];
+    write_csv(name, datatype, r, p, "ok");
+    if (p->pareto){
+      fprintf(conf, "%.1f; %d; %s; %s; %.1f; %.1f; %.4f; ", r, datatype, name, p->chain, p->c_speed, p->d_speed, p->ratio);
+      scilO_sweep_print_tolerance(conf, p);
+      fprintf(conf, "\n");
+    }
+  }
+  fflush(conf);
+  printf("%s %s: %d of %d points are Pareto-optimal, %d violate the tolerance\n", name, scil_datatype_to_str(datatype), pareto, point_count, violations);
+
+  free(points);
+  free(chain_list);
+  scilO_sweep_destroy(& s);
+}
+
+static void sweep_patterns(){
+  scil_dims_t dims;
+  scil_dims_initialize_1d(& dims, count);
+  const size_t buff_size = scil_get_compressed_data_size_limit(& dims, SCIL_TYPE_DOUBLE);
+  byte * data = (byte*) scilU_safe_malloc(buff_size);
+
+  for(int i=0; i < scilP_get_pattern_library_size(); i++){
+    char * name = scilP_get_library_pattern_name(i);
+    if (check_pattern != NULL && strcmp(name, check_pattern) != 0){
+      continue;
+    }
+    const SCIL_Datatype_t types[] = {SCIL_TYPE_FLOAT, SCIL_TYPE_DOUBLE};
+    for(int d=0; d < 2; d++){
+      int ret = scilP_create_library_pattern(data, types[d], & dims, i);
+      assert(ret == SCIL_NO_ERR);
+      sweep(name, types[d], data, & dims);
+    }
+  }
+  free(data);
+}
+
+static void sweep_file(scil_file_plugin_t * plugin, const char * file){
+  byte * read_data = NULL;
+  SCIL_Datatype_t datatype;
+  scil_dims_t dims;
+  size_t read_size;
+  int ret = plugin->readData(file, & read_data, & datatype, & dims, & read_size);
+  if (ret != 0){
+    critical("The input file %s could not be read\n", file);
+  }
+  if (datatype != SCIL_TYPE_FLOAT && datatype != SCIL_TYPE_DOUBLE){
+    printf("Skipping %s, only floating point data is compressed lossy\n", file);
+    scil_free_plugin_data(read_data);
+    return;
+  }
+  // the chains may use the data buffer up to the size limit
+  const size_t buff_size = scil_get_compressed_data_size_limit(& dims, datatype);
+  byte * data = (byte*) scilU_safe_malloc(buff_size);
+  memcpy(data, read_data, scil_dims_get_size(& dims, datatype));
+  scil_free_plugin_data(read_data);
+
+  // the name is stored in the configuration
+  const char * name = strrchr(file, '/') != NULL ? strrchr(file, '/') + 1 : file;
+  sweep(name, datatype, data, & dims);
+  free(data);
+}
+
+int main(int argc, char** argv){
+  option_help known_args[] = {
+    {'w', "warmup", "Number of runs before the measurement", OPTION_OPTIONAL_ARGUMENT, 'd', & warmup},
+    {'r', "repetitions", "Number of measured runs, the median throughput is used", OPTION_OPTIONAL_ARGUMENT, 'd', & repetitions},
+    {'n', "count", "Number of values of the patterns", OPTION_OPTIONAL_ARGUMENT, 'd', & count},
+    {'c', "chains", "The lossy chains to sweep, separated by ;", OPTION_OPTIONAL_ARGUMENT, 's', & chains},
+    {0, "pattern", "Only sweep this pattern, also set by SCIL_PATTERN_TO_USE", OPTION_OPTIONAL_ARGUMENT, 's', & check_pattern},
+    {'f', "files", "Sweep these files instead of the patterns, separated by ,", OPTION_OPTIONAL_ARGUMENT, 's', & files},
+    {'I', "in_file_format", "Format of the files", OPTION_OPTIONAL_ARGUMENT, 's', & in_file_format},
+    {0, "conf", "The configuration file with the Pareto-optimal entries to create", OPTION_OPTIONAL_ARGUMENT, 's', & conf_file},
+    {0, "csv", "CSV file with all points", OPTION_OPTIONAL_ARGUMENT, 's', & csv_file},
+    LAST_OPTION
+  };
+
+  int printhelp = 0;
+  int parsed = scilO_parseOptions(argc, argv, known_args, & printhelp);
+
+  scil_file_plugin_t * plugin = NULL;
+  if (files != NULL){
+    plugin = scil_find_plugin(in_file_format);
+    if (plugin == NULL){
+      critical("Unknown format for input: %s\n", in_file_format);
+    }
+    scilO_parseOptions(argc - parsed, argv + parsed, plugin->get_options(), & printhelp);
+  }
+  if (printhelp != 0 || repetitions < 1 || warmup < 0 || count < 1){
+    printf("\nSynopsis: %s ", argv[0]);
+    scilO_print_help(known_args, "-- <Input plugin options, see below>\n");
+    if (plugin != NULL){
+      printf("\nPlugin options for input plugin %s\n", in_file_format);
+      scilO_print_help(plugin->get_options(), "");
+    }
+    exit(printhelp == 1 ? 0 : 1);
+  }
+  if (check_pattern == NULL){
+    check_pattern = getenv("SCIL_PATTERN_TO_USE");
+  }
+
+  conf = fopen(conf_file, "w");
+  if (conf == NULL){
+    critical("Could not create %s: %s\n", conf_file, strerror(errno));
+  }
+  fprintf(conf, "#randomness; data type; pattern name; compressor name; compr. performance MiB; decompr. performance MiB; inverse compr. ratio; tolerance\n");
+  fprintf(conf, "# Pareto-optimal chains regarding achieved error, ratio and throughput, median of %d runs\n", repetitions);
+  csv = fopen(csv_file, "w");
+  if (csv == NULL){
+    critical("Could not create %s: %s\n", csv_file, strerror(errno));
+  }
+  fprintf(csv, "class,datatype,randomness,chain,kind,tolerance,achieved,ratio,c_median,d_median,status,pareto\n");
+
+  if (files != NULL){
+    char * file_list = strdup(files);
+    char * saveptr;
+    for(char * file = strtok_r(file_list, ",", & saveptr); file != NULL; file = strtok_r(NULL, ",", & saveptr)){
+      sweep_file(plugin, file);
+    }
+    free(file_list);
+  }else{
+    sweep_patterns();
+  }
+
+  fclose(csv);
+  fclose(conf);
+  return 0;
+}
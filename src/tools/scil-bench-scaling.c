@@ -0,0 +1,391 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Measures how the compression scales when 1..N threads compress at once and
+ * share the memory bandwidth of the node.
+ * Weak scaling: each thread compresses its own buffer of the given size.
+ * Strong scaling: the threads split one buffer of the given size.
+ * The aggregate throughput of memcopy at saturation is stored as the hardware
+ * limit "!memory" in scil.conf.
+ */
+
+// for pthread_setaffinity_np()
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <scil.h>
+#include <scil-error.h>
+#include <scil-debug.h>
+#include <scil-option.h>
+#include <scil-patterns.h>
+#include <scil-util.h>
+
+#include <scil-conf-update.h>
+
+// a thread count is saturated if it reaches this share of the peak throughput
+#define SATURATION 0.9
+
+enum mode{
+	MODE_WEAK = 0,
+	MODE_STRONG = 1
+};
+
+static const char * mode_names[] = {"weak", "strong"};
+
+static int max_threads = 0;
+static int warmup = 1;
+static int repetitions = 3;
+static int pin = 0;
+static int count = 2 * 1024 * 1024;
+static char * mode_str = "both";
+static char * chains_str = "memcopy;lz4;abstol,lz4";
+static char * pattern = "random1-100";
+static char * csv_file = "scil-bench-scaling.csv";
+static char * conf_file = "scil.conf";
+
+typedef struct{
+	pthread_t thread;
+	int id;
+	const char * chain;
+
+	// the data of weak scaling is copied by the thread itself to place it near its CPU
+	const double * source;
+	double * input;
+	scil_dims_t dims;
+
+	byte * compressed;
+	size_t compressed_limit;
+	size_t compressed_size;
+	double * output;
+	byte * tmp;
+
+	double * seconds_compress;
+	double * seconds_decompress;
+	int error;
+} worker_t;
+
+static pthread_barrier_t start_barrier;
+static pthread_barrier_t end_barrier;
+
+typedef struct{
+	double aggregate;
+	double per_thread;
+	double efficiency;
+} scaling_t;
+
+static int compare_double(const void * a, const void * b){
+	const double x = *(const double*) a;
+	const double y = *(const double*) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double median(double * values, int n){
+	qsort(values, n, sizeof(double), compare_double);
+	return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+static void pin_thread(int id){
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	cpu_set_t set;
+	CPU_ZERO(& set);
+	CPU_SET(id % cpus, & set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), & set);
+}
+
+// each run consists of a compression and a decompression phase, all threads start a phase together
+static void * worker_run(void * arg){
+	worker_t * w = (worker_t*) arg;
+	if (pin){
+		pin_thread(w->id);
+	}
+	const size_t size = scil_dims_get_size(& w->dims, SCIL_TYPE_DOUBLE);
+	if (w->input == NULL){
+		w->input = (double*) malloc(size);
+		memcpy(w->input, w->source, size);
+	}
+	scil_user_hints_t hints;
+	scil_user_hints_initialize(& hints);
+	hints.absolute_tolerance = SCIL_ACCURACY_DBL_FINEST;
+	hints.force_compression_methods = (char*) w->chain;
+	scil_context_t * ctx = NULL;
+	w->error = scil_context_create(& ctx, SCIL_TYPE_DOUBLE, 0, NULL, & hints);
+
+	for(int run = -warmup; run < repetitions; run++){
+		scil_timer timer;
+		pthread_barrier_wait(& start_barrier);
+		scilU_start_timer(& timer);
+		if (w->error == SCIL_NO_ERR){
+			w->error = scil_compress(w->compressed, w->compressed_limit, w->input, & w->dims, & w->compressed_size, ctx);
+		}
+		const double seconds = scilU_stop_timer(timer);
+		pthread_barrier_wait(& end_barrier);
+
+		pthread_barrier_wait(& start_barrier);
+		scilU_start_timer(& timer);
+		if (w->error == SCIL_NO_ERR){
+			w->error = scil_decompress(SCIL_TYPE_DOUBLE, w->output, & w->dims, w->compressed, w->compressed_size, w->tmp);
+		}
+		const double seconds_d = scilU_stop_timer(timer);
+		pthread_barrier_wait(& end_barrier);
+		if (run >= 0){
+			w->seconds_compress[run] = seconds;
+			w->seconds_decompress[run] = seconds_d;
+		}
+	}
+	if (ctx != NULL){
+		scil_destroy_context(ctx);
+	}
+	return NULL;
+}
+
+// measures one phase of all threads, the wall time covers the slowest thread
+static double wall_time_of_phase(){
+	scil_timer timer;
+	pthread_barrier_wait(& start_barrier);
+	scilU_start_timer(& timer);
+	pthread_barrier_wait(& end_barrier);
+	return scilU_stop_timer(timer);
+}
+
+static void summarize(scaling_t * out, const double * wall, worker_t * workers, int threads, int decompress, size_t total_size){
+	double aggregate[repetitions];
+	double per_thread[repetitions];
+	for(int run = 0; run < repetitions; run++){
+		aggregate[run] = total_size / wall[run] / 1024 / 1024;
+		double sum = 0;
+		for(int t = 0; t < threads; t++){
+			const double seconds = decompress ? workers[t].seconds_decompress[run] : workers[t].seconds_compress[run];
+			sum += scil_dims_get_size(& workers[t].dims, SCIL_TYPE_DOUBLE) / seconds / 1024 / 1024;
+		}
+		per_thread[run] = sum / threads;
+	}
+	out->aggregate = median(aggregate, repetitions);
+	out->per_thread = median(per_thread, repetitions);
+	out->efficiency = 0;
+}
+
+static int run_threads(enum mode mode, const char * chain, int threads, const double * data, scaling_t * c, scaling_t * d){
+	worker_t workers[threads];
+	double wall_compress[repetitions];
+	double wall_decompress[repetitions];
+	memset(workers, 0, sizeof(workers));
+
+	size_t total_size = 0;
+	for(int t = 0; t < threads; t++){
+		worker_t * w = & workers[t];
+		w->id = t;
+		w->chain = chain;
+		if (mode == MODE_WEAK){
+			w->source = data;
+			scil_dims_initialize_1d(& w->dims, count);
+		}else{
+			const size_t slice = count / threads;
+			w->input = (double*) & data[t * slice];
+			scil_dims_initialize_1d(& w->dims, t == threads - 1 ? count - t * slice : slice);
+		}
+		total_size += scil_dims_get_size(& w->dims, SCIL_TYPE_DOUBLE);
+		w->compressed_limit = scil_get_compressed_data_size_limit(& w->dims, SCIL_TYPE_DOUBLE);
+		w->compressed = (byte*) malloc(w->compressed_limit);
+		w->output = (double*) malloc(w->compressed_limit);
+		w->tmp = (byte*) malloc(w->compressed_limit);
+		w->seconds_compress = (double*) malloc(repetitions * sizeof(double));
+		w->seconds_decompress = (double*) malloc(repetitions * sizeof(double));
+	}
+
+	pthread_barrier_init(& start_barrier, NULL, threads + 1);
+	pthread_barrier_init(& end_barrier, NULL, threads + 1);
+	for(int t = 0; t < threads; t++){
+		int ret = pthread_create(& workers[t].thread, NULL, worker_run, & workers[t]);
+		if (ret != 0){
+			critical("pthread_create returned the error %s\n", strerror(ret));
+		}
+	}
+	for(int run = -warmup; run < repetitions; run++){
+		const double seconds = wall_time_of_phase();
+		const double seconds_d = wall_time_of_phase();
+		if (run >= 0){
+			wall_compress[run] = seconds;
+			wall_decompress[run] = seconds_d;
+		}
+	}
+	int error = 0;
+	for(int t = 0; t < threads; t++){
+		pthread_join(workers[t].thread, NULL);
+		error |= workers[t].error != SCIL_NO_ERR;
+	}
+	pthread_barrier_destroy(& start_barrier);
+	pthread_barrier_destroy(& end_barrier);
+
+	if (! error){
+		summarize(c, wall_compress, workers, threads, 0, total_size);
+		summarize(d, wall_decompress, workers, threads, 1, total_size);
+	}
+	for(int t = 0; t < threads; t++){
+		worker_t * w = & workers[t];
+		if (mode == MODE_WEAK){
+			free(w->input);
+		}
+		free(w->compressed);
+		free(w->output);
+		free(w->tmp);
+		free(w->seconds_compress);
+		free(w->seconds_decompress);
+	}
+	return error;
+}
+
+// the smallest thread count that reaches the given share of the peak throughput
+static int saturation_point(const scaling_t * results, int threads, double * peak){
+	*peak = 0;
+	for(int t = 0; t < threads; t++){
+		if (results[t].aggregate > *peak){
+			*peak = results[t].aggregate;
+		}
+	}
+	for(int t = 0; t < threads; t++){
+		if (results[t].aggregate >= SATURATION * *peak){
+			return t + 1;
+		}
+	}
+	return threads;
+}
+
+static void write_memory_limit(double bandwidth, int threads){
+	char comment[64];
+	snprintf(comment, sizeof(comment), "memory peaks with %d threads", threads);
+	if (scilO_conf_set_hardware_limit(conf_file, "memory", bandwidth, comment) != 0){
+		critical("Could not update %s: %s\n", conf_file, strerror(errno));
+	}
+	printf("Set !memory %.1f in %s\n", bandwidth, conf_file);
+}
+
+int main(int argc, char ** argv){
+	option_help known_args[] = {
+		{'t', "threads", "Maximum number of threads, by default the number of CPUs", OPTION_OPTIONAL_ARGUMENT, 'd', & max_threads},
+		{'n', "count", "Number of doubles per thread (weak) or in total (strong)", OPTION_OPTIONAL_ARGUMENT, 'd', & count},
+		{'m', "mode", "weak, strong or both", OPTION_OPTIONAL_ARGUMENT, 's', & mode_str},
+		{'c', "chains", "Chains to measure, separated by ;", OPTION_OPTIONAL_ARGUMENT, 's', & chains_str},
+		{'w', "warmup", "Number of runs before the measurement", OPTION_OPTIONAL_ARGUMENT, 'd', & warmup},
+		{'r', "repetitions", "Number of measured runs, the median is reported", OPTION_OPTIONAL_ARGUMENT, 'd', & repetitions},
+		{0, "pin", "Pin thread i to CPU i", OPTION_FLAG, 'd', & pin},
+		{0, "pattern", "The pattern of the library to compress", OPTION_OPTIONAL_ARGUMENT, 's', & pattern},
+		{0, "csv", "CSV file with all results", OPTION_OPTIONAL_ARGUMENT, 's', & csv_file},
+		{0, "conf", "The configuration file to update with the memory bandwidth", OPTION_OPTIONAL_ARGUMENT, 's', & conf_file},
+		LAST_OPTION
+	};
+	int printhelp = 0;
+	scilO_parseOptions(argc, argv, known_args, & printhelp);
+	int modes[2] = {strcmp(mode_str, "weak") == 0 || strcmp(mode_str, "both") == 0,
+	                strcmp(mode_str, "strong") == 0 || strcmp(mode_str, "both") == 0};
+	if (max_threads <= 0){
+		max_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (printhelp != 0 || repetitions < 1 || warmup < 0 || count < max_threads || ! (modes[0] || modes[1])){
+		printf("\nSynopsis: %s ", argv[0]);
+		scilO_print_help(known_args, "\n");
+		exit(printhelp == 1 ? 0 : 1);
+	}
+
+	int pattern_index = -1;
+	for(int i = 0; i < scilP_get_pattern_library_size(); i++){
+		if (strcmp(scilP_get_library_pattern_name(i), pattern) == 0){
+			pattern_index = i;
+		}
+	}
+	if (pattern_index == -1){
+		printf("Unknown pattern %s\n", pattern);
+		exit(1);
+	}
+	scil_dims_t dims;
+	scil_dims_initialize_1d(& dims, count);
+	double * data = (double*) malloc(scil_dims_get_size(& dims, SCIL_TYPE_DOUBLE));
+	int ret = scilP_create_library_pattern(data, SCIL_TYPE_DOUBLE, & dims, pattern_index);
+	assert(ret == SCIL_NO_ERR);
+
+	FILE * csv = fopen(csv_file, "w");
+	if (csv == NULL){
+		critical("fopen returned the error %s\n", strerror(errno));
+	}
+	fprintf(csv, "mode,chain,threads,status,c_aggregate,c_per_thread,c_efficiency,d_aggregate,d_per_thread,d_efficiency\n");
+
+	scaling_t * c = (scaling_t*) malloc(max_threads * sizeof(scaling_t));
+	scaling_t * d = (scaling_t*) malloc(max_threads * sizeof(scaling_t));
+	double memory = 0;
+	int memory_threads = 0;
+	int error_occured = 0;
+
+	char * chains = strdup(chains_str);
+	char * saveptr = NULL;
+	for(char * chain = strtok_r(chains, ";", & saveptr); chain != NULL; chain = strtok_r(NULL, ";", & saveptr)){
+		for(int m = MODE_WEAK; m <= MODE_STRONG; m++){
+			if (! modes[m]){
+				continue;
+			}
+			int threads = 1;
+			for(; threads <= max_threads; threads++){
+				scaling_t * ct = & c[threads - 1];
+				scaling_t * dt = & d[threads - 1];
+				if (run_threads((enum mode) m, chain, threads, data, ct, dt) != 0){
+					printf("Warning: compression %s returned an error!\n", chain);
+					fprintf(csv, "%s,\"%s\",%d,error,0,0,0,0,0,0\n", mode_names[m], chain, threads);
+					error_occured = 1;
+					break;
+				}
+				// relative to the ideal scaling of a single thread
+				ct->efficiency = ct->aggregate / (threads * c[0].aggregate);
+				dt->efficiency = dt->aggregate / (threads * d[0].aggregate);
+				fprintf(csv, "%s,\"%s\",%d,ok,%.1f,%.1f,%.3f,%.1f,%.1f,%.3f\n", mode_names[m], chain, threads,
+					ct->aggregate, ct->per_thread, ct->efficiency, dt->aggregate, dt->per_thread, dt->efficiency);
+				fflush(csv);
+			}
+			threads--;
+			if (threads == 0){
+				continue;
+			}
+			double c_peak, d_peak;
+			const int c_sat = saturation_point(c, threads, & c_peak);
+			const int d_sat = saturation_point(d, threads, & d_peak);
+			printf("%s %s: compression peaks at %.1f MiB/s, %s%d threads; decompression peaks at %.1f MiB/s, %s%d threads\n",
+				mode_names[m], chain,
+				c_peak, c_sat < threads ? "saturated with " : "not saturated up to ", c_sat < threads ? c_sat : threads,
+				d_peak, d_sat < threads ? "saturated with " : "not saturated up to ", d_sat < threads ? d_sat : threads);
+			// memcopy only moves the data, it measures the usable memory bandwidth
+			if (m == MODE_WEAK && strcmp(chain, "memcopy") == 0){
+				memory = c_peak;
+				memory_threads = c_sat;
+			}
+		}
+	}
+	fclose(csv);
+
+	if (memory > 0){
+		write_memory_limit(memory, memory_threads);
+	}
+
+	free(chains);
+	free(c);
+	free(d);
+	free(data);
+	return error_occured;
+}
@@ -13,24 +13,147 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
 
+/*
+ * Measures the performance of each compressor for the patterns of the library
+ * and creates a new scil.conf with the median throughput of the repetitions.
+ * All results with their percentiles are written as CSV and JSON, too.
+ */
+
+// for sched_setaffinity()
+#define _GNU_SOURCE
+
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
+#include <sched.h>
 
 #include <scil.h>
 #include <scil-compressor.h>
 #include <scil-data-characteristics.h>
 #include <scil-error.h>
 #include <scil-debug.h>
+#include <scil-option.h>
 #include <scil-patterns.h>
 #include <scil-util.h>
 
 #define allocate(type, name, count) type* name = (type*)malloc(count * sizeof(type))
 
+// the cache is flushed by writing a buffer larger than the last level cache
+#define FLUSH_SIZE (256 * 1024 * 1024)
+
 static int error_occured = 0;
 static double * buffer_uncompressed;
 
+static int warmup = 1;
+static int repetitions = 5;
+static int cpu = -1;
+static int flush_cache = 0;
+static char * csv_file = "scil-benchmark.csv";
+static char * json_file = "scil-benchmark.json";
+static char * conf_file = "scil.conf";
+static char * check_pattern = NULL;
+
+static byte * flush_buffer = NULL;
+static FILE * csv = NULL;
+static FILE * json = NULL;
+static int json_results = 0;
+
+typedef struct{
+  double median;
+  double p10;
+  double p90;
+  double mean;
+  double stddev;
+} throughput_t;
+
+static void flush(){
+  if (! flush_cache){
+    return;
+  }
+  if (flush_buffer == NULL){
+    flush_buffer = (byte*) malloc(FLUSH_SIZE);
+  }
+  static byte value = 0;
+  value++;
+  memset(flush_buffer, value, FLUSH_SIZE);
+  // read it back so the writes are not optimized away
+  volatile byte sum = 0;
+  for(size_t i = 0; i < FLUSH_SIZE; i += 4096){
+    sum += flush_buffer[i];
+  }
+}
+
+static int compare_double(const void * a, const void * b){
+  const double x = *(const double*) a;
+  const double y = *(const double*) b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// linear interpolation between the closest ranks of the sorted values
+static double percentile(const double * sorted, int count, double p){
+  const double rank = p * (count - 1);
+  const int low = (int) rank;
+  if (low + 1 >= count){
+    return sorted[count - 1];
+  }
+  return sorted[low] + (rank - low) * (sorted[low + 1] - sorted[low]);
+}
+
+// throughput in MiB/s of each run
+static throughput_t summarize(const double * seconds, int count, size_t data_size){
+  throughput_t t;
+  double mib[count];
+  double sum = 0;
+  for(int i=0; i < count; i++){
+    mib[i] = data_size / seconds[i] / 1024 / 1024;
+    sum += mib[i];
+  }
+  t.mean = sum / count;
+  double var = 0;
+  for(int i=0; i < count; i++){
+    var += (mib[i] - t.mean) * (mib[i] - t.mean);
+  }
+  t.stddev = count > 1 ? sqrt(var / (count - 1)) : 0;
+  qsort(mib, count, sizeof(double), compare_double);
+  t.median = percentile(mib, count, 0.5);
+  t.p10 = percentile(mib, count, 0.1);
+  t.p90 = percentile(mib, count, 0.9);
+  return t;
+}
+
+static void print_dims(FILE * f, const scil_dims_t * dims, const char * separator){
+  for(int i=0; i < dims->dims; i++){
+    fprintf(f, "%s%zu", i == 0 ? "" : separator, dims->length[i]);
+  }
+}
+
+static void write_csv(double r, SCIL_Datatype_t datatype, const char * name, const char * chain, const scil_dims_t * dims, const char * status, double c_fac, const throughput_t * c, const throughput_t * d){
+  fprintf(csv, "%.1f,%d,%s,%s,", r, datatype, name, chain);
+  print_dims(csv, dims, "x");
+  fprintf(csv, ",%d,%s,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+    repetitions, status, c_fac,
+    c->median, c->p10, c->p90, c->mean, c->stddev,
+    d->median, d->p10, d->p90, d->mean, d->stddev);
+  fflush(csv);
+}
+
+static void write_json_throughput(const char * name, const throughput_t * t){
+  fprintf(json, "\"%s\":{\"median\":%.1f,\"p10\":%.1f,\"p90\":%.1f,\"mean\":%.1f,\"stddev\":%.1f}", name, t->median, t->p10, t->p90, t->mean, t->stddev);
+}
+
+static void write_json(double r, SCIL_Datatype_t datatype, const char * name, const char * chain, const char * status, double c_fac, const throughput_t * c, const throughput_t * d){
+  fprintf(json, "%s\n{\"randomness\":%.1f,\"datatype\":%d,\"pattern\":\"%s\",\"chain\":\"%s\",\"status\":\"%s\",\"ratio\":%.3f,",
+    json_results == 0 ? "" : ",", r, datatype, name, chain, status, c_fac);
+  write_json_throughput("compression", c);
+  fprintf(json, ",");
+  write_json_throughput("decompression", d);
+  fprintf(json, "}");
+  fflush(json);
+  json_results++;
+}
+
 void benchmark(FILE * f, SCIL_Datatype_t datatype, const char * name, byte * buffer_in, scil_dims_t dims){
 	size_t out_c_size;
 
@@ -39,6 +162,8 @@ void benchmark(FILE * f, SCIL_Datatype_t datatype, const char * name, byte * buf
 
 	allocate(byte, buffer_out, buff_size);
 	allocate(byte, tmp_buff, buff_size);
+	allocate(double, seconds_compress, repetitions);
+	allocate(double, seconds_decompress, repetitions);
 
   scil_context_t* ctx;
   scil_user_hints_t hints;
@@ -48,9 +173,6 @@ void benchmark(FILE * f, SCIL_Datatype_t datatype, const char * name, byte * buf
 
 	double r = (double) scilU_get_data_randomness(buffer_in, data_size, tmp_buff, buff_size);
 
-	char * outputFiles = getenv("SCIL_BENCHMARK_OUTPUT");
-	const size_t buffer_size = scil_get_compressed_data_size_limit(&dims, datatype);
-
 	for(int i=0; i < scilU_get_available_compressor_count(); i++ ){
 		char compression_name[1024];
 		sprintf(compression_name, "%s", scilU_get_compressor_name(i));
@@ -62,50 +184,57 @@ void benchmark(FILE * f, SCIL_Datatype_t datatype, const char * name, byte * buf
 			continue;
 		}
 		assert(ctx != NULL);
-		int ret_c;
-		int ret_d;
+		int ret_c = SCIL_NO_ERR;
+		int ret_d = SCIL_NO_ERR;
 
-		scil_timer timer;
-		scilU_start_timer(& timer);
-		ret_c = scil_compress(buffer_out, buff_size, buffer_in, & dims, & out_c_size, ctx);
-		double seconds_compress = scilU_stop_timer(timer);
-		ret_d = -1;
-
-		double seconds_decompress;
-		if(ret_c == 0){
+		// the warm-up runs are not measured
+		for(int run = -warmup; run < repetitions && ret_c == SCIL_NO_ERR && ret_d == SCIL_NO_ERR; run++){
+			scil_timer timer;
+			flush();
+			scilU_start_timer(& timer);
+			ret_c = scil_compress(buffer_out, buff_size, buffer_in, & dims, & out_c_size, ctx);
+			const double seconds = scilU_stop_timer(timer);
+			if (ret_c != SCIL_NO_ERR){
+				break;
+			}
 			// initialize memory
-			memset(buffer_uncompressed, -1, buffer_size);
-
+			memset(buffer_uncompressed, -1, buff_size);
+			flush();
 			scilU_start_timer(& timer);
 			ret_d = scil_decompress(datatype, buffer_uncompressed, & dims, buffer_out, out_c_size, tmp_buff);
-			seconds_decompress = scilU_stop_timer(timer);
-		}else{
-			seconds_decompress = 1;
+			const double seconds_d = scilU_stop_timer(timer);
+			if (run >= 0){
+				seconds_compress[run] = seconds;
+				seconds_decompress[run] = seconds_d;
+			}
 		}
-
-		if ( ret_c == 0 && ret_d == 0 && outputFiles != NULL ){
-			// dump the file
-			char filename[1024];
-			sprintf(filename,"%s-%s.csv", name, compression_name);
-			// TODO
-			//scilU_plot(filename, dims, (double*) buffer_uncompressed);
-		}
-
+		scil_destroy_context(ctx);
 
 		if (ret_c != 0 || ret_d != 0 ){
+			// failed chains are reported but not added to the configuration
 			error_occured = 1;
 			printf("Warning: compression %s returned an error!\n",  hints.force_compression_methods);
+			throughput_t none;
+			memset(& none, 0, sizeof(none));
+			write_csv(r, datatype, name, compression_name, & dims, "error", 0, & none, & none);
+			write_json(r, datatype, name, compression_name, "error", 0, & none, & none);
 			continue;
 		}
 		double c_fac = (double)(out_c_size) / data_size;
+		const throughput_t c = summarize(seconds_compress, repetitions, data_size);
+		const throughput_t d = summarize(seconds_decompress, repetitions, data_size);
 
 		fprintf(f, "%.1f; %d; %s; %s; %.1lf; %.1lf; %.3lf\n",
 			r, datatype, name, hints.force_compression_methods,
-			data_size/seconds_compress/1024 /1024, data_size/seconds_decompress/1024 /1024, c_fac);
+			c.median, d.median, c_fac);
 		fflush(f);
+		write_csv(r, datatype, name, compression_name, & dims, "ok", c_fac, & c, & d);
+		write_json(r, datatype, name, compression_name, "ok", c_fac, & c, & d);
   }
 	free(buffer_out);
 	free(tmp_buff);
+	free(seconds_compress);
+	free(seconds_decompress);
 }
 
 void scilU_check_std_err(char const * what, int ret){
@@ -115,45 +244,93 @@ void scilU_check_std_err(char const * what, int ret){
 	}
 }
 
-#pragma GCC diagnostic ignored "-Wunused-parameter"
+static void pin_to_cpu(int cpu){
+	cpu_set_t set;
+	CPU_ZERO(& set);
+	CPU_SET(cpu, & set);
+	int ret = sched_setaffinity(0, sizeof(set), & set);
+	scilU_check_std_err("sched_setaffinity", ret);
+}
+
 int main(int argc, char** argv){
 	int ret;
 	scil_dims_t dims;
-
-	if (argc != 1){
-	  switch(argc - 1){
-	    case (1):{
-	  	  scil_dims_initialize_1d(& dims, atol(argv[1]));
-	      break;
-	    }case (2):{
-	      scil_dims_initialize_2d(& dims, atol(argv[1]), atol(argv[2]));
-	      break;
-	    }case (3):{
-	      scil_dims_initialize_3d(& dims, atol(argv[1]), atol(argv[2]), atol(argv[3]));
-	      break;
-	    }default:{
-	      printf("Error will only benchmark up to 3D\n");
-	      exit(1);
-	    }
-	  }
-	}else{
+	scil_dims_t pattern_dims;
+
+	option_help known_args[] = {
+		{'w', "warmup", "Number of runs before the measurement", OPTION_OPTIONAL_ARGUMENT, 'd', & warmup},
+		{'r', "repetitions", "Number of measured runs, the median is used for the configuration", OPTION_OPTIONAL_ARGUMENT, 'd', & repetitions},
+		{0, "cpu", "Pin the benchmark to this CPU, -1 to not pin it", OPTION_OPTIONAL_ARGUMENT, 'd', & cpu},
+		{0, "flush-cache", "Flush the cache before each run", OPTION_FLAG, 'd', & flush_cache},
+		{0, "pattern", "Only benchmark this pattern, also set by SCIL_PATTERN_TO_USE", OPTION_OPTIONAL_ARGUMENT, 's', & check_pattern},
+		{0, "conf", "The configuration file to create", OPTION_OPTIONAL_ARGUMENT, 's', & conf_file},
+		{0, "csv", "CSV file with all results", OPTION_OPTIONAL_ARGUMENT, 's', & csv_file},
+		{0, "json", "JSON file with all results", OPTION_OPTIONAL_ARGUMENT, 's', & json_file},
+		LAST_OPTION
+	};
+
+	// the dimensions precede the options
+	size_t length[5];
+	int dim_count = 0;
+	while(dim_count + 1 < argc && argv[dim_count + 1][0] != '-'){
+		if (dim_count == 5){
+			printf("Error will only benchmark up to 5D\n");
+			exit(1);
+		}
+		length[dim_count] = atol(argv[dim_count + 1]);
+		dim_count++;
+	}
+	if (dim_count == 0){
 		scil_dims_initialize_1d(& dims, 1024*1024);
+	}else{
+		scil_dims_initialize_array(& dims, dim_count, length);
+	}
+	// the patterns are defined up to 4D, the fifth dimension is folded into the fourth
+	pattern_dims = dims;
+	if (pattern_dims.dims > 4){
+		pattern_dims.length[3] *= pattern_dims.length[4];
+		pattern_dims.dims = 4;
+	}
+
+	int printhelp = 0;
+	scilO_parseOptions(argc - dim_count, argv + dim_count, known_args, & printhelp);
+	if (printhelp != 0 || repetitions < 1 || warmup < 0){
+		printf("\nSynopsis: %s [dim1 [dim2 [dim3 [dim4 [dim5]]]]] ", argv[0]);
+		scilO_print_help(known_args, "\n");
+		exit(printhelp == 1 ? 0 : 1);
+	}
+	if (check_pattern == NULL){
+		check_pattern = getenv("SCIL_PATTERN_TO_USE");
+	}
+	if (cpu >= 0){
+		pin_to_cpu(cpu);
 	}
 
 	int bufferSize = scil_get_compressed_data_size_limit(&dims, SCIL_TYPE_DOUBLE);
 	double * buffer_in = (double*) malloc(bufferSize);
 	buffer_uncompressed = malloc(bufferSize);
 
-	printf("This program creates a new scil.conf by measuring performance\n");
+	printf("This program creates a new %s by measuring performance\n", conf_file);
 
-	FILE * f = fopen("scil.conf.bak", "w+");
+	char conf_tmp[1024];
+	snprintf(conf_tmp, sizeof(conf_tmp), "%s.bak", conf_file);
+	FILE * f = fopen(conf_tmp, "w+");
+	scilU_check_std_err("fopen", f == NULL);
 	{
 		char * str = "#randomness; data type; pattern name; compressor name; compr. performance MiB; decompr. performance MiB; inverse compr. ratio\n";
 		ret = fwrite(str, strlen(str), 1, f);
 		scilU_check_std_err("fwrite", ret != 1);
+		fprintf(f, "# median of %d runs after %d warm-up runs\n", repetitions, warmup);
 	}
-
-	char * check_pattern = getenv("SCIL_PATTERN_TO_USE");
+	csv = fopen(csv_file, "w");
+	scilU_check_std_err("fopen", csv == NULL);
+	fprintf(csv, "randomness,datatype,pattern,chain,dims,repetitions,status,ratio,"
+		"c_median,c_p10,c_p90,c_mean,c_stddev,d_median,d_p10,d_p90,d_mean,d_stddev\n");
+	json = fopen(json_file, "w");
+	scilU_check_std_err("fopen", json == NULL);
+	fprintf(json, "{\"warmup\":%d,\"repetitions\":%d,\"cpu\":%d,\"flush_cache\":%d,\"dims\":[", warmup, repetitions, cpu, flush_cache);
+	print_dims(json, & dims, ",");
+	fprintf(json, "],\"unit\":\"MiB/s\",\"results\":[");
 
 	for(int i=0; i < scilP_get_pattern_library_size(); i++){
 		char * name = scilP_get_library_pattern_name(i);
@@ -163,19 +340,22 @@ int main(int argc, char** argv){
 			continue;
 		}
 
-		for(int d=SCIL_DATATYPE_NUMERIC_MIN; d < SCIL_DATATYPE_NUMERIC_MAX; d++ ){
-			ret = scilP_create_library_pattern(buffer_in, d, &dims, i);
+		for(int d=SCIL_DATATYPE_NUMERIC_MIN; d <= SCIL_DATATYPE_NUMERIC_MAX; d++ ){
+			ret = scilP_create_library_pattern(buffer_in, d, &pattern_dims, i);
 			assert( ret == SCIL_NO_ERR);
 			benchmark(f, d, name, (byte*) buffer_in, dims);
 		}
 	}
+	fprintf(json, "\n]}\n");
+	fclose(json);
+	fclose(csv);
 	fclose(f);
-	ret = rename("scil.conf.bak", "scil.conf");
+	ret = rename(conf_tmp, conf_file);
 	scilU_check_std_err("rename", ret);
 
-
 	free(buffer_in);
 	free(buffer_uncompressed);
+	free(flush_buffer);
 
 	return error_occured;
 }
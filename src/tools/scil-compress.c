@@ -23,16 +23,19 @@
 #include <scil-util.h>
 #include <scil-config.h>
 #include <scil-debug.h>
+#include <scil-thread-pool.h>
 
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
 
 #include <file-formats/scil-file-format.h>
-
-#define DATA_SIZE_LIMIT 3 << 29
+#ifdef HAVE_NETCDF
+#include <file-formats/file-netcdf.h>
+#endif
 
 static int validate = 0;
 static int verbose = 0;
@@ -43,7 +46,12 @@ static char * in_file = "";
 static char * out_file = NULL;
 static int compute_residual = 0;
 static int use_chunks = 0;
+static int chunk_size = 64;
+static int threads = 0;
+static int all_variables = 0;
+static char * hints_file = NULL;
 static int scientific_validation = 0;
+static int block_size = 0;
 
 static int use_max_value_as_fill_value = 0;
 static int measure_time = 0;
@@ -61,10 +69,655 @@ static byte * output_data = NULL;
 static scil_file_plugin_t * in_plugin = NULL;
 static scil_file_plugin_t * out_plugin = NULL;
 
+/*
+ * The chunked mode is a pipeline: a reader thread prefetches the chunks into
+ * a ring of slots, the worker threads compress and decompress them and the
+ * main thread writes them in order. A slot is reused once its chunk is written.
+ */
+
+typedef enum{
+  CHUNK_FREE = 0,
+  CHUNK_READ,
+  CHUNK_DONE
+} chunk_state_t;
+
+typedef struct{
+  chunk_state_t state;
+  size_t chunk;
+  size_t * pos;
+  byte * input_data;
+  byte * output_data;
+  size_t compressed_size;
+  double t_read;
+  double t_compress;
+  double t_decompress;
+} chunk_slot_t;
+
+typedef struct{
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  // serializes the calls of the file plugins, NetCDF is not thread-safe
+  pthread_mutex_t io_lock;
+
+  chunk_slot_t * slots;
+  int depth;
+  size_t chunks_number;
+  size_t next_chunk; // to compress
+
+  int rncid;
+  int rvarid;
+  SCIL_Datatype_t datatype;
+  scil_dims_t orig_dims;
+  size_t * count;
+  size_t buff_size;
+
+  const scil_user_hints_t * hints;
+  double fake_abstol_value;
+  double fake_finest_abstol_value;
+} chunk_pipeline_t;
+
+// the caller holds the lock
+static chunk_slot_t * wait_for_slot(chunk_pipeline_t * p, size_t chunk, chunk_state_t state){
+  chunk_slot_t * slot = & p->slots[chunk % p->depth];
+  while(slot->state != state || (state != CHUNK_FREE && slot->chunk != chunk)){
+    pthread_cond_wait(& p->changed, & p->lock);
+  }
+  return slot;
+}
+
+static void set_slot_state(chunk_pipeline_t * p, chunk_slot_t * slot, chunk_state_t state){
+  pthread_mutex_lock(& p->lock);
+  slot->state = state;
+  pthread_cond_broadcast(& p->changed);
+  pthread_mutex_unlock(& p->lock);
+}
+
+static void * read_chunks(void * arg){
+  chunk_pipeline_t * p = (chunk_pipeline_t*) arg;
+  const int dims = p->orig_dims.dims;
+  size_t * pos = (size_t*) calloc(dims, sizeof(size_t));
+
+  for (size_t cur_chunk = 0; cur_chunk < p->chunks_number; cur_chunk++){
+    pthread_mutex_lock(& p->lock);
+    chunk_slot_t * slot = wait_for_slot(p, cur_chunk, CHUNK_FREE);
+    pthread_mutex_unlock(& p->lock);
+
+    printf("cur_chunk: %zu | start position [%zu] [%zu] [%zu] [%zu]\n", cur_chunk, pos[0], dims > 1 ? pos[1] : 0, dims > 2 ? pos[2] : 0, dims > 3 ? pos[3] : 0);
+    memcpy(slot->pos, pos, dims * sizeof(size_t));
+    scil_timer timer;
+    pthread_mutex_lock(& p->io_lock);
+    scilU_start_timer(& timer);
+    int ret = in_plugin->readChunk(p->rncid, p->datatype, slot->input_data, p->rvarid, pos, p->count);
+    slot->t_read = scilU_stop_timer(timer);
+    pthread_mutex_unlock(& p->io_lock);
+    if (ret != 0){
+      printf("The chunk %zu could not be read\n", cur_chunk);
+      exit(1);
+    }
+    slot->chunk = cur_chunk;
+    set_slot_state(p, slot, CHUNK_READ);
+
+    //prepare next chunk
+    for (int i = 0; i < dims; i++){
+      if ((pos[i] + p->count[i]) < p->orig_dims.length[i]){
+         pos[i] += p->count[i];
+         debug("cur_chunk: %zu | i%d [%zu]\n", cur_chunk+1, i, pos[i]);
+         break;
+      }
+      else {
+        pos[i] = 0;
+      }
+    }
+  }
+  free(pos);
+  return NULL;
+}
+
+// sets the hints that depend on the data
+static void apply_data_hints(SCIL_Datatype_t datatype, byte * data, scil_dims_t * dims, scil_user_hints_t * hints, double fake_abstol_value, double fake_finest_abstol_value){
+  if (use_max_value_as_fill_value){
+    double max, min;
+    scilU_find_minimum_maximum(datatype, data, dims, & min, & max);
+    hints->fill_value = max;
+  }
+
+  if(verbose > 0){
+    double max, min;
+    scilU_find_minimum_maximum_with_excluded_points(datatype, data, dims, & min, & max, hints->lossless_data_range_up_to,  hints->lossless_data_range_from, hints->fill_value);
+    printf("Min: %.10e Max: %.10e\n", min, max);
+  }
+
+  if (fake_abstol_value > 0.0 || fake_finest_abstol_value > 0.0){
+    double max, min;
+    scilU_find_minimum_maximum_with_excluded_points(datatype, data, dims, & min, & max, hints->lossless_data_range_up_to,  hints->lossless_data_range_from, hints->fill_value);
+    if (min < 0 && max < -min){
+      max = -min;
+    }
+
+    if (min > max){
+        printf("*** [SCIL] warning: only fill values in the data\n");
+    }
+
+    if (fake_abstol_value > 0.0){
+      double new_abs_tol = max * fake_abstol_value;
+      printf("fake abstol: setting value to %f (min: %f max: %f)\n", new_abs_tol, min, max);
+      hints->absolute_tolerance = fabs(new_abs_tol);
+    }
+
+    if(fake_finest_abstol_value > 0.0){
+      hints->relative_err_finest_abs_tolerance = max * fake_finest_abstol_value;
+      printf("fake relative_err_finest_abs_tolerance: setting value to %f\n", hints->relative_err_finest_abs_tolerance);
+    }
+  }
+}
+
+static void process_chunk(chunk_pipeline_t * p, chunk_slot_t * slot, byte * result, byte * tmp_buff){
+  scil_user_hints_t hints = *p->hints;
+  scil_user_hints_t out_accuracy;
+  scil_validate_params_t out_validation;
+  scil_context_t * ctx;
+  scil_dims_t dims;
+  scil_timer timer;
+  int ret;
+
+  dims.dims = p->orig_dims.dims;
+  for (int i = 0; i < dims.dims; i++){
+    dims.length[i] = p->count[i];
+  }
+  memset(& out_validation, 0, sizeof(out_validation));
+
+  apply_data_hints(p->datatype, slot->input_data, & dims, & hints, p->fake_abstol_value, p->fake_finest_abstol_value);
+
+  ret = scil_context_create(&ctx, p->datatype, 0, NULL, &hints);
+  if (ret != SCIL_NO_ERR){
+    printf("*** [SCIL] error: datatype is not supported by compressor\n");
+    exit(1);
+  }
+  scil_context_set_block_size(ctx, (size_t) block_size);
+
+  if (print_hints){
+    printf("Effective hints (only needed for compression)\n");
+    scil_user_hints_t e = scil_get_effective_hints(ctx);
+    scil_user_hints_print(& e);
+  }
+
+  scilU_start_timer(& timer);
+  ret = scil_compress(result, p->buff_size, slot->input_data, & dims, & slot->compressed_size, ctx);
+  slot->t_compress = scilU_stop_timer(timer);
+  assert(ret == SCIL_NO_ERR);
+
+  scilU_start_timer(& timer);
+  ret = scil_decompress(p->datatype, slot->output_data, & dims, result, slot->compressed_size, tmp_buff);
+  slot->t_decompress = scilU_stop_timer(timer);
+  assert(ret == SCIL_NO_ERR);
+
+  if (validate) {
+    ret = scil_validate_compression(p->datatype, slot->input_data, &dims, result, slot->compressed_size, ctx, &out_accuracy, &out_validation);
+    if(ret != SCIL_NO_ERR){
+      printf("SCIL validation error in chunk %zu!\n", slot->chunk);
+    }
+    if(print_hints){
+      printf("Validation accuracy:");
+      scil_user_hints_print(& out_accuracy);
+    }
+    if(print_hints || scientific_validation){
+      scil_validate_params_print(& out_validation);
+    }
+  }
+
+  ret = scil_destroy_context(ctx);
+  assert(ret == SCIL_NO_ERR);
+}
+
+static void * compress_chunks(void * arg){
+  chunk_pipeline_t * p = (chunk_pipeline_t*) arg;
+  byte * result = (byte*) scilU_safe_malloc(p->buff_size);
+  byte * tmp_buff = (byte*) scilU_safe_malloc(p->buff_size);
+
+  while(1){
+    pthread_mutex_lock(& p->lock);
+    if (p->next_chunk == p->chunks_number){
+      pthread_mutex_unlock(& p->lock);
+      break;
+    }
+    chunk_slot_t * slot = wait_for_slot(p, p->next_chunk++, CHUNK_READ);
+    pthread_mutex_unlock(& p->lock);
+
+    process_chunk(p, slot, result, tmp_buff);
+    set_slot_state(p, slot, CHUNK_DONE);
+  }
+  free(result);
+  free(tmp_buff);
+  return NULL;
+}
+
+/*
+ * Reads, compresses, decompresses and writes the variable in chunks.
+ */
+static int process_chunks(const scil_user_hints_t * hints, double fake_abstol_value, double fake_finest_abstol_value){
+  chunk_pipeline_t p;
+  int wncid = 0, wvarid = 0;
+  int ret;
+
+  if (compress || uncompress){
+    printf("The chunked mode compresses and decompresses each chunk, it does not support -c and -x\n");
+    exit(1);
+  }
+  if (in_plugin->openRead == NULL || in_plugin->readChunk == NULL){
+    printf("The input format %s does not support chunks\n", in_plugin->name);
+    exit(1);
+  }
+  if (out_file != NULL && (out_plugin->openWrite == NULL || out_plugin->writeChunk == NULL)){
+    printf("The output format %s does not support chunks\n", out_plugin->name);
+    exit(1);
+  }
+  if (fake_abstol_value > 0.0 && hints->absolute_tolerance > 0.0){
+    printf("Error: don't set both the absolute_tolerance and the fake relative absolute tolerance!\n");
+    exit(1);
+  }
+
+  scil_timer totalRun;
+  scilU_start_timer(& totalRun);
+
+  memset(& p, 0, sizeof(p));
+  p.hints = hints;
+  p.fake_abstol_value = fake_abstol_value;
+  p.fake_finest_abstol_value = fake_finest_abstol_value;
+
+  ret = in_plugin->openRead(in_file, & p.datatype, & p.orig_dims, & p.rncid, & p.rvarid);
+  if (ret != 0){
+    printf("The input file %s could not be open\n", in_file);
+    exit(1);
+  }
+  if (out_file != NULL){
+    ret = out_plugin->openWrite(out_file, p.datatype, p.orig_dims, & wncid, & wvarid);
+    if (ret != 0){
+      printf("The output file %s could not be open\n", out_file);
+      exit(1);
+    }
+  }
+
+  const int dims = p.orig_dims.dims;
+  p.count = (size_t*) malloc(dims * sizeof(size_t));
+  for (int i = 0; i < dims; i++){
+    p.count[i] = p.orig_dims.length[i];
+  }
+  size_t array_size = scil_dims_get_size(& p.orig_dims, p.datatype);
+
+  //split data in chunks
+  const size_t limit = (size_t) chunk_size * 1024 * 1024;
+  p.chunks_number = 1;
+  int i = 0;
+  while (array_size > limit){
+    if ((p.count[i] % 2) == 0){
+      p.count[i] >>= 1;
+      p.chunks_number <<= 1;
+      array_size >>= 1;
+    }
+    else {
+      if (i == dims-1){
+        printf("Cannot be good enough chunked\n");
+        exit(1);
+      }
+      else i++;
+    }
+  }
+
+  scil_dims_t chunk_dims;
+  memset(& chunk_dims, 0, sizeof(chunk_dims));
+  chunk_dims.dims = dims;
+  for (int i = 0; i < dims; i++){
+    chunk_dims.length[i] = p.count[i];
+  }
+  p.buff_size = scil_get_compressed_data_size_limit(& chunk_dims, p.datatype);
+
+  printf("orig_dims: [%zu] [%zu] [%zu] [%zu]\n\n", p.orig_dims.length[0], p.orig_dims.length[1], p.orig_dims.length[2], p.orig_dims.length[3]);
+  printf("chunks: %zu | chunk size [%zu] [%zu] [%zu] [%zu]\n\n", p.chunks_number, chunk_dims.length[0], chunk_dims.length[1], chunk_dims.length[2], chunk_dims.length[3]);
+  printf("size: %zu\n", array_size);
+
+  if (threads < 1){
+    threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  // the workers occupy the cores, each compresses its chunk serially
+  if (threads > 1){
+    scil_set_threads(1);
+  }
+  // one slot is read and one is written while the workers compress
+  p.depth = threads + 2;
+  p.slots = (chunk_slot_t*) calloc(p.depth, sizeof(chunk_slot_t));
+  for (int s = 0; s < p.depth; s++){
+    p.slots[s].pos = (size_t*) malloc(dims * sizeof(size_t));
+    p.slots[s].input_data = (byte*) scilU_safe_malloc(p.buff_size);
+    p.slots[s].output_data = (byte*) scilU_safe_malloc(p.buff_size);
+  }
+  pthread_mutex_init(& p.lock, NULL);
+  pthread_mutex_init(& p.io_lock, NULL);
+  pthread_cond_init(& p.changed, NULL);
+
+  pthread_t reader;
+  pthread_t workers[threads];
+  pthread_create(& reader, NULL, read_chunks, & p);
+  for (int t = 0; t < threads; t++){
+    pthread_create(& workers[t], NULL, compress_chunks, & p);
+  }
+
+  double t_read = 0.0, t_write = 0.0, t_compress = 0.0, t_decompress = 0.0;
+  size_t compressed_size = 0;
+  for (size_t cur_chunk = 0; cur_chunk < p.chunks_number; cur_chunk++){
+    pthread_mutex_lock(& p.lock);
+    chunk_slot_t * slot = wait_for_slot(& p, cur_chunk, CHUNK_DONE);
+    pthread_mutex_unlock(& p.lock);
+
+    double t_chunk_write = 0.0;
+    if (out_file != NULL){
+      scil_timer timer;
+      pthread_mutex_lock(& p.io_lock);
+      scilU_start_timer(& timer);
+      ret = out_plugin->writeChunk(wncid, p.datatype, slot->output_data, wvarid, slot->pos, p.count);
+      t_chunk_write = scilU_stop_timer(timer);
+      pthread_mutex_unlock(& p.io_lock);
+      if (ret != 0){
+        printf("The output file %s could not be written\n", out_file);
+        exit(1);
+      }
+    }
+
+    if(measure_time){
+      printf("Chunk %zu:\n", cur_chunk);
+      printf(" size, %ld\n size_compressed, %ld\n ratio, %f\n", array_size, slot->compressed_size, ((double) slot->compressed_size) / array_size);
+      printf(" read,       %fs, %f MiB/s\n", slot->t_read, array_size/slot->t_read/1024 /1024);
+      printf(" compress,   %fs, %f MiB/s\n", slot->t_compress, array_size/slot->t_compress/1024 /1024);
+      printf(" decompress, %fs, %f MiB/s\n", slot->t_decompress, array_size/slot->t_decompress/1024 /1024);
+      if (t_chunk_write > 0.0)
+        printf(" write,      %fs, %f MiB/s\n", t_chunk_write, array_size/t_chunk_write/1024 /1024);
+    }
+    t_read += slot->t_read;
+    t_compress += slot->t_compress;
+    t_decompress += slot->t_decompress;
+    t_write += t_chunk_write;
+    compressed_size += slot->compressed_size;
+
+    set_slot_state(& p, slot, CHUNK_FREE);
+  }
+
+  pthread_join(reader, NULL);
+  for (int t = 0; t < threads; t++){
+    pthread_join(workers[t], NULL);
+  }
+  ret = in_plugin->closeFile(p.rncid);
+  if (out_file != NULL) ret = out_plugin->closeFile(wncid);
+
+  double runtime = scilU_stop_timer(totalRun);
+  if(measure_time){
+    // the stages overlap, their times are summed over all chunks
+    const size_t total_size = array_size * p.chunks_number;
+    printf("Size:\n");
+    printf(" size, %ld\n size_compressed, %ld\n ratio, %f\n", total_size, compressed_size, ((double) compressed_size) / total_size);
+    printf("Runtime:  %fs, %f MiB/s with %d threads\n", runtime, total_size/runtime/1024 /1024, threads);
+    printf(" read,       %fs\n compress,   %fs\n decompress, %fs\n", t_read, t_compress, t_decompress);
+    if (t_write > 0.0)
+      printf(" write,      %fs\n", t_write);
+  }
+
+  pthread_cond_destroy(& p.changed);
+  pthread_mutex_destroy(& p.io_lock);
+  pthread_mutex_destroy(& p.lock);
+  for (int s = 0; s < p.depth; s++){
+    free(p.slots[s].pos);
+    free(p.slots[s].input_data);
+    free(p.slots[s].output_data);
+  }
+  free(p.slots);
+  free(p.count);
+  return 0;
+}
+
+#ifdef HAVE_NETCDF
+/*
+ * The multi-variable mode processes all variables of a NetCDF file as tasks on
+ * the thread pool of the library and writes them into one NetCDF file.
+ * The compression of a variable shares the pool with the other variables.
+ */
+
+typedef struct{
+  SCIL_Datatype_t datatype;
+  size_t size;
+  size_t compressed_size;
+  double t_compress;
+  double t_decompress;
+  const char * status;
+} variable_result_t;
+
+typedef struct{
+  pthread_mutex_t lock;
+  // serializes the calls of NetCDF, it is not thread-safe
+  pthread_mutex_t io_lock;
+
+  int rncid;
+  int wncid;
+  char ** names;
+  int count;
+  int next; // to process
+  variable_result_t * results;
+
+  const scil_user_hints_t * hints;
+  double fake_abstol_value;
+  double fake_finest_abstol_value;
+} variable_pool_t;
+
+/*
+ * Loads the hints of the variable, or of "*", from the hints file.
+ * \return 1 if the hints are loaded, 0 if the default hints are used
+ */
+static int load_variable_hints(const char * varname, const scil_user_hints_t * defaults, scil_user_hints_t * out_hints){
+  if (hints_file != NULL){
+    if (scil_user_hints_load(out_hints, hints_file, varname) == SCIL_NO_ERR || scil_user_hints_load(out_hints, hints_file, "*") == SCIL_NO_ERR){
+      return 1;
+    }
+  }
+  *out_hints = *defaults;
+  return 0;
+}
+
+static void process_variable(variable_pool_t * p, int var){
+  const char * name = p->names[var];
+  variable_result_t * r = & p->results[var];
+  SCIL_Datatype_t datatype;
+  scil_dims_t dims;
+  byte * data;
+  size_t read_size;
+  int compressed;
+  scil_timer timer;
+  int ret;
+
+  pthread_mutex_lock(& p->io_lock);
+  ret = scilO_netcdf_read_variable(p->rncid, name, & datatype, & dims, & data, & read_size, & compressed);
+  pthread_mutex_unlock(& p->io_lock);
+  if (ret != 0){
+    r->status = ret == 2 ? "unsupported datatype" : "read error";
+    return;
+  }
+  r->datatype = datatype;
+  r->size = scil_dims_get_size(& dims, datatype);
+  if (compressed != (uncompress != 0)){
+    r->status = uncompress ? "not compressed" : "compressed";
+    free(data);
+    return;
+  }
+
+  const size_t buff_size = scil_get_compressed_data_size_limit(& dims, datatype);
+  byte * output_data = (byte*) scilU_safe_malloc(buff_size);
+  byte * tmp_buff = (byte*) scilU_safe_malloc(buff_size);
+  byte * result = NULL;
+  r->status = "ok";
+
+  if (uncompress){
+    r->compressed_size = read_size;
+    scilU_start_timer(& timer);
+    ret = scil_decompress(datatype, output_data, & dims, data, read_size, tmp_buff);
+    r->t_decompress = scilU_stop_timer(timer);
+    if (ret != SCIL_NO_ERR){
+      r->status = "decompression error";
+    }
+  }else{
+    scil_user_hints_t hints;
+    scil_user_hints_t out_accuracy;
+    scil_validate_params_t out_validation;
+    scil_context_t * ctx;
+    const int loaded = load_variable_hints(name, p->hints, & hints);
+    apply_data_hints(datatype, data, & dims, & hints, p->fake_abstol_value, p->fake_finest_abstol_value);
+
+    ret = scil_context_create(& ctx, datatype, 0, NULL, & hints);
+    if (ret == SCIL_NO_ERR){
+      scil_context_set_block_size(ctx, (size_t) block_size);
+      result = (byte*) scilU_safe_malloc(buff_size);
+      scilU_start_timer(& timer);
+      ret = scil_compress(result, buff_size, data, & dims, & r->compressed_size, ctx);
+      r->t_compress = scilU_stop_timer(timer);
+      if (ret != SCIL_NO_ERR){
+        r->status = "compression error";
+      }else if (! compress){
+        scilU_start_timer(& timer);
+        ret = scil_decompress(datatype, output_data, & dims, result, r->compressed_size, tmp_buff);
+        r->t_decompress = scilU_stop_timer(timer);
+        if (ret != SCIL_NO_ERR){
+          r->status = "decompression error";
+        }
+      }
+      if (ret == SCIL_NO_ERR && validate){
+        memset(& out_validation, 0, sizeof(out_validation));
+        ret = scil_validate_compression(datatype, data, & dims, result, r->compressed_size, ctx, & out_accuracy, & out_validation);
+        if (ret != SCIL_NO_ERR){
+          r->status = "validation error";
+        }
+        if(scientific_validation){
+          printf("Validation of %s:\n", name);
+          scil_validate_params_print(& out_validation);
+        }
+      }
+      scil_destroy_context(ctx);
+    }else{
+      r->status = "datatype not supported by compressor";
+    }
+    if (loaded && hints.force_compression_methods != NULL){
+      free(hints.force_compression_methods);
+    }
+  }
+
+  if (out_file != NULL && strcmp(r->status, "ok") == 0){
+    pthread_mutex_lock(& p->io_lock);
+    if (compress){
+      ret = scilO_netcdf_write_compressed_variable(p->wncid, name, datatype, & dims, result, r->compressed_size);
+    }else{
+      ret = scilO_netcdf_write_variable(p->wncid, name, datatype, & dims, output_data);
+    }
+    pthread_mutex_unlock(& p->io_lock);
+    if (ret != 0){
+      r->status = "write error";
+    }
+  }
+
+  free(data);
+  free(result);
+  free(output_data);
+  free(tmp_buff);
+}
+
+static void process_variables_task(void * arg, int task){
+  variable_pool_t * p = (variable_pool_t*) arg;
+  while(1){
+    pthread_mutex_lock(& p->lock);
+    const int var = p->next++;
+    pthread_mutex_unlock(& p->lock);
+    if (var >= p->count){
+      break;
+    }
+    process_variable(p, var);
+  }
+}
+
+static double mib_per_s(size_t size, double seconds){
+  return seconds > 0.0 ? size / seconds / 1024 / 1024 : 0.0;
+}
+
+/*
+ * Processes all variables of the NetCDF file and prints a summary.
+ */
+static int process_variables(const scil_user_hints_t * hints, double fake_abstol_value, double fake_finest_abstol_value){
+  variable_pool_t p;
+
+  if (strcmp(in_plugin->name, "netcdf") != 0 || (out_file != NULL && strcmp(out_plugin->name, "netcdf") != 0)){
+    printf("The multi-variable mode reads and writes NetCDF files\n");
+    exit(1);
+  }
+  if (hints_file != NULL && access(hints_file, R_OK) != 0){
+    printf("The hints file %s could not be read\n", hints_file);
+    exit(1);
+  }
+
+  scil_timer totalRun;
+  scilU_start_timer(& totalRun);
+
+  memset(& p, 0, sizeof(p));
+  p.hints = hints;
+  p.fake_abstol_value = fake_abstol_value;
+  p.fake_finest_abstol_value = fake_finest_abstol_value;
+  if (scilO_netcdf_open(in_file, & p.rncid) != 0 || scilO_netcdf_get_variables(p.rncid, & p.count, & p.names) != 0){
+    printf("The input file %s could not be open\n", in_file);
+    exit(1);
+  }
+  if (out_file != NULL && scilO_netcdf_create(out_file, & p.wncid) != 0){
+    printf("The output file %s could not be open\n", out_file);
+    exit(1);
+  }
+  p.results = (variable_result_t*) calloc(p.count, sizeof(variable_result_t));
+  pthread_mutex_init(& p.lock, NULL);
+  pthread_mutex_init(& p.io_lock, NULL);
+
+  scil_set_threads(threads);
+  threads = scilU_get_thread_count();
+  // each task takes the next variable until all are processed
+  scilU_parallel_run(threads < p.count ? threads : p.count, process_variables_task, & p);
+
+  scilO_netcdf_close(p.rncid);
+  if (out_file != NULL && scilO_netcdf_close(p.wncid) != 0){
+    printf("The output file %s could not be written\n", out_file);
+    exit(1);
+  }
+  const double runtime = scilU_stop_timer(totalRun);
+
+  size_t total_size = 0, total_compressed = 0;
+  int processed = 0;
+  printf("%-24s %-8s %14s %10s %16s %16s %s\n", "variable", "type", "size", "ratio", "compress MiB/s", "decompress MiB/s", "status");
+  for (int i = 0; i < p.count; i++){
+    const variable_result_t * r = & p.results[i];
+    const int ok = strcmp(r->status, "ok") == 0;
+    printf("%-24s %-8s %14zu %10.4f %16.1f %16.1f %s\n", p.names[i], ok ? scil_datatype_to_str(r->datatype) : "-", r->size,
+      ok && r->size > 0 ? (double) r->compressed_size / r->size : 0.0,
+      mib_per_s(r->size, r->t_compress), mib_per_s(r->size, r->t_decompress), r->status);
+    if (ok){
+      total_size += r->size;
+      total_compressed += r->compressed_size;
+      processed++;
+    }
+  }
+  printf("%d of %d variables processed, size %zu, compressed %zu, ratio %f, %fs with %d threads, %f MiB/s\n",
+    processed, p.count, total_size, total_compressed, total_size > 0 ? (double) total_compressed / total_size : 0.0, runtime, threads, mib_per_s(total_size, runtime));
+
+  pthread_mutex_destroy(& p.io_lock);
+  pthread_mutex_destroy(& p.lock);
+  for (int i = 0; i < p.count; i++){
+    free(p.names[i]);
+  }
+  free(p.names);
+  free(p.results);
+  return 0;
+}
+#endif
+
 int main(int argc, char ** argv){
   scil_context_t* ctx = NULL;
   scil_user_hints_t hints;
-  scil_user_hints_t hints_cpy;
   scil_user_hints_t out_accuracy;
   scil_validate_params_t out_validation;
 
@@ -104,8 +757,13 @@ int main(int argc, char ** argv){
     {0, "hint-fake-absolute-tolerance-percent-max", "This is a fake hint. Actually it sets the abstol value based on the given percentage (enter 0.1 aka 10%% tolerance)",  OPTION_OPTIONAL_ARGUMENT, 'F', & fake_abstol_value},
     {0, "hint-fake-relative_err_finest_abs_tolerance", "This is a fake hint. Actually it sets the finest abstol value based on the given percentage (enter 0.1 aka 10%% tolerance)",  OPTION_OPTIONAL_ARGUMENT, 'F', & fake_finest_abstol_value},
     {0, "cycle", "For testing: Compress, then decompress and store the output. Files are CSV files",OPTION_FLAG, 'd' , & cycle},
-    {0, "use_chunks", "For testing: use chunks",OPTION_FLAG, 'd' , & use_chunks},
-    {0, "scientific_validation", "", OPTION_FLAG, 'd', & scientific_validation},
+    {0, "use_chunks", "Compress and decompress the variable in chunks, reading and writing overlap with the compression",OPTION_FLAG, 'd' , & use_chunks},
+    {0, "chunk-size", "Maximum size of a chunk in MiB", OPTION_OPTIONAL_ARGUMENT, 'd', & chunk_size},
+    {0, "threads", "Number of threads compressing the chunks or variables, 0 uses all cores", OPTION_OPTIONAL_ARGUMENT, 'd', & threads},
+    {0, "all-variables", "Process all variables of a NetCDF file in parallel into one NetCDF file", OPTION_FLAG, 'd', & all_variables},
+    {0, "hints-file", "Hints of the variables for the multi-variable mode, see scil_user_hints_load", OPTION_OPTIONAL_ARGUMENT, 's', & hints_file},
+    {0, "block-size", "Compress in independent blocks of at least this many values, they are validated block by block", OPTION_OPTIONAL_ARGUMENT, 'd', & block_size},
+    {0, "scientific_validation", "Print the error metrics of the validation", OPTION_FLAG, 'd', & scientific_validation},
     LAST_OPTION
   };
 
@@ -151,240 +809,17 @@ int main(int argc, char ** argv){
   out_validation.relative_tolerance_percent_idx = 0;
   out_validation.relative_err_finest_abs_tolerance_idx = 0;
 
-  if (use_chunks){
-    int rncid, rvarid, wncid, wvarid;
-    scil_dims_t orig_dims;
-    size_t * pos;
-    size_t * count;
-    size_t chunks_number=1;
-    size_t buff_size, input_size;
-
-    scil_timer timer;
-    scil_timer totalRun;
-    double t_read = 0.0, t_write = 0.0, t_compress = 0.0, t_decompress = 0.0;
-    scilU_start_timer(& totalRun);
-
-    ret = in_plugin->openRead(in_file, & input_datatype, & orig_dims, & rncid, & rvarid);
-    if (ret != 0){
-      printf("The input file %s could not be open\n", in_file);
-      exit(1);
-    }
-
-    if (out_file != NULL){
-      if (compress){
-        output_datatype = SCIL_TYPE_BINARY;
-      }
-      else{
-        output_datatype = input_datatype;
-      }
-      //todo fix error with writing in another format
-      /*ret = in_plugin->openWrite(out_file, output_datatype, orig_dims, & wncid, & wvarid);
-      if (ret != 0){
-        printf("The input file %s could not be open\n", out_file);
-        exit(1);
-      }*/
-    }
-
-    pos = (size_t*) malloc(orig_dims.dims * sizeof(size_t));
-    count = (size_t*) malloc(orig_dims.dims * sizeof(size_t));
-
-    for (size_t i = 0; i < orig_dims.dims; i++){
-      count[i] = orig_dims.length[i];
-      pos[i] = 0;
-    }
-    array_size = scil_dims_get_size(& orig_dims, input_datatype);
-
-    chunks_number = 1;
-    int i = 0;
-    //split data in chunks
-    while (array_size > DATA_SIZE_LIMIT){
-      if ((count[i] % 2) == 0){
-        count[i] >>= 1;
-        chunks_number <<= 1;
-        array_size >>= 1;
-      }
-      else {
-        if (i == orig_dims.dims-1){
-          printf("Cannot be good enough chunked\n");
-          exit(1);
-        }
-        else i++;
-      }
-    }
-
-    dims.dims = orig_dims.dims;
-
-    for (size_t i = 0; i < dims.dims; i++){
-      dims.length[i] = count[i];
-    }
-
-    printf("orig_dims: [%lld] [%lld] [%lld] [%lld]\n\n", orig_dims.length[0], orig_dims.length[1], orig_dims.length[2], orig_dims.length[3]);
-    printf("chunks: %lld | chunk size [%lld] [%lld] [%lld] [%lld]\n\n", chunks_number, count[0], count[1], count[2], count[3]);
-    printf("size: %lld\n", array_size);
-
-    //scil_user_hints_copy(& hints_cpy, & hints);
-    ret = scil_context_create(&ctx, input_datatype, 0, NULL, &hints);
-    assert(ret == SCIL_NO_ERR);
-
-    /*read, compress, decompress, write in chunks*/
-    for (size_t cur_chunk = 0; cur_chunk < chunks_number; cur_chunk++){
-      //scil_user_hints_copy(& hints, & hints_cpy);
-
-      printf("cur_chunk: %lld | start position [%lld] [%lld] [%lld] [%lld]\n", cur_chunk, pos[0], pos[1], pos[2], pos[3]);
-      input_data = (byte*) scilU_safe_malloc(array_size);
-      scilU_start_timer(& timer);
-      ret = in_plugin->readChunk(rncid, input_datatype, input_data, rvarid, pos, count);
-      if (ret != 0){
-        printf("The chunk %i could not be read\n",i);
-        exit(1);
-      }
-      t_read = scilU_stop_timer(timer);
-
-      if (use_max_value_as_fill_value){
-        double max, min;
-        scilU_find_minimum_maximum(input_datatype, input_data, & dims, & min, & max);
-        hints.fill_value = max;
-      }
-
-      if(verbose > 0){
-        double max, min;
-        scilU_find_minimum_maximum_with_excluded_points(input_datatype, input_data, & dims, & min, & max, hints.lossless_data_range_up_to,  hints.lossless_data_range_from, hints.fill_value);
-        printf("Min: %.10e Max: %.10e\n", min, max);
-      }
-
-      if (fake_abstol_value > 0.0 || fake_finest_abstol_value > 0.0){
-        double max, min;
-        scilU_find_minimum_maximum_with_excluded_points(input_datatype, input_data, & dims, & min, & max, hints.lossless_data_range_up_to,  hints.lossless_data_range_from, hints.fill_value);
-        if (min < 0 && max < -min){
-	     max = -min;
-        }
-
-        if (min > max){
-            printf("*** [SCIL] warning: only fill values in chunk\n");
-        }
-
-        if (fake_abstol_value > 0.0){
-          double new_abs_tol = max * fake_abstol_value;
-          if ( hints.absolute_tolerance > 0.0 ){
-            printf("Error: don't set both the absolute_tolerance and the fake relative absolute tolerance!\n");
-            exit(1);
-          }
-
-          printf("fake abstol: setting value to %f (min: %f max: %f)\n", new_abs_tol, min, max);
-          hints.absolute_tolerance = fabs(new_abs_tol);
-        }
-
-        if(fake_finest_abstol_value > 0.0){
-          hints.relative_err_finest_abs_tolerance = max * fake_finest_abstol_value;
-          printf("fake relative_err_finest_abs_tolerance: setting value to %f\n", hints.relative_err_finest_abs_tolerance);
-        }
-      }
-
-      ret = scil_context_create(&ctx, input_datatype, 0, NULL, &hints);
-      if (ret != SCIL_NO_ERR){
-            printf("*** [SCIL] error: datatype is not supported by compressor\n");
-            return 0;
-      }
-
-      if (print_hints){
-        printf("Effective hints (only needed for compression)\n");
-        scil_user_hints_t e = scil_get_effective_hints(ctx);
-        scil_user_hints_print(& e);
-      }
-
-      input_size = scil_get_compressed_data_size_limit(&dims, input_datatype);
-      //printf("input size: %lld\n", input_size);
-      output_data = (byte*) scilU_safe_malloc(input_size);
-      //compress
-      if (cycle || (! compress && ! uncompress) ){
-        printf("...compression and decompression\n");
-        byte* result = (byte*) scilU_safe_malloc(input_size);
-
-        scilU_start_timer(& timer);
-        ret = scil_compress(result,input_size, input_data, & dims, & buff_size, ctx);
-        t_compress = scilU_stop_timer(timer);
-        assert(ret == SCIL_NO_ERR);
-
-        byte* tmp_buff = (byte*) scilU_safe_malloc(input_size);
-        scilU_start_timer(& timer);
-        ret = scil_decompress(input_datatype, output_data, & dims, result, buff_size, tmp_buff);
-        t_decompress = scilU_stop_timer(timer);
-        assert(ret == SCIL_NO_ERR);
-
-        free(tmp_buff);
-
-        output_datatype = input_datatype;
-
-        if (validate) {
-          ret = scil_validate_compression(input_datatype, input_data, &dims, result, buff_size, ctx, &out_accuracy, &out_validation);
-          if(ret != SCIL_NO_ERR){
-            printf("SCIL validation error!\n");
-          }
-          if(print_hints){
-            printf("Validation accuracy:");
-            scil_user_hints_print(& out_accuracy);
-          }
-        }
-
-        free(result);
-        if(ret != SCIL_NO_ERR){
-          ret = scil_destroy_context(ctx);
-          assert(ret == SCIL_NO_ERR);
-          return 0;
-        }
-      }
-
-      //write
-      // todo reformat into output format, if neccessary
-      if (out_file != NULL){
-        //if ( compute_residual && (uncompress || cycle) ){
-          // compute the residual error
-          //scilU_subtract_data(input_datatype, input_data, output_data, & dims);
-        //}
-        ret = out_plugin->writeChunk(wncid, output_datatype, output_data, wvarid, pos, count);
-        if (ret != 0){
-          printf("The output file %s could not be written\n", out_file);
-          exit(1);
-        }
-      }
-
-      if(measure_time){
-        printf("Size:\n");
-        printf(" size, %ld\n size_compressed, %ld\n ratio, %f\n", array_size, buff_size, ((double) buff_size) / array_size);
-        //printf("Runtime:  %fs\n", runtime);
-        printf(" read,       %fs, %f MiB/s\n", t_read, array_size/t_read/1024 /1024);
-        if (t_compress > 0.0)
-          printf(" compress,   %fs, %f MiB/s\n", t_compress, array_size/t_compress/1024 /1024);
-        if (t_decompress > 0.0)
-          printf(" decompress, %fs, %f MiB/s\n", t_decompress, array_size/t_decompress/1024 /1024);
-        if (t_write > 0.0)
-          printf(" write,      %fs, %f MiB/s\n", t_write, array_size/t_write/1024 /1024);
-      }
-
-
-      //prepare next chunk
-      for (size_t i = 0; i < orig_dims.dims; i++){
-        if ((pos[i] + count[i]) < orig_dims.length[i]){
-           pos[i] += count[i];
-           debug("cur_chunk: %lld | i%lld [%lld] [%lld] [%lld] [%lld]\n", cur_chunk+1, i, pos[0], pos[1], pos[2], pos[3]);
-           break;
-        }
-        else {
-          pos[i] = 0;
-        }
-      }
-      free(input_data);
-      free(output_data);
-
-      ret = scil_destroy_context(ctx);
-      assert(ret == SCIL_NO_ERR);
-    }
+  if (all_variables){
+#ifdef HAVE_NETCDF
+    return process_variables(& hints, fake_abstol_value, fake_finest_abstol_value);
+#else
+    printf("The multi-variable mode requires NetCDF support\n");
+    exit(1);
+#endif
+  }
 
-    //ret = scil_destroy_context(ctx);
-    //assert(ret == SCIL_NO_ERR);
-    ret = in_plugin->closeFile(rncid);
-    if (out_file != NULL) ret = out_plugin->closeFile(wncid);
-    return 0;
+  if (use_chunks){
+    return process_chunks(& hints, fake_abstol_value, fake_finest_abstol_value);
   }
 
   scil_timer timer;
@@ -439,6 +874,7 @@ int main(int argc, char ** argv){
 
   ret = scil_context_create(&ctx, input_datatype, 0, NULL, &hints);
   assert(ret == SCIL_NO_ERR);
+  scil_context_set_block_size(ctx, (size_t) block_size);
 
   if (print_hints){
     printf("Effective hints (only needed for compression)\n");
@@ -479,9 +915,9 @@ int main(int argc, char ** argv){
         if(print_hints){
           printf("Validation accuracy:");
           scil_user_hints_print(& out_accuracy);
-	  if (scientific_validation){
-            printf("Scientific Validation:\n\tabsolute_tolerance_idx: %lu \n\trelative_err_finest_abs_tolerance_idx: %lu \n\trelative_tolerance_percent_idx: %lu \n", out_validation.absolute_tolerance_idx, out_validation.relative_err_finest_abs_tolerance_idx, out_validation.relative_tolerance_percent_idx);
-          }
+        }
+        if(print_hints || scientific_validation){
+          scil_validate_params_print(& out_validation);
         }
     }
     ret = scil_destroy_context(ctx);
@@ -502,9 +938,9 @@ int main(int argc, char ** argv){
         if(print_hints){
           printf("Validation accuracy:");
           scil_user_hints_print(& out_accuracy);
-	  if (scientific_validation){
-            printf("Scientific Validation:\n\tabsolute_tolerance_idx: %lu \n\trelative_err_finest_abs_tolerance_idx: %lu \n\trelative_tolerance_percent_idx: %lu \n", out_validation.absolute_tolerance_idx, out_validation.relative_err_finest_abs_tolerance_idx, out_validation.relative_tolerance_percent_idx);
-          }
+        }
+        if(print_hints || scientific_validation){
+          scil_validate_params_print(& out_validation);
         }
     }
     ret = scil_destroy_context(ctx);
@@ -552,7 +988,7 @@ int main(int argc, char ** argv){
       printf(" write,      %fs, %f MiB/s\n", t_write, array_size/t_write/1024 /1024);
   }
 
-  free(input_data);
+  scil_free_plugin_data(input_data);
   free(output_data);
 
   return 0;
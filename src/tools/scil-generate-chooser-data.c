@@ -24,6 +24,7 @@
 
 #include <scil.h>
 #include <scil-algo-chooser.h>
+#include <scil-data-characteristics.h>
 #include <scil-debug.h>
 #include <scil-patterns.h>
 #include <scil-util.h>
@@ -98,12 +99,13 @@ typedef struct line_data {
     double compthru;
     double decompthru;
     double compratio;
+    scilU_data_characteristics_t characteristics;
 } line_data_t;
 
-static line_data_t current_data = { 0, "", "", 0.0, 0.0, 0.0, 0.0, 0, 0, 0, 0, 0, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+static line_data_t current_data = { 0, "", "", 0.0, 0.0, 0.0, 0.0, 0, 0, 0, 0, 0, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, {0} };
 
 static void write_line(){
-    printf("%lu,%s,%s,%f,%f,%f,%f,%lu,%lu,%u,%lu,%lu,%lu,%lu,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
+    printf("%lu,%s,%s,%f,%f,%f,%f,%lu,%lu,%u,%lu,%lu,%lu,%lu,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%d,%f,%f,%f\n",
         current_data.line,
         current_data.algo,
         current_data.pattern,
@@ -128,9 +130,14 @@ static void write_line(){
         current_data.rel_tol,
         current_data.compthru,
         current_data.decompthru,
-        current_data.compratio);
-
-    fprintf(file, "%lu,%s,%s,%f,%f,%f,%f,%lu,%lu,%u,%lu,%lu,%lu,%lu,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
+        current_data.compratio,
+        current_data.characteristics.entropy,
+        current_data.characteristics.exponent_max - current_data.characteristics.exponent_min,
+        current_data.characteristics.smoothness[0],
+        current_data.characteristics.zero_fraction,
+        current_data.characteristics.repeat_fraction);
+
+    fprintf(file, "%lu,%s,%s,%f,%f,%f,%f,%lu,%lu,%u,%lu,%lu,%lu,%lu,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%d,%f,%f,%f\n",
         current_data.line,
         current_data.algo,
         current_data.pattern,
@@ -155,7 +162,12 @@ static void write_line(){
         current_data.rel_tol,
         current_data.compthru,
         current_data.decompthru,
-        current_data.compratio);
+        current_data.compratio,
+        current_data.characteristics.entropy,
+        current_data.characteristics.exponent_max - current_data.characteristics.exponent_min,
+        current_data.characteristics.smoothness[0],
+        current_data.characteristics.zero_fraction,
+        current_data.characteristics.repeat_fraction);
 
     current_data.line++;
 }
@@ -470,6 +482,7 @@ static int set_data_characteristics(const double *data, const scil_dims_t *dims)
     current_data.median = get_data_median(data, current_data.count);
     current_data.stddev = get_data_std_deviation(data, current_data.count, current_data.mean);
     current_data.maxstep = get_data_max_step(data, dims);
+    scilU_get_data_characteristics(data, SCIL_TYPE_DOUBLE, dims, DBL_MAX, &current_data.characteristics);
 
     return 0;
 }
@@ -651,7 +664,7 @@ int main(int argc, char** argv){
         return 1;
     }
 
-    fprintf(file, "%s\n", "Index,Algorithm,Pattern Name,Pattern Param Minimum,Pattern Param Maximum,Pattern Param 1,Pattern Param 2,Size of buffer,Value count,Dimensionality,Count x-Dim,Count y-Dim,Count z-Dim,Count w-Dim,Minimum,Maximum,Average,Median,Standard deviation,Maximum step,Absolute error tolerance,Relative error tolerance,Compression throughput,Decompression throughput,Compression ratio");
+    fprintf(file, "%s\n", "Index,Algorithm,Pattern Name,Pattern Param Minimum,Pattern Param Maximum,Pattern Param 1,Pattern Param 2,Size of buffer,Value count,Dimensionality,Count x-Dim,Count y-Dim,Count z-Dim,Count w-Dim,Minimum,Maximum,Average,Median,Standard deviation,Maximum step,Absolute error tolerance,Relative error tolerance,Compression throughput,Decompression throughput,Compression ratio,Byte entropy,Exponent spread,Smoothness,Zero fraction,Repeat fraction");
 
     for (size_t i = 0; i < SAMPLE_SIZE; i++){
         generate_data();
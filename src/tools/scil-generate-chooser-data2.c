@@ -24,6 +24,7 @@
 
 #include <scil.h>
 #include <scil-algo-chooser.h>
+#include <scil-data-characteristics.h>
 #include <scil-debug.h>
 #include <scil-patterns.h>
 #include <scil-util.h>
@@ -91,12 +92,13 @@ typedef struct line_data {
     double compthru;
     double decompthru;
     double compratio;
+    scilU_data_characteristics_t characteristics;
 } line_data_t;
 
-static line_data_t current_data = { 0, "", 0, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+static line_data_t current_data = { 0, "", 0, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, {0} };
 
 static void write_line(){
-    printf("%lu,%s,%lu,%lu,%u,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n", current_data.line,
+    printf("%lu,%s,%lu,%lu,%u,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%d,%f,%f,%f\n", current_data.line,
                                                                 current_data.algo,
                                                                 current_data.size,
                                                                 current_data.count,
@@ -111,9 +113,14 @@ static void write_line(){
                                                                 current_data.rel_tol,
                                                                 current_data.compthru,
                                                                 current_data.decompthru,
-                                                                current_data.compratio);
-
-    fprintf(file, "%lu,%s,%lu,%lu,%u,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n", current_data.line,
+                                                                current_data.compratio,
+                                                                current_data.characteristics.entropy,
+                                                                current_data.characteristics.exponent_max - current_data.characteristics.exponent_min,
+                                                                current_data.characteristics.smoothness[0],
+                                                                current_data.characteristics.zero_fraction,
+                                                                current_data.characteristics.repeat_fraction);
+
+    fprintf(file, "%lu,%s,%lu,%lu,%u,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%d,%f,%f,%f\n", current_data.line,
                                                                 current_data.algo,
                                                                 current_data.size,
                                                                 current_data.count,
@@ -128,7 +135,12 @@ static void write_line(){
                                                                 current_data.rel_tol,
                                                                 current_data.compthru,
                                                                 current_data.decompthru,
-                                                                current_data.compratio);
+                                                                current_data.compratio,
+                                                                current_data.characteristics.entropy,
+                                                                current_data.characteristics.exponent_max - current_data.characteristics.exponent_min,
+                                                                current_data.characteristics.smoothness[0],
+                                                                current_data.characteristics.zero_fraction,
+                                                                current_data.characteristics.repeat_fraction);
 
     current_data.line++;
 }
@@ -150,7 +162,7 @@ static void open_data_file(const char *file_name){
         exit(1);
     }
 
-    fprintf(file, "%s\n", "Index,Algorithm,Size of buffer,Value count,Dimensionality,Minimum,Maximum,Average,Median,Standard deviation,Maximum step,Absolute error tolerance,Relative error tolerance,Compression throughput,Decompression throughput,Compression ratio");
+    fprintf(file, "%s\n", "Index,Algorithm,Size of buffer,Value count,Dimensionality,Minimum,Maximum,Average,Median,Standard deviation,Maximum step,Absolute error tolerance,Relative error tolerance,Compression throughput,Decompression throughput,Compression ratio,Byte entropy,Exponent spread,Smoothness,Zero fraction,Repeat fraction");
 }
 
 static void close_data_file(){
@@ -486,6 +498,7 @@ static int set_data_characteristics(const double *data, const scil_dims_t *dims)
     current_data.median = 0.0;//get_data_median(data, current_data.count);
     current_data.stddev = get_data_std_deviation(data, current_data.count, current_data.mean);
     current_data.maxstep = get_data_max_step(data, dims);
+    scilU_get_data_characteristics(data, SCIL_TYPE_DOUBLE, dims, DBL_MAX, &current_data.characteristics);
 
     return 0;
 }
@@ -814,7 +827,7 @@ int main(int argc, char** argv){
 
     srand((unsigned)time(NULL));
 
-    fprintf(file, "%s\n", "Index,Algorithm,Size of buffer,Value count,Dimensionality,Minimum,Maximum,Average,Median,Standard deviation,Maximum step,Absolute error tolerance,Relative error tolerance,Compression throughput,Decompression throughput,Compression ratio");
+    fprintf(file, "%s\n", "Index,Algorithm,Size of buffer,Value count,Dimensionality,Minimum,Maximum,Average,Median,Standard deviation,Maximum step,Absolute error tolerance,Relative error tolerance,Compression throughput,Decompression throughput,Compression ratio,Byte entropy,Exponent spread,Smoothness,Zero fraction,Repeat fraction");
 
     //generate_dims_data();
     generate_stddev_data();
@@ -0,0 +1,502 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Measures the inner kernels of the compressors for working sets that fit into
+ * L1, L2, L3 and main memory. The best time of the repetitions is reported as
+ * nanoseconds and cycles per element and as GB/s of the input.
+ * The results can be stored as baseline, a later run compared against the
+ * baseline flags each kernel that became slower than the tolerance.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC
+#endif
+
+#include <scil.h>
+#include <scil-data-characteristics.h>
+#include <scil-debug.h>
+#include <scil-error.h>
+#include <scil-option.h>
+#include <scil-patterns.h>
+#include <scil-util.h>
+
+#include <algo/huffman.h>
+#include <algo/precond-delta.h>
+#include <algo/algo-sigbits.h>
+#include <scil-quantizer.h>
+#include <scil-swager.h>
+
+#define LEVELS 4
+#define HUFFMAN_MAX 256
+
+static const char * level_names[LEVELS] = {"L1", "L2", "L3", "DRAM"};
+
+static int repetitions = 5;
+static double min_time = 0.02;
+static double tolerance = 0.1;
+static int dram_mib = 0;
+static char * kernel_filter = NULL;
+static char * csv_file = NULL;
+static char * baseline_file = NULL;
+static char * save_baseline_file = NULL;
+
+typedef struct kernel_state kernel_state_t;
+
+typedef struct{
+	const char * name;
+	SCIL_Datatype_t datatype;
+	int param; // e.g., the bits per value, 0 if the kernel has no parameter
+	void (*prepare)(kernel_state_t * s);
+	int (*run)(kernel_state_t * s);
+} kernel_t;
+
+struct kernel_state{
+	const kernel_t * k;
+	size_t count;
+	scil_dims_t dims;
+	void * in;
+	void * out;
+	void * scratch;
+	size_t buffer_size;
+	double minimum;
+	double maximum;
+	double tolerance;
+	size_t compressed_size;
+	scil_context_t * ctx;
+	huffman_entity entities[HUFFMAN_MAX];
+};
+
+typedef struct{
+	char kernel[64];
+	char datatype[16];
+	int param;
+	char level[8];
+	double gb_s;
+} baseline_t;
+
+static baseline_t * baseline = NULL;
+static int baseline_count = 0;
+
+// the tolerance that quantizes the range into the given bits
+static double tolerance_for_bits(double mn, double mx, int bits){
+	return (mx - mn) / ((double)(1ull << bits) - 1) / 2;
+}
+
+static void prepare_quantize(kernel_state_t * s){
+	s->tolerance = tolerance_for_bits(s->minimum, s->maximum, s->k->param);
+}
+
+static int run_quantize(kernel_state_t * s){
+	if (s->k->datatype == SCIL_TYPE_FLOAT){
+		return scil_quantize_buffer_minmax_float((uint64_t*) s->out, (float*) s->in, s->count, s->tolerance, (float) s->minimum, (float) s->maximum);
+	}
+	return scil_quantize_buffer_minmax_double((uint64_t*) s->out, (double*) s->in, s->count, s->tolerance, s->minimum, s->maximum);
+}
+
+static void prepare_unquantize(kernel_state_t * s){
+	prepare_quantize(s);
+	void * out = s->out;
+	s->out = s->scratch;
+	run_quantize(s);
+	s->out = out;
+}
+
+static int run_unquantize(kernel_state_t * s){
+	if (s->k->datatype == SCIL_TYPE_FLOAT){
+		return scil_unquantize_buffer_float((float*) s->out, (uint64_t*) s->scratch, s->count, s->tolerance, (float) s->minimum);
+	}
+	return scil_unquantize_buffer_double((double*) s->out, (uint64_t*) s->scratch, s->count, s->tolerance, s->minimum);
+}
+
+static int run_minmax(kernel_state_t * s){
+	switch(s->k->datatype){
+		case(SCIL_TYPE_FLOAT): {
+			float mn, mx;
+			scilU_find_minimum_maximum_float((float*) s->in, s->count, & mn, & mx);
+			break;
+		}
+		case(SCIL_TYPE_INT32): {
+			int32_t mn, mx;
+			scilU_find_minimum_maximum_int32_t((int32_t*) s->in, s->count, & mn, & mx);
+			break;
+		}
+		default: {
+			double mn, mx;
+			scilU_find_minimum_maximum_double((double*) s->in, s->count, & mn, & mx);
+		}
+	}
+	return SCIL_NO_ERR;
+}
+
+// the quantized values of the given bits are the input of scil_swage
+static void prepare_swage(kernel_state_t * s){
+	uint64_t * values = (uint64_t*) s->scratch;
+	const uint64_t mask = (1ull << s->k->param) - 1;
+	for(size_t i = 0; i < s->count; i++){
+		values[i] = (i * 2654435761ull) & mask;
+	}
+}
+
+static int run_swage(kernel_state_t * s){
+	return scil_swage((byte*) s->out, (uint64_t*) s->scratch, s->count, s->k->param);
+}
+
+static void prepare_unswage(kernel_state_t * s){
+	prepare_swage(s);
+	scil_swage((byte*) s->in, (uint64_t*) s->scratch, s->count, s->k->param);
+}
+
+static int run_unswage(kernel_state_t * s){
+	return scil_unswage((uint64_t*) s->out, (byte*) s->in, s->count, s->k->param);
+}
+
+static void prepare_sigbits(kernel_state_t * s){
+	scil_user_hints_t hints;
+	scil_user_hints_initialize(& hints);
+	hints.significant_bits = s->k->param;
+	hints.force_compression_methods = "sigbits";
+	int ret = scil_context_create(& s->ctx, s->k->datatype, 0, NULL, & hints);
+	assert(ret == SCIL_NO_ERR);
+}
+
+static int run_sigbits(kernel_state_t * s){
+	s->compressed_size = s->buffer_size;
+	if (s->k->datatype == SCIL_TYPE_FLOAT){
+		return scil_sigbits_compress_float(s->ctx, (byte*) s->out, & s->compressed_size, (float*) s->in, & s->dims);
+	}
+	return scil_sigbits_compress_double(s->ctx, (byte*) s->out, & s->compressed_size, (double*) s->in, & s->dims);
+}
+
+static void prepare_unsigbits(kernel_state_t * s){
+	prepare_sigbits(s);
+	void * out = s->out;
+	s->out = s->scratch;
+	run_sigbits(s);
+	s->out = out;
+}
+
+static int run_unsigbits(kernel_state_t * s){
+	if (s->k->datatype == SCIL_TYPE_FLOAT){
+		return scil_sigbits_decompress_float((float*) s->out, & s->dims, (byte*) s->scratch, s->compressed_size);
+	}
+	return scil_sigbits_decompress_double((double*) s->out, & s->dims, (byte*) s->scratch, s->compressed_size);
+}
+
+static int run_delta(kernel_state_t * s){
+	byte header[16];
+	int header_size;
+	if (s->k->datatype == SCIL_TYPE_FLOAT){
+		return scil_delta_precond_compress_float(NULL, (float*) s->out, header, & header_size, (float*) s->in, & s->dims);
+	}
+	return scil_delta_precond_compress_double(NULL, (double*) s->out, header, & header_size, (double*) s->in, & s->dims);
+}
+
+static int run_randomness(kernel_state_t * s){
+	scilU_get_data_randomness(s->in, scil_dims_get_size(& s->dims, s->k->datatype), (byte*) s->out, s->buffer_size);
+	return SCIL_NO_ERR;
+}
+
+// the element count is the number of entities
+static void prepare_huffman(kernel_state_t * s){
+	s->count = s->k->param;
+	for(int i = 0; i < s->k->param; i++){
+		s->entities[i].data = NULL;
+		s->entities[i].count = (i * 2654435761ull) % 1000;
+	}
+}
+
+static int run_huffman(kernel_state_t * s){
+	huffman_encode(s->entities, s->count);
+	return SCIL_NO_ERR;
+}
+
+static const kernel_t kernels[] = {
+	{"minmax", SCIL_TYPE_DOUBLE, 0, NULL, run_minmax},
+	{"minmax", SCIL_TYPE_FLOAT, 0, NULL, run_minmax},
+	{"minmax", SCIL_TYPE_INT32, 0, NULL, run_minmax},
+	{"quantize", SCIL_TYPE_DOUBLE, 8, prepare_quantize, run_quantize},
+	{"quantize", SCIL_TYPE_DOUBLE, 20, prepare_quantize, run_quantize},
+	{"quantize", SCIL_TYPE_FLOAT, 8, prepare_quantize, run_quantize},
+	{"unquantize", SCIL_TYPE_DOUBLE, 8, prepare_unquantize, run_unquantize},
+	{"unquantize", SCIL_TYPE_DOUBLE, 20, prepare_unquantize, run_unquantize},
+	{"unquantize", SCIL_TYPE_FLOAT, 8, prepare_unquantize, run_unquantize},
+	{"swage", SCIL_TYPE_INT64, 4, prepare_swage, run_swage},
+	{"swage", SCIL_TYPE_INT64, 12, prepare_swage, run_swage},
+	{"swage", SCIL_TYPE_INT64, 32, prepare_swage, run_swage},
+	{"unswage", SCIL_TYPE_INT64, 4, prepare_unswage, run_unswage},
+	{"unswage", SCIL_TYPE_INT64, 12, prepare_unswage, run_unswage},
+	{"unswage", SCIL_TYPE_INT64, 32, prepare_unswage, run_unswage},
+	{"sigbits", SCIL_TYPE_DOUBLE, 8, prepare_sigbits, run_sigbits},
+	{"sigbits", SCIL_TYPE_DOUBLE, 24, prepare_sigbits, run_sigbits},
+	{"sigbits", SCIL_TYPE_FLOAT, 8, prepare_sigbits, run_sigbits},
+	{"unsigbits", SCIL_TYPE_DOUBLE, 8, prepare_unsigbits, run_unsigbits},
+	{"unsigbits", SCIL_TYPE_DOUBLE, 24, prepare_unsigbits, run_unsigbits},
+	{"unsigbits", SCIL_TYPE_FLOAT, 8, prepare_unsigbits, run_unsigbits},
+	{"delta", SCIL_TYPE_DOUBLE, 0, NULL, run_delta},
+	{"delta", SCIL_TYPE_FLOAT, 0, NULL, run_delta},
+	{"randomness", SCIL_TYPE_DOUBLE, 0, NULL, run_randomness},
+	{"huffman", SCIL_TYPE_INT64, 6, prepare_huffman, run_huffman},
+	{"huffman", SCIL_TYPE_INT64, 64, prepare_huffman, run_huffman},
+	{"huffman", SCIL_TYPE_INT64, 256, prepare_huffman, run_huffman},
+	{NULL, 0, 0, NULL, NULL}
+};
+
+static uint64_t read_cycles(){
+#ifdef HAVE_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+// the working set of each level is a quarter of the cache, the input and the output must fit
+static void get_working_sets(size_t * bytes){
+	long sizes[3] = {32 * 1024, 1024 * 1024, 32 * 1024 * 1024};
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+	const long detected[3] = {sysconf(_SC_LEVEL1_DCACHE_SIZE), sysconf(_SC_LEVEL2_CACHE_SIZE), sysconf(_SC_LEVEL3_CACHE_SIZE)};
+	for(int i = 0; i < 3; i++){
+		if (detected[i] > 0){
+			sizes[i] = detected[i];
+		}
+	}
+#endif
+	for(int i = 0; i < 3; i++){
+		bytes[i] = sizes[i] / 4;
+	}
+	// the reported L3 may be shared by many cores, the memory working set is limited to fit into the RAM
+	if (dram_mib > 0){
+		bytes[3] = (size_t) dram_mib * 1024 * 1024;
+	}else{
+		bytes[3] = sizes[2] * 2;
+		bytes[3] = bytes[3] < 64 * 1024 * 1024 ? 64 * 1024 * 1024 : bytes[3];
+		bytes[3] = bytes[3] > 256 * 1024 * 1024 ? 256 * 1024 * 1024 : bytes[3];
+	}
+}
+
+static void load_baseline(const char * file){
+	FILE * f = fopen(file, "r");
+	if (f == NULL){
+		critical("Cannot open the baseline %s: %s\n", file, strerror(errno));
+	}
+	char line[1024];
+	int capacity = 0;
+	while(fgets(line, sizeof(line), f) != NULL){
+		baseline_t b;
+		double ns, cycles;
+		size_t bytes;
+		if (sscanf(line, "%63[^,],%15[^,],%d,%7[^,],%zu,%lf,%lf,%lf", b.kernel, b.datatype, & b.param, b.level, & bytes, & ns, & cycles, & b.gb_s) != 8){
+			// the header
+			continue;
+		}
+		if (baseline_count == capacity){
+			capacity = capacity == 0 ? 64 : capacity * 2;
+			baseline = (baseline_t*) realloc(baseline, capacity * sizeof(baseline_t));
+		}
+		baseline[baseline_count++] = b;
+	}
+	fclose(f);
+}
+
+static const baseline_t * find_baseline(const kernel_t * k, const char * level){
+	for(int i = 0; i < baseline_count; i++){
+		const baseline_t * b = & baseline[i];
+		if (strcmp(b->kernel, k->name) == 0 && strcmp(b->datatype, scil_datatype_to_str(k->datatype)) == 0 && b->param == k->param && strcmp(b->level, level) == 0){
+			return b;
+		}
+	}
+	return NULL;
+}
+
+// the best time per call of the repetitions, each repetition runs for at least min_time
+static int measure(kernel_state_t * s, double * seconds, double * cycles){
+	size_t iterations = 1;
+	*seconds = INFINITY;
+	*cycles = INFINITY;
+	for(int r = 0; r < repetitions; r++){
+		while(1){
+			scil_timer timer;
+			scilU_start_timer(& timer);
+			const uint64_t start = read_cycles();
+			for(size_t i = 0; i < iterations; i++){
+				int ret = s->k->run(s);
+				if (ret != SCIL_NO_ERR){
+					return ret;
+				}
+			}
+			const uint64_t end = read_cycles();
+			const double t = scilU_stop_timer(timer);
+			if (t < min_time){
+				iterations = t > 0 ? (size_t)(iterations * 1.5 * min_time / t) + 1 : iterations * 10;
+				continue;
+			}
+			if (t / iterations < *seconds){
+				*seconds = t / iterations;
+				*cycles = (double)(end - start) / iterations;
+			}
+			break;
+		}
+	}
+	return SCIL_NO_ERR;
+}
+
+int main(int argc, char ** argv){
+	option_help known_args[] = {
+		{'r', "repetitions", "Number of measurements, the best one is reported", OPTION_OPTIONAL_ARGUMENT, 'd', & repetitions},
+		{0, "min-time", "Minimum duration of each measurement in seconds", OPTION_OPTIONAL_ARGUMENT, 'F', & min_time},
+		{'k', "kernel", "Only measure kernels whose name contains this string", OPTION_OPTIONAL_ARGUMENT, 's', & kernel_filter},
+		{0, "csv", "CSV file with all results", OPTION_OPTIONAL_ARGUMENT, 's', & csv_file},
+		{'b', "baseline", "Compare with this baseline, returns an error if a kernel regressed", OPTION_OPTIONAL_ARGUMENT, 's', & baseline_file},
+		{0, "save-baseline", "Store the results as baseline", OPTION_OPTIONAL_ARGUMENT, 's', & save_baseline_file},
+		{0, "dram-mib", "Working set of the memory level in MiB, by default twice the L3 cache up to 256 MiB", OPTION_OPTIONAL_ARGUMENT, 'd', & dram_mib},
+		{'t', "tolerance", "Tolerated slowdown relative to the baseline", OPTION_OPTIONAL_ARGUMENT, 'F', & tolerance},
+		LAST_OPTION
+	};
+	int printhelp = 0;
+	scilO_parseOptions(argc, argv, known_args, & printhelp);
+	if (printhelp != 0 || repetitions < 1 || min_time <= 0){
+		printf("\nSynopsis: %s ", argv[0]);
+		scilO_print_help(known_args, "\n");
+		exit(printhelp == 1 ? 0 : 1);
+	}
+	if (baseline_file != NULL){
+		load_baseline(baseline_file);
+	}
+
+	size_t working_set[LEVELS];
+	get_working_sets(working_set);
+
+	// the buffers hold the largest working set of doubles, the output may be larger than the input
+	size_t max_count = 0;
+	for(int l = 0; l < LEVELS; l++){
+		max_count = working_set[l] / sizeof(double) > max_count ? working_set[l] / sizeof(double) : max_count;
+	}
+	scil_dims_t dims;
+	scil_dims_initialize_1d(& dims, max_count);
+	const size_t buffer_size = scil_get_compressed_data_size_limit(& dims, SCIL_TYPE_DOUBLE);
+	double * data = (double*) malloc(max_count * sizeof(double));
+	void * in = malloc(buffer_size);
+	void * out = malloc(buffer_size);
+	void * scratch = malloc(buffer_size);
+	int pattern = 0;
+	for(int i = 0; i < scilP_get_pattern_library_size(); i++){
+		if (strcmp(scilP_get_library_pattern_name(i), "sin23") == 0){
+			pattern = i;
+		}
+	}
+	int ret = scilP_create_library_pattern(data, SCIL_TYPE_DOUBLE, & dims, pattern);
+	assert(ret == SCIL_NO_ERR);
+
+	const char * header = "kernel,datatype,param,level,bytes,ns_per_element,cycles_per_element,gb_s\n";
+	FILE * outputs[2] = {NULL, NULL};
+	if (csv_file != NULL){
+		outputs[0] = fopen(csv_file, "w");
+	}
+	if (save_baseline_file != NULL){
+		outputs[1] = fopen(save_baseline_file, "w");
+	}
+	for(int o = 0; o < 2; o++){
+		if (outputs[o] != NULL){
+			fputs(header, outputs[o]);
+		}
+	}
+#ifndef HAVE_TSC
+	printf("The cycles are not available on this architecture\n");
+#endif
+	printf("%-12s %-8s %5s %-5s %12s %10s %10s %10s\n", "kernel", "datatype", "param", "level", "bytes", "ns/elem", "cycles", "GB/s");
+
+	int regressions = 0;
+	for(const kernel_t * k = kernels; k->name != NULL; k++){
+		if (kernel_filter != NULL && strstr(k->name, kernel_filter) == NULL){
+			continue;
+		}
+		const size_t element_size = DATATYPE_LENGTH(k->datatype);
+		for(int l = 0; l < LEVELS; l++){
+			kernel_state_t s;
+			memset(& s, 0, sizeof(s));
+			s.k = k;
+			// the intermediate values of quantize and swage take 64 bits for any datatype
+			s.count = working_set[l] / sizeof(uint64_t);
+			s.in = in;
+			s.out = out;
+			s.scratch = scratch;
+			s.buffer_size = buffer_size;
+			scil_dims_initialize_1d(& s.dims, s.count);
+			if (k->datatype == SCIL_TYPE_DOUBLE){
+				memcpy(in, data, s.count * sizeof(double));
+			}else{
+				scilP_convert_data_from_double(in, k->datatype, data, & s.dims);
+			}
+			scilU_find_minimum_maximum(k->datatype, (byte*) in, & s.dims, & s.minimum, & s.maximum);
+			if (k->prepare != NULL){
+				k->prepare(& s);
+			}
+			double seconds, cycles;
+			ret = measure(& s, & seconds, & cycles);
+			if (s.ctx != NULL){
+				scil_destroy_context(s.ctx);
+			}
+			if (ret != SCIL_NO_ERR){
+				printf("%-12s %-8s %5d %-5s error %d\n", k->name, scil_datatype_to_str(k->datatype), k->param, level_names[l], ret);
+				regressions++;
+				continue;
+			}
+			const size_t bytes = s.count * element_size;
+			const double gb_s = bytes / seconds / 1e9;
+			printf("%-12s %-8s %5d %-5s %12zu %10.3f %10.2f %10.2f", k->name, scil_datatype_to_str(k->datatype), k->param, level_names[l], bytes, seconds * 1e9 / s.count, cycles / s.count, gb_s);
+			for(int o = 0; o < 2; o++){
+				if (outputs[o] != NULL){
+					fprintf(outputs[o], "%s,%s,%d,%s,%zu,%.4f,%.3f,%.3f\n", k->name, scil_datatype_to_str(k->datatype), k->param, level_names[l], bytes, seconds * 1e9 / s.count, cycles / s.count, gb_s);
+				}
+			}
+			const baseline_t * b = baseline_file != NULL ? find_baseline(k, level_names[l]) : NULL;
+			if (b != NULL){
+				const double change = gb_s / b->gb_s - 1;
+				const int regressed = gb_s < b->gb_s * (1 - tolerance);
+				regressions += regressed;
+				printf(" %+6.1f%%%s", change * 100, regressed ? " REGRESSION" : "");
+			}
+			printf("\n");
+			// the huffman code does not depend on the working set
+			if (k->run == run_huffman){
+				break;
+			}
+		}
+	}
+	for(int o = 0; o < 2; o++){
+		if (outputs[o] != NULL){
+			fclose(outputs[o]);
+		}
+	}
+	if (baseline_file != NULL){
+		printf("%d kernels regressed by more than %.0f%%\n", regressions, tolerance * 100);
+	}
+
+	free(baseline);
+	free(data);
+	free(in);
+	free(out);
+	free(scratch);
+	return regressions > 0;
+}
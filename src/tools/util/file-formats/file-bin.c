@@ -63,18 +63,21 @@ static int readData(const char * name, byte ** out_buf, SCIL_Datatype_t * out_da
   curr_pos = ftell(f);
   fseek(f, 0L, SEEK_END);
   input_data_size = ftell(f) - curr_pos;
-  fseek(f, curr_pos, SEEK_SET);
-
-  byte * input_data = (byte*) scilU_safe_malloc(input_data_size);
+  fclose(f);
 
-  if(fread(input_data, 1, input_data_size, f) == 0)
+  if(input_data_size == 0)
+  {
+    printf("Could not read values from %s\n", name);
+    return 1;
+  }
+  // the data is compressed straight from the page cache
+  byte * input_data = scil_map_file(name, curr_pos, input_data_size);
+  if(input_data == NULL)
   {
     printf("Could not read values from %s\n", name);
     return 1;
   }
   *out_buf = input_data;
-
-  fclose(f);
   return 0;
 }
 
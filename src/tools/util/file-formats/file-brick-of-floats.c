@@ -18,6 +18,8 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
 
 #include <scil-util.h>
 #include <file-formats/file-brick-of-floats.h>
@@ -43,40 +45,65 @@ static option_help * get_options(){
 }
 
 
-static int readData(const char * name, byte ** out_buf, SCIL_Datatype_t * out_datatype, scil_dims_t * out_dims, size_t * read_size){
-  FILE * fd = fopen(name, "rb");
-  if (! fd){
-    return SCIL_EINVAL;
+// swaps the byte order of each value, the loops are vectorized by the compiler
+static void swap_byte_order(byte * data, size_t size, int length){
+  switch(length){
+    case(2):{
+      uint16_t * values = (uint16_t*) data;
+      for(size_t i = 0; i < size / 2; i++){
+        values[i] = __builtin_bswap16(values[i]);
+      }
+      break;
+    }
+    case(4):{
+      uint32_t * values = (uint32_t*) data;
+      for(size_t i = 0; i < size / 4; i++){
+        values[i] = __builtin_bswap32(values[i]);
+      }
+      break;
+    }
+    case(8):{
+      uint64_t * values = (uint64_t*) data;
+      for(size_t i = 0; i < size / 8; i++){
+        values[i] = __builtin_bswap64(values[i]);
+      }
+      break;
+    }
+    default:
+      break;
   }
+}
+
+static int readData(const char * name, byte ** out_buf, SCIL_Datatype_t * out_datatype, scil_dims_t * out_dims, size_t * read_size){
   *out_datatype = datatype;
   scil_dims_initialize_4d(out_dims, size_x, size_y, size_z, size_za);
   const size_t data_size = scil_dims_get_size(out_dims, *out_datatype);
 
-  byte * input_data = (byte*) malloc(scil_get_compressed_data_size_limit(out_dims, *out_datatype));
-  //assert(size_y != 0 && size_z != 0 && size_za == 0 && size_x != 0);
-
   // index=x+dim_x×(y+dim_y×z)
-  size_t ret = fread(input_data, data_size, 1, fd);
-  if (ret != 1){
+  struct stat st;
+  if (stat(name, & st) != 0){
+    return SCIL_EINVAL;
+  }
+  if ((size_t) st.st_size < data_size){
     printf("Error while reading data from %s\n", name);
-    ret = SCIL_EINVAL;
-  }else{
-    ret = SCIL_NO_ERR;
+    return SCIL_EINVAL;
+  }
+  byte * input_data = scil_map_file(name, 0, data_size);
+  if (input_data == NULL){
+    printf("Error while reading data from %s\n", name);
+    return SCIL_EINVAL;
   }
-  fclose(fd);
 
   if (swap_order){
-    // depending on the endianess, we may have to swap the endianess
-    for(size_t p = 0; p < data_size; p += DATATYPE_LENGTH(datatype) ){
-      for(int i=0; i < DATATYPE_LENGTH(datatype)/2; i++){
-        byte tmp = input_data[p + i];
-        input_data[p + i] = input_data[p + DATATYPE_LENGTH(datatype) - i - 1];
-        input_data[p + DATATYPE_LENGTH(datatype) - i - 1] = tmp;
-      }
-    }
+    // depending on the endianess, we may have to swap the endianess.
+    // The swap writes every page of the private mapping, thus the data is copied
+    // into anonymous memory like a read; only data in the byte order of the
+    // machine is compressed straight from the page cache.
+    swap_byte_order(input_data, data_size, DATATYPE_LENGTH(datatype));
   }
   *out_buf = input_data;
-  return ret;
+  *read_size = data_size;
+  return SCIL_NO_ERR;
 }
 
 
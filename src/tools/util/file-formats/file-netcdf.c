@@ -627,6 +627,182 @@ static int closeFile(const int ncid){
   printf("*** SUCCESS close file!\n");
 }
 
+static int nc_to_datatype(nc_type type, SCIL_Datatype_t * out_datatype){
+  switch(type){
+    case(NC_DOUBLE):
+      *out_datatype = SCIL_TYPE_DOUBLE;
+      return 0;
+    case(NC_FLOAT):
+      *out_datatype = SCIL_TYPE_FLOAT;
+      return 0;
+    case(NC_BYTE):
+      *out_datatype = SCIL_TYPE_INT8;
+      return 0;
+    case(NC_SHORT):
+      *out_datatype = SCIL_TYPE_INT16;
+      return 0;
+    case(NC_INT):
+      *out_datatype = SCIL_TYPE_INT32;
+      return 0;
+    case(NC_INT64):
+      *out_datatype = SCIL_TYPE_INT64;
+      return 0;
+    case(NC_UBYTE):
+      *out_datatype = SCIL_TYPE_BINARY;
+      return 0;
+    default:
+      return 1;
+  }
+}
+
+static nc_type datatype_to_nc(SCIL_Datatype_t datatype){
+  switch(datatype){
+    case(SCIL_TYPE_DOUBLE):
+      return NC_DOUBLE;
+    case(SCIL_TYPE_FLOAT):
+      return NC_FLOAT;
+    case(SCIL_TYPE_INT8):
+      return NC_BYTE;
+    case(SCIL_TYPE_INT16):
+      return NC_SHORT;
+    case(SCIL_TYPE_INT32):
+      return NC_INT;
+    case(SCIL_TYPE_INT64):
+      return NC_INT64;
+    default:
+      return NC_UBYTE;
+  }
+}
+
+#define NC_CHECK(call) do { \
+  int retval_ = (call); \
+  if (retval_ != NC_NOERR){ \
+    printf("NetCDF error in %s: %s\n", __func__, nc_strerror(retval_)); \
+    return 1; \
+  } \
+} while(0)
+
+int scilO_netcdf_open(const char * name, int * ncid){
+  NC_CHECK(nc_open(name, NC_NOWRITE, ncid));
+  return 0;
+}
+
+int scilO_netcdf_create(const char * name, int * ncid){
+  NC_CHECK(nc_create(name, NC_NETCDF4 | NC_CLOBBER, ncid));
+  NC_CHECK(nc_enddef(*ncid));
+  return 0;
+}
+
+int scilO_netcdf_close(const int ncid){
+  NC_CHECK(nc_close(ncid));
+  return 0;
+}
+
+int scilO_netcdf_get_variables(const int ncid, int * out_count, char *** out_names){
+  int nvars;
+  NC_CHECK(nc_inq_nvars(ncid, & nvars));
+  char ** names = (char**) scilU_safe_malloc(sizeof(char*) * (nvars + 1));
+  for (int i = 0; i < nvars; i++){
+    char name[NC_MAX_NAME + 1];
+    NC_CHECK(nc_inq_varname(ncid, i, name));
+    names[i] = strdup(name);
+  }
+  *out_count = nvars;
+  *out_names = names;
+  return 0;
+}
+
+int scilO_netcdf_read_variable(const int ncid, const char * varname, SCIL_Datatype_t * out_datatype, scil_dims_t * out_dims, byte ** out_buf, size_t * out_size, int * out_compressed){
+  int varid, ndims;
+  int dimids[NC_MAX_VAR_DIMS];
+  size_t length[NC_MAX_VAR_DIMS];
+  nc_type type;
+
+  NC_CHECK(nc_inq_varid(ncid, varname, & varid));
+  NC_CHECK(nc_inq_var(ncid, varid, NULL, & type, & ndims, dimids, NULL));
+  if (nc_to_datatype(type, out_datatype) != 0 || ndims < 1 || ndims > SCIL_DIMS_MAX){
+    return 2;
+  }
+  for (int j = 0; j < ndims; j++){
+    NC_CHECK(nc_inq_dimlen(ncid, dimids[j], & length[j]));
+  }
+  scil_dims_initialize_array(out_dims, ndims, length);
+  *out_size = scil_dims_get_size(out_dims, *out_datatype);
+
+  // the original data type and dimensions of compressed data
+  int orig_datatype;
+  size_t orig_ndims;
+  *out_compressed = type == NC_UBYTE && ndims == 1 && nc_get_att_int(ncid, varid, "scil_datatype", & orig_datatype) == NC_NOERR;
+  if (*out_compressed){
+    unsigned long long orig_length[SCIL_DIMS_MAX];
+    NC_CHECK(nc_inq_attlen(ncid, varid, "scil_dims", & orig_ndims));
+    if (orig_ndims < 1 || orig_ndims > SCIL_DIMS_MAX){
+      return 1;
+    }
+    NC_CHECK(nc_get_att_ulonglong(ncid, varid, "scil_dims", orig_length));
+    for (size_t j = 0; j < orig_ndims; j++){
+      length[j] = (size_t) orig_length[j];
+    }
+    *out_datatype = (SCIL_Datatype_t) orig_datatype;
+    scil_dims_initialize_array(out_dims, orig_ndims, length);
+  }
+
+  const size_t limit = scil_get_compressed_data_size_limit(out_dims, *out_datatype);
+  byte * buf = (byte*) scilU_safe_malloc(limit > *out_size ? limit : *out_size);
+  int retval = nc_get_var(ncid, varid, buf);
+  if (retval != NC_NOERR){
+    printf("NetCDF error reading %s: %s\n", varname, nc_strerror(retval));
+    free(buf);
+    return 1;
+  }
+  *out_buf = buf;
+  return 0;
+}
+
+// defines the variable with its own dimensions, named after it
+static int define_variable(const int ncid, const char * varname, nc_type type, int ndims, const size_t * length, int * varid){
+  int dimids[NC_MAX_VAR_DIMS];
+  int retval = nc_redef(ncid);
+  if (retval != NC_NOERR && retval != NC_EINDEFINE){
+    printf("NetCDF error in %s: %s\n", __func__, nc_strerror(retval));
+    return 1;
+  }
+  for (int i = 0; i < ndims; i++){
+    char dim_name[NC_MAX_NAME + 1];
+    snprintf(dim_name, sizeof(dim_name), "%.*s_dim%d", NC_MAX_NAME - 16, varname, i);
+    NC_CHECK(nc_def_dim(ncid, dim_name, length[i], & dimids[i]));
+  }
+  NC_CHECK(nc_def_var(ncid, varname, type, ndims, dimids, varid));
+  return 0;
+}
+
+int scilO_netcdf_write_variable(const int ncid, const char * varname, SCIL_Datatype_t datatype, const scil_dims_t * dims, const byte * buf){
+  int varid;
+  if (define_variable(ncid, varname, datatype_to_nc(datatype), dims->dims, dims->length, & varid) != 0){
+    return 1;
+  }
+  NC_CHECK(nc_enddef(ncid));
+  NC_CHECK(nc_put_var(ncid, varid, buf));
+  return 0;
+}
+
+int scilO_netcdf_write_compressed_variable(const int ncid, const char * varname, SCIL_Datatype_t orig_datatype, const scil_dims_t * orig_dims, const byte * buf, size_t size){
+  int varid;
+  const int datatype = orig_datatype;
+  unsigned long long orig_length[SCIL_DIMS_MAX];
+  for (int i = 0; i < orig_dims->dims; i++){
+    orig_length[i] = orig_dims->length[i];
+  }
+  if (define_variable(ncid, varname, NC_UBYTE, 1, & size, & varid) != 0){
+    return 1;
+  }
+  NC_CHECK(nc_put_att_int(ncid, varid, "scil_datatype", NC_INT, 1, & datatype));
+  NC_CHECK(nc_put_att_ulonglong(ncid, varid, "scil_dims", NC_UINT64, orig_dims->dims, orig_length));
+  NC_CHECK(nc_enddef(ncid));
+  NC_CHECK(nc_put_var(ncid, varid, buf));
+  return 0;
+}
+
 scil_file_plugin_t netcdf_plugin = {
   "netcdf",
   "nc",
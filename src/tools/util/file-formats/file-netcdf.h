@@ -20,4 +20,36 @@
 
 scil_file_plugin_t netcdf_plugin;
 
+/*
+ * Access to files with several variables, the variable is named instead of
+ * the plugin option. A file must not be used by several threads at a time.
+ * The functions return 0 on success.
+ */
+int scilO_netcdf_open(const char * name, int * ncid);
+
+// creates a NetCDF4 file, variables are defined when they are written
+int scilO_netcdf_create(const char * name, int * ncid);
+
+int scilO_netcdf_close(const int ncid);
+
+/*
+ * Stores the names of all variables in out_names, the caller frees each name
+ * and the array.
+ */
+int scilO_netcdf_get_variables(const int ncid, int * out_count, char *** out_names);
+
+/*
+ * Reads a variable into a buffer of the compressed data size limit.
+ * A variable written by scilO_netcdf_write_compressed_variable is returned
+ * with its original data type and dimensions and out_compressed is set,
+ * out_size is the size of the read data.
+ * \return 0, 1 on error, 2 if the data type is not supported
+ */
+int scilO_netcdf_read_variable(const int ncid, const char * varname, SCIL_Datatype_t * out_datatype, scil_dims_t * out_dims, byte ** out_buf, size_t * out_size, int * out_compressed);
+
+int scilO_netcdf_write_variable(const int ncid, const char * varname, SCIL_Datatype_t datatype, const scil_dims_t * dims, const byte * buf);
+
+// stores the compressed bytes with the original data type and dimensions as attributes
+int scilO_netcdf_write_compressed_variable(const int ncid, const char * varname, SCIL_Datatype_t orig_datatype, const scil_dims_t * orig_dims, const byte * buf, size_t size);
+
 #endif
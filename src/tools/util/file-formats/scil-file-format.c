@@ -13,8 +13,14 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
 
-#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <file-formats/scil-file-format.h>
 
@@ -58,3 +64,80 @@ scil_file_plugin_t * scil_find_plugin(const char * name){
   }
   return NULL;
 }
+
+// the buffers returned by scil_map_file that are mapped
+typedef struct{
+  byte * buf;
+  void * base;
+  size_t length;
+} file_mapping_t;
+
+static file_mapping_t * mappings = NULL;
+static int mapping_count = 0;
+static pthread_mutex_t mapping_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static byte * read_file(int fd, size_t offset, size_t size){
+  byte * buf = (byte*) malloc(size);
+  if (buf == NULL){
+    return NULL;
+  }
+  for(size_t pos = 0; pos < size; ){
+    ssize_t ret = pread(fd, buf + pos, size - pos, offset + pos);
+    if (ret <= 0){
+      if (ret == 0){
+        errno = EIO;
+      }
+      free(buf);
+      return NULL;
+    }
+    pos += (size_t) ret;
+  }
+  return buf;
+}
+
+byte * scil_map_file(const char * name, size_t offset, size_t size){
+  int fd = open(name, O_RDONLY);
+  if (fd < 0){
+    return NULL;
+  }
+  // the mapping starts at the beginning of the file, the offset need not be aligned to a page
+  const size_t length = offset + size;
+  void * base = size > 0 ? mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  if (base == MAP_FAILED){
+    byte * buf = read_file(fd, offset, size);
+    close(fd);
+    return buf;
+  }
+  close(fd);
+  madvise(base, length, MADV_SEQUENTIAL);
+
+  pthread_mutex_lock(& mapping_lock);
+  file_mapping_t * m = (file_mapping_t*) realloc(mappings, sizeof(file_mapping_t) * (mapping_count + 1));
+  if (m == NULL){
+    pthread_mutex_unlock(& mapping_lock);
+    munmap(base, length);
+    errno = ENOMEM;
+    return NULL;
+  }
+  mappings = m;
+  mappings[mapping_count].buf = (byte*) base + offset;
+  mappings[mapping_count].base = base;
+  mappings[mapping_count].length = length;
+  mapping_count++;
+  pthread_mutex_unlock(& mapping_lock);
+  return (byte*) base + offset;
+}
+
+void scil_free_plugin_data(byte * buf){
+  pthread_mutex_lock(& mapping_lock);
+  for(int i = 0; i < mapping_count; i++){
+    if (mappings[i].buf == buf){
+      munmap(mappings[i].base, mappings[i].length);
+      mappings[i] = mappings[--mapping_count];
+      pthread_mutex_unlock(& mapping_lock);
+      return;
+    }
+  }
+  pthread_mutex_unlock(& mapping_lock);
+  free(buf);
+}
@@ -36,4 +36,17 @@ typedef struct {
 
 scil_file_plugin_t * scil_find_plugin(const char * name);
 
+/*
+ * Maps size bytes of the file from the offset privately, i.e., changes of the
+ * buffer are not written back, for a sequential read.
+ * If the file cannot be mapped, it is read into an allocated buffer.
+ * \return the buffer or NULL with errno set
+ */
+byte * scil_map_file(const char * name, size_t offset, size_t size);
+
+/*
+ * Releases the buffer returned by readData, it is mapped or allocated.
+ */
+void scil_free_plugin_data(byte * buf);
+
 #endif
@@ -0,0 +1,67 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <scil-conf-update.h>
+
+static void write_limit(FILE * out, const char * name, double value, const char * comment){
+  fprintf(out, "# %s\n!%s %.1f\n", comment, name, value);
+}
+
+int scilO_conf_set_hardware_limit(const char * conf_file, const char * name, double value, const char * comment){
+  char line[1024];
+  char pending[1024] = ""; // a comment that is dropped if it describes the old limit
+  char tmp_file[1024];
+  char limit[64];
+  snprintf(tmp_file, sizeof(tmp_file), "%s.bak", conf_file);
+  snprintf(limit, sizeof(limit), "!%s ", name);
+
+  FILE * out = fopen(tmp_file, "w");
+  if (out == NULL){
+    return -1;
+  }
+  int written = 0;
+  FILE * in = fopen(conf_file, "r");
+  while(in != NULL && fgets(line, sizeof(line), in) != NULL){
+    if (strncmp(line, limit, strlen(limit)) == 0){
+      pending[0] = 0;
+      continue;
+    }
+    fputs(pending, out);
+    pending[0] = 0;
+    if (line[0] == '#'){
+      strcpy(pending, line);
+      continue;
+    }
+    if (! written && line[0] != '!'){
+      write_limit(out, name, value, comment);
+      written = 1;
+    }
+    fputs(line, out);
+  }
+  fputs(pending, out);
+  if (! written){
+    write_limit(out, name, value, comment);
+  }
+  if (in != NULL){
+    fclose(in);
+  }
+  if (fclose(out) != 0){
+    return -1;
+  }
+  return rename(tmp_file, conf_file);
+}
@@ -0,0 +1,28 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SCIL_CONF_UPDATE_H
+#define SCIL_CONF_UPDATE_H
+
+/*
+ * Replaces the hardware limit "!name" of the configuration file, or adds it
+ * before the first entry, together with a comment line that describes it.
+ * A comment line directly before the old limit is removed with it.
+ * The file is created if it does not exist.
+ * \return 0, or -1 with errno set
+ */
+int scilO_conf_set_hardware_limit(const char * conf_file, const char * name, double value, const char * comment);
+
+#endif
@@ -0,0 +1,217 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <assert.h>
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <scil.h>
+#include <scil-error.h>
+#include <scil-util.h>
+
+#include <scil-sweep.h>
+
+static const double abs_levels[] = {1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6};
+static const double rel_levels[] = {10, 1, 0.1, 0.01};
+static const int bits_levels[] = {3, 6, 10, 16, 23};
+
+#define LEVEL_COUNT(x) (sizeof(x) / sizeof(x[0]))
+
+void scilO_sweep_init(sweep_data_t * s, SCIL_Datatype_t datatype, byte * data, const scil_dims_t * dims){
+  s->datatype = datatype;
+  s->data = data;
+  s->dims = *dims;
+  s->buff_size = scil_get_compressed_data_size_limit(dims, datatype);
+  s->buffer_out = (byte*) scilU_safe_malloc(s->buff_size);
+  s->buffer_decompressed = (byte*) scilU_safe_malloc(s->buff_size);
+  s->tmp_buff = (byte*) scilU_safe_malloc(s->buff_size);
+
+  double min, max;
+  scilU_find_minimum_maximum(datatype, data, & s->dims, & min, & max);
+  s->range = max > min ? max - min : 1.0;
+  const double magnitude = max > -min ? max : -min;
+  s->slack = datatype == SCIL_TYPE_FLOAT ? magnitude * (double) FLT_EPSILON : 0;
+}
+
+void scilO_sweep_destroy(sweep_data_t * s){
+  free(s->buffer_out);
+  free(s->buffer_decompressed);
+  free(s->tmp_buff);
+}
+
+void scilO_sweep_lossy_points(const sweep_data_t * s, const char * chain, sweep_point_t * out){
+  int pos = 0;
+  memset(out, 0, sizeof(sweep_point_t) * SWEEP_LEVELS);
+  for(size_t i=0; i < LEVEL_COUNT(abs_levels); i++){
+    out[pos].kind = SWEEP_ABSOLUTE;
+    out[pos++].tolerance = abs_levels[i] * s->range;
+  }
+  for(size_t i=0; i < LEVEL_COUNT(rel_levels); i++){
+    out[pos].kind = SWEEP_RELATIVE;
+    out[pos++].tolerance = rel_levels[i];
+  }
+  for(size_t i=0; i < LEVEL_COUNT(bits_levels); i++){
+    out[pos].kind = SWEEP_BITS;
+    out[pos++].tolerance = bits_levels[i];
+  }
+  assert(pos == SWEEP_LEVELS);
+  for(int i=0; i < SWEEP_LEVELS; i++){
+    out[i].chain = chain;
+  }
+}
+
+static int compare_double(const void * a, const void * b){
+  const double x = *(const double*) a;
+  const double y = *(const double*) b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double median(double * values, int count){
+  qsort(values, count, sizeof(double), compare_double);
+  return count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
+}
+
+static void set_tolerance(scil_user_hints_t * hints, const sweep_point_t * p){
+  switch(p->kind){
+    case(SWEEP_ABSOLUTE):
+      hints->absolute_tolerance = p->tolerance;
+      break;
+    case(SWEEP_RELATIVE):
+      hints->relative_tolerance_percent = p->tolerance;
+      break;
+    case(SWEEP_BITS):
+      hints->significant_bits = (int) p->tolerance;
+      break;
+    default:
+      break;
+  }
+}
+
+static double get_error(const scil_user_hints_t * a, sweep_kind_t kind){
+  switch(kind){
+    case(SWEEP_RELATIVE):
+      return a->relative_tolerance_percent;
+    case(SWEEP_BITS):
+      return - a->significant_bits;
+    default:
+      return a->absolute_tolerance;
+  }
+}
+
+static int violates(const sweep_data_t * s, const sweep_point_t * p){
+  switch(p->kind){
+    case(SWEEP_LOSSLESS):
+      return p->error > 0;
+    case(SWEEP_ABSOLUTE):
+      return p->error > p->tolerance + s->slack;
+    case(SWEEP_RELATIVE):
+      return p->error > p->tolerance;
+    default:
+      return -p->error < p->tolerance;
+  }
+}
+
+int scilO_sweep_measure(const sweep_data_t * s, sweep_point_t * p, int warmup, int repetitions){
+  const size_t data_size = scil_dims_get_size(& s->dims, s->datatype);
+  scil_dims_t dims = s->dims;
+  double seconds_compress[repetitions];
+  double seconds_decompress[repetitions];
+
+  scil_user_hints_t hints;
+  scil_user_hints_initialize(& hints);
+  hints.force_compression_methods = (char*) p->chain;
+  set_tolerance(& hints, p);
+
+  scil_context_t* ctx;
+  int ret = scil_context_create(& ctx, s->datatype, 0, NULL, & hints);
+  if (ret != SCIL_NO_ERR){
+    return ret;
+  }
+  size_t out_c_size = 0;
+  for(int run = -warmup; run < repetitions && ret == SCIL_NO_ERR; run++){
+    scil_timer timer;
+    scilU_start_timer(& timer);
+    ret = scil_compress(s->buffer_out, s->buff_size, s->data, & dims, & out_c_size, ctx);
+    const double seconds = scilU_stop_timer(timer);
+    if (ret != SCIL_NO_ERR){
+      break;
+    }
+    scilU_start_timer(& timer);
+    ret = scil_decompress(s->datatype, s->buffer_decompressed, & dims, s->buffer_out, out_c_size, s->tmp_buff);
+    const double seconds_d = scilU_stop_timer(timer);
+    if (run >= 0){
+      seconds_compress[run] = seconds;
+      seconds_decompress[run] = seconds_d;
+    }
+  }
+  scil_destroy_context(ctx);
+  if (ret != SCIL_NO_ERR){
+    return ret;
+  }
+
+  scil_user_hints_t achieved;
+  scil_validate_params_t validation;
+  scil_determine_accuracy(s->datatype, s->buffer_decompressed, s->data, & dims, 0, & achieved, & validation);
+  p->error = get_error(& achieved, p->kind);
+  p->ratio = (double) out_c_size / data_size;
+  p->c_speed = data_size / median(seconds_compress, repetitions) / 1024 / 1024;
+  p->d_speed = data_size / median(seconds_decompress, repetitions) / 1024 / 1024;
+  return violates(s, p) ? SCIL_PRECISION_ERR : SCIL_NO_ERR;
+}
+
+// o dominates p if it is at least as good in every metric and better in one
+static int dominates(const sweep_point_t * o, const sweep_point_t * p){
+  if (o->error > p->error || o->ratio > p->ratio || o->c_speed < p->c_speed || o->d_speed < p->d_speed){
+    return 0;
+  }
+  return o->error < p->error || o->ratio < p->ratio || o->c_speed > p->c_speed || o->d_speed > p->d_speed;
+}
+
+int scilO_sweep_mark_pareto(sweep_point_t * points, int count){
+  int pareto = 0;
+  for(int i=0; i < count; i++){
+    points[i].pareto = 1;
+    for(int j=0; j < count; j++){
+      if (j != i && points[j].kind == points[i].kind && dominates(& points[j], & points[i])){
+        points[i].pareto = 0;
+        break;
+      }
+    }
+    pareto += points[i].pareto;
+  }
+  return pareto;
+}
+
+const char * scilO_sweep_kind_name(sweep_kind_t kind){
+  switch(kind){
+    case(SWEEP_ABSOLUTE):
+      return "abs";
+    case(SWEEP_RELATIVE):
+      return "rel";
+    case(SWEEP_BITS):
+      return "bits";
+    default:
+      return "lossless";
+  }
+}
+
+void scilO_sweep_print_tolerance(FILE * f, const sweep_point_t * p){
+  if (p->kind == SWEEP_BITS){
+    fprintf(f, "%s=%d", scilO_sweep_kind_name(p->kind), (int) p->tolerance);
+  }else{
+    fprintf(f, "%s=%g", scilO_sweep_kind_name(p->kind), p->tolerance);
+  }
+}
@@ -0,0 +1,91 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SCIL_SWEEP_H
+#define SCIL_SWEEP_H
+
+#include <stdio.h>
+
+#include <scil-datatypes.h>
+#include <scil-dims.h>
+
+/*
+ * Measures chains on one variable with the tolerances of a sweep, as used by the
+ * benchmark tools that characterize lossy chains.
+ */
+
+typedef enum{
+  SWEEP_LOSSLESS = 0,
+  SWEEP_ABSOLUTE,
+  SWEEP_RELATIVE,
+  SWEEP_BITS
+} sweep_kind_t;
+
+// the number of tolerances of a lossy chain, absolute tolerances are relative to the value range
+#define SWEEP_LEVELS 15
+
+typedef struct{
+  const char * chain;
+  sweep_kind_t kind;
+  double tolerance;
+  double error;  // the achieved error of the kind, the negative significant bits
+  double ratio;
+  double c_speed; // median MiB/s
+  double d_speed;
+  int pareto;
+} sweep_point_t;
+
+typedef struct{
+  SCIL_Datatype_t datatype;
+  byte * data; // must hold the compressed data size limit
+  scil_dims_t dims;
+  double range;
+  double slack; // the rounding error of the values
+  size_t buff_size;
+  byte * buffer_out;
+  byte * buffer_decompressed;
+  byte * tmp_buff;
+} sweep_data_t;
+
+void scilO_sweep_init(sweep_data_t * s, SCIL_Datatype_t datatype, byte * data, const scil_dims_t * dims);
+void scilO_sweep_destroy(sweep_data_t * s);
+
+/*
+ * Stores the SWEEP_LEVELS points of the lossy chain in out.
+ */
+void scilO_sweep_lossy_points(const sweep_data_t * s, const char * chain, sweep_point_t * out);
+
+/*
+ * Compresses and decompresses the data with the chain and tolerance of p.
+ * \return SCIL_NO_ERR and the metrics in p, SCIL_PRECISION_ERR if the
+ * tolerance is violated or the error of the chain.
+ */
+int scilO_sweep_measure(const sweep_data_t * s, sweep_point_t * p, int warmup, int repetitions);
+
+/*
+ * Marks the points that are not dominated regarding achieved error, ratio and
+ * throughput by a point of the same kind.
+ * \return the number of Pareto-optimal points
+ */
+int scilO_sweep_mark_pareto(sweep_point_t * points, int count);
+
+const char * scilO_sweep_kind_name(sweep_kind_t kind);
+
+/*
+ * Prints the tolerance as expected by the chooser, e.g., abs=0.01.
+ */
+void scilO_sweep_print_tolerance(FILE * f, const sweep_point_t * p);
+
+#endif
@@ -0,0 +1,437 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <scil-counters.h>
+
+#include <scil-debug.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TRACE_NAME_LENGTH 64
+#define DEFAULT_TRACE_EVENTS 65536
+
+// the counters of a thread, an open addressing hash table
+typedef struct thread_table{
+  pthread_mutex_t lock; // taken by the owner and while collecting
+  scilU_counter_t* entries;
+  size_t capacity; // a power of 2
+  size_t count;
+  struct thread_table* next;
+} thread_table_t;
+
+typedef struct{
+  char name[TRACE_NAME_LENGTH];
+  int thread;
+  double start;
+  double seconds;
+} trace_event_t;
+
+static pthread_once_t counters_once = PTHREAD_ONCE_INIT;
+// guards the list of tables and the retired counters
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static thread_table_t* tables;
+// the counters of finished threads
+static thread_table_t retired;
+static pthread_key_t table_key;
+static int counters_on; // accessed atomically
+static __thread thread_table_t* own_table = NULL;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_event_t* trace_events; // ring buffer
+static size_t trace_capacity;
+static size_t trace_count;
+static size_t trace_next;
+static int trace_on; // accessed atomically
+static int thread_ids; // accessed atomically
+static __thread int thread_id = 0;
+
+static const char* counters_file;
+static const char* trace_file;
+
+static uint64_t hash_name(const char* name){
+  // FNV-1a
+  uint64_t h = 14695981039346656037ull;
+  for(const char* c = name; *c != 0; c++){
+    h ^= (unsigned char) *c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+static scilU_counter_t* find_counter(thread_table_t* t, const char* name);
+
+static void grow_table(thread_table_t* t){
+  scilU_counter_t* old = t->entries;
+  const size_t old_capacity = t->capacity;
+  t->capacity = old_capacity == 0 ? 64 : 2 * old_capacity;
+  t->entries = (scilU_counter_t*) scilU_safe_malloc(t->capacity * sizeof(scilU_counter_t));
+  memset(t->entries, 0, t->capacity * sizeof(scilU_counter_t));
+  t->count = 0;
+  for(size_t i = 0; i < old_capacity; i++){
+    if(old[i].name[0] != 0){
+      *find_counter(t, old[i].name) = old[i];
+    }
+  }
+  free(old);
+}
+
+// returns the counter with the name, an empty one is added if it is missing
+static scilU_counter_t* find_counter(thread_table_t* t, const char* name){
+  if(2 * (t->count + 1) > t->capacity){
+    grow_table(t);
+  }
+  const size_t mask = t->capacity - 1;
+  for(size_t i = hash_name(name) & mask; ; i = (i + 1) & mask){
+    scilU_counter_t* c = &t->entries[i];
+    if(c->name[0] == 0){
+      strcpy(c->name, name);
+      t->count++;
+      return c;
+    }
+    if(strcmp(c->name, name) == 0){
+      return c;
+    }
+  }
+}
+
+static void merge_counter(thread_table_t* t, const scilU_counter_t* c){
+  scilU_counter_t* d = find_counter(t, c->name);
+  d->calls += c->calls;
+  d->errors += c->errors;
+  d->input_bytes += c->input_bytes;
+  d->output_bytes += c->output_bytes;
+  d->seconds += c->seconds;
+}
+
+static void merge_table(thread_table_t* dest, thread_table_t* src){
+  for(size_t i = 0; i < src->capacity; i++){
+    if(src->entries[i].name[0] != 0){
+      merge_counter(dest, &src->entries[i]);
+    }
+  }
+}
+
+// the counters of a finished thread are kept
+static void retire_table(void* arg){
+  thread_table_t* t = (thread_table_t*) arg;
+  pthread_mutex_lock(&registry_lock);
+  for(thread_table_t** p = &tables; *p != NULL; p = &(*p)->next){
+    if(*p == t){
+      *p = t->next;
+      break;
+    }
+  }
+  merge_table(&retired, t);
+  pthread_mutex_unlock(&registry_lock);
+  pthread_mutex_destroy(&t->lock);
+  free(t->entries);
+  free(t);
+}
+
+static thread_table_t* get_own_table(){
+  if(own_table != NULL){
+    return own_table;
+  }
+  thread_table_t* t = (thread_table_t*) scilU_safe_malloc(sizeof(thread_table_t));
+  memset(t, 0, sizeof(thread_table_t));
+  pthread_mutex_init(&t->lock, NULL);
+  pthread_mutex_lock(&registry_lock);
+  t->next = tables;
+  tables = t;
+  pthread_mutex_unlock(&registry_lock);
+  pthread_setspecific(table_key, t);
+  own_table = t;
+  return t;
+}
+
+// a forked child may use the counters of its parent
+static void lock_all(){
+  pthread_mutex_lock(&registry_lock);
+  for(thread_table_t* t = tables; t != NULL; t = t->next){
+    pthread_mutex_lock(&t->lock);
+  }
+  pthread_mutex_lock(&trace_lock);
+}
+
+static void unlock_all(){
+  pthread_mutex_unlock(&trace_lock);
+  for(thread_table_t* t = tables; t != NULL; t = t->next){
+    pthread_mutex_unlock(&t->lock);
+  }
+  pthread_mutex_unlock(&registry_lock);
+}
+
+static FILE* open_report(const char* name){
+  if(strcmp(name, "-") == 0){
+    return stderr;
+  }
+  FILE* f = fopen(name, "w");
+  if(f == NULL){
+    warn("Could not write %s\n", name);
+  }
+  return f;
+}
+
+static void close_report(FILE* f){
+  if(f != NULL && f != stderr){
+    fclose(f);
+  }
+}
+
+static void write_at_exit(){
+  if(counters_file != NULL){
+    FILE* f = open_report(counters_file);
+    if(f != NULL){
+      const size_t len = strlen(counters_file);
+      const int json = len >= 5 && strcmp(counters_file + len - 5, ".json") == 0;
+      scilU_counters_write(f, json ? SCILU_COUNTERS_JSON : SCILU_COUNTERS_CSV);
+      close_report(f);
+    }
+  }
+  if(trace_file != NULL){
+    FILE* f = open_report(trace_file);
+    if(f != NULL){
+      scilU_trace_write(f);
+      close_report(f);
+    }
+  }
+}
+
+static void set_trace_capacity(size_t capacity){
+  pthread_mutex_lock(&trace_lock);
+  free(trace_events);
+  trace_events = NULL;
+  if(capacity > 0){
+    trace_events = (trace_event_t*) scilU_safe_malloc(capacity * sizeof(trace_event_t));
+  }
+  trace_capacity = capacity;
+  trace_count = 0;
+  trace_next = 0;
+  __atomic_store_n(&trace_on, capacity > 0, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&trace_lock);
+}
+
+static void initialize_counters(){
+  pthread_key_create(&table_key, retire_table);
+  pthread_atfork(lock_all, unlock_all, unlock_all);
+
+  counters_file = getenv("SCIL_COUNTERS");
+  if(counters_file != NULL && counters_file[0] != 0){
+    __atomic_store_n(&counters_on, 1, __ATOMIC_RELAXED);
+  }else{
+    counters_file = NULL;
+  }
+  trace_file = getenv("SCIL_TRACE");
+  if(trace_file != NULL && trace_file[0] != 0){
+    const char* events = getenv("SCIL_TRACE_EVENTS");
+    long capacity = events != NULL ? atol(events) : 0;
+    set_trace_capacity(capacity > 0 ? (size_t) capacity : DEFAULT_TRACE_EVENTS);
+  }else{
+    trace_file = NULL;
+  }
+  if(counters_file != NULL || trace_file != NULL){
+    atexit(write_at_exit);
+  }
+}
+
+int scilU_counters_enabled(){
+  pthread_once(&counters_once, initialize_counters);
+  return __atomic_load_n(&counters_on, __ATOMIC_RELAXED);
+}
+
+void scilU_counters_set_enabled(int enabled){
+  pthread_once(&counters_once, initialize_counters);
+  __atomic_store_n(&counters_on, enabled != 0, __ATOMIC_RELAXED);
+}
+
+void scilU_counter_add(const char* name, size_t input_bytes, size_t output_bytes, double seconds, int error){
+  pthread_once(&counters_once, initialize_counters);
+  char key[SCILU_COUNTER_NAME_LENGTH];
+  snprintf(key, SCILU_COUNTER_NAME_LENGTH, "%s", name);
+  if(key[0] == 0){
+    return;
+  }
+  thread_table_t* t = get_own_table();
+  pthread_mutex_lock(&t->lock);
+  scilU_counter_t* c = find_counter(t, key);
+  c->calls++;
+  c->errors += error != 0;
+  c->input_bytes += input_bytes;
+  c->output_bytes += output_bytes;
+  c->seconds += seconds;
+  pthread_mutex_unlock(&t->lock);
+}
+
+static int compare_counters(const void* a, const void* b){
+  return strcmp(((const scilU_counter_t*) a)->name, ((const scilU_counter_t*) b)->name);
+}
+
+int scilU_counters_collect(scilU_counter_t** out_counters){
+  pthread_once(&counters_once, initialize_counters);
+  thread_table_t sum;
+  memset(&sum, 0, sizeof(thread_table_t));
+  pthread_mutex_lock(&registry_lock);
+  merge_table(&sum, &retired);
+  for(thread_table_t* t = tables; t != NULL; t = t->next){
+    pthread_mutex_lock(&t->lock);
+    merge_table(&sum, t);
+    pthread_mutex_unlock(&t->lock);
+  }
+  pthread_mutex_unlock(&registry_lock);
+
+  scilU_counter_t* counters = (scilU_counter_t*) scilU_safe_malloc((sum.count + 1) * sizeof(scilU_counter_t));
+  int count = 0;
+  for(size_t i = 0; i < sum.capacity; i++){
+    if(sum.entries[i].name[0] != 0){
+      counters[count] = sum.entries[i];
+      count++;
+    }
+  }
+  free(sum.entries);
+  qsort(counters, count, sizeof(scilU_counter_t), compare_counters);
+  *out_counters = counters;
+  return count;
+}
+
+static void write_json_string(FILE* file, const char* s){
+  fputc('"', file);
+  for(const char* c = s; *c != 0; c++){
+    if(*c == '"' || *c == '\\'){
+      fputc('\\', file);
+    }
+    if((unsigned char) *c < 32){
+      fprintf(file, "\\u%04x", (unsigned char) *c);
+    }else{
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+// names with a comma, e.g., of a chain, are quoted
+static void write_csv_string(FILE* file, const char* s){
+  if(strpbrk(s, ",\"\n") == NULL){
+    fputs(s, file);
+    return;
+  }
+  fputc('"', file);
+  for(const char* c = s; *c != 0; c++){
+    if(*c == '"'){
+      fputc('"', file);
+    }
+    fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+void scilU_counters_write(FILE* file, enum scilU_counters_format format){
+  scilU_counter_t* counters;
+  const int count = scilU_counters_collect(&counters);
+  if(format == SCILU_COUNTERS_JSON){
+    fprintf(file, "{\"counters\":[");
+    for(int i = 0; i < count; i++){
+      const scilU_counter_t* c = &counters[i];
+      fprintf(file, "%s\n{\"name\":", i == 0 ? "" : ",");
+      write_json_string(file, c->name);
+      fprintf(file, ",\"calls\":%llu,\"errors\":%llu,\"input_bytes\":%llu,\"output_bytes\":%llu,\"seconds\":%.9f}",
+        (unsigned long long) c->calls, (unsigned long long) c->errors,
+        (unsigned long long) c->input_bytes, (unsigned long long) c->output_bytes, c->seconds);
+    }
+    fprintf(file, "\n]}\n");
+  }else{
+    fprintf(file, "name,calls,errors,input_bytes,output_bytes,seconds\n");
+    for(int i = 0; i < count; i++){
+      const scilU_counter_t* c = &counters[i];
+      write_csv_string(file, c->name);
+      fprintf(file, ",%llu,%llu,%llu,%llu,%.9f\n",
+        (unsigned long long) c->calls, (unsigned long long) c->errors,
+        (unsigned long long) c->input_bytes, (unsigned long long) c->output_bytes, c->seconds);
+    }
+  }
+  free(counters);
+}
+
+static void clear_table(thread_table_t* t){
+  if(t->capacity > 0){
+    memset(t->entries, 0, t->capacity * sizeof(scilU_counter_t));
+  }
+  t->count = 0;
+}
+
+void scilU_counters_reset(){
+  pthread_once(&counters_once, initialize_counters);
+  pthread_mutex_lock(&registry_lock);
+  clear_table(&retired);
+  for(thread_table_t* t = tables; t != NULL; t = t->next){
+    pthread_mutex_lock(&t->lock);
+    clear_table(t);
+    pthread_mutex_unlock(&t->lock);
+  }
+  pthread_mutex_unlock(&registry_lock);
+}
+
+int scilU_trace_enabled(){
+  pthread_once(&counters_once, initialize_counters);
+  return __atomic_load_n(&trace_on, __ATOMIC_RELAXED);
+}
+
+void scilU_trace_set_capacity(size_t capacity){
+  pthread_once(&counters_once, initialize_counters);
+  set_trace_capacity(capacity);
+}
+
+void scilU_trace_event(const char* name, scil_timer start, double seconds){
+  if(! scilU_trace_enabled()){
+    return;
+  }
+  if(thread_id == 0){
+    thread_id = __atomic_add_fetch(&thread_ids, 1, __ATOMIC_RELAXED);
+  }
+  // the monotonic clock, the viewers show the time relative to the first event
+  const double start_seconds = scilU_time_to_double(start);
+  pthread_mutex_lock(&trace_lock);
+  if(trace_capacity > 0){
+    trace_event_t* e = &trace_events[trace_next];
+    snprintf(e->name, TRACE_NAME_LENGTH, "%s", name);
+    e->thread = thread_id;
+    e->start = start_seconds;
+    e->seconds = seconds;
+    trace_next = (trace_next + 1) % trace_capacity;
+    if(trace_count < trace_capacity){
+      trace_count++;
+    }
+  }
+  pthread_mutex_unlock(&trace_lock);
+}
+
+void scilU_trace_write(FILE* file){
+  pthread_once(&counters_once, initialize_counters);
+  const int pid = (int) getpid();
+  fprintf(file, "{\"traceEvents\":[");
+  pthread_mutex_lock(&trace_lock);
+  const size_t first = (trace_next + trace_capacity - trace_count) % (trace_capacity > 0 ? trace_capacity : 1);
+  for(size_t i = 0; i < trace_count; i++){
+    const trace_event_t* e = &trace_events[(first + i) % trace_capacity];
+    fprintf(file, "%s\n{\"name\":", i == 0 ? "" : ",");
+    write_json_string(file, e->name);
+    fprintf(file, ",\"cat\":\"scil\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+      pid, e->thread, e->start * 1e6, e->seconds * 1e6);
+  }
+  pthread_mutex_unlock(&trace_lock);
+  fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+}
@@ -0,0 +1,92 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Process-wide counters for the monitoring of long running applications.
+ * A counter is identified by its name, e.g., "compress:lz4". Each thread adds
+ * to its own table, the tables are summed up on demand.
+ * Optionally, the events are kept in a ring buffer and exported in the Chrome
+ * trace format, which chrome://tracing and Perfetto display.
+ *
+ * The environment enables both at the start and writes them at exit:
+ *   SCIL_COUNTERS=<file> the counters as CSV, as JSON if the file ends with .json
+ *   SCIL_TRACE=<file> the trace
+ *   SCIL_TRACE_EVENTS=<count> the capacity of the ring buffer, 65536 by default
+ * The file "-" is stderr.
+ */
+
+#ifndef SCIL_COUNTERS_H
+#define SCIL_COUNTERS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <scil-util.h>
+
+#define SCILU_COUNTER_NAME_LENGTH 128
+
+typedef struct{
+  char name[SCILU_COUNTER_NAME_LENGTH];
+  uint64_t calls;
+  uint64_t errors;
+  uint64_t input_bytes;
+  uint64_t output_bytes;
+  double seconds;
+} scilU_counter_t;
+
+enum scilU_counters_format{
+  SCILU_COUNTERS_CSV,
+  SCILU_COUNTERS_JSON
+};
+
+int scilU_counters_enabled();
+
+void scilU_counters_set_enabled(int enabled);
+
+/*
+ * \brief Adds a call to the counter of the calling thread, names longer than
+ * SCILU_COUNTER_NAME_LENGTH are truncated.
+ */
+void scilU_counter_add(const char* name, size_t input_bytes, size_t output_bytes, double seconds, int error);
+
+/*
+ * \brief Sums up the counters of all threads.
+ * \param out_counters receives the counters sorted by name, to be freed by the caller
+ * \return the number of counters
+ */
+int scilU_counters_collect(scilU_counter_t** out_counters);
+
+void scilU_counters_write(FILE* file, enum scilU_counters_format format);
+
+void scilU_counters_reset();
+
+int scilU_trace_enabled();
+
+/*
+ * \brief Keeps the last capacity events, 0 disables the trace and drops the events.
+ */
+void scilU_trace_set_capacity(size_t capacity);
+
+/*
+ * \brief Records an event of the calling thread that started at start and took seconds.
+ */
+void scilU_trace_event(const char* name, scil_timer start, double seconds);
+
+/*
+ * \brief Writes the events in the Chrome trace format, the oldest first.
+ */
+void scilU_trace_write(FILE* file);
+
+#endif // SCIL_COUNTERS_H
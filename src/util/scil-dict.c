@@ -50,6 +50,7 @@ void scilU_dict_destroy(scilU_dict_t* dict)
         }
     }
     free(dict->elem);
+    free(dict);
 }
 
 /* lookup: look for s in dict */
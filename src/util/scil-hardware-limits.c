@@ -21,9 +21,11 @@
 #include <scil-error.h>
 
 static float hardware_limits[HARDWARE_MAX];
+// must match the order of hardware_limit_e
 static const char* hardware_names[] = {
-  "storage",
   "network",
+  "storage",
+  "memory",
   NULL
 };
 
@@ -45,3 +47,10 @@ int scilU_add_hardware_limit(const char* name, const char* str){
   }
   return SCIL_EINVAL;
 }
+
+float scilU_get_hardware_limit(enum hardware_limit_e limit){
+  if(limit >= HARDWARE_MAX){
+    return 0;
+  }
+  return hardware_limits[limit];
+}
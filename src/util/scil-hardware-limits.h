@@ -19,6 +19,7 @@
 enum hardware_limit_e{
   NETWORK = 0,
   STORAGE = 1,
+  MEMORY = 2, // the aggregate bandwidth of all threads of the node
   HARDWARE_MAX
 };
 
@@ -26,5 +27,10 @@ void scilU_initialize_hardware_limits();
 
 int scilU_add_hardware_limit(const char* name, const char* str);
 
+/*
+ * \brief Returns the bandwidth of the component in MiB/s, 0 if it is unknown.
+ */
+float scilU_get_hardware_limit(enum hardware_limit_e limit);
+
 
 #endif // SCIL_HARDWARE_LIMITS_H
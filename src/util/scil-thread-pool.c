@@ -0,0 +1,357 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <scil-thread-pool.h>
+
+#include <scil-error.h>
+#include <scil-util.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Ranges per thread of scilU_parallel_for(), more ranges balance the load
+#define RANGES_PER_THREAD 4
+
+typedef struct{
+  scilU_task_func func;
+  void* arg;
+  scilU_task_group_t* group;
+} task_t;
+
+typedef struct{
+  pthread_mutex_t lock;
+  task_t* tasks; // ring buffer
+  size_t capacity;
+  size_t head; // the oldest task, stolen first
+  size_t count;
+} task_queue_t;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+// guards the start of workers and the sleeping
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+// queue 0 is shared by the threads outside of the pool, worker i owns queue i
+static task_queue_t queues[SCIL_MAX_THREADS];
+static int default_thread_count;
+static int thread_count; // accessed atomically
+static int started_workers; // accessed atomically
+static size_t queued_tasks; // accessed atomically
+static pthread_key_t scratch_key;
+
+static __thread int worker_id = 0;
+
+typedef struct{
+  void* buffer;
+  size_t size;
+} scratch_t;
+
+static void free_scratch(void* arg){
+  scratch_t* s = (scratch_t*) arg;
+  free(s->buffer);
+  free(s);
+}
+
+// the queues in use are consistent at a fork
+static int locked_queues;
+
+static void lock_all(){
+  pthread_mutex_lock(&pool_lock);
+  locked_queues = started_workers + 1;
+  for(int i = 0; i < locked_queues; i++){
+    pthread_mutex_lock(&queues[i].lock);
+  }
+}
+
+static void unlock_all(){
+  for(int i = locked_queues - 1; i >= 0; i--){
+    pthread_mutex_unlock(&queues[i].lock);
+  }
+  pthread_mutex_unlock(&pool_lock);
+}
+
+// the workers do not exist in a forked child, the pool starts them again
+static void unlock_all_in_child(){
+  unlock_all();
+  started_workers = 0;
+  worker_id = 0;
+  // the condition still counts the sleeping workers of the parent
+  pthread_cond_init(&pool_cond, NULL);
+}
+
+static void initialize_pool(){
+  for(int i = 0; i < SCIL_MAX_THREADS; i++){
+    pthread_mutex_init(&queues[i].lock, NULL);
+  }
+  pthread_key_create(&scratch_key, free_scratch);
+  pthread_atfork(lock_all, unlock_all, unlock_all_in_child);
+
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  const char* env = getenv("SCIL_THREADS");
+  if(env != NULL && atoi(env) > 0){
+    count = atoi(env);
+  }
+  if(count < 1) count = 1;
+  if(count > SCIL_MAX_THREADS) count = SCIL_MAX_THREADS;
+  default_thread_count = (int) count;
+  __atomic_store_n(&thread_count, default_thread_count, __ATOMIC_RELAXED);
+}
+
+int scilU_set_thread_count(int count){
+  if(count < 0){
+    return SCIL_EINVAL;
+  }
+  pthread_once(&pool_once, initialize_pool);
+  if(count == 0){
+    count = default_thread_count;
+  }
+  if(count > SCIL_MAX_THREADS){
+    count = SCIL_MAX_THREADS;
+  }
+  __atomic_store_n(&thread_count, count, __ATOMIC_RELAXED);
+  // workers beyond the count go to sleep, others may have to start
+  pthread_mutex_lock(&pool_lock);
+  pthread_cond_broadcast(&pool_cond);
+  pthread_mutex_unlock(&pool_lock);
+  return SCIL_NO_ERR;
+}
+
+int scilU_get_thread_count(){
+  pthread_once(&pool_once, initialize_pool);
+  return __atomic_load_n(&thread_count, __ATOMIC_RELAXED);
+}
+
+static void push_task(int queue, const task_t* task){
+  task_queue_t* q = &queues[queue];
+  pthread_mutex_lock(&q->lock);
+  if(q->count == q->capacity){
+    size_t capacity = q->capacity == 0 ? 64 : 2 * q->capacity;
+    task_t* tasks = (task_t*) scilU_safe_malloc(capacity * sizeof(task_t));
+    for(size_t i = 0; i < q->count; i++){
+      tasks[i] = q->tasks[(q->head + i) % q->capacity];
+    }
+    free(q->tasks);
+    q->tasks = tasks;
+    q->capacity = capacity;
+    q->head = 0;
+  }
+  q->tasks[(q->head + q->count) % q->capacity] = *task;
+  q->count++;
+  pthread_mutex_unlock(&q->lock);
+  __atomic_add_fetch(&queued_tasks, 1, __ATOMIC_SEQ_CST);
+}
+
+// the owner takes the newest task, a thief the oldest one
+static int pop_task(int queue, int steal, task_t* out){
+  task_queue_t* q = &queues[queue];
+  pthread_mutex_lock(&q->lock);
+  if(q->count == 0){
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+  }
+  if(steal){
+    *out = q->tasks[q->head];
+    q->head = (q->head + 1) % q->capacity;
+  }else{
+    *out = q->tasks[(q->head + q->count - 1) % q->capacity];
+  }
+  q->count--;
+  pthread_mutex_unlock(&q->lock);
+  __atomic_sub_fetch(&queued_tasks, 1, __ATOMIC_SEQ_CST);
+  return 1;
+}
+
+static void wake_all(){
+  pthread_mutex_lock(&pool_lock);
+  pthread_cond_broadcast(&pool_cond);
+  pthread_mutex_unlock(&pool_lock);
+}
+
+static int run_one_task(){
+  task_t task;
+  const int queue_count = __atomic_load_n(&started_workers, __ATOMIC_ACQUIRE) + 1;
+  int found = pop_task(worker_id, 0, &task);
+  for(int i = 1; i < queue_count && ! found; i++){
+    found = pop_task((worker_id + i) % queue_count, 1, &task);
+  }
+  if(! found){
+    return 0;
+  }
+  task.func(task.arg);
+  if(__atomic_sub_fetch(&task.group->pending, 1, __ATOMIC_SEQ_CST) == 0){
+    wake_all();
+  }
+  return 1;
+}
+
+static int may_work(){
+  return worker_id < __atomic_load_n(&thread_count, __ATOMIC_RELAXED);
+}
+
+static void* worker_main(void* arg){
+  worker_id = (int) (intptr_t) arg;
+  while(1){
+    if(may_work() && run_one_task()){
+      continue;
+    }
+    pthread_mutex_lock(&pool_lock);
+    while(! (may_work() && __atomic_load_n(&queued_tasks, __ATOMIC_SEQ_CST) > 0)){
+      pthread_cond_wait(&pool_cond, &pool_lock);
+    }
+    pthread_mutex_unlock(&pool_lock);
+  }
+  return NULL;
+}
+
+// starts the workers on demand, if a thread cannot be started the remaining threads process its work
+static void start_workers(int count){
+  pthread_mutex_lock(&pool_lock);
+  while(started_workers < count - 1){
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&thread, &attr, worker_main, (void*) (intptr_t) (started_workers + 1));
+    pthread_attr_destroy(&attr);
+    if(ret != 0){
+      break;
+    }
+    __atomic_store_n(&started_workers, started_workers + 1, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&pool_lock);
+}
+
+void scilU_task_group_init(scilU_task_group_t* group){
+  group->pending = 0;
+}
+
+void scilU_task_group_run(scilU_task_group_t* group, scilU_task_func func, void* arg){
+  const int count = scilU_get_thread_count();
+  if(count == 1){
+    func(arg);
+    return;
+  }
+  start_workers(count);
+  task_t task;
+  task.func = func;
+  task.arg = arg;
+  task.group = group;
+  __atomic_add_fetch(&group->pending, 1, __ATOMIC_SEQ_CST);
+  push_task(worker_id, &task);
+  wake_all();
+}
+
+void scilU_task_group_wait(scilU_task_group_t* group){
+  while(__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) > 0){
+    if(run_one_task()){
+      continue;
+    }
+    pthread_mutex_lock(&pool_lock);
+    while(__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) > 0 && __atomic_load_n(&queued_tasks, __ATOMIC_SEQ_CST) == 0){
+      pthread_cond_wait(&pool_cond, &pool_lock);
+    }
+    pthread_mutex_unlock(&pool_lock);
+  }
+}
+
+typedef struct{
+  void (*func)(void* arg, int task);
+  void* arg;
+  int task;
+} run_task_t;
+
+static void run_task(void* arg){
+  run_task_t* t = (run_task_t*) arg;
+  t->func(t->arg, t->task);
+}
+
+void scilU_parallel_run(int task_count, void (*func)(void* arg, int task), void* arg){
+  if(task_count < 2 || scilU_get_thread_count() == 1){
+    for(int i = 0; i < task_count; i++){
+      func(arg, i);
+    }
+    return;
+  }
+  run_task_t* tasks = (run_task_t*) scilU_safe_malloc(task_count * sizeof(run_task_t));
+  scilU_task_group_t group;
+  scilU_task_group_init(&group);
+  for(int i = task_count - 1; i >= 0; i--){
+    tasks[i].func = func;
+    tasks[i].arg = arg;
+    tasks[i].task = i;
+    if(i > 0){
+      scilU_task_group_run(&group, run_task, &tasks[i]);
+    }
+  }
+  // the calling thread takes the first task
+  run_task(&tasks[0]);
+  scilU_task_group_wait(&group);
+  free(tasks);
+}
+
+typedef struct{
+  void (*func)(void* arg, size_t start, size_t end);
+  void* arg;
+  size_t count;
+  int ranges;
+} parallel_for_t;
+
+static void run_range(void* arg, int range){
+  parallel_for_t* p = (parallel_for_t*) arg;
+  const size_t start = p->count * (size_t) range / (size_t) p->ranges;
+  const size_t end = p->count * (size_t) (range + 1) / (size_t) p->ranges;
+  p->func(p->arg, start, end);
+}
+
+void scilU_parallel_for(size_t count, size_t grain, void (*func)(void* arg, size_t start, size_t end), void* arg){
+  if(count == 0){
+    return;
+  }
+  if(grain == 0){
+    grain = 1;
+  }
+  size_t ranges = count / grain;
+  const size_t max_ranges = (size_t) scilU_get_thread_count() * RANGES_PER_THREAD;
+  if(ranges > max_ranges) ranges = max_ranges;
+  if(ranges < 2){
+    func(arg, 0, count);
+    return;
+  }
+  parallel_for_t p;
+  p.func = func;
+  p.arg = arg;
+  p.count = count;
+  p.ranges = (int) ranges;
+  scilU_parallel_run(p.ranges, run_range, &p);
+}
+
+void* scilU_thread_scratch(size_t size){
+  pthread_once(&pool_once, initialize_pool);
+  scratch_t* s = (scratch_t*) pthread_getspecific(scratch_key);
+  if(s == NULL){
+    s = (scratch_t*) scilU_safe_malloc(sizeof(scratch_t));
+    s->buffer = NULL;
+    s->size = 0;
+    pthread_setspecific(scratch_key, s);
+  }
+  if(s->size < size){
+    free(s->buffer);
+    s->buffer = scilU_safe_malloc(size);
+    s->size = size;
+  }
+  return s->buffer;
+}
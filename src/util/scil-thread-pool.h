@@ -0,0 +1,78 @@
+// This file is part of SCIL.
+//
+// SCIL is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// SCIL is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SCIL.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * The thread pool shared by all parallel code paths of the library.
+ * Each worker owns a queue of tasks, an idle worker steals the oldest task
+ * of another queue. Threads outside of the pool submit into a shared queue.
+ * A thread that waits for tasks processes queued tasks meanwhile, thus tasks
+ * may submit and wait for tasks themselves and the calling thread always
+ * takes part in the work.
+ */
+
+#ifndef SCIL_THREAD_POOL_H
+#define SCIL_THREAD_POOL_H
+
+#include <stddef.h>
+
+// Upper bound for the number of threads including the calling thread
+#define SCIL_MAX_THREADS 64
+
+/*
+ * \brief Sets the number of threads that process parallel work, including the calling thread.
+ * \param count 1 processes all work in the calling thread. 0 restores the
+ *   default, the environment variable SCIL_THREADS or else the number of online processors.
+ * \return SCIL_NO_ERR, SCIL_EINVAL if count is negative
+ */
+int scilU_set_thread_count(int count);
+
+int scilU_get_thread_count();
+
+typedef void (*scilU_task_func)(void* arg);
+
+typedef struct{
+  size_t pending; // tasks not finished, updated atomically
+} scilU_task_group_t;
+
+void scilU_task_group_init(scilU_task_group_t* group);
+
+/*
+ * \brief Queues the task, with a single thread it is processed immediately.
+ */
+void scilU_task_group_run(scilU_task_group_t* group, scilU_task_func func, void* arg);
+
+/*
+ * \brief Returns after all tasks of the group finished, processes queued tasks meanwhile.
+ */
+void scilU_task_group_wait(scilU_task_group_t* group);
+
+/*
+ * \brief Calls func(arg, task) for each task in [0, task_count) and waits for them.
+ */
+void scilU_parallel_run(int task_count, void (*func)(void* arg, int task), void* arg);
+
+/*
+ * \brief Calls func(arg, start, end) for disjoint ranges covering [0, count).
+ * A range holds at least grain elements unless it is the last one.
+ */
+void scilU_parallel_for(size_t count, size_t grain, void (*func)(void* arg, size_t start, size_t end), void* arg);
+
+/*
+ * \brief Returns a buffer of at least size bytes private to the calling thread.
+ * The buffer stays valid until the next call of the same thread.
+ */
+void* scilU_thread_scratch(size_t size);
+
+#endif // SCIL_THREAD_POOL_H
@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <float.h>
+#include <pthread.h>
 
 
 #include <scil-user-hints.h>
@@ -216,6 +217,28 @@ void scilU_read_dims_from_buffer(scil_dims_t* dims, void* dest){
     }
 }
 
+byte* scilU_write_varint(byte* dest, uint64_t value){
+    while(value >= 128){
+        *dest = (byte) (value & 127) | 128;
+        value >>= 7;
+        dest++;
+    }
+    *dest = (byte) value;
+    return dest + 1;
+}
+
+const byte* scilU_read_varint(const byte* pos, const byte* end, uint64_t* value){
+    *value = 0;
+    for(int shift = 0; pos < end && shift < 64; shift += 7){
+        *value |= ((uint64_t) (*pos & 127)) << shift;
+        if(! (*pos & 128)){
+            return pos + 1;
+        }
+        pos++;
+    }
+    return NULL;
+}
+
 void scilU_print_buffer(char * dest, size_t out_size){
 	for (size_t i=0; i < out_size ; i++){
 		printf("%x", dest[i]);
@@ -228,22 +251,24 @@ void scilU_print_buffer(char * dest, size_t out_size){
 }
 
 
-static unsigned char sig_bits[MANTISSA_MAX_LENGTH_P1] = {255};
-static unsigned char sig_decimals[MANTISSA_MAX_LENGTH_P1] = {255};
+static unsigned char sig_bits[MANTISSA_MAX_LENGTH_P1];
+static unsigned char sig_decimals[MANTISSA_MAX_LENGTH_P1];
+static pthread_once_t sig_mapping_once = PTHREAD_ONCE_INIT;
 
 #define LOG10B2 3.3219280948873626
 #define LOG2B10 0.30102999566398114
 
-static void compute_significant_bit_mapping(){
-
-	if(sig_bits[0] != 255) return;
-
+static void compute_significant_bit_mapping_once(){
 	for(int i = 0; i < MANTISSA_MAX_LENGTH_P1; ++i){
 		sig_bits[i] = (unsigned char)ceil(i * LOG10B2);
 		sig_decimals[i] = (unsigned char)ceil(i * LOG2B10);
 	}
 }
 
+static void compute_significant_bit_mapping(){
+	pthread_once(& sig_mapping_once, compute_significant_bit_mapping_once);
+}
+
 int scilU_convert_significant_decimals_to_bits(int decimals){
   if (decimals == SCIL_ACCURACY_INT_FINEST){
     return SCIL_ACCURACY_INT_FINEST;
@@ -107,6 +107,19 @@ size_t scilU_write_dims_to_buffer(void *dest, const scil_dims_t *dims);
  */
 void scilU_read_dims_from_buffer(scil_dims_t *dims, void *dest);
 
+/**
+ * \brief Writes value as varint, 7 bits per byte starting with the lowest, the high bit marks that another byte follows.
+ * \pre dest can hold 10 bytes
+ * \return Position behind the written bytes
+ */
+byte * scilU_write_varint(byte * dest, uint64_t value);
+
+/**
+ * \brief Reads a varint written by scilU_write_varint() from [pos, end).
+ * \return Position behind the varint, NULL if it is truncated or too long
+ */
+const byte * scilU_read_varint(const byte * pos, const byte * end, uint64_t * value);
+
 ////////////// TIMER MANAGEMENT /////////////////////
 
 typedef struct timespec scil_timer;
@@ -0,0 +1,143 @@
+#include <scil-counters.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*  The counters of all threads are summed up, also of finished threads.
+    The trace keeps the last events.
+*/
+
+#define THREADS 4
+#define CALLS 1000
+
+static void* add_calls(void* arg){
+  for(int i = 0; i < CALLS; i++){
+    scilU_counter_add("compress:abstol", 100, 10, 0.001, i % 10 == 0);
+    char name[32];
+    sprintf(name, "thread:%d", (int)(size_t) arg);
+    scilU_counter_add(name, 1, 1, 0, 0);
+  }
+  return NULL;
+}
+
+static const scilU_counter_t* find(const scilU_counter_t* counters, int count, const char* name){
+  for(int i = 0; i < count; i++){
+    if(strcmp(counters[i].name, name) == 0){
+      return & counters[i];
+    }
+  }
+  return NULL;
+}
+
+static int check_counters(){
+  int errors = 0;
+  pthread_t threads[THREADS];
+  for(size_t i = 0; i < THREADS; i++){
+    pthread_create(& threads[i], NULL, add_calls, (void*) i);
+  }
+  for(int i = 0; i < THREADS; i++){
+    pthread_join(threads[i], NULL);
+  }
+  // names are truncated
+  char name[200];
+  memset(name, 'x', 199);
+  name[199] = 0;
+  scilU_counter_add(name, 0, 0, 0, 0);
+  scilU_counter_add("chooser:var:abstol,lz4,", 5, 0, 0, 0);
+
+  scilU_counter_t* counters;
+  const int count = scilU_counters_collect(& counters);
+  printf("counters,%d\n", count);
+  errors += count != THREADS + 3;
+  const scilU_counter_t* c = find(counters, count, "compress:abstol");
+  errors += c == NULL;
+  if(c != NULL){
+    printf("%s,%llu,%llu,%llu,%llu,%f\n", c->name, (unsigned long long) c->calls, (unsigned long long) c->errors,
+      (unsigned long long) c->input_bytes, (unsigned long long) c->output_bytes, c->seconds);
+    errors += c->calls != THREADS * CALLS || c->errors != THREADS * CALLS / 10;
+    errors += c->input_bytes != 100 * THREADS * CALLS || c->output_bytes != 10 * THREADS * CALLS;
+  }
+  errors += find(counters, count, "thread:3") == NULL;
+  errors += strlen(counters[count - 1].name) != SCILU_COUNTER_NAME_LENGTH - 1;
+  // sorted by name
+  for(int i = 1; i < count; i++){
+    errors += strcmp(counters[i - 1].name, counters[i].name) >= 0;
+  }
+  free(counters);
+  return errors;
+}
+
+static int contains(FILE* f, const char* text){
+  char buffer[65536];
+  rewind(f);
+  size_t len = fread(buffer, 1, sizeof(buffer) - 1, f);
+  buffer[len] = 0;
+  int count = 0;
+  for(char* p = strstr(buffer, text); p != NULL; p = strstr(p + 1, text)){
+    count++;
+  }
+  return count;
+}
+
+static int check_write(){
+  int errors = 0;
+  FILE* f = tmpfile();
+  scilU_counters_write(f, SCILU_COUNTERS_CSV);
+  errors += contains(f, "name,calls,errors,input_bytes,output_bytes,seconds\n") != 1;
+  // the comma of the chain is quoted
+  errors += contains(f, "\"chooser:var:abstol,lz4,\",1,0,5,0,") != 1;
+  fclose(f);
+
+  f = tmpfile();
+  scilU_counters_write(f, SCILU_COUNTERS_JSON);
+  errors += contains(f, "{\"counters\":[") != 1;
+  errors += contains(f, "{\"name\":\"compress:abstol\",\"calls\":4000,\"errors\":400,") != 1;
+  fclose(f);
+  printf("write,%d\n", errors);
+  return errors;
+}
+
+static int check_trace(){
+  int errors = 0;
+  errors += scilU_trace_enabled();
+  scilU_trace_set_capacity(10);
+  errors += ! scilU_trace_enabled();
+  for(int i = 0; i < 25; i++){
+    char name[32];
+    sprintf(name, "event:%d", i);
+    scil_timer t;
+    scilU_start_timer(& t);
+    scilU_trace_event(name, t, 0.000001);
+  }
+  FILE* f = tmpfile();
+  scilU_trace_write(f);
+  errors += contains(f, "{\"traceEvents\":[") != 1;
+  errors += contains(f, "\"ph\":\"X\"") != 10;
+  // only the last events are kept
+  errors += contains(f, "\"event:14\"") != 0;
+  errors += contains(f, "\"event:15\"") != 1;
+  errors += contains(f, "\"event:24\"") != 1;
+  fclose(f);
+  scilU_trace_set_capacity(0);
+  errors += scilU_trace_enabled();
+  printf("trace,%d\n", errors);
+  return errors;
+}
+
+int main(void){
+  int errors = 0;
+  scilU_counters_set_enabled(1);
+  errors += ! scilU_counters_enabled();
+  errors += check_counters();
+  errors += check_write();
+  errors += check_trace();
+
+  scilU_counters_reset();
+  scilU_counter_t* counters;
+  errors += scilU_counters_collect(& counters) != 0;
+  free(counters);
+  printf("Errors: %d\n", errors);
+  return errors;
+}
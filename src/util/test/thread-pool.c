@@ -0,0 +1,144 @@
+#include <scil-thread-pool.h>
+#include <scil-error.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*  The thread pool processes each task exactly once, also if tasks start and
+    wait for tasks themselves.
+*/
+
+#define COUNT 1000000
+
+typedef struct{
+  unsigned char* visited;
+  size_t calls; // updated atomically
+} visit_t;
+
+static void visit_range(void* arg, size_t start, size_t end){
+  visit_t* v = (visit_t*) arg;
+  for(size_t i = start; i < end; i++){
+    v->visited[i]++;
+  }
+  __atomic_add_fetch(& v->calls, 1, __ATOMIC_SEQ_CST);
+}
+
+static int check_visited(const char* name, visit_t* v, size_t count){
+  size_t wrong = 0;
+  for(size_t i = 0; i < count; i++){
+    wrong += v->visited[i] != 1;
+  }
+  printf("%s,%d,%zu,%zu\n", name, scilU_get_thread_count(), v->calls, wrong);
+  return wrong != 0;
+}
+
+static int check_parallel_for(){
+  visit_t v;
+  v.visited = (unsigned char*) calloc(COUNT, 1);
+  v.calls = 0;
+  scilU_parallel_for(COUNT, 1000, visit_range, & v);
+  int errors = check_visited("parallel for", & v, COUNT);
+  // a grain larger than the count results in a single range
+  memset(v.visited, 0, COUNT);
+  v.calls = 0;
+  scilU_parallel_for(COUNT, 2 * COUNT, visit_range, & v);
+  errors += check_visited("single range", & v, COUNT);
+  errors += v.calls != 1;
+  free(v.visited);
+  return errors;
+}
+
+// every task runs a parallel loop on its own part
+static void nested_task(void* arg, int task){
+  visit_t* v = (visit_t*) arg;
+  visit_t part;
+  part.visited = v->visited + (size_t) task * (COUNT / 10);
+  part.calls = 0;
+  scilU_parallel_for(COUNT / 10, 100, visit_range, & part);
+  __atomic_add_fetch(& v->calls, part.calls, __ATOMIC_SEQ_CST);
+}
+
+static int check_nested(){
+  visit_t v;
+  v.visited = (unsigned char*) calloc(COUNT, 1);
+  v.calls = 0;
+  scilU_parallel_run(10, nested_task, & v);
+  int errors = check_visited("nested", & v, COUNT);
+  free(v.visited);
+  return errors;
+}
+
+static pthread_t caller;
+static int other_thread;
+
+static void record_thread(void* arg){
+  size_t* count = (size_t*) arg;
+  if(! pthread_equal(pthread_self(), caller)){
+    other_thread = 1;
+  }
+  __atomic_add_fetch(count, 1, __ATOMIC_SEQ_CST);
+}
+
+static int check_serial(){
+  scilU_set_thread_count(1);
+  caller = pthread_self();
+  other_thread = 0;
+  size_t count = 0;
+  scilU_task_group_t group;
+  scilU_task_group_init(& group);
+  for(int i = 0; i < 100; i++){
+    scilU_task_group_run(& group, record_thread, & count);
+  }
+  scilU_task_group_wait(& group);
+  printf("serial,%d,%zu,%d\n", scilU_get_thread_count(), count, other_thread);
+  return count != 100 || other_thread;
+}
+
+static void use_scratch(void* arg, int task){
+  int* errors = (int*) arg;
+  unsigned char* s = (unsigned char*) scilU_thread_scratch(4096);
+  memset(s, task, 4096);
+  for(int i = 0; i < 4096; i++){
+    if(s[i] != (unsigned char) task){
+      __atomic_add_fetch(errors, 1, __ATOMIC_SEQ_CST);
+      return;
+    }
+  }
+}
+
+static int check_scratch(){
+  int errors = 0;
+  scilU_parallel_run(200, use_scratch, & errors);
+  printf("scratch,%d,%d\n", scilU_get_thread_count(), errors);
+  return errors;
+}
+
+// the pool starts its workers again in a forked child
+static int check_fork(){
+  fflush(stdout);
+  pid_t pid = fork();
+  if(pid == 0){
+    exit(check_parallel_for());
+  }
+  int status;
+  waitpid(pid, & status, 0);
+  return ! WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
+
+int main(void){
+  printf("#Check,Threads,Calls,Errors\n");
+  int errors = 0;
+  errors += scilU_set_thread_count(-1) != SCIL_EINVAL;
+  // more threads than processors are fine
+  scilU_set_thread_count(4);
+  errors += check_parallel_for();
+  errors += check_nested();
+  errors += check_scratch();
+  errors += check_fork();
+  errors += check_serial();
+  return errors;
+}